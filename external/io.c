@@ -1,37 +1,44 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-int write_int(int x) {
+/* The copy of the runtime linked into the compiler (for the JIT) prefixes its symbols, e.g. 'error' would clash with glibc */
+#ifdef MILA_RUNTIME_PREFIX
+#define MILA_RT(name) mila_rt_##name
+#else
+#define MILA_RT(name) name
+#endif
+
+int MILA_RT(write_int)(int x) {
     printf("%d", x);
     return 0;
 }
 
-int write_double(double x) {
+int MILA_RT(write_double)(double x) {
     printf("%.3f", x);
     return 0;
 }
 
-int writeln_int(int x) {
+int MILA_RT(writeln_int)(int x) {
     printf("%d\n", x);
     return 0;
 }
 
-int writeln_double(double x) {
+int MILA_RT(writeln_double)(double x) {
     printf("%.3f\n", x);
     return 0;
 }
 
-int readln_int(int *x) {
+int MILA_RT(readln_int)(int *x) {
     scanf("%d", x);
     return 0;
 }
 
-int readln_double(double *x) {
+int MILA_RT(readln_double)(double *x) {
     scanf("%lf", x);
     return 0;
 }
 
-int error(char *s) {
+int MILA_RT(error)(char *s) {
     printf("%s", s);
     exit(1);
 }
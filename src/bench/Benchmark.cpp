@@ -0,0 +1,90 @@
+#include "Benchmark.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <utility>
+#include <vector>
+
+static std::atomic<uint64_t> allocations{0};
+
+uint64_t allocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+// Counts the allocations of the measured code (the array and sized forms forward to these)
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void BenchmarkState::measure(const std::function<void()>& body, uint64_t bytes) {
+    body();
+
+    using Clock = std::chrono::steady_clock;
+    uint64_t runs = 0;
+    uint64_t allocationsBefore = allocationCount();
+    Clock::time_point start = Clock::now();
+    Clock::duration elapsed{};
+    do {
+        body();
+        ++runs;
+        elapsed = Clock::now() - start;
+    } while (elapsed < minTime);
+
+    iterations = runs;
+    nsPerIteration = std::chrono::duration<double, std::nano>(elapsed).count() / runs;
+    allocationsPerIteration = double(allocationCount() - allocationsBefore) / runs;
+    bytesPerIteration = bytes;
+}
+
+void BenchmarkState::setLabel(std::string text) {
+    label = std::move(text);
+}
+
+static std::vector<std::pair<const char*, BenchmarkRegistry::Function>>& benchmarks() {
+    static std::vector<std::pair<const char*, BenchmarkRegistry::Function>> registered;
+    return registered;
+}
+
+void BenchmarkRegistry::add(const char* name, Function function) {
+    benchmarks().emplace_back(name, function);
+}
+
+void BenchmarkRegistry::runAll(const std::string& filter) {
+    std::cout << std::left << std::setw(40) << "Benchmark" << std::right << std::setw(12) << "Iterations"
+              << std::setw(16) << "Time (us)" << std::setw(14) << "MB/s" << std::setw(14) << "Allocs" << "  Label\n";
+
+    for (const auto& [name, function] : benchmarks()) {
+        if (std::string(name).find(filter) == std::string::npos)
+            continue;
+
+        BenchmarkState state;
+        function(state);
+
+        std::cout << std::left << std::setw(40) << name << std::right << std::setw(12) << state.iterations
+                  << std::fixed << std::setprecision(2) << std::setw(16) << state.nsPerIteration / 1000;
+        if (state.bytesPerIteration > 0)
+            std::cout << std::setw(14) << state.bytesPerIteration * 1000.0 / state.nsPerIteration;
+        else
+            std::cout << std::setw(14) << "-";
+        std::cout << std::setprecision(0) << std::setw(14) << state.allocationsPerIteration << "  " << state.label
+                  << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkRegistry::runAll(argc > 1 ? argv[1] : "");
+    return 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/**
+ * @brief Number of heap allocations (operator new) so far, the benchmark binary replaces the global operator new
+ */
+uint64_t allocationCount();
+
+/**
+ * @brief Measures one benchmark body, see MILA_BENCHMARK
+ */
+class BenchmarkState {
+   private:
+    std::string label;
+    uint64_t iterations = 0;
+    double nsPerIteration = 0;
+    uint64_t bytesPerIteration = 0;
+    double allocationsPerIteration = 0;
+
+    friend class BenchmarkRegistry;
+
+   public:
+    /**
+     * @brief Minimum wall time of a measurement, the body is repeated until it is reached
+     */
+    static constexpr std::chrono::milliseconds minTime{300};
+
+    /**
+     * @brief Runs 'body' once to warm up, then repeatedly for at least 'minTime'
+     * @param bytes Input size processed by one run of 'body', reported as throughput
+     */
+    void measure(const std::function<void()>& body, uint64_t bytes = 0);
+
+    /**
+     * @brief Free-form text printed next to the result (e.g. the variant being compared)
+     */
+    void setLabel(std::string text);
+};
+
+class BenchmarkRegistry {
+   public:
+    using Function = void (*)(BenchmarkState&);
+
+    static void add(const char* name, Function function);
+
+    /**
+     * @brief Runs all benchmarks whose name contains 'filter' and prints a result line per benchmark
+     */
+    static void runAll(const std::string& filter);
+};
+
+struct BenchmarkRegistration {
+    BenchmarkRegistration(const char* name, BenchmarkRegistry::Function function) {
+        BenchmarkRegistry::add(name, function);
+    }
+};
+
+/**
+ * @brief Defines and registers a benchmark, the body calls 'state.measure(...)'
+ */
+#define MILA_BENCHMARK(NAME)                                                         \
+    static void NAME(BenchmarkState& state);                                         \
+    static BenchmarkRegistration NAME##Registration(#NAME, NAME);                    \
+    static void NAME(BenchmarkState& state)
+
+/**
+ * @brief Keeps the compiler from optimizing away a computed value
+ */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
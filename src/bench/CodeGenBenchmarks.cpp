@@ -0,0 +1,217 @@
+#include <string>
+#include "Benchmark.hpp"
+#include "ast/CodeGenerator.hpp"
+#include "ast/FlatAST.hpp"
+#include "ast/visitor/CollectorVisitor.hpp"
+#include "ast/visitor/SemaVisitor.hpp"
+#include "lexer/TokenStream.hpp"
+#include "parser/Parser.hpp"
+
+/**
+ * @brief 'globals' global variables followed by 'procedures' procedures, each with a parameter and a few locals, so
+ * that every procedure scope is opened with all the globals visible
+ */
+static std::string generateScopes(size_t globals, size_t procedures) {
+    std::string source = "program scopes;\nvar";
+    for (size_t i = 0; i < globals; ++i)
+        source += (i == 0 ? " g" : ", g") + std::to_string(i);
+    source += " : integer;\n";
+
+    for (size_t i = 0; i < procedures; ++i) {
+        const std::string global = "g" + std::to_string(i % globals);
+        source += "procedure p" + std::to_string(i) + "(n : integer);\nvar a, b : integer;\nbegin\n";
+        source += "    a := n + " + global + "; b := a * 2; " + global + " := b\nend;\n";
+    }
+
+    source += "begin\n    g0 := 1\nend.\n";
+    return source;
+}
+
+/**
+ * @brief Generates IR for N globals x M procedures, the time should grow linearly with N + M
+ */
+static void benchmarkScopes(BenchmarkState& state, size_t count) {
+    const std::string source = generateScopes(count, count);
+    TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+    ASTContext context;
+    Parser parser(stream, context);
+    ProgramASTNode* programNode = parser.parseProgram();
+
+    state.setLabel(std::to_string(count) + " globals x " + std::to_string(count) + " procedures");
+    state.measure(
+        [&]() {
+            GenContext gen("scopes");
+            CodeGenerator(programNode).generate(gen);
+            doNotOptimize(gen.module.size());
+        },
+        source.size());
+}
+
+/**
+ * @brief 'depth' nested while loops, each with a few statements and a break, inside a procedure with an exit
+ */
+static std::string generateNestedLoops(size_t depth) {
+    std::string source = "program loops;\nprocedure p(n : integer);\nvar i : integer;\nbegin\n";
+    for (size_t i = 0; i < depth; ++i)
+        source += "while i < n do begin i := i + 1; if i > " + std::to_string(i) + " then break;\n";
+    source += "if i = n then exit\n";
+    for (size_t i = 0; i < depth; ++i)
+        source += "end\n";
+    source += "end;\nbegin\n    p(1)\nend.\n";
+    return source;
+}
+
+/**
+ * @brief Generates IR for loops nested N deep, the time should grow linearly with N
+ */
+static void benchmarkNestedLoops(BenchmarkState& state, size_t depth) {
+    const std::string source = generateNestedLoops(depth);
+    TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+    ASTContext context;
+    Parser parser(stream, context);
+    ProgramASTNode* programNode = parser.parseProgram();
+
+    state.setLabel(std::to_string(depth) + " nested loops");
+    state.measure(
+        [&]() {
+            GenContext gen("loops");
+            CodeGenerator(programNode).generate(gen);
+            doNotOptimize(gen.module.size());
+        },
+        source.size());
+}
+
+/**
+ * @brief 'functions' functions mixing the usual statements: arithmetic, comparisons, array accesses, loops, calls
+ */
+static std::string generateLargeProgram(size_t functions) {
+    std::string source = "program large;\nconst limit = 10;\nvar total : integer; data : array [0 .. 9] of real;\n";
+    for (size_t i = 0; i < functions; ++i) {
+        const std::string name = "f" + std::to_string(i);
+        source += "function " + name + "(n : integer; x : real) : integer;\nvar i, acc : integer; y : real;\nbegin\n";
+        source += "    acc := n * 3 + total div 2 - (n mod 7);\n";
+        source += "    for i := 0 to limit - 1 do begin\n";
+        source += "        data[i] := data[i] + x * i - y / 2.0;\n";
+        source += "        if (acc > i) and not (i = 3) then acc := acc - i else acc := acc + 1;\n";
+        source += "        while acc > 100 do begin acc := acc div 2; if acc < 10 then break end\n";
+        source += "    end;\n";
+        if (i > 0)
+            source += "    acc := acc + f" + std::to_string(i - 1) + "(acc, to_real(n));\n";
+        source += "    if acc < 0 then writeln(acc);\n";
+        source += "    " + name + " := acc\nend;\n";
+    }
+    source += "begin\n    total := f" + std::to_string(functions - 1) + "(1, 2.5);\n    writeln(total)\nend.\n";
+    return source;
+}
+
+/**
+ * @brief Analyzes and generates IR for (or only analyzes) a large program
+ */
+static void benchmarkLargeProgram(BenchmarkState& state, size_t functions, bool analysisOnly) {
+    const std::string source = generateLargeProgram(functions);
+    TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+    ASTContext context;
+    Parser parser(stream, context);
+    ProgramASTNode* programNode = parser.parseProgram();
+
+    state.setLabel(std::to_string(functions) + " functions");
+    state.measure(
+        [&]() {
+            if (analysisOnly) {
+                SemaContext sema;
+                SemaVisitor(sema).analyze(*programNode);
+                doNotOptimize(sema.getNumSymbols());
+                return;
+            }
+
+            GenContext gen("large");
+            CodeGenerator(programNode).generate(gen);
+            doNotOptimize(gen.module.size());
+        },
+        source.size());
+}
+
+/**
+ * @brief Walks the tree of a large program (or its flat form) collecting the expressions, labeled with the bytes taken
+ * by the walked form
+ */
+static void benchmarkLargeProgramWalk(BenchmarkState& state, size_t functions, bool flat) {
+    const std::string source = generateLargeProgram(functions);
+    TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+    ASTContext context;
+    Parser parser(stream, context);
+    ProgramASTNode* programNode = parser.parseProgram();
+    FlatAST flatAST = FlatAST::lower(*programNode);
+
+    const size_t bytes = flat ? flatAST.getMemoryUsage() : context.getBytesAllocated();
+    state.setLabel(std::to_string(functions) + " functions, " + std::to_string(bytes / 1024) + " KiB");
+    state.measure(
+        [&]() {
+            if (!flat) {
+                CollectorVisitor<ExprASTNode> exprs;
+                exprs.dispatch(*programNode);
+                doNotOptimize(exprs.collectedNodes.size());
+                return;
+            }
+
+            std::vector<FlatAST::NodeId> exprs;
+            const auto& kinds = flatAST.getKinds();
+            for (FlatAST::NodeId id = 0; id < kinds.size(); ++id) {
+                if (kinds[id] >= ASTNode::Kind::BIN_OP && kinds[id] <= ASTNode::Kind::FUN_CALL)
+                    exprs.push_back(id);
+            }
+            doNotOptimize(exprs.size());
+        },
+        source.size());
+}
+
+MILA_BENCHMARK(CodeGenScopes1k) {
+    benchmarkScopes(state, 1000);
+}
+
+MILA_BENCHMARK(CodeGenScopes2k) {
+    benchmarkScopes(state, 2000);
+}
+
+MILA_BENCHMARK(CodeGenScopes4k) {
+    benchmarkScopes(state, 4000);
+}
+
+MILA_BENCHMARK(CodeGenNestedLoops100) {
+    benchmarkNestedLoops(state, 100);
+}
+
+MILA_BENCHMARK(CodeGenNestedLoops200) {
+    benchmarkNestedLoops(state, 200);
+}
+
+MILA_BENCHMARK(CodeGenNestedLoops300) {
+    benchmarkNestedLoops(state, 300);
+}
+
+MILA_BENCHMARK(SemaLargeProgram) {
+    benchmarkLargeProgram(state, 2000, true);
+}
+
+MILA_BENCHMARK(CodeGenLargeProgram) {
+    benchmarkLargeProgram(state, 2000, false);
+}
+
+MILA_BENCHMARK(TreeWalkLargeProgram) {
+    benchmarkLargeProgramWalk(state, 2000, false);
+}
+
+MILA_BENCHMARK(FlatWalkLargeProgram) {
+    benchmarkLargeProgramWalk(state, 2000, true);
+}
+
+MILA_BENCHMARK(FlatLowerLargeProgram) {
+    const std::string source = generateLargeProgram(2000);
+    TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+    ASTContext context;
+    Parser parser(stream, context);
+    ProgramASTNode* programNode = parser.parseProgram();
+
+    state.setLabel("2000 functions");
+    state.measure([&]() { doNotOptimize(FlatAST::lower(*programNode).size()); }, source.size());
+}
@@ -0,0 +1,472 @@
+#include <charconv>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Benchmark.hpp"
+#include "lexer/Keywords.hpp"
+#include "lexer/Lexer.hpp"
+#include "lexer/Scanner.hpp"
+#include "lexer/TokenPipe.hpp"
+#include "lexer/TokenStream.hpp"
+#include "parser/Parser.hpp"
+
+/**
+ * @brief Identifier-heavy words: one in four is a keyword, the rest are drawn from 4096 distinct identifiers of 1 to
+ * 12 characters (names repeat, as in real programs), many of them sharing a prefix with a keyword (the worst case of
+ * the ordered map)
+ */
+static std::vector<std::string> generateWords(size_t count) {
+    static const char* const prefixes[] = {"be", "en", "pro", "fun", "wh", "do", "i", "tmp", "x", "count"};
+    std::mt19937 random(42);
+
+    std::vector<std::string> identifiers;
+    for (size_t i = 0; i < 4096; ++i) {
+        std::string identifier = prefixes[random() % std::size(prefixes)];
+        for (size_t length = random() % 8; length > 0; --length)
+            identifier.push_back(static_cast<char>('a' + random() % 26));
+        identifiers.push_back(std::move(identifier));
+    }
+
+    std::vector<std::string> words;
+    words.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (random() % 4 == 0)
+            words.emplace_back(Keywords::keywords[random() % Keywords::keywords.size()].spelling);
+        else
+            words.push_back(identifiers[random() % identifiers.size()]);
+    }
+
+    return words;
+}
+
+static std::string generateSource(const std::vector<std::string>& words) {
+    std::string source;
+    for (size_t i = 0; i < words.size(); ++i)
+        source += words[i] + (i % 8 == 7 ? ";\n" : " ");
+    return source;
+}
+
+static uint64_t totalSize(const std::vector<std::string>& words) {
+    uint64_t size = 0;
+    for (const auto& word : words)
+        size += word.size();
+    return size;
+}
+
+/**
+ * @brief The keyword table as it was before the perfect hash, the baseline
+ */
+static const std::map<std::string, TokenType>& keywordMap() {
+    static const std::map<std::string, TokenType> map = []() {
+        std::map<std::string, TokenType> keywords;
+        for (const auto& keyword : Keywords::keywords)
+            keywords.emplace(keyword.spelling, keyword.type);
+        return keywords;
+    }();
+    return map;
+}
+
+MILA_BENCHMARK(KeywordLookupStdMap) {
+    const std::vector<std::string> words = generateWords(100000);
+    const auto& keywords = keywordMap();
+
+    state.setLabel("std::map<std::string, TokenType>::find");
+    state.measure(
+        [&]() {
+            for (const auto& word : words) {
+                // The lexer used to build the string before the lookup
+                std::string identifier(word.data(), word.size());
+                auto it = keywords.find(identifier);
+                doNotOptimize(it);
+            }
+        },
+        totalSize(words));
+}
+
+MILA_BENCHMARK(KeywordLookupPerfectHash) {
+    const std::vector<std::string> words = generateWords(100000);
+
+    state.setLabel("Keywords::lookup");
+    state.measure(
+        [&]() {
+            for (const auto& word : words)
+                doNotOptimize(Keywords::lookup(word.data(), word.size()));
+        },
+        totalSize(words));
+}
+
+MILA_BENCHMARK(LexIdentifierHeavySource) {
+    const std::string source = generateSource(generateWords(200000));
+
+    state.setLabel("Lexer over an in-memory SourceBuffer");
+    state.measure(
+        [&]() {
+            Lexer lexer(source.data(), source.data() + source.size());
+            while (!lexer.match(TokenType::EOI)) {
+                if (!lexer.match(TokenType::IDENTIFIER))
+                    lexer.match(lexer.peek().getType());
+            }
+        },
+        source.size());
+}
+
+/**
+ * @brief Generated-code shape: deep indentation and '{ ... }' comments around few short statements
+ */
+static std::string generateIndentedSource(size_t lines) {
+    std::string source;
+    for (size_t i = 0; i < lines; ++i) {
+        source += std::string(4 * (1 + i % 12), ' ');
+        if (i % 3 == 0)
+            source += "{ generated from rule " + std::to_string(i) + ", do not edit by hand }\n";
+        else
+            source += "x := x + 1;\n";
+    }
+    return source;
+}
+
+static void benchmarkSkipping(BenchmarkState& state, Scanner::Isa isa, const char* label) {
+    if (!Scanner::isSupported(isa)) {
+        state.setLabel(std::string(label) + " (not supported)");
+        return;
+    }
+
+    const std::string source = generateIndentedSource(100000);
+    state.setLabel(label);
+    state.measure(
+        [&]() {
+            const char* cur = source.data();
+            const char* end = source.data() + source.size();
+            size_t comments = 0;
+            while (cur < end) {
+                cur = Scanner::skipWhitespace(cur, end, isa);
+                if (cur < end && *cur == '{') {
+                    cur = Scanner::skipComment(cur + 1, end, isa);
+                    ++comments;
+                }
+                // Statement or '}'
+                while (cur < end && *cur != '\n')
+                    ++cur;
+            }
+            doNotOptimize(comments);
+        },
+        source.size());
+}
+
+MILA_BENCHMARK(SkipIndentationAndCommentsScalar) {
+    benchmarkSkipping(state, Scanner::Isa::Scalar, "Scanner, scalar");
+}
+
+MILA_BENCHMARK(SkipIndentationAndCommentsSSE2) {
+    benchmarkSkipping(state, Scanner::Isa::SSE2, "Scanner, SSE2");
+}
+
+MILA_BENCHMARK(SkipIndentationAndCommentsAVX2) {
+    benchmarkSkipping(state, Scanner::Isa::AVX2, "Scanner, AVX2");
+}
+
+MILA_BENCHMARK(LexIndentedSource) {
+    const std::string source = generateIndentedSource(100000);
+
+    state.setLabel("Lexer, whitespace/comment-heavy");
+    state.measure(
+        [&]() {
+            Lexer lexer(source.data(), source.data() + source.size());
+            while (!lexer.match(TokenType::EOI))
+                lexer.match(lexer.peek().getType());
+        },
+        source.size());
+}
+
+/**
+ * @brief Layout of a token before interning, to compare the memory of a lexed file
+ */
+struct LegacyToken {
+    TokenType type;
+    Position position;
+    std::optional<TokenValue> value;
+};
+
+MILA_BENCHMARK(LexAndStoreTokens) {
+    // Long, repeated identifiers as in generated code
+    std::vector<std::string> words = generateWords(200000);
+    for (size_t i = 0; i < words.size(); ++i)
+        words[i] += "_generated_suffix";
+    const std::string source = generateSource(words);
+
+    size_t tokenCount = 0;
+    size_t internerBytes = 0;
+    size_t legacyStringBytes = 0;
+    state.measure(
+        [&]() {
+            Lexer lexer(source.data(), source.data() + source.size());
+            std::vector<Token> tokens;
+            while (lexer.peek().getType() != TokenType::EOI)
+                tokens.push_back(*lexer.match(lexer.peek().getType()));
+
+            tokenCount = tokens.size();
+            internerBytes = lexer.getInterner().getMemoryUsage();
+            legacyStringBytes = 0;
+            for (const Token& token : tokens) {
+                // Every identifier owned its std::string, heap allocated beyond the small string buffer
+                size_t length = token.getType() == TokenType::IDENTIFIER
+                                    ? lexer.getInterner().getName(token.getSymbol()).size()
+                                    : 0;
+                legacyStringBytes += length > 15 ? length + 1 : 0;
+            }
+            doNotOptimize(tokens.data());
+        },
+        source.size());
+
+    size_t bytes = tokenCount * sizeof(Token) + internerBytes;
+    size_t legacyBytes = tokenCount * sizeof(LegacyToken) + legacyStringBytes;
+    state.setLabel(std::to_string(tokenCount) + " tokens: " + std::to_string(bytes / 1024) + " KiB (" +
+                   std::to_string(sizeof(Token)) + " B tokens + interner), was " + std::to_string(legacyBytes / 1024) +
+                   " KiB (" + std::to_string(sizeof(LegacyToken)) + " B tokens + strings)");
+}
+
+MILA_BENCHMARK(LexIntoTokenStream) {
+    std::vector<std::string> words = generateWords(200000);
+    for (size_t i = 0; i < words.size(); ++i)
+        words[i] += "_generated_suffix";
+    const std::string source = generateSource(words);
+
+    size_t tokenCount = 0;
+    size_t bytes = 0;
+    state.measure(
+        [&]() {
+            TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+            tokenCount = stream.size();
+            bytes = stream.getMemoryUsage();
+            doNotOptimize(stream);
+        },
+        source.size());
+
+    state.setLabel(std::to_string(tokenCount) + " tokens: " + std::to_string(bytes / 1024) + " KiB (" +
+                   std::to_string(bytes / tokenCount) + " B per token, without the interner)");
+}
+
+/**
+ * @brief A program of many small statements, to compare parsing from the streaming lexer and from the token arrays
+ */
+static std::string generateProgram(size_t statements) {
+    std::string source = "program generated;\nvar x, y, counter : integer;\nbegin\n";
+    for (size_t i = 0; i < statements; ++i) {
+        if (i % 4 == 0)
+            source += "    if x > " + std::to_string(i) + " then y := y + 1 else y := y - 1;\n";
+        else if (i % 4 == 1)
+            source += "    while counter < 10 do counter := counter + 1;\n";
+        else
+            source += "    x := (x + " + std::to_string(i) + ") * y - counter div 2;\n";
+    }
+    source += "    x := 0\nend.\n";
+    return source;
+}
+
+MILA_BENCHMARK(ParseFromLexer) {
+    const std::string source = generateProgram(50000);
+
+    state.setLabel("Lexer and Parser interleaved");
+    state.measure(
+        [&]() {
+            Lexer lexer(source.data(), source.data() + source.size());
+            ASTContext context;
+            Parser parser(lexer, context);
+            doNotOptimize(parser.parseProgram());
+        },
+        source.size());
+}
+
+MILA_BENCHMARK(ParseFromTokenStream) {
+    const std::string source = generateProgram(50000);
+
+    state.setLabel("TokenStream::lex, then Parser over the arrays");
+    state.measure(
+        [&]() {
+            TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+            ASTContext context;
+            Parser parser(stream, context);
+            doNotOptimize(parser.parseProgram());
+        },
+        source.size());
+}
+
+/**
+ * @brief Generated program of about 'megabytes' MB, parsed either after lexing it serially into a TokenStream or with
+ * the lexer running concurrently on its own thread (TokenPipe)
+ */
+static void benchmarkLargeSource(BenchmarkState& state, size_t megabytes, bool pipelined) {
+    // A statement of the generated program takes 47 characters on average
+    const std::string source = generateProgram(megabytes * 1024 * 1024 / 47);
+
+    state.setLabel(std::to_string((source.size() + 512 * 1024) / (1024 * 1024)) + " MB, " +
+                   (pipelined ? "TokenPipe (lexer thread) + Parser" : "TokenStream::lex, then Parser"));
+    state.measure(
+        [&]() {
+            if (pipelined) {
+                TokenPipe pipe(source.data(), source.data() + source.size());
+                ASTContext context;
+                Parser parser(pipe, context);
+                doNotOptimize(parser.parseProgram());
+            } else {
+                TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+                ASTContext context;
+                Parser parser(stream, context);
+                doNotOptimize(parser.parseProgram());
+            }
+        },
+        source.size());
+}
+
+MILA_BENCHMARK(ParseLargeSerial1MB) {
+    benchmarkLargeSource(state, 1, false);
+}
+
+MILA_BENCHMARK(ParseLargePipelined1MB) {
+    benchmarkLargeSource(state, 1, true);
+}
+
+MILA_BENCHMARK(ParseLargeSerial10MB) {
+    benchmarkLargeSource(state, 10, false);
+}
+
+MILA_BENCHMARK(ParseLargePipelined10MB) {
+    benchmarkLargeSource(state, 10, true);
+}
+
+MILA_BENCHMARK(ParseLargeSerial100MB) {
+    benchmarkLargeSource(state, 100, false);
+}
+
+MILA_BENCHMARK(ParseLargePipelined100MB) {
+    benchmarkLargeSource(state, 100, true);
+}
+
+/**
+ * @brief Expression-heavy program: long conditions and arithmetic mixing all precedence levels, mostly of literals and
+ * variables (the operands that used to descend through every level)
+ */
+static std::string generateExpressions(size_t statements) {
+    std::mt19937 random(3);
+    std::string source = "program expressions;\nvar a, b, c, x : integer;\nbegin\n";
+    for (size_t i = 0; i < statements; ++i) {
+        auto literal = [&]() { return std::to_string(random() % 1000); };
+        if (i % 2 == 0)
+            source += "    if (a + " + literal() + " * b < c - " + literal() + ") and (x mod " + literal() +
+                      " = 0) or not (a >= b) then x := -x;\n";
+        else
+            source += "    x := a * " + literal() + " + b div " + literal() + " - c * (x + " + literal() + ") - " +
+                      literal() + " * " + literal() + ";\n";
+    }
+    source += "    x := 0\nend.\n";
+    return source;
+}
+
+MILA_BENCHMARK(ParseExpressions) {
+    const std::string source = generateExpressions(50000);
+
+    state.setLabel("TokenStream::lex, then Parser, expression-heavy");
+    state.measure(
+        [&]() {
+            TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+            ASTContext context;
+            Parser parser(stream, context);
+            doNotOptimize(parser.parseProgram());
+        },
+        source.size());
+}
+
+/**
+ * @brief Numeric-table shape (e.g. generated lookup tables): rows of integer and real constants
+ */
+static std::string generateNumericTable(size_t rows) {
+    std::mt19937 random(7);
+    std::string source;
+    for (size_t i = 0; i < rows; ++i) {
+        source += "    t[" + std::to_string(i) + "] := " + std::to_string(random() % 1000000) + "; ";
+        source += "r[" + std::to_string(i) + "] := " + std::to_string(random() % 1000) + "." +
+                  std::to_string(random()) + std::to_string(random() % 100000) + ";";
+        if (i % 4 == 0)
+            source += " s := " + std::to_string(random() % 100) + ".5e-" + std::to_string(random() % 20) + ";";
+        source += '\n';
+    }
+    return source;
+}
+
+/**
+ * @brief Real literals of the table as [first, last) ranges, to compare the conversions alone
+ */
+static std::vector<std::string_view> extractReals(const std::string& source) {
+    std::vector<std::string_view> reals;
+    for (size_t pos = source.find(":= "); pos != std::string::npos; pos = source.find(":= ", pos)) {
+        pos += 3;
+        size_t length = source.find(';', pos) - pos;
+        std::string_view literal(source.data() + pos, length);
+        if (literal.find('.') != std::string_view::npos && literal.find('e') == std::string_view::npos)
+            reals.push_back(literal);
+    }
+    return reals;
+}
+
+MILA_BENCHMARK(ConvertRealsDivision) {
+    const std::string source = generateNumericTable(100000);
+    const std::vector<std::string_view> reals = extractReals(source);
+
+    uint64_t bytes = 0;
+    for (auto real : reals)
+        bytes += real.size();
+
+    state.setLabel("digit / divider accumulation, as the lexer used to (overflows past 9 fractional digits)");
+    state.measure(
+        [&]() {
+            for (auto real : reals) {
+                int integer = 0;
+                size_t i = 0;
+                for (; real[i] != '.'; ++i)
+                    integer = integer * 10 + real[i] - '0';
+                double value = integer;
+                int divider = 10;
+                for (++i; i < real.size(); ++i) {
+                    value += (double)(real[i] - '0') / divider;
+                    divider *= 10;
+                }
+                doNotOptimize(value);
+            }
+        },
+        bytes);
+}
+
+MILA_BENCHMARK(ConvertRealsFromChars) {
+    const std::string source = generateNumericTable(100000);
+    const std::vector<std::string_view> reals = extractReals(source);
+
+    uint64_t bytes = 0;
+    for (auto real : reals)
+        bytes += real.size();
+
+    state.setLabel("std::from_chars, correctly rounded");
+    state.measure(
+        [&]() {
+            for (auto real : reals) {
+                double value = 0.0;
+                std::from_chars(real.data(), real.data() + real.size(), value);
+                doNotOptimize(value);
+            }
+        },
+        bytes);
+}
+
+MILA_BENCHMARK(LexNumericTable) {
+    const std::string source = generateNumericTable(100000);
+
+    state.setLabel("Lexer, numeric-table-heavy");
+    state.measure(
+        [&]() {
+            Lexer lexer(source.data(), source.data() + source.size());
+            while (lexer.next().getType() != TokenType::EOI) {
+            }
+        },
+        source.size());
+}
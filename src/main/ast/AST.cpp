@@ -1,8 +1,44 @@
 #include "AST.hpp"
+#include <type_traits>
 #include <utility>
 #include "visitor/ASTNodeVisitor.hpp"
-
-PrimitiveTypeASTNode::PrimitiveTypeASTNode(PrimitiveType type) : type(type) {}
+#include "utils/Statistic.hpp"
+
+MILA_STATISTIC(NumPrimitiveTypeNodes, "ast", "Number of PrimitiveTypeASTNode nodes allocated");
+MILA_STATISTIC(NumArrayTypeNodes, "ast", "Number of ArrayTypeASTNode nodes allocated");
+MILA_STATISTIC(NumBinOpNodes, "ast", "Number of BinOpASTNode nodes allocated");
+MILA_STATISTIC(NumUnaryOpNodes, "ast", "Number of UnaryOpASTNode nodes allocated");
+MILA_STATISTIC(NumLiteralNodes, "ast", "Number of LiteralASTNode nodes allocated");
+MILA_STATISTIC(NumDeclVarRefNodes, "ast", "Number of DeclVarRefASTNode nodes allocated");
+MILA_STATISTIC(NumDeclArrayRefNodes, "ast", "Number of DeclArrayRefASTNode nodes allocated");
+MILA_STATISTIC(NumFunCallNodes, "ast", "Number of FunCallASTNode nodes allocated");
+MILA_STATISTIC(NumBlockNodes, "ast", "Number of BlockASTNode nodes allocated");
+MILA_STATISTIC(NumCompoundStmtNodes, "ast", "Number of CompoundStmtASTNode nodes allocated");
+MILA_STATISTIC(NumVarDeclNodes, "ast", "Number of VarDeclASTNode nodes allocated");
+MILA_STATISTIC(NumArrayDeclNodes, "ast", "Number of ArrayDeclASTNode nodes allocated");
+MILA_STATISTIC(NumConstDefNodes, "ast", "Number of ConstDefASTNode nodes allocated");
+MILA_STATISTIC(NumProcDeclNodes, "ast", "Number of ProcDeclASTNode nodes allocated");
+MILA_STATISTIC(NumFunDeclNodes, "ast", "Number of FunDeclASTNode nodes allocated");
+MILA_STATISTIC(NumAssignNodes, "ast", "Number of AssignASTNode nodes allocated");
+MILA_STATISTIC(NumIfNodes, "ast", "Number of IfASTNode nodes allocated");
+MILA_STATISTIC(NumWhileNodes, "ast", "Number of WhileASTNode nodes allocated");
+MILA_STATISTIC(NumForNodes, "ast", "Number of ForASTNode nodes allocated");
+MILA_STATISTIC(NumProcCallNodes, "ast", "Number of ProcCallASTNode nodes allocated");
+MILA_STATISTIC(NumProgramNodes, "ast", "Number of ProgramASTNode nodes allocated");
+
+// The ASTContext releases these without running any destructor
+template <typename... Nodes>
+constexpr bool allTriviallyDestructible = (std::is_trivially_destructible_v<Nodes> && ...);
+static_assert(allTriviallyDestructible<PrimitiveTypeASTNode, ArrayTypeASTNode, BinOpASTNode, UnaryOpASTNode,
+                                       LiteralASTNode, DeclVarRefASTNode, DeclArrayRefASTNode, FunCallASTNode,
+                                       BlockASTNode, CompoundStmtASTNode, VarDeclASTNode, ArrayDeclASTNode,
+                                       ConstDefASTNode, ProcDeclASTNode, FunDeclASTNode, AssignASTNode, IfASTNode,
+                                       WhileASTNode, ForASTNode, ProcCallASTNode, EmptyStmtASTNode, ProgramASTNode,
+                                       BreakASTNode, ExitASTNode>);
+
+PrimitiveTypeASTNode::PrimitiveTypeASTNode(PrimitiveType type) : TypeASTNode(Kind::PRIMITIVE_TYPE), type(type) {
+    ++NumPrimitiveTypeNodes;
+}
 
 PrimitiveTypeASTNode::PrimitiveType PrimitiveTypeASTNode::getPrimitiveType() const {
     return type;
@@ -12,18 +48,20 @@ TypeASTNode::Type PrimitiveTypeASTNode::getType() const {
     return TypeASTNode::Type::PRIMITIVE;
 }
 
-std::unique_ptr<DeclASTNode> PrimitiveTypeASTNode::createDeclNode(const std::string& ident) const {
-    return std::make_unique<VarDeclASTNode>(ident, std::make_unique<PrimitiveTypeASTNode>(type));
+DeclASTNode* PrimitiveTypeASTNode::createDeclNode(ASTContext& context, const std::string& ident) const {
+    return context.create<VarDeclASTNode>(ident, context.create<PrimitiveTypeASTNode>(type));
 }
 
 void PrimitiveTypeASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-ArrayTypeASTNode::ArrayTypeASTNode(std::unique_ptr<PrimitiveTypeASTNode> elemTypeNode, int lowerBound, int upperBound)
-    : elemTypeNode(std::move(elemTypeNode)), lowerBound(lowerBound), upperBound(upperBound) {}
+ArrayTypeASTNode::ArrayTypeASTNode(PrimitiveTypeASTNode* elemTypeNode, int lowerBound, int upperBound)
+    : TypeASTNode(Kind::ARRAY_TYPE), elemTypeNode(elemTypeNode), lowerBound(lowerBound), upperBound(upperBound) {
+    ++NumArrayTypeNodes;
+}
 
-const std::unique_ptr<PrimitiveTypeASTNode>& ArrayTypeASTNode::getElemTypeNode() const {
+PrimitiveTypeASTNode* ArrayTypeASTNode::getElemTypeNode() const {
     return elemTypeNode;
 }
 
@@ -39,28 +77,30 @@ TypeASTNode::Type ArrayTypeASTNode::getType() const {
     return TypeASTNode::Type::ARRAY;
 }
 
-std::unique_ptr<DeclASTNode> ArrayTypeASTNode::createDeclNode(const std::string& ident) const {
-    return std::make_unique<ArrayDeclASTNode>(
-        ident, std::make_unique<ArrayTypeASTNode>(
-                   std::make_unique<PrimitiveTypeASTNode>(elemTypeNode->getPrimitiveType()), lowerBound, upperBound));
+DeclASTNode* ArrayTypeASTNode::createDeclNode(ASTContext& context, const std::string& ident) const {
+    return context.create<ArrayDeclASTNode>(
+        ident, context.create<ArrayTypeASTNode>(context.create<PrimitiveTypeASTNode>(elemTypeNode->getPrimitiveType()),
+                                                lowerBound, upperBound));
 }
 
 void ArrayTypeASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-BinOpASTNode::BinOpASTNode(Token op, std::unique_ptr<ExprASTNode> lhsExprNode, std::unique_ptr<ExprASTNode> rhsExprNode)
-    : op(std::move(op)), lhsExprNode(std::move(lhsExprNode)), rhsExprNode(std::move(rhsExprNode)) {}
+BinOpASTNode::BinOpASTNode(Token op, ExprASTNode* lhsExprNode, ExprASTNode* rhsExprNode)
+    : ExprASTNode(Kind::BIN_OP), op(op), lhsExprNode(lhsExprNode), rhsExprNode(rhsExprNode) {
+    ++NumBinOpNodes;
+}
 
 const Token& BinOpASTNode::getOp() const {
     return op;
 }
 
-const std::unique_ptr<ExprASTNode>& BinOpASTNode::getLhsExprNode() const {
+ExprASTNode* BinOpASTNode::getLhsExprNode() const {
     return lhsExprNode;
 }
 
-const std::unique_ptr<ExprASTNode>& BinOpASTNode::getRhsExprNode() const {
+ExprASTNode* BinOpASTNode::getRhsExprNode() const {
     return rhsExprNode;
 }
 
@@ -68,14 +108,16 @@ void BinOpASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-UnaryOpASTNode::UnaryOpASTNode(Token op, std::unique_ptr<ExprASTNode> exprNode)
-    : op(std::move(op)), exprNode(std::move(exprNode)) {}
+UnaryOpASTNode::UnaryOpASTNode(Token op, ExprASTNode* exprNode)
+    : ExprASTNode(Kind::UNARY_OP), op(op), exprNode(exprNode) {
+    ++NumUnaryOpNodes;
+}
 
 const Token& UnaryOpASTNode::getOp() const {
     return op;
 }
 
-const std::unique_ptr<ExprASTNode>& UnaryOpASTNode::getExprNode() const {
+ExprASTNode* UnaryOpASTNode::getExprNode() const {
     return exprNode;
 }
 
@@ -83,32 +125,38 @@ void UnaryOpASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-LiteralASTNode::LiteralASTNode(TokenValue value) : value(std::move(value)) {}
+LiteralASTNode::LiteralASTNode(std::variant<int, double> value) : ExprASTNode(Kind::LITERAL), value(value) {
+    ++NumLiteralNodes;
+}
 
 TokenValue LiteralASTNode::getValue() const {
-    return value;
+    return std::visit([](auto literal) -> TokenValue { return literal; }, value);
 }
 
 void LiteralASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-DeclRefASTNode::DeclRefASTNode(std::string refName) : refName(std::move(refName)) {}
+DeclRefASTNode::DeclRefASTNode(Kind kind, const std::string& refName) : ExprASTNode(kind), refName(&refName) {}
 
 const std::string& DeclRefASTNode::getRefName() const {
-    return refName;
+    return *refName;
 }
 
-DeclVarRefASTNode::DeclVarRefASTNode(std::string refName) : DeclRefASTNode(std::move(refName)) {}
+DeclVarRefASTNode::DeclVarRefASTNode(const std::string& refName) : DeclRefASTNode(Kind::DECL_VAR_REF, refName) {
+    ++NumDeclVarRefNodes;
+}
 
 void DeclVarRefASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-DeclArrayRefASTNode::DeclArrayRefASTNode(std::string refName, std::unique_ptr<ExprASTNode> indexNode)
-    : DeclRefASTNode(std::move(refName)), indexNode(std::move(indexNode)) {}
+DeclArrayRefASTNode::DeclArrayRefASTNode(const std::string& refName, ExprASTNode* indexNode)
+    : DeclRefASTNode(Kind::DECL_ARRAY_REF, refName), indexNode(indexNode) {
+    ++NumDeclArrayRefNodes;
+}
 
-const std::unique_ptr<ExprASTNode>& DeclArrayRefASTNode::getIndexNode() const {
+ExprASTNode* DeclArrayRefASTNode::getIndexNode() const {
     return indexNode;
 }
 
@@ -116,14 +164,16 @@ void DeclArrayRefASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-FunCallASTNode::FunCallASTNode(std::string funName, std::vector<std::unique_ptr<ExprASTNode>> argNodes)
-    : funName(std::move(funName)), argNodes(std::move(argNodes)) {}
+FunCallASTNode::FunCallASTNode(const std::string& funName, llvm::ArrayRef<ExprASTNode*> argNodes)
+    : ExprASTNode(Kind::FUN_CALL), funName(&funName), argNodes(argNodes) {
+    ++NumFunCallNodes;
+}
 
 const std::string& FunCallASTNode::getFunName() const {
-    return funName;
+    return *funName;
 }
 
-const std::vector<std::unique_ptr<ExprASTNode>>& FunCallASTNode::getArgNodes() const {
+llvm::ArrayRef<ExprASTNode*> FunCallASTNode::getArgNodes() const {
     return argNodes;
 }
 
@@ -131,10 +181,12 @@ void FunCallASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-BlockASTNode::BlockASTNode(std::vector<std::unique_ptr<StatementASTNode>> statementNodes)
-    : statementNodes(std::move(statementNodes)) {}
+BlockASTNode::BlockASTNode(llvm::ArrayRef<StatementASTNode*> statementNodes)
+    : StatementASTNode(Kind::BLOCK), statementNodes(statementNodes) {
+    ++NumBlockNodes;
+}
 
-const std::vector<std::unique_ptr<StatementASTNode>>& BlockASTNode::getStatementNodes() const {
+llvm::ArrayRef<StatementASTNode*> BlockASTNode::getStatementNodes() const {
     return statementNodes;
 }
 
@@ -150,10 +202,12 @@ void BlockASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-CompoundStmtASTNode::CompoundStmtASTNode(std::vector<std::unique_ptr<StatementASTNode>> statementNodes)
-    : statementNodes(std::move(statementNodes)) {}
+CompoundStmtASTNode::CompoundStmtASTNode(llvm::ArrayRef<StatementASTNode*> statementNodes)
+    : StatementASTNode(Kind::COMPOUND_STMT), statementNodes(statementNodes) {
+    ++NumCompoundStmtNodes;
+}
 
-const std::vector<std::unique_ptr<StatementASTNode>>& CompoundStmtASTNode::getStatementNodes() const {
+llvm::ArrayRef<StatementASTNode*> CompoundStmtASTNode::getStatementNodes() const {
     return statementNodes;
 }
 
@@ -161,7 +215,7 @@ void CompoundStmtASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-DeclASTNode::DeclASTNode(std::string declName) : declName(std::move(declName)) {}
+DeclASTNode::DeclASTNode(Kind kind, const std::string& declName) : StatementASTNode(kind), declName(&declName) {}
 
 bool DeclASTNode::isGlobal() const {
     return global;
@@ -172,13 +226,15 @@ void DeclASTNode::setGlobal(bool _global) {
 }
 
 const std::string& DeclASTNode::getDeclName() const {
-    return declName;
+    return *declName;
 }
 
-VarDeclASTNode::VarDeclASTNode(std::string varName, std::unique_ptr<PrimitiveTypeASTNode> typeNode)
-    : DeclASTNode(std::move(varName)), typeNode(std::move(typeNode)) {}
+VarDeclASTNode::VarDeclASTNode(const std::string& varName, PrimitiveTypeASTNode* typeNode)
+    : DeclASTNode(Kind::VAR_DECL, varName), typeNode(typeNode) {
+    ++NumVarDeclNodes;
+}
 
-const std::unique_ptr<PrimitiveTypeASTNode>& VarDeclASTNode::getTypeNode() const {
+PrimitiveTypeASTNode* VarDeclASTNode::getTypeNode() const {
     return typeNode;
 }
 
@@ -186,10 +242,12 @@ void VarDeclASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-ArrayDeclASTNode::ArrayDeclASTNode(std::string arrayName, std::unique_ptr<ArrayTypeASTNode> typeNode)
-    : DeclASTNode(std::move(arrayName)), typeNode(std::move(typeNode)) {}
+ArrayDeclASTNode::ArrayDeclASTNode(const std::string& arrayName, ArrayTypeASTNode* typeNode)
+    : DeclASTNode(Kind::ARRAY_DECL, arrayName), typeNode(typeNode) {
+    ++NumArrayDeclNodes;
+}
 
-const std::unique_ptr<ArrayTypeASTNode>& ArrayDeclASTNode::getTypeNode() const {
+ArrayTypeASTNode* ArrayDeclASTNode::getTypeNode() const {
     return typeNode;
 }
 
@@ -197,34 +255,30 @@ void ArrayDeclASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-ConstDefASTNode::ConstDefASTNode(std::string constName, std::unique_ptr<ExprASTNode> exprNode)
-    : DeclASTNode(std::move(constName)), exprNode(std::move(exprNode)) {}
-
-const std::unique_ptr<ExprASTNode>& ConstDefASTNode::getExprNode() const {
-    return exprNode;
+ConstDefASTNode::ConstDefASTNode(const std::string& constName, ExprASTNode* exprNode)
+    : DeclASTNode(Kind::CONST_DEF, constName), exprNode(exprNode) {
+    ++NumConstDefNodes;
 }
 
-const std::optional<std::unique_ptr<PrimitiveTypeASTNode>>& ConstDefASTNode::getTypeNode() const {
-    return typeNode;
+ExprASTNode* ConstDefASTNode::getExprNode() const {
+    return exprNode;
 }
 
 void ConstDefASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-void ConstDefASTNode::setTypeNode(std::unique_ptr<PrimitiveTypeASTNode> newTypeNode) {
-    typeNode = std::move(newTypeNode);
+ProcDeclASTNode::ProcDeclASTNode(const std::string& procName, llvm::ArrayRef<VarDeclASTNode*> paramNodes,
+                                 std::optional<BlockASTNode*> optBlockNode)
+    : DeclASTNode(Kind::PROC_DECL, procName), paramNodes(paramNodes), optBlockNode(optBlockNode) {
+    ++NumProcDeclNodes;
 }
 
-ProcDeclASTNode::ProcDeclASTNode(std::string procName, std::vector<std::unique_ptr<VarDeclASTNode>> paramNodes,
-                                 std::optional<std::unique_ptr<BlockASTNode>> optBlockNode)
-    : DeclASTNode(std::move(procName)), paramNodes(std::move(paramNodes)), optBlockNode(std::move(optBlockNode)) {}
-
-const std::vector<std::unique_ptr<VarDeclASTNode>>& ProcDeclASTNode::getParamNodes() const {
+llvm::ArrayRef<VarDeclASTNode*> ProcDeclASTNode::getParamNodes() const {
     return paramNodes;
 }
 
-const std::optional<std::unique_ptr<BlockASTNode>>& ProcDeclASTNode::getBlockNode() const {
+const std::optional<BlockASTNode*>& ProcDeclASTNode::getBlockNode() const {
     return optBlockNode;
 }
 
@@ -232,23 +286,24 @@ void ProcDeclASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-FunDeclASTNode::FunDeclASTNode(std::string funName, std::vector<std::unique_ptr<VarDeclASTNode>> paramNodes,
-                               std::optional<std::unique_ptr<BlockASTNode>> optBlockNode,
-                               std::unique_ptr<PrimitiveTypeASTNode> retTypeNode)
-    : DeclASTNode(std::move(funName)),
-      paramNodes(std::move(paramNodes)),
-      retTypeNode(std::move(retTypeNode)),
-      optBlockNode(std::move(optBlockNode)) {}
+FunDeclASTNode::FunDeclASTNode(const std::string& funName, llvm::ArrayRef<VarDeclASTNode*> paramNodes,
+                               std::optional<BlockASTNode*> optBlockNode, PrimitiveTypeASTNode* retTypeNode)
+    : DeclASTNode(Kind::FUN_DECL, funName),
+      paramNodes(paramNodes),
+      retTypeNode(retTypeNode),
+      optBlockNode(optBlockNode) {
+    ++NumFunDeclNodes;
+}
 
-const std::vector<std::unique_ptr<VarDeclASTNode>>& FunDeclASTNode::getParamNodes() const {
+llvm::ArrayRef<VarDeclASTNode*> FunDeclASTNode::getParamNodes() const {
     return paramNodes;
 }
 
-const std::unique_ptr<PrimitiveTypeASTNode>& FunDeclASTNode::getRetTypeNode() const {
+PrimitiveTypeASTNode* FunDeclASTNode::getRetTypeNode() const {
     return retTypeNode;
 }
 
-const std::optional<std::unique_ptr<BlockASTNode>>& FunDeclASTNode::getBlockNode() const {
+const std::optional<BlockASTNode*>& FunDeclASTNode::getBlockNode() const {
     return optBlockNode;
 }
 
@@ -256,14 +311,16 @@ void FunDeclASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-AssignASTNode::AssignASTNode(std::unique_ptr<DeclRefASTNode> varNode, std::unique_ptr<ExprASTNode> exprNode)
-    : varNode(std::move(varNode)), exprNode(std::move(exprNode)) {}
+AssignASTNode::AssignASTNode(DeclRefASTNode* varNode, ExprASTNode* exprNode)
+    : StatementASTNode(Kind::ASSIGN), varNode(varNode), exprNode(exprNode) {
+    ++NumAssignNodes;
+}
 
-const std::unique_ptr<DeclRefASTNode>& AssignASTNode::getVarNode() const {
+DeclRefASTNode* AssignASTNode::getVarNode() const {
     return varNode;
 }
 
-const std::unique_ptr<ExprASTNode>& AssignASTNode::getExprNode() const {
+ExprASTNode* AssignASTNode::getExprNode() const {
     return exprNode;
 }
 
@@ -271,19 +328,21 @@ void AssignASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-IfASTNode::IfASTNode(std::unique_ptr<ExprASTNode> condNode, std::unique_ptr<StatementASTNode> bodyNode,
-                     std::optional<std::unique_ptr<StatementASTNode>> optElseBodyNode)
-    : condNode(std::move(condNode)), bodyNode(std::move(bodyNode)), optElseBodyNode(std::move(optElseBodyNode)) {}
+IfASTNode::IfASTNode(ExprASTNode* condNode, StatementASTNode* bodyNode,
+                     std::optional<StatementASTNode*> optElseBodyNode)
+    : StatementASTNode(Kind::IF), condNode(condNode), bodyNode(bodyNode), optElseBodyNode(optElseBodyNode) {
+    ++NumIfNodes;
+}
 
-const std::unique_ptr<ExprASTNode>& IfASTNode::getCondNode() const {
+ExprASTNode* IfASTNode::getCondNode() const {
     return condNode;
 }
 
-const std::unique_ptr<StatementASTNode>& IfASTNode::getBodyNode() const {
+StatementASTNode* IfASTNode::getBodyNode() const {
     return bodyNode;
 }
 
-const std::optional<std::unique_ptr<StatementASTNode>>& IfASTNode::getElseBodyNode() const {
+const std::optional<StatementASTNode*>& IfASTNode::getElseBodyNode() const {
     return optElseBodyNode;
 }
 
@@ -291,14 +350,16 @@ void IfASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-WhileASTNode::WhileASTNode(std::unique_ptr<ExprASTNode> condNode, std::unique_ptr<StatementASTNode> bodyNode)
-    : condNode(std::move(condNode)), bodyNode(std::move(bodyNode)) {}
+WhileASTNode::WhileASTNode(ExprASTNode* condNode, StatementASTNode* bodyNode)
+    : StatementASTNode(Kind::WHILE), condNode(condNode), bodyNode(bodyNode) {
+    ++NumWhileNodes;
+}
 
-const std::unique_ptr<ExprASTNode>& WhileASTNode::getCondNode() const {
+ExprASTNode* WhileASTNode::getCondNode() const {
     return condNode;
 }
 
-const std::unique_ptr<StatementASTNode>& WhileASTNode::getBodyNode() const {
+StatementASTNode* WhileASTNode::getBodyNode() const {
     return bodyNode;
 }
 
@@ -306,19 +367,20 @@ void WhileASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-ForASTNode::ForASTNode(std::unique_ptr<AssignASTNode> initNode, std::unique_ptr<ExprASTNode> toNode,
-                       std::unique_ptr<StatementASTNode> bodyNode, bool increasing)
-    : initNode(std::move(initNode)), toNode(std::move(toNode)), bodyNode(std::move(bodyNode)), increasing(increasing) {}
+ForASTNode::ForASTNode(AssignASTNode* initNode, ExprASTNode* toNode, StatementASTNode* bodyNode, bool increasing)
+    : StatementASTNode(Kind::FOR), initNode(initNode), toNode(toNode), bodyNode(bodyNode), increasing(increasing) {
+    ++NumForNodes;
+}
 
-const std::unique_ptr<AssignASTNode>& ForASTNode::getInitNode() const {
+AssignASTNode* ForASTNode::getInitNode() const {
     return initNode;
 }
 
-const std::unique_ptr<ExprASTNode>& ForASTNode::getToNode() const {
+ExprASTNode* ForASTNode::getToNode() const {
     return toNode;
 }
 
-const std::unique_ptr<StatementASTNode>& ForASTNode::getBodyNode() const {
+StatementASTNode* ForASTNode::getBodyNode() const {
     return bodyNode;
 }
 
@@ -330,14 +392,16 @@ void ForASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-ProcCallASTNode::ProcCallASTNode(std::string procName, std::vector<std::unique_ptr<ExprASTNode>> argNodes)
-    : procName(std::move(procName)), argNodes(std::move(argNodes)) {}
+ProcCallASTNode::ProcCallASTNode(const std::string& procName, llvm::ArrayRef<ExprASTNode*> argNodes)
+    : StatementASTNode(Kind::PROC_CALL), procName(&procName), argNodes(argNodes) {
+    ++NumProcCallNodes;
+}
 
 const std::string& ProcCallASTNode::getProcName() const {
-    return procName;
+    return *procName;
 }
 
-const std::vector<std::unique_ptr<ExprASTNode>>& ProcCallASTNode::getArgNodes() const {
+llvm::ArrayRef<ExprASTNode*> ProcCallASTNode::getArgNodes() const {
     return argNodes;
 }
 
@@ -349,14 +413,16 @@ void EmptyStmtASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-ProgramASTNode::ProgramASTNode(std::string programName, std::unique_ptr<BlockASTNode> blockNode)
-    : programName(std::move(programName)), blockNode(std::move(blockNode)) {}
+ProgramASTNode::ProgramASTNode(const std::string& programName, BlockASTNode* blockNode)
+    : ASTNode(Kind::PROGRAM), programName(&programName), blockNode(blockNode) {
+    ++NumProgramNodes;
+}
 
 const std::string& ProgramASTNode::getProgramName() const {
-    return programName;
+    return *programName;
 }
 
-const std::unique_ptr<BlockASTNode>& ProgramASTNode::getBlockNode() const {
+BlockASTNode* ProgramASTNode::getBlockNode() const {
     return blockNode;
 }
 
@@ -364,26 +430,10 @@ void ProgramASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-void BreakASTNode::setBreakBlock(llvm::BasicBlock* BB) {
-    breakBlock = BB;
-}
-
-llvm::BasicBlock* BreakASTNode::getBreakBlock() const {
-    return breakBlock;
-}
-
 void BreakASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
 
-void ExitASTNode::setRetV(ExitASTNode::RetV newRetV) {
-    retV = std::move(newRetV);
-}
-
-const ExitASTNode::RetV& ExitASTNode::getRetV() const {
-    return retV;
-}
-
 void ExitASTNode::accept(ASTNodeVisitor& visitor) {
     visitor.visit(*this);
 }
@@ -2,10 +2,12 @@
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
+#include <llvm/Support/Casting.h>
 #include <map>
-#include <memory>
+#include <optional>
 #include <ostream>
-#include <vector>
+#include <variant>
+#include "ASTContext.hpp"
 #include "lexer/Token.hpp"
 
 //------------------------------------------------------------------------------//
@@ -14,23 +16,83 @@
 class ASTNodeVisitor;
 class StatementASTNode;
 class DeclASTNode;
+class SemaType;
 
 //------------------------------------------------------------------------------//
 
 /**
  * @brief Base AST node interface
+ * @note Nodes are created in and owned by an ASTContext (ASTContext::create), children are plain pointers into the
+ * same context and names are pooled by it. Nodes are never deleted one by one, hence the non-virtual destructor.
  */
 class ASTNode {
    public:
-    virtual ~ASTNode() = default;
+    /**
+     * @brief Concrete class of the node, for llvm::isa/cast/dyn_cast (see the classof of each class)
+     * @note The kinds of the subclasses of an abstract class are contiguous, so that its classof is a range check
+     */
+    enum class Kind : uint8_t {
+        // TypeASTNode
+        PRIMITIVE_TYPE,
+        ARRAY_TYPE,
+        // ExprASTNode
+        BIN_OP,
+        UNARY_OP,
+        LITERAL,
+        DECL_VAR_REF,  // DeclRefASTNode
+        DECL_ARRAY_REF,
+        FUN_CALL,
+        // StatementASTNode
+        BLOCK,
+        COMPOUND_STMT,
+        VAR_DECL,  // DeclASTNode
+        ARRAY_DECL,
+        CONST_DEF,
+        PROC_DECL,
+        FUN_DECL,
+        ASSIGN,
+        IF,
+        WHILE,
+        FOR,
+        PROC_CALL,
+        EMPTY_STMT,
+        BREAK,
+        EXIT,
+        PROGRAM,
+    };
+
+   private:
+    const Kind kind;
+
+    /**
+     * @brief Offset of the node in the source code, resolved to a position by the SourceManager for diagnostics
+     */
+    uint32_t offset = 0;
+
+   protected:
+    explicit ASTNode(Kind kind) : kind(kind) {}
+    ~ASTNode() = default;
+
+   public:
     virtual void accept(ASTNodeVisitor& visitor) = 0;
+
+    [[nodiscard]] Kind getKind() const { return kind; }
+    [[nodiscard]] uint32_t getOffset() const { return offset; }
+    void setOffset(uint32_t offset) { this->offset = offset; }
 };
 
 /**
  * @brief Abstract type node
  */
 class TypeASTNode : public ASTNode {
+   protected:
+    using ASTNode::ASTNode;
+
    public:
+    static bool classof(const ASTNode* node) {
+        return node->getKind() >= Kind::PRIMITIVE_TYPE && node->getKind() <= Kind::ARRAY_TYPE;
+    }
+
     /**
      * @brief Type of the types :)
      */
@@ -44,7 +106,7 @@ class TypeASTNode : public ASTNode {
     /**
      * @brief Creates a declaration node with the given identifier and the type of the node that overrides this method
      */
-    [[nodiscard]] virtual std::unique_ptr<DeclASTNode> createDeclNode(const std::string& ident) const = 0;
+    [[nodiscard]] virtual DeclASTNode* createDeclNode(ASTContext& context, const std::string& ident) const = 0;
 };
 
 /**
@@ -64,7 +126,8 @@ class PrimitiveTypeASTNode : public TypeASTNode {
     explicit PrimitiveTypeASTNode(PrimitiveType type);
     [[nodiscard]] PrimitiveType getPrimitiveType() const;
     [[nodiscard]] TypeASTNode::Type getType() const override;
-    [[nodiscard]] std::unique_ptr<DeclASTNode> createDeclNode(const std::string& ident) const override;
+    [[nodiscard]] DeclASTNode* createDeclNode(ASTContext& context, const std::string& ident) const override;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::PRIMITIVE_TYPE; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -73,38 +136,56 @@ class PrimitiveTypeASTNode : public TypeASTNode {
  */
 class ArrayTypeASTNode : public TypeASTNode {
    private:
-    std::unique_ptr<PrimitiveTypeASTNode> elemTypeNode;
+    PrimitiveTypeASTNode* elemTypeNode;
     int lowerBound;
     int upperBound;
 
    public:
-    ArrayTypeASTNode(std::unique_ptr<PrimitiveTypeASTNode> elemTypeNode, int lowerBound, int upperBound);
-    [[nodiscard]] const std::unique_ptr<PrimitiveTypeASTNode>& getElemTypeNode() const;
+    ArrayTypeASTNode(PrimitiveTypeASTNode* elemTypeNode, int lowerBound, int upperBound);
+    [[nodiscard]] PrimitiveTypeASTNode* getElemTypeNode() const;
     [[nodiscard]] int getLowerBound() const;
     [[nodiscard]] int getUpperBound() const;
     [[nodiscard]] TypeASTNode::Type getType() const override;
-    [[nodiscard]] std::unique_ptr<DeclASTNode> createDeclNode(const std::string& ident) const override;
+    [[nodiscard]] DeclASTNode* createDeclNode(ASTContext& context, const std::string& ident) const override;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::ARRAY_TYPE; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
 /**
  * @brief Expression node interface
  */
-class ExprASTNode : public ASTNode {};
+class ExprASTNode : public ASTNode {
+    /**
+     * @brief Interned by the SemaContext, set by the semantic analysis
+     */
+    const SemaType* semaType = nullptr;
+
+   protected:
+    using ASTNode::ASTNode;
+
+   public:
+    static bool classof(const ASTNode* node) {
+        return node->getKind() >= Kind::BIN_OP && node->getKind() <= Kind::FUN_CALL;
+    }
+
+    [[nodiscard]] const SemaType* getSemaType() const { return semaType; }
+    void setSemaType(const SemaType* type) { semaType = type; }
+};
 
 /**
  * @brief Binary operation
  */
 class BinOpASTNode : public ExprASTNode {
     Token op;
-    std::unique_ptr<ExprASTNode> lhsExprNode;
-    std::unique_ptr<ExprASTNode> rhsExprNode;
+    ExprASTNode* lhsExprNode;
+    ExprASTNode* rhsExprNode;
 
    public:
-    BinOpASTNode(Token op, std::unique_ptr<ExprASTNode> lhsExprNode, std::unique_ptr<ExprASTNode> rhsExprNode);
+    BinOpASTNode(Token op, ExprASTNode* lhsExprNode, ExprASTNode* rhsExprNode);
     [[nodiscard]] const Token& getOp() const;
-    [[nodiscard]] const std::unique_ptr<ExprASTNode>& getLhsExprNode() const;
-    [[nodiscard]] const std::unique_ptr<ExprASTNode>& getRhsExprNode() const;
+    [[nodiscard]] ExprASTNode* getLhsExprNode() const;
+    [[nodiscard]] ExprASTNode* getRhsExprNode() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::BIN_OP; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -113,24 +194,26 @@ class BinOpASTNode : public ExprASTNode {
  */
 class UnaryOpASTNode : public ExprASTNode {
     Token op;
-    std::unique_ptr<ExprASTNode> exprNode;
+    ExprASTNode* exprNode;
 
    public:
-    UnaryOpASTNode(Token op, std::unique_ptr<ExprASTNode> exprNode);
+    UnaryOpASTNode(Token op, ExprASTNode* exprNode);
     [[nodiscard]] const Token& getOp() const;
-    [[nodiscard]] const std::unique_ptr<ExprASTNode>& getExprNode() const;
+    [[nodiscard]] ExprASTNode* getExprNode() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::UNARY_OP; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
 /**
- * @brief Literal (integer, real, string)
+ * @brief Literal (integer, real)
  */
 class LiteralASTNode : public ExprASTNode {
-    TokenValue value;
+    std::variant<int, double> value;
 
    public:
-    explicit LiteralASTNode(TokenValue value);
+    explicit LiteralASTNode(std::variant<int, double> value);
     [[nodiscard]] TokenValue getValue() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::LITERAL; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -139,11 +222,26 @@ class LiteralASTNode : public ExprASTNode {
  */
 class DeclRefASTNode : public ExprASTNode {
    protected:
-    std::string refName;
+    /**
+     * @brief Pooled by the ASTContext, like all names of the nodes
+     */
+    const std::string* refName;
+
+    /**
+     * @brief Referenced symbol (index into the SemaContext), bound by the semantic analysis
+     */
+    uint32_t symbolId = 0;
+
+    DeclRefASTNode(Kind kind, const std::string& refName);
 
    public:
-    explicit DeclRefASTNode(std::string refName);
+    static bool classof(const ASTNode* node) {
+        return node->getKind() >= Kind::DECL_VAR_REF && node->getKind() <= Kind::DECL_ARRAY_REF;
+    }
+
     [[nodiscard]] const std::string& getRefName() const;
+    [[nodiscard]] uint32_t getSymbolId() const { return symbolId; }
+    void setSymbolId(uint32_t id) { symbolId = id; }
 };
 
 /**
@@ -151,7 +249,8 @@ class DeclRefASTNode : public ExprASTNode {
  */
 class DeclVarRefASTNode : public DeclRefASTNode {
    public:
-    explicit DeclVarRefASTNode(std::string refName);
+    explicit DeclVarRefASTNode(const std::string& refName);
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::DECL_VAR_REF; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -159,11 +258,12 @@ class DeclVarRefASTNode : public DeclRefASTNode {
  * @brief Array declaration reference
  */
 class DeclArrayRefASTNode : public DeclRefASTNode {
-    std::unique_ptr<ExprASTNode> indexNode;
+    ExprASTNode* indexNode;
 
    public:
-    DeclArrayRefASTNode(std::string refName, std::unique_ptr<ExprASTNode> indexNode);
-    [[nodiscard]] const std::unique_ptr<ExprASTNode>& getIndexNode() const;
+    DeclArrayRefASTNode(const std::string& refName, ExprASTNode* indexNode);
+    [[nodiscard]] ExprASTNode* getIndexNode() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::DECL_ARRAY_REF; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -171,20 +271,36 @@ class DeclArrayRefASTNode : public DeclRefASTNode {
  * @brief Function call
  */
 class FunCallASTNode : public ExprASTNode {
-    std::string funName;
-    std::vector<std::unique_ptr<ExprASTNode>> argNodes;
+    const std::string* funName;
+    llvm::ArrayRef<ExprASTNode*> argNodes;
+
+    /**
+     * @brief Called routine (index into the SemaContext), bound by the semantic analysis
+     */
+    uint32_t routineId = 0;
 
    public:
-    FunCallASTNode(std::string funName, std::vector<std::unique_ptr<ExprASTNode>> argNodes);
+    FunCallASTNode(const std::string& funName, llvm::ArrayRef<ExprASTNode*> argNodes);
     [[nodiscard]] const std::string& getFunName() const;
-    [[nodiscard]] const std::vector<std::unique_ptr<ExprASTNode>>& getArgNodes() const;
+    [[nodiscard]] llvm::ArrayRef<ExprASTNode*> getArgNodes() const;
+    [[nodiscard]] uint32_t getRoutineId() const { return routineId; }
+    void setRoutineId(uint32_t id) { routineId = id; }
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::FUN_CALL; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
 /**
  * @brief Statement node interface
  */
-class StatementASTNode : public ASTNode {};
+class StatementASTNode : public ASTNode {
+   protected:
+    using ASTNode::ASTNode;
+
+   public:
+    static bool classof(const ASTNode* node) {
+        return node->getKind() >= Kind::BLOCK && node->getKind() <= Kind::EXIT;
+    }
+};
 
 /**
  * @brief Block statement
@@ -195,13 +311,14 @@ class BlockASTNode : public StatementASTNode {
      * @note In main block, all declared constants/variables are global. And there is only one main block (similar to main() in C).
      */
     bool main = false;
-    std::vector<std::unique_ptr<StatementASTNode>> statementNodes;
+    llvm::ArrayRef<StatementASTNode*> statementNodes;
 
    public:
-    explicit BlockASTNode(std::vector<std::unique_ptr<StatementASTNode>> statementNodes);
+    explicit BlockASTNode(llvm::ArrayRef<StatementASTNode*> statementNodes);
     [[nodiscard]] bool isMain() const;
     void setMain(bool _main);
-    [[nodiscard]] const std::vector<std::unique_ptr<StatementASTNode>>& getStatementNodes() const;
+    [[nodiscard]] llvm::ArrayRef<StatementASTNode*> getStatementNodes() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::BLOCK; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -209,11 +326,12 @@ class BlockASTNode : public StatementASTNode {
  * @brief Compound statement
  */
 class CompoundStmtASTNode : public StatementASTNode {
-    std::vector<std::unique_ptr<StatementASTNode>> statementNodes;
+    llvm::ArrayRef<StatementASTNode*> statementNodes;
 
    public:
-    explicit CompoundStmtASTNode(std::vector<std::unique_ptr<StatementASTNode>> statementNodes);
-    [[nodiscard]] const std::vector<std::unique_ptr<StatementASTNode>>& getStatementNodes() const;
+    explicit CompoundStmtASTNode(llvm::ArrayRef<StatementASTNode*> statementNodes);
+    [[nodiscard]] llvm::ArrayRef<StatementASTNode*> getStatementNodes() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::COMPOUND_STMT; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -221,25 +339,40 @@ class CompoundStmtASTNode : public StatementASTNode {
  * @brief Abstract declaration statement
  */
 class DeclASTNode : public StatementASTNode {
-    std::string declName;
+    const std::string* declName;
     bool global = false;
 
+    /**
+     * @brief Declared symbol, or routine for procedures and functions (index into the SemaContext), set by the
+     * semantic analysis
+     */
+    uint32_t symbolId = 0;
+
+   protected:
+    DeclASTNode(Kind kind, const std::string& declName);
+
    public:
-    explicit DeclASTNode(std::string declName);
+    static bool classof(const ASTNode* node) {
+        return node->getKind() >= Kind::VAR_DECL && node->getKind() <= Kind::FUN_DECL;
+    }
+
     [[nodiscard]] const std::string& getDeclName() const;
     [[nodiscard]] bool isGlobal() const;
     void setGlobal(bool _global);
+    [[nodiscard]] uint32_t getSymbolId() const { return symbolId; }
+    void setSymbolId(uint32_t id) { symbolId = id; }
 };
 
 /**
  * @brief Primitive variable declaration
  */
 class VarDeclASTNode : public DeclASTNode {
-    std::unique_ptr<PrimitiveTypeASTNode> typeNode;
+    PrimitiveTypeASTNode* typeNode;
 
    public:
-    VarDeclASTNode(std::string varName, std::unique_ptr<PrimitiveTypeASTNode> typeNode);
-    [[nodiscard]] const std::unique_ptr<PrimitiveTypeASTNode>& getTypeNode() const;
+    VarDeclASTNode(const std::string& varName, PrimitiveTypeASTNode* typeNode);
+    [[nodiscard]] PrimitiveTypeASTNode* getTypeNode() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::VAR_DECL; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -247,11 +380,12 @@ class VarDeclASTNode : public DeclASTNode {
  * @brief Array declaration
  */
 class ArrayDeclASTNode : public DeclASTNode {
-    std::unique_ptr<ArrayTypeASTNode> typeNode;
+    ArrayTypeASTNode* typeNode;
 
    public:
-    ArrayDeclASTNode(std::string arrayName, std::unique_ptr<ArrayTypeASTNode> typeNode);
-    [[nodiscard]] const std::unique_ptr<ArrayTypeASTNode>& getTypeNode() const;
+    ArrayDeclASTNode(const std::string& arrayName, ArrayTypeASTNode* typeNode);
+    [[nodiscard]] ArrayTypeASTNode* getTypeNode() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::ARRAY_DECL; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -259,18 +393,15 @@ class ArrayDeclASTNode : public DeclASTNode {
  * @brief Constant definition
  */
 class ConstDefASTNode : public DeclASTNode {
-    std::unique_ptr<ExprASTNode> exprNode;
-
     /**
-     * @note Type is inferred during codegen from the exprNode
+     * @note The type of the constant is the one of the expression, inferred by the semantic analysis
      */
-    std::optional<std::unique_ptr<PrimitiveTypeASTNode>> typeNode = std::nullopt;
+    ExprASTNode* exprNode;
 
    public:
-    ConstDefASTNode(std::string constName, std::unique_ptr<ExprASTNode> exprNode);
-    [[nodiscard]] const std::unique_ptr<ExprASTNode>& getExprNode() const;
-    [[nodiscard]] const std::optional<std::unique_ptr<PrimitiveTypeASTNode>>& getTypeNode() const;
-    void setTypeNode(std::unique_ptr<PrimitiveTypeASTNode> newTypeNode);
+    ConstDefASTNode(const std::string& constName, ExprASTNode* exprNode);
+    [[nodiscard]] ExprASTNode* getExprNode() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::CONST_DEF; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -278,18 +409,19 @@ class ConstDefASTNode : public DeclASTNode {
  * @brief Procedure declaration
  */
 class ProcDeclASTNode : public DeclASTNode {
-    std::vector<std::unique_ptr<VarDeclASTNode>> paramNodes;
+    llvm::ArrayRef<VarDeclASTNode*> paramNodes;
 
     /**
      * @note Forward declaration does not have body (definition)
      */
-    std::optional<std::unique_ptr<BlockASTNode>> optBlockNode;
+    std::optional<BlockASTNode*> optBlockNode;
 
    public:
-    ProcDeclASTNode(std::string procName, std::vector<std::unique_ptr<VarDeclASTNode>> paramNodes,
-                    std::optional<std::unique_ptr<BlockASTNode>> optBlockNode);
-    [[nodiscard]] const std::vector<std::unique_ptr<VarDeclASTNode>>& getParamNodes() const;
-    [[nodiscard]] const std::optional<std::unique_ptr<BlockASTNode>>& getBlockNode() const;
+    ProcDeclASTNode(const std::string& procName, llvm::ArrayRef<VarDeclASTNode*> paramNodes,
+                    std::optional<BlockASTNode*> optBlockNode);
+    [[nodiscard]] llvm::ArrayRef<VarDeclASTNode*> getParamNodes() const;
+    [[nodiscard]] const std::optional<BlockASTNode*>& getBlockNode() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::PROC_DECL; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -297,21 +429,28 @@ class ProcDeclASTNode : public DeclASTNode {
  * @brief Function declaration
  */
 class FunDeclASTNode : public DeclASTNode {
-    std::vector<std::unique_ptr<VarDeclASTNode>> paramNodes;
-    std::unique_ptr<PrimitiveTypeASTNode> retTypeNode;
+    llvm::ArrayRef<VarDeclASTNode*> paramNodes;
+    PrimitiveTypeASTNode* retTypeNode;
 
     /**
      * @note Forward declaration does not have body (definition)
      */
-    std::optional<std::unique_ptr<BlockASTNode>> optBlockNode;
+    std::optional<BlockASTNode*> optBlockNode;
+
+    /**
+     * @brief Variable of the function's name holding the result (index into the SemaContext)
+     */
+    uint32_t resultSymbolId = 0;
 
    public:
-    FunDeclASTNode(std::string funName, std::vector<std::unique_ptr<VarDeclASTNode>> paramNodes,
-                   std::optional<std::unique_ptr<BlockASTNode>> optBlockNode,
-                   std::unique_ptr<PrimitiveTypeASTNode> retTypeNode);
-    [[nodiscard]] const std::vector<std::unique_ptr<VarDeclASTNode>>& getParamNodes() const;
-    [[nodiscard]] const std::unique_ptr<PrimitiveTypeASTNode>& getRetTypeNode() const;
-    [[nodiscard]] const std::optional<std::unique_ptr<BlockASTNode>>& getBlockNode() const;
+    FunDeclASTNode(const std::string& funName, llvm::ArrayRef<VarDeclASTNode*> paramNodes,
+                   std::optional<BlockASTNode*> optBlockNode, PrimitiveTypeASTNode* retTypeNode);
+    [[nodiscard]] llvm::ArrayRef<VarDeclASTNode*> getParamNodes() const;
+    [[nodiscard]] PrimitiveTypeASTNode* getRetTypeNode() const;
+    [[nodiscard]] const std::optional<BlockASTNode*>& getBlockNode() const;
+    [[nodiscard]] uint32_t getResultSymbolId() const { return resultSymbolId; }
+    void setResultSymbolId(uint32_t id) { resultSymbolId = id; }
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::FUN_DECL; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -319,13 +458,14 @@ class FunDeclASTNode : public DeclASTNode {
  * @brief Assignment statement
  */
 class AssignASTNode : public StatementASTNode {
-    std::unique_ptr<DeclRefASTNode> varNode;
-    std::unique_ptr<ExprASTNode> exprNode;
+    DeclRefASTNode* varNode;
+    ExprASTNode* exprNode;
 
    public:
-    AssignASTNode(std::unique_ptr<DeclRefASTNode> varNode, std::unique_ptr<ExprASTNode> exprNode);
-    [[nodiscard]] const std::unique_ptr<DeclRefASTNode>& getVarNode() const;
-    [[nodiscard]] const std::unique_ptr<ExprASTNode>& getExprNode() const;
+    AssignASTNode(DeclRefASTNode* varNode, ExprASTNode* exprNode);
+    [[nodiscard]] DeclRefASTNode* getVarNode() const;
+    [[nodiscard]] ExprASTNode* getExprNode() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::ASSIGN; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -333,16 +473,16 @@ class AssignASTNode : public StatementASTNode {
  * @brief If statement
  */
 class IfASTNode : public StatementASTNode {
-    std::unique_ptr<ExprASTNode> condNode;
-    std::unique_ptr<StatementASTNode> bodyNode;
-    std::optional<std::unique_ptr<StatementASTNode>> optElseBodyNode;
+    ExprASTNode* condNode;
+    StatementASTNode* bodyNode;
+    std::optional<StatementASTNode*> optElseBodyNode;
 
    public:
-    IfASTNode(std::unique_ptr<ExprASTNode> condNode, std::unique_ptr<StatementASTNode> bodyNode,
-              std::optional<std::unique_ptr<StatementASTNode>> optElseBodyNode);
-    [[nodiscard]] const std::unique_ptr<ExprASTNode>& getCondNode() const;
-    [[nodiscard]] const std::unique_ptr<StatementASTNode>& getBodyNode() const;
-    [[nodiscard]] const std::optional<std::unique_ptr<StatementASTNode>>& getElseBodyNode() const;
+    IfASTNode(ExprASTNode* condNode, StatementASTNode* bodyNode, std::optional<StatementASTNode*> optElseBodyNode);
+    [[nodiscard]] ExprASTNode* getCondNode() const;
+    [[nodiscard]] StatementASTNode* getBodyNode() const;
+    [[nodiscard]] const std::optional<StatementASTNode*>& getElseBodyNode() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::IF; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -350,13 +490,14 @@ class IfASTNode : public StatementASTNode {
  * @brief While statement
  */
 class WhileASTNode : public StatementASTNode {
-    std::unique_ptr<ExprASTNode> condNode;
-    std::unique_ptr<StatementASTNode> bodyNode;
+    ExprASTNode* condNode;
+    StatementASTNode* bodyNode;
 
    public:
-    WhileASTNode(std::unique_ptr<ExprASTNode> condNode, std::unique_ptr<StatementASTNode> bodyNode);
-    [[nodiscard]] const std::unique_ptr<ExprASTNode>& getCondNode() const;
-    [[nodiscard]] const std::unique_ptr<StatementASTNode>& getBodyNode() const;
+    WhileASTNode(ExprASTNode* condNode, StatementASTNode* bodyNode);
+    [[nodiscard]] ExprASTNode* getCondNode() const;
+    [[nodiscard]] StatementASTNode* getBodyNode() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::WHILE; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -364,18 +505,18 @@ class WhileASTNode : public StatementASTNode {
  * @brief For statement
  */
 class ForASTNode : public StatementASTNode {
-    std::unique_ptr<AssignASTNode> initNode;
-    std::unique_ptr<ExprASTNode> toNode;
-    std::unique_ptr<StatementASTNode> bodyNode;
+    AssignASTNode* initNode;
+    ExprASTNode* toNode;
+    StatementASTNode* bodyNode;
     bool increasing;
 
    public:
-    ForASTNode(std::unique_ptr<AssignASTNode> initNode, std::unique_ptr<ExprASTNode> toNode,
-               std::unique_ptr<StatementASTNode> bodyNode, bool increasing);
-    [[nodiscard]] const std::unique_ptr<AssignASTNode>& getInitNode() const;
-    [[nodiscard]] const std::unique_ptr<ExprASTNode>& getToNode() const;
-    [[nodiscard]] const std::unique_ptr<StatementASTNode>& getBodyNode() const;
+    ForASTNode(AssignASTNode* initNode, ExprASTNode* toNode, StatementASTNode* bodyNode, bool increasing);
+    [[nodiscard]] AssignASTNode* getInitNode() const;
+    [[nodiscard]] ExprASTNode* getToNode() const;
+    [[nodiscard]] StatementASTNode* getBodyNode() const;
     [[nodiscard]] bool isIncreasing() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::FOR; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -383,13 +524,21 @@ class ForASTNode : public StatementASTNode {
  * @brief Procedure call
  */
 class ProcCallASTNode : public StatementASTNode {
-    std::string procName;
-    std::vector<std::unique_ptr<ExprASTNode>> argNodes;
+    const std::string* procName;
+    llvm::ArrayRef<ExprASTNode*> argNodes;
+
+    /**
+     * @brief Called routine (index into the SemaContext), bound by the semantic analysis
+     */
+    uint32_t routineId = 0;
 
    public:
-    ProcCallASTNode(std::string procName, std::vector<std::unique_ptr<ExprASTNode>> argNodes);
+    ProcCallASTNode(const std::string& procName, llvm::ArrayRef<ExprASTNode*> argNodes);
     [[nodiscard]] const std::string& getProcName() const;
-    [[nodiscard]] const std::vector<std::unique_ptr<ExprASTNode>>& getArgNodes() const;
+    [[nodiscard]] llvm::ArrayRef<ExprASTNode*> getArgNodes() const;
+    [[nodiscard]] uint32_t getRoutineId() const { return routineId; }
+    void setRoutineId(uint32_t id) { routineId = id; }
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::PROC_CALL; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -398,6 +547,8 @@ class ProcCallASTNode : public StatementASTNode {
  */
 class EmptyStmtASTNode : public StatementASTNode {
    public:
+    EmptyStmtASTNode() : StatementASTNode(Kind::EMPTY_STMT) {}
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::EMPTY_STMT; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
@@ -405,44 +556,35 @@ class EmptyStmtASTNode : public StatementASTNode {
  * @brief Program
  */
 class ProgramASTNode : public ASTNode {
-    std::string programName;
-    std::unique_ptr<BlockASTNode> blockNode;
+    const std::string* programName;
+    BlockASTNode* blockNode;
 
    public:
-    ProgramASTNode(std::string programName, std::unique_ptr<BlockASTNode> blockNode);
+    ProgramASTNode(const std::string& programName, BlockASTNode* blockNode);
     [[nodiscard]] const std::string& getProgramName() const;
-    [[nodiscard]] const std::unique_ptr<BlockASTNode>& getBlockNode() const;
+    [[nodiscard]] BlockASTNode* getBlockNode() const;
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::PROGRAM; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
 /**
  * @brief Break instruction (for, while)
+ * @note Jumps past the innermost enclosing loop, tracked by the codegen
  */
 class BreakASTNode : public StatementASTNode {
-    llvm::BasicBlock* breakBlock = nullptr;
-
    public:
-    void setBreakBlock(llvm::BasicBlock* BB);
-    [[nodiscard]] llvm::BasicBlock* getBreakBlock() const;
+    BreakASTNode() : StatementASTNode(Kind::BREAK) {}
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::BREAK; }
     void accept(ASTNodeVisitor& visitor) override;
 };
 
 /**
  * @brief Exit instruction (procedure, function)
+ * @note Returns from the enclosing procedure/function (or the main block), tracked by the codegen
  */
 class ExitASTNode : public StatementASTNode {
-    //    /**
-    //     * @brief Function that loads the return value
-    //     * @note nullptr = void return type
-    //     */
-    //    std::function<llvm::LoadInst*()> loadReturnV = nullptr;
-    // todo:
-
-    using RetV = std::variant<std::monostate, std::function<llvm::LoadInst*()>, llvm::Value*>;
-    RetV retV = std::monostate{};
-
    public:
-    void setRetV(RetV newRetV);
-    [[nodiscard]] const RetV& getRetV() const;
+    ExitASTNode() : StatementASTNode(Kind::EXIT) {}
+    static bool classof(const ASTNode* node) { return node->getKind() == Kind::EXIT; }
     void accept(ASTNodeVisitor& visitor) override;
 };
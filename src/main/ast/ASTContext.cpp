@@ -0,0 +1,10 @@
+#include "ASTContext.hpp"
+
+ASTContext::~ASTContext() {
+    for (auto [destructor, node] : destructors)
+        destructor(node);
+}
+
+const std::string& ASTContext::getName(std::string_view name) {
+    return *names.emplace(name).first;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/Support/Allocator.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Owns the nodes of an AST, which are placement-allocated in a bump-pointer arena together with their child
+ * arrays and released all at once
+ * @note The nodes are trivially destructible (children are raw pointers and arena arrays, names point into the name
+ * pool), so destroying the context frees a few slabs instead of walking the tree. The rare node type with non-trivial
+ * members registers its destructor on creation. The context must outlive every node created in it.
+ */
+class ASTContext {
+   private:
+    llvm::BumpPtrAllocator arena;
+
+    /**
+     * @brief Distinct names of the AST (identifiers), referenced by the nodes. Elements of an unordered_set are never
+     * moved.
+     */
+    std::unordered_set<std::string> names;
+
+    /**
+     * @brief Destructors of the nodes that are not trivially destructible, run when the context is destroyed
+     */
+    std::vector<std::pair<void (*)(void*), void*>> destructors;
+
+   public:
+    ASTContext() = default;
+    ~ASTContext();
+
+    // The nodes point into the arena and the name pool
+    ASTContext(const ASTContext&) = delete;
+    ASTContext& operator=(const ASTContext&) = delete;
+
+    /**
+     * @brief Constructs a node in the arena
+     */
+    template <typename Node, typename... Args>
+    Node* create(Args&&... args) {
+        Node* node = new (arena.Allocate<Node>()) Node(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<Node>)
+            destructors.emplace_back([](void* ptr) { static_cast<Node*>(ptr)->~Node(); }, node);
+        return node;
+    }
+
+    /**
+     * @brief Copies the elements (e.g. child nodes collected in a temporary vector) into the arena
+     */
+    template <typename T>
+    llvm::ArrayRef<T> copyArray(const std::vector<T>& elements) {
+        static_assert(std::is_trivially_copyable_v<T>, "arena arrays are never destroyed");
+        if (elements.empty())
+            return {};
+
+        T* copy = arena.Allocate<T>(elements.size());
+        std::uninitialized_copy(elements.begin(), elements.end(), copy);
+        return {copy, elements.size()};
+    }
+
+    /**
+     * @brief Bytes taken by the nodes and their child arrays (without the name pool)
+     */
+    [[nodiscard]] size_t getBytesAllocated() const { return arena.getBytesAllocated(); }
+
+    /**
+     * @brief Returns the pooled copy of the name, valid for the lifetime of the context
+     */
+    const std::string& getName(std::string_view name);
+};
@@ -1,74 +1,221 @@
 #include "CodeGenerator.hpp"
 #include "ast/visitor/CodeGenVisitor.hpp"
+#include "ast/visitor/SemaVisitor.hpp"
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/IR/PassTimingInfo.h"
+#include "llvm/Passes/PassBuilder.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
+#include <sstream>
+#include "utils/PhaseTimer.hpp"
+#include "utils/Statistic.hpp"
 
-bool Symbol::isGlobal() const {
-    return std::holds_alternative<llvm::GlobalVariable*>(memPtr);
-}
+GenContext::GenContext(const std::string& moduleName)
+    : ownedCtx(std::make_unique<llvm::LLVMContext>()),
+      ownedModule(std::make_unique<llvm::Module>(moduleName, *ownedCtx)),
+      ctx(*ownedCtx),
+      builder(ctx),
+      module(*ownedModule) {
+    auto writeHandler = std::make_shared<WriteFuncHandler>(*this);
+    auto writelnHandler = std::make_shared<WritelnFuncHandler>(*this);
+    auto readlnHandler = std::make_shared<ReadlnFuncHandler>(*this);
+    auto toIntegerHandler = std::make_shared<ToIntegerFuncHandler>(*this);
+    auto toRealHandler = std::make_shared<ToRealFuncHandler>(*this);
+    auto userHandler = std::make_shared<UserFuncHandler>(*this);
 
-llvm::GlobalVariable* Symbol::getGlobalMemPtr() const {
-    if (!isGlobal())
-        throw std::runtime_error("Failed to get global memory pointer - symbol is not global");
+    writeHandler->setNext(writelnHandler)
+        ->setNext(readlnHandler)
+        ->setNext(toIntegerHandler)
+        ->setNext(toRealHandler)
+        ->setNext(userHandler);
 
-    return std::get<llvm::GlobalVariable*>(memPtr);
+    funcHandler = writeHandler;
 }
 
-llvm::AllocaInst* Symbol::getLocalMemPtr() const {
-    if (isGlobal())
-        throw std::runtime_error("Failed to get local (stack) memory pointer - symbol is global");
+llvm::Type* GenContext::lowerType(const SemaType* type) {
+    llvm::Type*& lowered = loweredTypes[type];
+    if (lowered)
+        return lowered;
 
-    return std::get<llvm::AllocaInst*>(memPtr);
+    switch (type->getKind()) {
+        case SemaType::Kind::INTEGER:
+            lowered = llvm::Type::getInt32Ty(ctx);
+            break;
+        case SemaType::Kind::REAL:
+            lowered = llvm::Type::getDoubleTy(ctx);
+            break;
+        case SemaType::Kind::BOOLEAN:
+            lowered = llvm::Type::getInt1Ty(ctx);
+            break;
+        case SemaType::Kind::ARRAY:
+            lowered = llvm::ArrayType::get(lowerType(type->getElementType()),
+                                           type->getUpperBound() - type->getLowerBound() + 1);
+            break;
+    }
+    return lowered;
 }
 
-void SymbolTable::addSymbol(const std::string& name, const Symbol& symbol) {
-    if (contains(name))
-        throw CodeGenException("Failed to add new symbol - symbol already exists: " + name);
+std::pair<std::unique_ptr<llvm::LLVMContext>, std::unique_ptr<llvm::Module>> GenContext::release() {
+    if (!ownedCtx)
+        throw CodeGenException("Failed to release the module - already released");
 
-    table[name] = symbol;
+    builder.ClearInsertionPoint();
+    return {std::move(ownedCtx), std::move(ownedModule)};
 }
 
-const Symbol& SymbolTable::getSymbol(const std::string& name) const {
-    if (!contains(name))
-        throw CodeGenException("Failed to get symbol - symbol not found: " + name);
+std::string toString(OptLevel level) {
+    switch (level) {
+        case OptLevel::O0:
+            return "-O0";
+        case OptLevel::O1:
+            return "-O1";
+        case OptLevel::O2:
+            return "-O2";
+        case OptLevel::O3:
+            return "-O3";
+        case OptLevel::Os:
+            return "-Os";
+    }
+    return "";
+}
 
-    return table.at(name);
+std::optional<OptLevel> optLevelFromString(const std::string& flag) {
+    for (OptLevel level : {OptLevel::O0, OptLevel::O1, OptLevel::O2, OptLevel::O3, OptLevel::Os}) {
+        if (flag == toString(level))
+            return level;
+    }
+    return std::nullopt;
 }
 
-bool SymbolTable::contains(const std::string& name) const {
-    return table.count(name) > 0;
+CodeGenerator::CodeGenerator(ASTNode* astNode) : astNode(astNode) {}
+
+void CodeGenerator::generate(GenContext& gen) const {
+    SemaContext sema;
+    {
+        PhaseTimer timer("Semantic analysis");
+        SemaVisitor(sema).analyze(*astNode);
+    }
+
+    // The bindings do not outlive the analysis, even if the code generation fails
+    gen.sema = &sema;
+    auto resetSema = llvm::make_scope_exit([&gen]() { gen.sema = nullptr; });
+    gen.symbolStorage.assign(sema.getNumSymbols(), nullptr);
+    gen.routineFunctions.assign(sema.getNumRoutines(), nullptr);
+
+    CodeGenVisitor codegenVisitor(gen);
+    astNode->accept(codegenVisitor);
 }
 
-GenContext::GenContext(const std::string& moduleName) : ctx(), builder(ctx), module(moduleName, ctx) {
-    auto writeHandler = std::make_shared<WriteFuncHandler>(*this);
-    auto writelnHandler = std::make_shared<WritelnFuncHandler>(*this);
-    auto readlnHandler = std::make_shared<ReadlnFuncHandler>(*this);
-    auto toIntegerHandler = std::make_shared<ToIntegerFuncHandler>(*this);
-    auto toRealHandler = std::make_shared<ToRealFuncHandler>(*this);
-    auto userHandler = std::make_shared<UserFuncHandler>(*this);
+/**
+ * @brief Records the basic block and instruction counts of every defined function as '<function>.<what>.<stage>'
+ */
+static void countIRSize(const llvm::Module& module, const std::string& stage) {
+    StatisticRegistry& registry = StatisticRegistry::instance();
+    if (!registry.isEnabled())
+        return;
 
-    writeHandler->setNext(writelnHandler)
-        ->setNext(readlnHandler)
-        ->setNext(toIntegerHandler)
-        ->setNext(toRealHandler)
-        ->setNext(userHandler);
+    for (const llvm::Function& function : module) {
+        if (function.isDeclaration())
+            continue;
 
-    funcHandler = writeHandler;
+        const std::string name = function.getName().str();
+        registry.add("ir", name + ".blocks." + stage, function.size());
+        registry.add("ir", name + ".instructions." + stage, function.getInstructionCount());
+    }
 }
 
-CodeGenerator::CodeGenerator(ASTNode* astNode) : astNode(astNode) {}
+void CodeGenerator::optimize(llvm::Module& module, OptLevel level, llvm::TargetMachine* targetMachine) {
+    std::string error;
+    llvm::raw_string_ostream errorStream(error);
+    if (llvm::verifyModule(module, &errorStream))
+        throw CodeGenException("Generated module is broken: " + errorStream.str());
+
+    countIRSize(module, "before");
+    if (level == OptLevel::O0)
+        return;
+
+    PhaseTimer timer("Optimization", toString(level));
+
+    llvm::OptimizationLevel llvmLevel = llvm::OptimizationLevel::O2;
+    switch (level) {
+        case OptLevel::O1:
+            llvmLevel = llvm::OptimizationLevel::O1;
+            break;
+        case OptLevel::O2:
+            llvmLevel = llvm::OptimizationLevel::O2;
+            break;
+        case OptLevel::O3:
+            llvmLevel = llvm::OptimizationLevel::O3;
+            break;
+        case OptLevel::Os:
+            llvmLevel = llvm::OptimizationLevel::Os;
+            break;
+        default:
+            break;
+    }
+
+    // Same vectorization defaults as clang: enabled from -O2 on (including -Os)
+    llvm::PipelineTuningOptions tuningOptions;
+    tuningOptions.LoopVectorization = level != OptLevel::O1;
+    tuningOptions.SLPVectorization = level != OptLevel::O1;
+
+    // Analysis managers must be declared in this order, so that they are destroyed in the reverse one
+    llvm::LoopAnalysisManager LAM;
+    llvm::FunctionAnalysisManager FAM;
+    llvm::CGSCCAnalysisManager CGAM;
+    llvm::ModuleAnalysisManager MAM;
+
+    // Per-pass times: a report for the '--time-phases' summary and/or trace events for '--trace'
+    llvm::PassInstrumentationCallbacks instrumentation;
+    std::string passReport;
+    llvm::raw_string_ostream passReportStream(passReport);
+    std::optional<llvm::TimePassesHandler> passTimes;
+
+    PhaseTimings* timings = PhaseTimings::active();
+    if (timings) {
+        passTimes.emplace(true);
+        passTimes->setOutStream(passReportStream);
+        passTimes->registerCallbacks(instrumentation);
+    }
+
+    if (llvm::timeTraceProfilerEnabled()) {
+        instrumentation.registerBeforeNonSkippedPassCallback(
+            [](llvm::StringRef pass, llvm::Any) { llvm::timeTraceProfilerBegin(pass, ""); });
+        instrumentation.registerAfterPassCallback(
+            [](llvm::StringRef, llvm::Any, const llvm::PreservedAnalyses&) { llvm::timeTraceProfilerEnd(); });
+        instrumentation.registerAfterPassInvalidatedCallback(
+            [](llvm::StringRef, const llvm::PreservedAnalyses&) { llvm::timeTraceProfilerEnd(); });
+    }
+
+    llvm::PassBuilder passBuilder(targetMachine, tuningOptions, llvm::None, &instrumentation);
+    passBuilder.registerModuleAnalyses(MAM);
+    passBuilder.registerCGSCCAnalyses(CGAM);
+    passBuilder.registerFunctionAnalyses(FAM);
+    passBuilder.registerLoopAnalyses(LAM);
+    passBuilder.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+    // mem2reg, SROA, inlining, GVN, LICM, loop vectorization, ... as scheduled by the per-level default pipeline
+    llvm::ModulePassManager MPM = passBuilder.buildPerModuleDefaultPipeline(llvmLevel);
+    MPM.run(module, MAM);
+    countIRSize(module, "after");
+
+    if (timings) {
+        passTimes->print();
+        timings->addPassReport(passReportStream.str());
+    }
+}
 
 void CodeGenerator::generate() const {
     GenContext gen("mila-module");
-    CodeGenVisitor codegenVisitor(gen);
-    astNode->accept(codegenVisitor);
+    generate(gen);
     gen.module.print(llvm::outs(), nullptr);
 }
 
 void CodeGenerator::generate(const std::string& outFile) const {
     GenContext gen("mila-module");
-    CodeGenVisitor codegenVisitor(gen);
-    astNode->accept(codegenVisitor);
+    generate(gen);
 
     std::error_code EC;
     llvm::raw_fd_ostream out(outFile, EC, llvm::sys::fs::OF_None);
@@ -81,6 +228,29 @@ void CodeGenerator::generate(const std::string& outFile) const {
 
 CodeGenException::CodeGenException(std::string msg) : message(std::move(msg)) {}
 
+CodeGenException::CodeGenException(std::string msg, uint32_t offset) : message(std::move(msg)), offset(offset) {}
+
+void CodeGenException::locate(uint32_t offset) {
+    if (!this->offset)
+        this->offset = offset;
+}
+
+std::optional<uint32_t> CodeGenException::getOffset() const {
+    return offset;
+}
+
+std::string CodeGenException::format(const SourceManager& sources) const {
+    if (!offset)
+        return message;
+
+    std::ostringstream oss;
+    oss << "at [";
+    if (!sources.getName().empty())
+        oss << sources.getName() << ':';
+    oss << sources.getPosition(*offset) << "] - " << message;
+    return oss.str();
+}
+
 const char* CodeGenException::what() const noexcept {
     return message.c_str();
 }
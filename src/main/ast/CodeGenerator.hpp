@@ -1,69 +1,58 @@
 #pragma once
+#include <llvm/ADT/DenseMap.h>
 #include "AST.hpp"
 #include "FuncHandler.hpp"
+#include "SemaContext.hpp"
+#include "lexer/SourceManager.hpp"
 
-struct Symbol {
-    std::string name;
-    /**
-     * @brief The type of the symbol
-     */
-    TypeASTNode* type;
+namespace llvm {
+class TargetMachine;
+}
 
+/**
+ * @brief LLVM context for code generation
+ */
+struct GenContext {
+   private:
     /**
-     * @brief The memory location of the symbol
-     * @note If the symbol is a global variable, the memory location is a GlobalVariable.
+     * @brief Owners of 'ctx' and 'module', heap allocated so that they can be handed over (e.g. to the JIT)
      */
-    std::variant<llvm::AllocaInst*, llvm::GlobalVariable*> memPtr;
+    std::unique_ptr<llvm::LLVMContext> ownedCtx;
+    std::unique_ptr<llvm::Module> ownedModule;
 
-    bool immutable;
-
-    [[nodiscard]] bool isGlobal() const;
-    [[nodiscard]] llvm::GlobalVariable* getGlobalMemPtr() const;
-    [[nodiscard]] llvm::AllocaInst* getLocalMemPtr() const;
-};
-
-class SymbolTable {
-   private:
-    std::map<std::string, Symbol> table;
+    llvm::DenseMap<const SemaType*, llvm::Type*> loweredTypes;
 
    public:
     /**
-     * @brief Adds a symbol to the table
+     * @brief Environment/Context for the code generation
+     * @note Holds the global state required during the LLVM IR construction process, including unique instances of types, constant values, metadata
      */
-    void addSymbol(const std::string& name, const Symbol& symbol);
+    llvm::LLVMContext& ctx;
 
     /**
-     * @brief Returns the symbol with the given name
+     * @brief Simplifies the generation of LLVM IR code with abstractions
      */
-    [[nodiscard]] const Symbol& getSymbol(const std::string& name) const;
+    llvm::IRBuilder<> builder;
 
     /**
-     * @brief Checks if the symbol is in the table
+     * @brief Container for functions, global variables, etc.
      */
-    [[nodiscard]] bool contains(const std::string& name) const;
-};
+    llvm::Module& module;
 
-/**
- * @brief LLVM context for code generation
- */
-struct GenContext {
     /**
-     * @brief Environment/Context for the code generation
-     * @note Holds the global state required during the LLVM IR construction process, including unique instances of types, constant values, metadata
+     * @brief Result of the semantic analysis of the program being generated, set by CodeGenerator::generate
      */
-    llvm::LLVMContext ctx;
+    const SemaContext* sema = nullptr;
 
     /**
-     * @brief Simplifies the generation of LLVM IR code with abstractions
+     * @brief Memory location (alloca or global variable) of each symbol of 'sema', indexed by DeclId
      */
-    llvm::IRBuilder<> builder;
+    std::vector<llvm::Value*> symbolStorage;
 
     /**
-     * @brief Container for functions, global variables, etc.
+     * @brief LLVM function of each routine of 'sema', indexed by RoutineId (nullptr for builtins)
      */
-    llvm::Module module;
-
-    SymbolTable symbolTable;
+    std::vector<llvm::Function*> routineFunctions;
 
     /**
      * @brief Chain of responsibility for function/procedure calls both predefined and user-defined
@@ -71,8 +60,34 @@ struct GenContext {
     std::shared_ptr<FuncHandler> funcHandler;
 
     explicit GenContext(const std::string& moduleName);
+
+    /**
+     * @brief Returns the LLVM type of the semantic type: i32 for integers, double for reals, i1 for booleans
+     */
+    llvm::Type* lowerType(const SemaType* type);
+
+    /**
+     * @brief Transfers ownership of the context and the module to the caller
+     * @note The module must be destroyed before the context. The GenContext must not be used afterwards.
+     */
+    [[nodiscard]] std::pair<std::unique_ptr<llvm::LLVMContext>, std::unique_ptr<llvm::Module>> release();
 };
 
+/**
+ * @brief Optimization level of the generated code, mirrors the usual compiler driver '-O' flags
+ */
+enum class OptLevel { O0, O1, O2, O3, Os };
+
+/**
+ * @brief Returns the driver flag spelling of the level, e.g. "-O2"
+ */
+std::string toString(OptLevel level);
+
+/**
+ * @brief Parses the driver flag spelling of a level, e.g. "-O2", returns std::nullopt for anything else
+ */
+std::optional<OptLevel> optLevelFromString(const std::string& flag);
+
 class CodeGenerator {
    private:
     ASTNode* astNode;
@@ -80,6 +95,18 @@ class CodeGenerator {
    public:
     explicit CodeGenerator(ASTNode* astNode);
 
+    /**
+     * @brief Generates the LLVM IR code for 'astNode' into the module of the given context
+     */
+    void generate(GenContext& gen) const;
+
+    /**
+     * @brief Verifies the module and runs the LLVM default pass pipeline of the given level over it
+     * @note OptLevel::O0 only verifies the module. 'targetMachine' (optional) enables target specific cost models (e.g.
+     * for the loop vectorizer).
+     */
+    static void optimize(llvm::Module& module, OptLevel level, llvm::TargetMachine* targetMachine = nullptr);
+
     /**
      * @brief Generates and dumps to standard output the LLVM IR code for 'astNode'
      */
@@ -95,8 +122,26 @@ class CodeGenException : public std::exception {
    private:
     std::string message;
 
+    /**
+     * @brief Offset of the offending node in the source code, resolved by the SourceManager when the error is reported
+     */
+    std::optional<uint32_t> offset;
+
    public:
     explicit CodeGenException(std::string msg);
+    CodeGenException(std::string msg, uint32_t offset);
+
+    /**
+     * @brief Sets the offset unless the error is already located (by a more specific node)
+     */
+    void locate(uint32_t offset);
+
+    [[nodiscard]] std::optional<uint32_t> getOffset() const;
+
+    /**
+     * @brief Formats the message with the source position of the error, if known (e.g. "at [file.mila:3:5] - message")
+     */
+    [[nodiscard]] std::string format(const SourceManager& sources) const;
 
     [[nodiscard]] const char* what() const noexcept override;
 };
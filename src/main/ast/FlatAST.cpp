@@ -0,0 +1,435 @@
+#include "FlatAST.hpp"
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
+#include "CodeGenerator.hpp"
+#include "utils/Statistic.hpp"
+#include "visitor/StaticVisitor.hpp"
+
+MILA_STATISTIC(NumFlatASTNodes, "ast", "Number of nodes lowered into the flat AST");
+MILA_STATISTIC(NumFlatASTBytes, "ast", "Bytes taken by the arrays of the flat AST");
+
+std::ostream& operator<<(std::ostream& os, Opcode opcode) noexcept {
+    switch (opcode) {
+        case Opcode::ADD:
+            return os << "ADD";
+        case Opcode::SUB:
+            return os << "SUB";
+        case Opcode::MUL:
+            return os << "MUL";
+        case Opcode::DIVIDE:
+            return os << "DIVIDE";
+        case Opcode::DIV:
+            return os << "DIV";
+        case Opcode::MOD:
+            return os << "MOD";
+        case Opcode::EQ:
+            return os << "EQ";
+        case Opcode::NE:
+            return os << "NE";
+        case Opcode::LT:
+            return os << "LT";
+        case Opcode::LE:
+            return os << "LE";
+        case Opcode::GT:
+            return os << "GT";
+        case Opcode::GE:
+            return os << "GE";
+        case Opcode::AND:
+            return os << "AND";
+        case Opcode::OR:
+            return os << "OR";
+        case Opcode::NEG:
+            return os << "NEG";
+        case Opcode::NOT:
+            return os << "NOT";
+    }
+    return os << "UNKNOWN";
+}
+
+static Opcode toBinaryOpcode(const BinOpASTNode& node) {
+    switch (node.getOp().getType()) {
+        case TokenType::PLUS:
+            return Opcode::ADD;
+        case TokenType::MINUS:
+            return Opcode::SUB;
+        case TokenType::MULTIPLY:
+            return Opcode::MUL;
+        case TokenType::DIVIDE:
+            return Opcode::DIVIDE;
+        case TokenType::DIV:
+            return Opcode::DIV;
+        case TokenType::MOD:
+            return Opcode::MOD;
+        case TokenType::EQUAL:
+            return Opcode::EQ;
+        case TokenType::NOT_EQUAL:
+            return Opcode::NE;
+        case TokenType::LESS:
+            return Opcode::LT;
+        case TokenType::LESS_EQUAL:
+            return Opcode::LE;
+        case TokenType::GREATER:
+            return Opcode::GT;
+        case TokenType::GREATER_EQUAL:
+            return Opcode::GE;
+        case TokenType::AND:
+            return Opcode::AND;
+        case TokenType::OR:
+            return Opcode::OR;
+        default:
+            throw CodeGenException("Unknown binary operator", node.getOffset());
+    }
+}
+
+static Opcode toUnaryOpcode(const UnaryOpASTNode& node) {
+    switch (node.getOp().getType()) {
+        case TokenType::MINUS:
+            return Opcode::NEG;
+        case TokenType::NOT:
+            return Opcode::NOT;
+        default:
+            throw CodeGenException("Unknown unary operator", node.getOffset());
+    }
+}
+
+/**
+ * @brief Appends the nodes of the tree to a FlatAST in pre-order
+ */
+class FlattenVisitor : public StaticVisitor<FlattenVisitor> {
+   private:
+    FlatAST& ast;
+
+    /**
+     * @brief Index of each name in FlatAST::names, the names of the tree are pooled so the address identifies them
+     */
+    llvm::DenseMap<const std::string*, uint32_t> nameIds;
+
+    FlatAST::NodeId open(const ASTNode& node, uint8_t flags = 0, uint32_t data = 0) {
+        const FlatAST::NodeId id = ast.size();
+        ast.kinds.push_back(node.getKind());
+        ast.flags.push_back(flags);
+        ast.data.push_back(data);
+        ast.ends.push_back(id + 1);
+        ast.offsets.push_back(node.getOffset());
+        return id;
+    }
+
+    void close(FlatAST::NodeId id) { ast.ends[id] = ast.size(); }
+
+    uint32_t nameOf(const std::string& name) {
+        auto [it, inserted] = nameIds.try_emplace(&name, uint32_t(ast.names.size()));
+        if (inserted)
+            ast.names.push_back(name);
+        return it->second;
+    }
+
+    template <typename Node>
+    void visitAll(llvm::ArrayRef<Node*> nodes) {
+        for (Node* node : nodes)
+            dispatch(*node);
+    }
+
+   public:
+    explicit FlattenVisitor(FlatAST& ast) : ast(ast) {}
+
+    void visit(PrimitiveTypeASTNode& node) { open(node, uint8_t(node.getPrimitiveType())); }
+
+    void visit(ArrayTypeASTNode& node) {
+        auto id = open(node, 0, uint32_t(ast.arrayBounds.size()));
+        ast.arrayBounds.push_back({node.getLowerBound(), node.getUpperBound()});
+        dispatch(*node.getElemTypeNode());
+        close(id);
+    }
+
+    void visit(BinOpASTNode& node) {
+        // Operator and 'else if' chains are as deep as they are long, they are lowered by loops: the nodes of a chain
+        // are opened top-down and closed bottom-up
+        llvm::SmallVector<std::pair<BinOpASTNode*, FlatAST::NodeId>, 8> spine;
+        for (BinOpASTNode* binOpNode = &node; binOpNode;
+             binOpNode = llvm::dyn_cast<BinOpASTNode>(binOpNode->getLhsExprNode()))
+            spine.emplace_back(binOpNode, open(*binOpNode, uint8_t(toBinaryOpcode(*binOpNode))));
+
+        dispatch(*spine.back().first->getLhsExprNode());
+        for (auto it = spine.rbegin(); it != spine.rend(); ++it) {
+            dispatch(*it->first->getRhsExprNode());
+            close(it->second);
+        }
+    }
+
+    void visit(UnaryOpASTNode& node) {
+        UnaryOpASTNode* unaryNode = &node;
+        llvm::SmallVector<FlatAST::NodeId, 4> ids{open(node, uint8_t(toUnaryOpcode(node)))};
+        while (auto* exprNode = llvm::dyn_cast<UnaryOpASTNode>(unaryNode->getExprNode())) {
+            unaryNode = exprNode;
+            ids.push_back(open(*unaryNode, uint8_t(toUnaryOpcode(*unaryNode))));
+        }
+
+        dispatch(*unaryNode->getExprNode());
+        for (auto it = ids.rbegin(); it != ids.rend(); ++it)
+            close(*it);
+    }
+
+    void visit(LiteralASTNode& node) {
+        TokenValue value = node.getValue();
+        if (std::holds_alternative<int>(value)) {
+            open(node, false, uint32_t(std::get<int>(value)));
+        } else {
+            open(node, true, uint32_t(ast.reals.size()));
+            ast.reals.push_back(std::get<double>(value));
+        }
+    }
+
+    void visit(DeclVarRefASTNode& node) { open(node, 0, nameOf(node.getRefName())); }
+
+    void visit(DeclArrayRefASTNode& node) {
+        auto id = open(node, 0, nameOf(node.getRefName()));
+        dispatch(*node.getIndexNode());
+        close(id);
+    }
+
+    void visit(FunCallASTNode& node) {
+        auto id = open(node, 0, nameOf(node.getFunName()));
+        visitAll(node.getArgNodes());
+        close(id);
+    }
+
+    void visit(BlockASTNode& node) {
+        auto id = open(node);
+        visitAll(node.getStatementNodes());
+        close(id);
+    }
+
+    void visit(CompoundStmtASTNode& node) {
+        auto id = open(node);
+        visitAll(node.getStatementNodes());
+        close(id);
+    }
+
+    void visit(VarDeclASTNode& node) {
+        auto id = open(node, node.isGlobal(), nameOf(node.getDeclName()));
+        dispatch(*node.getTypeNode());
+        close(id);
+    }
+
+    void visit(ArrayDeclASTNode& node) {
+        auto id = open(node, node.isGlobal(), nameOf(node.getDeclName()));
+        dispatch(*node.getTypeNode());
+        close(id);
+    }
+
+    void visit(ConstDefASTNode& node) {
+        auto id = open(node, node.isGlobal(), nameOf(node.getDeclName()));
+        dispatch(*node.getExprNode());
+        close(id);
+    }
+
+    void visit(ProcDeclASTNode& node) {
+        auto id = open(node, node.isGlobal(), nameOf(node.getDeclName()));
+        visitAll(node.getParamNodes());
+        if (node.getBlockNode().has_value())
+            dispatch(*node.getBlockNode().value());
+        close(id);
+    }
+
+    void visit(FunDeclASTNode& node) {
+        auto id = open(node, node.isGlobal(), nameOf(node.getDeclName()));
+        dispatch(*node.getRetTypeNode());
+        visitAll(node.getParamNodes());
+        if (node.getBlockNode().has_value())
+            dispatch(*node.getBlockNode().value());
+        close(id);
+    }
+
+    void visit(AssignASTNode& node) {
+        auto id = open(node);
+        dispatch(*node.getVarNode());
+        dispatch(*node.getExprNode());
+        close(id);
+    }
+
+    void visit(IfASTNode& node) {
+        llvm::SmallVector<FlatAST::NodeId, 4> ids;
+        for (IfASTNode* ifNode = &node; ifNode;) {
+            ids.push_back(open(*ifNode));
+            dispatch(*ifNode->getCondNode());
+            dispatch(*ifNode->getBodyNode());
+
+            const std::optional<StatementASTNode*>& elseBodyNode = ifNode->getElseBodyNode();
+            ifNode = elseBodyNode.has_value() ? llvm::dyn_cast<IfASTNode>(elseBodyNode.value()) : nullptr;
+            if (elseBodyNode.has_value() && !ifNode)
+                dispatch(*elseBodyNode.value());
+        }
+
+        for (auto it = ids.rbegin(); it != ids.rend(); ++it)
+            close(*it);
+    }
+
+    void visit(WhileASTNode& node) {
+        auto id = open(node);
+        dispatch(*node.getCondNode());
+        dispatch(*node.getBodyNode());
+        close(id);
+    }
+
+    void visit(ForASTNode& node) {
+        auto id = open(node, node.isIncreasing());
+        dispatch(*node.getInitNode());
+        dispatch(*node.getToNode());
+        dispatch(*node.getBodyNode());
+        close(id);
+    }
+
+    void visit(ProcCallASTNode& node) {
+        auto id = open(node, 0, nameOf(node.getProcName()));
+        visitAll(node.getArgNodes());
+        close(id);
+    }
+
+    void visit(EmptyStmtASTNode& node) { open(node); }
+
+    void visit(BreakASTNode& node) { open(node); }
+
+    void visit(ExitASTNode& node) { open(node); }
+
+    void visit(ProgramASTNode& node) {
+        auto id = open(node, 0, nameOf(node.getProgramName()));
+        dispatch(*node.getBlockNode());
+        close(id);
+    }
+};
+
+FlatAST FlatAST::lower(ProgramASTNode& programNode) {
+    FlatAST ast;
+    FlattenVisitor(ast).dispatch(programNode);
+
+    NumFlatASTNodes += ast.size();
+    NumFlatASTBytes += ast.getMemoryUsage();
+    return ast;
+}
+
+FlatAST::NodeId FlatAST::getChild(NodeId id, size_t position) const {
+    NodeId child = id + 1;
+    while (position--)
+        child = ends[child];
+    return child;
+}
+
+size_t FlatAST::getNumChildren(NodeId id) const {
+    size_t count = 0;
+    for ([[maybe_unused]] NodeId child : children(id))
+        ++count;
+    return count;
+}
+
+TokenValue FlatAST::getValue(NodeId id) const {
+    if (flags[id])
+        return reals[data[id]];
+    return int(data[id]);
+}
+
+size_t FlatAST::getMemoryUsage() const {
+    return kinds.size() * sizeof(Kind) + flags.size() * sizeof(uint8_t) + data.size() * sizeof(uint32_t) +
+           ends.size() * sizeof(NodeId) + offsets.size() * sizeof(uint32_t) + names.size() * sizeof(std::string) +
+           reals.size() * sizeof(double) + arrayBounds.size() * sizeof(ArrayBounds);
+}
+
+static const char* kindName(ASTNode::Kind kind) {
+    switch (kind) {
+        case ASTNode::Kind::PRIMITIVE_TYPE:
+            return "PrimitiveType";
+        case ASTNode::Kind::ARRAY_TYPE:
+            return "ArrayType";
+        case ASTNode::Kind::BIN_OP:
+            return "BinOp";
+        case ASTNode::Kind::UNARY_OP:
+            return "UnaryOp";
+        case ASTNode::Kind::LITERAL:
+            return "Literal";
+        case ASTNode::Kind::DECL_VAR_REF:
+            return "DeclVarRef";
+        case ASTNode::Kind::DECL_ARRAY_REF:
+            return "DeclArrayRef";
+        case ASTNode::Kind::FUN_CALL:
+            return "FunCall";
+        case ASTNode::Kind::BLOCK:
+            return "Block";
+        case ASTNode::Kind::COMPOUND_STMT:
+            return "CompoundStmt";
+        case ASTNode::Kind::VAR_DECL:
+            return "VarDecl";
+        case ASTNode::Kind::ARRAY_DECL:
+            return "ArrayDecl";
+        case ASTNode::Kind::CONST_DEF:
+            return "ConstDef";
+        case ASTNode::Kind::PROC_DECL:
+            return "ProcDecl";
+        case ASTNode::Kind::FUN_DECL:
+            return "FunDecl";
+        case ASTNode::Kind::ASSIGN:
+            return "Assign";
+        case ASTNode::Kind::IF:
+            return "If";
+        case ASTNode::Kind::WHILE:
+            return "While";
+        case ASTNode::Kind::FOR:
+            return "For";
+        case ASTNode::Kind::PROC_CALL:
+            return "ProcCall";
+        case ASTNode::Kind::EMPTY_STMT:
+            return "EmptyStmt";
+        case ASTNode::Kind::BREAK:
+            return "Break";
+        case ASTNode::Kind::EXIT:
+            return "Exit";
+        case ASTNode::Kind::PROGRAM:
+            return "Program";
+    }
+    return "Unknown";
+}
+
+void FlatAST::print(std::ostream& os) const {
+    // Ends of the enclosing subtrees, the depth of a node is the number of those not ended yet
+    std::vector<NodeId> enclosing;
+
+    for (NodeId id = 0; id < size(); ++id) {
+        while (!enclosing.empty() && enclosing.back() <= id)
+            enclosing.pop_back();
+
+        os << std::string(2 * enclosing.size(), ' ') << kindName(kinds[id]);
+        switch (kinds[id]) {
+            case Kind::PRIMITIVE_TYPE:
+                os << (getPrimitiveType(id) == PrimitiveTypeASTNode::PrimitiveType::INTEGER ? " integer" : " real");
+                break;
+            case Kind::ARRAY_TYPE:
+                os << " from " << getArrayBounds(id).lowerBound << " to " << getArrayBounds(id).upperBound;
+                break;
+            case Kind::BIN_OP:
+            case Kind::UNARY_OP:
+                os << " " << getOpcode(id);
+                break;
+            case Kind::LITERAL:
+                os << " " << getValue(id);
+                break;
+            case Kind::DECL_VAR_REF:
+            case Kind::DECL_ARRAY_REF:
+            case Kind::FUN_CALL:
+            case Kind::VAR_DECL:
+            case Kind::ARRAY_DECL:
+            case Kind::CONST_DEF:
+            case Kind::PROC_DECL:
+            case Kind::FUN_DECL:
+            case Kind::PROC_CALL:
+            case Kind::PROGRAM:
+                os << " " << getName(id);
+                break;
+            case Kind::FOR:
+                os << (isIncreasing(id) ? " to" : " downto");
+                break;
+            default:
+                break;
+        }
+        os << "\n";
+
+        enclosing.push_back(ends[id]);
+    }
+}
@@ -0,0 +1,176 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "AST.hpp"
+
+/**
+ * @brief Operator of a BIN_OP or UNARY_OP node of a FlatAST (instead of the whole Token of the tree nodes)
+ */
+enum class Opcode : uint8_t {
+    // binary
+    ADD,
+    SUB,
+    MUL,
+    DIVIDE,  // '/'
+    DIV,
+    MOD,
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE,
+    AND,
+    OR,
+    // unary
+    NEG,
+    NOT,
+};
+
+std::ostream& operator<<(std::ostream& os, Opcode opcode) noexcept;
+
+/**
+ * @brief Data-oriented form of an AST, lowered from the tree built by the Parser (FlatAST::lower)
+ * @note Nodes are numbered in pre-order and their columns are stored in separate arrays indexed by the NodeId, so a
+ * pass looking only at kinds (or opcodes) reads one byte per node from a single array. The children of a node follow
+ * it, each child's subtree ends where the next one starts, and the subtree of the node ends at getEnd. Kind specific
+ * payloads live in per-kind arrays (names, reals, array bounds) referenced by the 32-bit data of the node.
+ *
+ * Children in pre-order, by kind:
+ *  - ARRAY_TYPE: element type
+ *  - BIN_OP: lhs, rhs; UNARY_OP: expression
+ *  - DECL_ARRAY_REF: index
+ *  - FUN_CALL, PROC_CALL: arguments
+ *  - BLOCK, COMPOUND_STMT: statements
+ *  - VAR_DECL, ARRAY_DECL: type; CONST_DEF: expression
+ *  - PROC_DECL: parameters, block (unless forward); FUN_DECL: return type, parameters, block (unless forward)
+ *  - ASSIGN: variable, expression
+ *  - IF: condition, body, else body (if present); WHILE: condition, body
+ *  - FOR: initial assignment, bound, body
+ *  - PROGRAM: block
+ *
+ * Only the syntax is lowered, analysis results belong in arrays of the pass indexed by the NodeId.
+ */
+class FlatAST {
+   public:
+    using NodeId = uint32_t;
+    using Kind = ASTNode::Kind;
+
+    struct ArrayBounds {
+        int lowerBound;
+        int upperBound;
+    };
+
+    /**
+     * @brief Iterates over the direct children of a node, jumping over their subtrees
+     */
+    class ChildIterator {
+        const FlatAST* ast;
+        NodeId id;
+
+       public:
+        ChildIterator(const FlatAST* ast, NodeId id) : ast(ast), id(id) {}
+        NodeId operator*() const { return id; }
+        ChildIterator& operator++() {
+            id = ast->ends[id];
+            return *this;
+        }
+        bool operator!=(const ChildIterator& other) const { return id != other.id; }
+    };
+
+    struct ChildRange {
+        ChildIterator first, last;
+        [[nodiscard]] ChildIterator begin() const { return first; }
+        [[nodiscard]] ChildIterator end() const { return last; }
+    };
+
+   private:
+    std::vector<Kind> kinds;
+
+    /**
+     * @brief Small per-node value: the Opcode (BIN_OP, UNARY_OP), the PrimitiveType (PRIMITIVE_TYPE), whether a
+     * literal is real (LITERAL), a global declaration (declarations), an increasing loop (FOR)
+     */
+    std::vector<uint8_t> flags;
+
+    /**
+     * @brief Index into the array of the kind (names, reals, arrayBounds) or the value of an integer literal
+     */
+    std::vector<uint32_t> data;
+
+    /**
+     * @brief One past the last node of the subtree
+     */
+    std::vector<NodeId> ends;
+
+    /**
+     * @brief Offsets in the source code, for diagnostics only
+     */
+    std::vector<uint32_t> offsets;
+
+    /**
+     * @brief Distinct names of references, declarations, calls and the program
+     */
+    std::vector<std::string> names;
+    std::vector<double> reals;
+    std::vector<ArrayBounds> arrayBounds;
+
+    friend class FlattenVisitor;
+
+   public:
+    /**
+     * @brief Lowers the tree of the program
+     */
+    static FlatAST lower(ProgramASTNode& programNode);
+
+    /**
+     * @brief Number of nodes, the root (PROGRAM) is 0
+     */
+    [[nodiscard]] NodeId size() const { return NodeId(kinds.size()); }
+
+    [[nodiscard]] const std::vector<Kind>& getKinds() const { return kinds; }
+    [[nodiscard]] Kind getKind(NodeId id) const { return kinds[id]; }
+    [[nodiscard]] NodeId getEnd(NodeId id) const { return ends[id]; }
+    [[nodiscard]] uint32_t getOffset(NodeId id) const { return offsets[id]; }
+    [[nodiscard]] ChildRange children(NodeId id) const { return {{this, id + 1}, {this, ends[id]}}; }
+
+    /**
+     * @brief Child at the position (see the order in the class description), linear in the position
+     */
+    [[nodiscard]] NodeId getChild(NodeId id, size_t position) const;
+    [[nodiscard]] size_t getNumChildren(NodeId id) const;
+
+    [[nodiscard]] Opcode getOpcode(NodeId id) const { return Opcode(flags[id]); }
+    [[nodiscard]] PrimitiveTypeASTNode::PrimitiveType getPrimitiveType(NodeId id) const {
+        return PrimitiveTypeASTNode::PrimitiveType(flags[id]);
+    }
+
+    /**
+     * @brief Value of a LITERAL node
+     */
+    [[nodiscard]] TokenValue getValue(NodeId id) const;
+
+    /**
+     * @brief Name of a reference, declaration, call or the program
+     */
+    [[nodiscard]] const std::string& getName(NodeId id) const { return names[data[id]]; }
+    [[nodiscard]] const ArrayBounds& getArrayBounds(NodeId id) const { return arrayBounds[data[id]]; }
+
+    /**
+     * @note Set by the semantic analysis, so false if the tree was lowered before it
+     */
+    [[nodiscard]] bool isGlobal(NodeId id) const { return flags[id]; }
+    [[nodiscard]] bool isIncreasing(NodeId id) const { return flags[id]; }
+
+    /**
+     * @brief Bytes taken by the arrays (without the characters of the names)
+     */
+    [[nodiscard]] size_t getMemoryUsage() const;
+
+    /**
+     * @brief Prints the nodes in pre-order, indented by their depth
+     */
+    void print(std::ostream& os) const;
+};
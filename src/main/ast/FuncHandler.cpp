@@ -9,12 +9,11 @@ std::shared_ptr<FuncHandler> FuncHandler::setNext(std::shared_ptr<FuncHandler> n
     return next;
 }
 
-llvm::Value* FuncHandler::handle(const std::string& funName,
-                                 const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) {
+llvm::Value* FuncHandler::handle(const Routine& routine, llvm::ArrayRef<ExprASTNode*> argNodes) {
     if (nextHandler) {
-        return nextHandler->handle(funName, argNodes);
+        return nextHandler->handle(routine, argNodes);
     } else {
-        throw std::runtime_error("Cannot handle function call: " + funName);
+        throw std::runtime_error("Cannot handle function call: " + routine.name.str());
     }
 }
 
@@ -34,34 +33,19 @@ WriteFuncHandler::WriteFuncHandler(GenContext& gen) : FuncHandler(gen) {
     }
 }
 
-void WriteFuncHandler::validateCall(const std::string& funName,
-                                    const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) {
-    if (funName != "write")
-        throw CodeGenException("WriteFuncHandler can only handle 'write' function");
-    if (argNodes.size() != 1)
-        throw CodeGenException("'write' procedure expects 1 argument, but " + std::to_string(argNodes.size()) +
-                               " were provided");
-}
-
-llvm::Value* WriteFuncHandler::handle(const std::string& funName,
-                                      const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) {
-    if (funName != "write")
-        return FuncHandler::handle(funName, argNodes);
-
-    validateCall(funName, argNodes);
+llvm::Value* WriteFuncHandler::handle(const Routine& routine, llvm::ArrayRef<ExprASTNode*> argNodes) {
+    if (routine.builtin != Builtin::WRITE)
+        return FuncHandler::handle(routine, argNodes);
 
     CodeGenVisitor codeGenVisitor(gen);
     argNodes[0]->accept(codeGenVisitor);
     auto* argV = codeGenVisitor.getValue();
-    if (!argV)
-        throw CodeGenException("Failed to get argument value of 'write' procedure");
 
-    if (argV->getType()->isDoubleTy())
+    // The semantic analysis only lets numeric arguments through
+    if (argNodes[0]->getSemaType()->isReal())
         return gen.builder.CreateCall(gen.module.getFunction("write_double"), argV);
-    else if (argV->getType()->isIntegerTy())
-        return gen.builder.CreateCall(gen.module.getFunction("write_int"), argV);
     else
-        throw CodeGenException("Unsupported argument type for 'write' procedure");
+        return gen.builder.CreateCall(gen.module.getFunction("write_int"), argV);
 }
 
 WritelnFuncHandler::WritelnFuncHandler(GenContext& gen) : FuncHandler(gen) {
@@ -80,34 +64,19 @@ WritelnFuncHandler::WritelnFuncHandler(GenContext& gen) : FuncHandler(gen) {
     }
 }
 
-void WritelnFuncHandler::validateCall(const std::string& funName,
-                                      const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) {
-    if (funName != "writeln")
-        throw CodeGenException("WritelnFuncHandler can only handle 'writeln' function");
-    if (argNodes.size() != 1)
-        throw CodeGenException("'writeln' procedure expects 1 argument, but " + std::to_string(argNodes.size()) +
-                               " were provided");
-}
-
-llvm::Value* WritelnFuncHandler::handle(const std::string& funName,
-                                        const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) {
-    if (funName != "writeln")
-        return FuncHandler::handle(funName, argNodes);
-
-    validateCall(funName, argNodes);
+llvm::Value* WritelnFuncHandler::handle(const Routine& routine, llvm::ArrayRef<ExprASTNode*> argNodes) {
+    if (routine.builtin != Builtin::WRITELN)
+        return FuncHandler::handle(routine, argNodes);
 
     CodeGenVisitor codeGenVisitor(gen);
     argNodes[0]->accept(codeGenVisitor);
     auto* argV = codeGenVisitor.getValue();
-    if (!argV)
-        throw CodeGenException("Failed to get argument value of 'writeln' procedure");
 
-    if (argV->getType()->isDoubleTy())
+    // The semantic analysis only lets numeric arguments through
+    if (argNodes[0]->getSemaType()->isReal())
         return gen.builder.CreateCall(gen.module.getFunction("writeln_double"), argV);
-    else if (argV->getType()->isIntegerTy())
-        return gen.builder.CreateCall(gen.module.getFunction("writeln_int"), argV);
     else
-        throw CodeGenException("Unsupported argument type for 'writeln' procedure");
+        return gen.builder.CreateCall(gen.module.getFunction("writeln_int"), argV);
 }
 
 ReadlnFuncHandler::ReadlnFuncHandler(GenContext& gen) : FuncHandler(gen) {
@@ -126,137 +95,71 @@ ReadlnFuncHandler::ReadlnFuncHandler(GenContext& gen) : FuncHandler(gen) {
     }
 }
 
-void ReadlnFuncHandler::validateCall(const std::string& funName,
-                                     const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) {
-    if (funName != "readln")
-        throw CodeGenException("ReadlnFuncHandler can only handle 'readln' function");
-    if (argNodes.size() != 1)
-        throw CodeGenException("'readln' procedure expects 1 argument, but " + std::to_string(argNodes.size()) +
-                               " were provided");
-}
-
-llvm::Value* ReadlnFuncHandler::handle(const std::string& funName,
-                                       const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) {
-    if (funName != "readln")
-        return FuncHandler::handle(funName, argNodes);
-
-    validateCall(funName, argNodes);
+llvm::Value* ReadlnFuncHandler::handle(const Routine& routine, llvm::ArrayRef<ExprASTNode*> argNodes) {
+    if (routine.builtin != Builtin::READLN)
+        return FuncHandler::handle(routine, argNodes);
 
-    auto* declRefNode = dynamic_cast<DeclRefASTNode*>(argNodes[0].get());
+    // The semantic analysis checked that the argument is a variable
+    auto* declRefNode = llvm::dyn_cast<DeclRefASTNode>(argNodes[0]);
     if (!declRefNode)
         throw CodeGenException("'readln' procedure failed, argument is not a variable");
 
-    StoreVisitor storeVisitor(gen);
-    declRefNode->accept(storeVisitor);
-    auto* argStore = storeVisitor.getStore();
-    if (!argStore)
-        throw CodeGenException("'readln' procedure failed, argument store (memory location) not found");
+    auto* argStore = StoreVisitor(gen).dispatch(*declRefNode);
 
-    llvm::Type* storeType = argStore->getType();
-    if (!storeType->isPointerTy())
-        throw CodeGenException("'readln' procedure failed, store is not a pointer");
-
-    llvm::Type* valType = storeType->getPointerElementType();
-    if (valType->isDoubleTy())
+    if (declRefNode->getSemaType()->isReal())
         return gen.builder.CreateCall(gen.module.getFunction("readln_double"), argStore);
-    else if (valType->isIntegerTy())
-        return gen.builder.CreateCall(gen.module.getFunction("readln_int"), argStore);
     else
-        throw CodeGenException("Unsupported argument type for 'readln' procedure");
+        return gen.builder.CreateCall(gen.module.getFunction("readln_int"), argStore);
 }
 
 ToIntegerFuncHandler::ToIntegerFuncHandler(GenContext& gen) : FuncHandler(gen) {}
 
-void ToIntegerFuncHandler::validateCall(const std::string& funName,
-                                     const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) {
-    if (funName != "to_integer")
-        throw CodeGenException("ToIntegerFuncHandler can only handle 'to_integer' function");
-    if (argNodes.size() != 1)
-        throw CodeGenException("'to_integer' function expects 1 argument, but " + std::to_string(argNodes.size()) +
-                               " were provided");
-}
-
-llvm::Value* ToIntegerFuncHandler::handle(const std::string& funName,
-                                       const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) {
-    if (funName != "to_integer")
-        return FuncHandler::handle(funName, argNodes);
-
-    validateCall(funName, argNodes);
+llvm::Value* ToIntegerFuncHandler::handle(const Routine& routine, llvm::ArrayRef<ExprASTNode*> argNodes) {
+    if (routine.builtin != Builtin::TO_INTEGER)
+        return FuncHandler::handle(routine, argNodes);
 
     CodeGenVisitor codeGenVisitor(gen);
     argNodes[0]->accept(codeGenVisitor);
     auto* argV = codeGenVisitor.getValue();
-    if (!argV)
-        throw CodeGenException("Failed to get argument value of 'to_integer' function");
 
-    if (argV->getType()->isDoubleTy())
+    if (argNodes[0]->getSemaType()->isReal())
         return gen.builder.CreateFPToSI(argV, llvm::Type::getInt32Ty(gen.ctx));
-    else if (argV->getType()->isIntegerTy())
-        return argV;
     else
-        throw CodeGenException("Unsupported argument type for 'to_integer' function");
+        return argV;
 }
 
 ToRealFuncHandler::ToRealFuncHandler(GenContext& gen) : FuncHandler(gen) {}
 
-void ToRealFuncHandler::validateCall(const std::string& funName,
-                                        const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) {
-    if (funName != "to_real")
-        throw CodeGenException("ToRealFuncHandler can only handle 'to_real' function");
-    if (argNodes.size() != 1)
-        throw CodeGenException("'to_real' function expects 1 argument, but " + std::to_string(argNodes.size()) +
-                               " were provided");
-}
-
-llvm::Value* ToRealFuncHandler::handle(const std::string& funName,
-                                          const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) {
-    if (funName != "to_real")
-        return FuncHandler::handle(funName, argNodes);
-
-    validateCall(funName, argNodes);
+llvm::Value* ToRealFuncHandler::handle(const Routine& routine, llvm::ArrayRef<ExprASTNode*> argNodes) {
+    if (routine.builtin != Builtin::TO_REAL)
+        return FuncHandler::handle(routine, argNodes);
 
     CodeGenVisitor codeGenVisitor(gen);
     argNodes[0]->accept(codeGenVisitor);
     auto* argV = codeGenVisitor.getValue();
-    if (!argV)
-        throw CodeGenException("Failed to get argument value of 'to_real' function");
 
-    if (argV->getType()->isIntegerTy())
+    if (argNodes[0]->getSemaType()->isInteger())
         return gen.builder.CreateSIToFP(argV, llvm::Type::getDoubleTy(gen.ctx));
-    else if (argV->getType()->isDoubleTy())
-        return argV;
     else
-        throw CodeGenException("Unsupported argument type for 'to_real' function");
+        return argV;
 }
 
 UserFuncHandler::UserFuncHandler(GenContext& gen) : FuncHandler(gen) {}
 
-void UserFuncHandler::validateCall(const std::string& funName,
-                                   const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) {
-    auto* func = gen.module.getFunction(funName);
-
-    if (!func)
-        throw CodeGenException("Function/Procedure not found: " + funName);
-
-    if (func->arg_size() != argNodes.size())
-        throw CodeGenException("Function/Procedure " + funName + " expects " + std::to_string(func->arg_size()) +
-                               " arguments, but " + std::to_string(argNodes.size()) + " were provided");
-}
-
-llvm::Value* UserFuncHandler::handle(const std::string& funName,
-                                     const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) {
-    validateCall(funName, argNodes);
-
-    auto* func = gen.module.getFunction(funName);
+llvm::Value* UserFuncHandler::handle(const Routine& routine, llvm::ArrayRef<ExprASTNode*> argNodes) {
+    auto* func = gen.routineFunctions[routine.id];
 
     std::vector<llvm::Value*> argsV;
 
     CodeGenVisitor codeGenVisitor(gen);
-    for (const auto& argNode : argNodes) {
-        argNode->accept(codeGenVisitor);
+    for (size_t i = 0; i < argNodes.size(); ++i) {
+        argNodes[i]->accept(codeGenVisitor);
         auto* argV = codeGenVisitor.getValue();
-        if (!argV)
-            throw CodeGenException("Failed to get argument value of " + funName + " function/procedure");
+
+        // Handle implicit conversion int -> double
+        if (routine.paramTypes[i]->isReal() && argNodes[i]->getSemaType()->isInteger())
+            argV = gen.builder.CreateSIToFP(argV, llvm::Type::getDoubleTy(gen.ctx));
+
         argsV.push_back(argV);
     }
 
@@ -3,6 +3,7 @@
 
 // Forward declaration
 struct GenContext;
+struct Routine;
 
 /**
  * @brief Abstract function call handler
@@ -20,54 +21,46 @@ class FuncHandler {
 
     /**
      * @brief Handle function call
-     * @param funName Function name
+     * @param routine Called function, resolved by the semantic analysis (which also checked the arguments)
      * @param argNodes Function arguments
      * @returns Function call return value
      */
-    virtual llvm::Value* handle(const std::string& funName, const std::vector<std::unique_ptr<ExprASTNode>>& argNodes);
-
-    virtual void validateCall(const std::string& funName,
-                              const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) = 0;
+    virtual llvm::Value* handle(const Routine& routine, llvm::ArrayRef<ExprASTNode*> argNodes);
 };
 
 class WriteFuncHandler : public FuncHandler {
    public:
     explicit WriteFuncHandler(GenContext& gen);
 
-    void validateCall(const std::string& funName, const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) override;
-    llvm::Value* handle(const std::string& funName, const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) override;
+    llvm::Value* handle(const Routine& routine, llvm::ArrayRef<ExprASTNode*> argNodes) override;
 };
 
 class WritelnFuncHandler : public FuncHandler {
    public:
     explicit WritelnFuncHandler(GenContext& gen);
 
-    void validateCall(const std::string& funName, const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) override;
-    llvm::Value* handle(const std::string& funName, const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) override;
+    llvm::Value* handle(const Routine& routine, llvm::ArrayRef<ExprASTNode*> argNodes) override;
 };
 
 class ReadlnFuncHandler : public FuncHandler {
    public:
     explicit ReadlnFuncHandler(GenContext& gen);
 
-    void validateCall(const std::string& funName, const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) override;
-    llvm::Value* handle(const std::string& funName, const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) override;
+    llvm::Value* handle(const Routine& routine, llvm::ArrayRef<ExprASTNode*> argNodes) override;
 };
 
 class ToIntegerFuncHandler : public FuncHandler {
    public:
     explicit ToIntegerFuncHandler(GenContext& gen);
 
-    void validateCall(const std::string& funName, const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) override;
-    llvm::Value* handle(const std::string& funName, const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) override;
+    llvm::Value* handle(const Routine& routine, llvm::ArrayRef<ExprASTNode*> argNodes) override;
 };
 
 class ToRealFuncHandler : public FuncHandler {
    public:
     explicit ToRealFuncHandler(GenContext& gen);
 
-    void validateCall(const std::string& funName, const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) override;
-    llvm::Value* handle(const std::string& funName, const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) override;
+    llvm::Value* handle(const Routine& routine, llvm::ArrayRef<ExprASTNode*> argNodes) override;
 };
 
 /**
@@ -77,6 +70,5 @@ class UserFuncHandler : public FuncHandler {
    public:
     explicit UserFuncHandler(GenContext& gen);
 
-    void validateCall(const std::string& funName, const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) override;
-    llvm::Value* handle(const std::string& funName, const std::vector<std::unique_ptr<ExprASTNode>>& argNodes) override;
+    llvm::Value* handle(const Routine& routine, llvm::ArrayRef<ExprASTNode*> argNodes) override;
 };
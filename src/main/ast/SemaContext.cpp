@@ -0,0 +1,123 @@
+#include "SemaContext.hpp"
+#include "CodeGenerator.hpp"
+#include "utils/Statistic.hpp"
+
+MILA_STATISTIC(NumSymbolLookups, "symbols", "Number of symbol table lookups");
+MILA_STATISTIC(NumScopes, "symbols", "Number of symbol table scopes entered");
+MILA_STATISTIC(NumShadowedSymbols, "symbols", "Number of symbols shadowing a symbol of an outer scope");
+MILA_STATISTIC(NumSemaTypes, "symbols", "Number of interned types");
+
+SemaType::SemaType(Kind kind, const SemaType* elementType, int lowerBound, int upperBound)
+    : kind(kind), elementType(elementType), lowerBound(lowerBound), upperBound(upperBound) {}
+
+std::string SemaType::toString() const {
+    switch (kind) {
+        case Kind::INTEGER:
+            return "integer";
+        case Kind::REAL:
+            return "real";
+        case Kind::BOOLEAN:
+            return "boolean";
+        case Kind::ARRAY:
+            return "array [" + std::to_string(lowerBound) + ".." + std::to_string(upperBound) + "] of " +
+                   elementType->toString();
+    }
+    return "";
+}
+
+SymbolTable::~SymbolTable() {
+    NumSymbolLookups += lookups;
+}
+
+SymbolTable::Scope::Scope(SymbolTable& table) : table(table) {
+    table.pushScope();
+}
+
+SymbolTable::Scope::~Scope() {
+    table.popScope();
+}
+
+size_t SymbolTable::currentScopeStart() const {
+    return scopeStarts.empty() ? 0 : scopeStarts.back();
+}
+
+void SymbolTable::pushScope() {
+    ++NumScopes;
+    scopeStarts.push_back(entries.size());
+}
+
+void SymbolTable::popScope() {
+    if (scopeStarts.empty())
+        throw CodeGenException("Failed to leave scope - no scope is open");
+
+    for (size_t start = scopeStarts.back(); entries.size() > start; entries.pop_back()) {
+        const Entry& entry = entries.back();
+        if (entry.shadowed == noEntry)
+            visible.erase(entry.binding->getKey());
+        else
+            entry.binding->second = entry.shadowed;
+    }
+    scopeStarts.pop_back();
+}
+
+void SymbolTable::addSymbol(llvm::StringRef name, DeclId symbol) {
+    if (containsInScope(name))
+        throw CodeGenException("Failed to add new symbol - symbol already exists: " + name.str());
+
+    auto [it, inserted] = visible.try_emplace(name, noEntry);
+    if (!inserted)
+        ++NumShadowedSymbols;
+
+    entries.push_back({symbol, &*it, it->second});
+    it->second = entries.size() - 1;
+}
+
+std::optional<DeclId> SymbolTable::lookup(llvm::StringRef name) const {
+    ++lookups;
+
+    auto it = visible.find(name);
+    if (it == visible.end())
+        return std::nullopt;
+
+    return entries[it->second].symbol;
+}
+
+bool SymbolTable::contains(llvm::StringRef name) const {
+    return visible.count(name) > 0;
+}
+
+bool SymbolTable::containsInScope(llvm::StringRef name) const {
+    auto it = visible.find(name);
+    return it != visible.end() && it->second >= currentScopeStart();
+}
+
+SemaContext::SemaContext()
+    : integerType(&types.emplace_back(SemaType::Kind::INTEGER)),
+      realType(&types.emplace_back(SemaType::Kind::REAL)),
+      booleanType(&types.emplace_back(SemaType::Kind::BOOLEAN)) {
+    addRoutine({0, "write", Builtin::WRITE, nullptr, {}, true});
+    addRoutine({0, "writeln", Builtin::WRITELN, nullptr, {}, true});
+    addRoutine({0, "readln", Builtin::READLN, nullptr, {}, true});
+    addRoutine({0, "to_integer", Builtin::TO_INTEGER, integerType, {}, true});
+    addRoutine({0, "to_real", Builtin::TO_REAL, realType, {}, true});
+}
+
+const SemaType* SemaContext::getArrayType(const SemaType* elementType, int lowerBound, int upperBound) {
+    auto [it, inserted] = arrayTypes.try_emplace({elementType, lowerBound, upperBound}, nullptr);
+    if (inserted) {
+        ++NumSemaTypes;
+        it->second = &types.emplace_back(SemaType::Kind::ARRAY, elementType, lowerBound, upperBound);
+    }
+    return it->second;
+}
+
+DeclId SemaContext::addSymbol(const Symbol& symbol) {
+    symbols.push_back(symbol);
+    return symbols.size() - 1;
+}
+
+RoutineId SemaContext::addRoutine(Routine routine) {
+    routine.id = routines.size();
+    routines.push_back(std::move(routine));
+    return routines.back().id;
+}
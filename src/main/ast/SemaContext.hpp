@@ -0,0 +1,254 @@
+#pragma once
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/**
+ * @brief Canonical type of a value, interned by the SemaContext (two types are equal iff they are the same object)
+ */
+class SemaType {
+   public:
+    enum class Kind {
+        INTEGER,
+        REAL,
+        /**
+         * @brief Result of comparisons and of logical operators over comparisons, cannot be stored
+         */
+        BOOLEAN,
+        ARRAY,
+    };
+
+   private:
+    Kind kind;
+    const SemaType* elementType;
+    int lowerBound;
+    int upperBound;
+
+   public:
+    explicit SemaType(Kind kind, const SemaType* elementType = nullptr, int lowerBound = 0, int upperBound = 0);
+
+    [[nodiscard]] Kind getKind() const { return kind; }
+    [[nodiscard]] bool isInteger() const { return kind == Kind::INTEGER; }
+    [[nodiscard]] bool isReal() const { return kind == Kind::REAL; }
+    [[nodiscard]] bool isBoolean() const { return kind == Kind::BOOLEAN; }
+    [[nodiscard]] bool isArray() const { return kind == Kind::ARRAY; }
+    [[nodiscard]] bool isNumeric() const { return kind == Kind::INTEGER || kind == Kind::REAL; }
+
+    /**
+     * @note Arrays only
+     */
+    [[nodiscard]] const SemaType* getElementType() const { return elementType; }
+    [[nodiscard]] int getLowerBound() const { return lowerBound; }
+    [[nodiscard]] int getUpperBound() const { return upperBound; }
+
+    /**
+     * @brief Spelling of the type in diagnostics, e.g. "integer" or "array [1..10] of real"
+     */
+    [[nodiscard]] std::string toString() const;
+};
+
+/**
+ * @brief Index of a Symbol, or of a Routine, in the SemaContext (not to be confused with the SymbolId of an interned
+ * name, several declarations may share a name)
+ */
+using DeclId = uint32_t;
+using RoutineId = uint32_t;
+
+/**
+ * @brief Variable, constant, parameter or function result resolved by the semantic analysis
+ */
+struct Symbol {
+    /**
+     * @brief Points into the names pooled by the ASTContext of the analyzed program
+     */
+    llvm::StringRef name;
+    const SemaType* type;
+    bool immutable;
+    bool global;
+};
+
+/**
+ * @brief Runtime procedures and functions, called like user-defined ones
+ */
+enum class Builtin {
+    NONE,
+    WRITE,
+    WRITELN,
+    READLN,
+    TO_INTEGER,
+    TO_REAL,
+};
+
+/**
+ * @brief Procedure or function, either builtin or user-defined
+ */
+struct Routine {
+    RoutineId id;
+    llvm::StringRef name;
+    Builtin builtin;
+
+    /**
+     * @brief nullptr for procedures
+     */
+    const SemaType* returnType;
+
+    /**
+     * @note Builtins take a single numeric argument, their parameter types are not listed
+     */
+    std::vector<const SemaType*> paramTypes;
+
+    /**
+     * @brief Has a body (a forward declaration does not)
+     */
+    bool defined;
+
+    [[nodiscard]] bool isFunction() const { return returnType != nullptr; }
+};
+
+/**
+ * @brief Scoped table of the visible symbol names, an inner scope may shadow the symbols of the outer ones
+ * @note Bindings live on a stack that doubles as the undo log: each entry remembers the binding of its name it
+ * shadows. Entering a scope pushes a marker, leaving it unwinds the entries above the marker and restores the shadowed
+ * bindings, so the cost of a scope is proportional to its own declarations, not to everything visible in it.
+ */
+class SymbolTable {
+   private:
+    static constexpr size_t noEntry = SIZE_MAX;
+
+    struct Entry {
+        DeclId symbol;
+        /**
+         * @brief Binding of the name in 'visible', restored or removed when the entry is unwound
+         */
+        llvm::StringMapEntry<size_t>* binding;
+        /**
+         * @brief Index of the entry of the same name this one shadows, noEntry if none
+         */
+        size_t shadowed;
+    };
+
+    std::vector<Entry> entries;
+
+    /**
+     * @brief Index of the innermost visible entry of each name
+     */
+    llvm::StringMap<size_t> visible;
+
+    /**
+     * @brief Size of 'entries' at the time each open scope was entered
+     */
+    std::vector<size_t> scopeStarts;
+
+    /**
+     * @brief Lookups of this table, added to the process-wide statistic once on destruction (not per lookup)
+     */
+    mutable uint64_t lookups = 0;
+
+    [[nodiscard]] size_t currentScopeStart() const;
+
+   public:
+    SymbolTable() = default;
+    ~SymbolTable();
+
+    // Each table reports its lookups once
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    /**
+     * @brief Opens a scope for the lifetime of the object
+     */
+    class Scope {
+       private:
+        SymbolTable& table;
+
+       public:
+        explicit Scope(SymbolTable& table);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    void pushScope();
+
+    /**
+     * @brief Removes the symbols of the innermost scope, making the symbols they shadowed visible again
+     */
+    void popScope();
+
+    /**
+     * @brief Binds the name in the innermost scope, possibly shadowing a symbol of an outer scope
+     * @throws CodeGenException If the innermost scope already has a symbol of that name
+     */
+    void addSymbol(llvm::StringRef name, DeclId symbol);
+
+    /**
+     * @brief Returns the innermost visible symbol with the given name, std::nullopt if there is none
+     */
+    [[nodiscard]] std::optional<DeclId> lookup(llvm::StringRef name) const;
+
+    /**
+     * @brief Checks if a symbol of the given name is visible in the innermost scope (declared there or in an outer one)
+     */
+    [[nodiscard]] bool contains(llvm::StringRef name) const;
+
+    /**
+     * @brief Checks if a symbol of the given name is declared in the innermost scope itself
+     */
+    [[nodiscard]] bool containsInScope(llvm::StringRef name) const;
+};
+
+/**
+ * @brief Result of the semantic analysis: interned types, symbols and routines of a program
+ * @note The analyzed nodes refer to the types by pointer and to the symbols and routines by index, they are valid as
+ * long as the context lives. Codegen and any other backend read them instead of resolving names again.
+ */
+class SemaContext {
+   private:
+    /**
+     * @brief A deque, so that the interned types never move
+     */
+    std::deque<SemaType> types;
+    std::map<std::tuple<const SemaType*, int, int>, const SemaType*> arrayTypes;
+
+    const SemaType* integerType;
+    const SemaType* realType;
+    const SemaType* booleanType;
+
+    std::vector<Symbol> symbols;
+    std::vector<Routine> routines;
+
+   public:
+    /**
+     * @brief Creates the primitive types and registers the builtin routines
+     */
+    SemaContext();
+
+    SemaContext(const SemaContext&) = delete;
+    SemaContext& operator=(const SemaContext&) = delete;
+
+    [[nodiscard]] const SemaType* getIntegerType() const { return integerType; }
+    [[nodiscard]] const SemaType* getRealType() const { return realType; }
+    [[nodiscard]] const SemaType* getBooleanType() const { return booleanType; }
+
+    /**
+     * @brief Returns the interned array type, creating it on the first request
+     */
+    const SemaType* getArrayType(const SemaType* elementType, int lowerBound, int upperBound);
+
+    DeclId addSymbol(const Symbol& symbol);
+    RoutineId addRoutine(Routine routine);
+
+    [[nodiscard]] const Symbol& getSymbol(DeclId id) const { return symbols[id]; }
+    [[nodiscard]] const Routine& getRoutine(RoutineId id) const { return routines[id]; }
+    [[nodiscard]] Routine& getRoutine(RoutineId id) { return routines[id]; }
+
+    [[nodiscard]] size_t getNumSymbols() const { return symbols.size(); }
+    [[nodiscard]] size_t getNumRoutines() const { return routines.size(); }
+};
@@ -1,7 +1,7 @@
 #include "CodeGenVisitor.hpp"
-#include "CollectorVisitor.hpp"
-#include "GenTypeVisitor.hpp"
 #include "StoreVisitor.hpp"
+#include "utils/PhaseTimer.hpp"
+#include "utils/Statistic.hpp"
 #include "utils/Utils.hpp"
 
 CodeGenVisitor::CodeGenVisitor(GenContext& gen) : gen(gen) {}
@@ -25,18 +25,27 @@ void CodeGenVisitor::visit([[maybe_unused]] PrimitiveTypeASTNode& node) {}
 void CodeGenVisitor::visit([[maybe_unused]] ArrayTypeASTNode& node) {}
 
 void CodeGenVisitor::visit(BinOpASTNode& node) {
-    node.getLhsExprNode()->accept(*this);
-    auto* lhsV = value;
-    node.getRhsExprNode()->accept(*this);
-    auto* rhsV = value;
+    // Walks the left spine of a chain 'a + b + c ...' by a loop, like the semantic analysis
+    llvm::SmallVector<BinOpASTNode*, 8> spine{&node};
+    while (auto* lhsNode = llvm::dyn_cast<BinOpASTNode>(spine.back()->getLhsExprNode()))
+        spine.push_back(lhsNode);
+
+    spine.back()->getLhsExprNode()->accept(*this);
+    for (auto it = spine.rbegin(); it != spine.rend(); ++it) {
+        auto* lhsV = value;
+        (*it)->getRhsExprNode()->accept(*this);
+        generateBinOp(**it, lhsV, value);
+    }
+}
 
+void CodeGenVisitor::generateBinOp(BinOpASTNode& node, llvm::Value* lhsV, llvm::Value* rhsV) {
     if (!lhsV)
-        throw CodeGenException("Left-hand side value of binary operator is not found");
+        throw CodeGenException("Left-hand side value of binary operator is not found", node.getOffset());
 
     if (!rhsV)
-        throw CodeGenException("Right-hand side value of binary operator is not found");
+        throw CodeGenException("Right-hand side value of binary operator is not found", node.getOffset());
 
-    bool dblArith = lhsV->getType()->isDoubleTy() || rhsV->getType()->isDoubleTy();
+    bool dblArith = node.getLhsExprNode()->getSemaType()->isReal() || node.getRhsExprNode()->getSemaType()->isReal();
 
     /*
         LLVM function names decoding:
@@ -116,16 +125,10 @@ void CodeGenVisitor::visit(BinOpASTNode& node) {
                 value = gen.builder.CreateICmpSGE(lhsV, rhsV, "ge");
             break;
         case TokenType::OR:
-            if (dblArith)
-                throw CodeGenException("Unsupported logical OR operation for real type");
-            else
-                value = gen.builder.CreateOr(lhsV, rhsV, "or");
+            value = gen.builder.CreateOr(lhsV, rhsV, "or");
             break;
         case TokenType::AND:
-            if (dblArith)
-                throw CodeGenException("Unsupported logical AND operation for real type");
-            else
-                value = gen.builder.CreateAnd(lhsV, rhsV, "and");
+            value = gen.builder.CreateAnd(lhsV, rhsV, "and");
             break;
         case TokenType::MOD:
             if (dblArith)
@@ -134,32 +137,37 @@ void CodeGenVisitor::visit(BinOpASTNode& node) {
                 value = gen.builder.CreateSRem(lhsV, rhsV, "mod");
             break;
         default:
-            throw CodeGenException("Unknown binary operator");
+            throw CodeGenException("Unknown binary operator", node.getOffset());
     }
 }
 
 void CodeGenVisitor::visit(UnaryOpASTNode& node) {
-    node.getExprNode()->accept(*this);
-    auto* exprV = value;
+    llvm::SmallVector<UnaryOpASTNode*, 4> run{&node};
+    while (auto* exprNode = llvm::dyn_cast<UnaryOpASTNode>(run.back()->getExprNode()))
+        run.push_back(exprNode);
+
+    run.back()->getExprNode()->accept(*this);
+    for (auto it = run.rbegin(); it != run.rend(); ++it)
+        generateUnaryOp(**it, value);
+}
 
+void CodeGenVisitor::generateUnaryOp(UnaryOpASTNode& node, llvm::Value* exprV) {
     if (!exprV)
-        throw CodeGenException("Expression value is not found");
+        throw CodeGenException("Expression value is not found", node.getOffset());
 
     switch (node.getOp().getType()) {
         case TokenType::MINUS:
-            if (exprV->getType()->isDoubleTy())
+            if (node.getSemaType()->isReal())
                 value = gen.builder.CreateFNeg(exprV, "fneg");
             else
                 value = gen.builder.CreateNeg(exprV, "neg");
             break;
         case TokenType::NOT:
-            if (exprV->getType()->isDoubleTy())
-                throw CodeGenException("Unsupported NOT operation for real type");
-            else  // NOT is achieved by XOR with 1
-                value = gen.builder.CreateXor(exprV, llvm::ConstantInt::get(llvm::Type::getInt1Ty(gen.ctx), 1), "not");
+            // NOT is achieved by XOR with 1
+            value = gen.builder.CreateXor(exprV, llvm::ConstantInt::get(exprV->getType(), 1), "not");
             break;
         default:
-            throw CodeGenException("Unknown unary operator");
+            throw CodeGenException("Unknown unary operator", node.getOffset());
     }
 }
 
@@ -171,80 +179,30 @@ void CodeGenVisitor::visit(LiteralASTNode& node) {
     } else if (std::holds_alternative<double>(tokenValue)) {
         value = llvm::ConstantFP::get(llvm::Type::getDoubleTy(gen.ctx), std::get<double>(tokenValue));
     } else {
-        throw CodeGenException("Unknown literal type");
+        throw CodeGenException("Unknown literal type", node.getOffset());
     }
 }
 
 void CodeGenVisitor::visit(DeclVarRefASTNode& node) {
-    if (!gen.symbolTable.contains(node.getRefName()))
-        throw CodeGenException("Variable/Constant not found: " + node.getRefName());
-
-    const Symbol& symbol = gen.symbolTable.getSymbol(node.getRefName());
-
-    // Get symbol type
-    GenTypeVisitor genTypeVisitor(gen);
-    symbol.type->accept(genTypeVisitor);
-    auto* varType = genTypeVisitor.getType();
-
-    // Load value
-    llvm::Value* loadedValue = (symbol.isGlobal())
-                                   ? gen.builder.CreateLoad(varType, symbol.getGlobalMemPtr(), node.getRefName())
-                                   : gen.builder.CreateLoad(varType, symbol.getLocalMemPtr(), node.getRefName());
-
-    value = loadedValue;
+    value = gen.builder.CreateLoad(gen.lowerType(node.getSemaType()), gen.symbolStorage[node.getSymbolId()],
+                                   node.getRefName());
 }
 
 void CodeGenVisitor::visit(DeclArrayRefASTNode& node) {
-    // Validations
-    if (!gen.symbolTable.contains(node.getRefName()))
-        throw CodeGenException("Array identifier not found: " + node.getRefName());
-
-    const Symbol& symbol = gen.symbolTable.getSymbol(node.getRefName());
-
-    if (symbol.type->getType() != TypeASTNode::Type::ARRAY)
-        throw CodeGenException("Identifier is not an array: " + node.getRefName());
-
-    node.getIndexNode()->accept(*this);
-    auto* indexV = value;
-
-    if (!indexV)
-        throw CodeGenException("Array index value is not found: " + node.getRefName());
-
-    if (!indexV->getType()->isIntegerTy())
-        throw CodeGenException("Array index value is not an integer: " + node.getRefName());
-
-    // Safe cast, because we checked that it's an array
-    auto* arrType = dynamic_cast<const ArrayTypeASTNode*>(symbol.type);
-    auto* lowerBoundV = llvm::ConstantInt::get(llvm::Type::getInt32Ty(gen.ctx), arrType->getLowerBound());
-    auto* upperBoundV = llvm::ConstantInt::get(llvm::Type::getInt32Ty(gen.ctx), arrType->getUpperBound());
-
-    // Check if the index is within bounds
-    Utils::LLVM::generateIndexOutOfBoundsCheck(node.getRefName(), indexV, lowerBoundV, upperBoundV, gen);
-
-    // Handles non-zero based arrays
-    auto* adjustedIndexV = gen.builder.CreateSub(indexV, lowerBoundV, "adjustedIndex");
-    // Calculate the address of the element at the given index. Array access in LLVM IR is done using a zero index followed by the actual index
-    std::vector<llvm::Value*> indices = {gen.builder.getInt32(0), adjustedIndexV};
-
-    // Get array type and element type
-    GenTypeVisitor genTypeVisitor(gen);
-    symbol.type->accept(genTypeVisitor);
-    auto* llvmArrayType = genTypeVisitor.getType();
-    auto* llvmElementType = llvmArrayType->getArrayElementType();
-
-    llvm::Value* elementPtr =
-        (symbol.isGlobal())
-            ? gen.builder.CreateGEP(llvmArrayType, symbol.getGlobalMemPtr(), indices, node.getRefName() + "_idx")
-            : gen.builder.CreateGEP(llvmArrayType, symbol.getLocalMemPtr(), indices, node.getRefName() + "_idx");
-
-    llvm::Value* loadedValue = gen.builder.CreateLoad(llvmElementType, elementPtr, node.getRefName() + "_elem");
-
-    value = loadedValue;
+    value = gen.builder.CreateLoad(gen.lowerType(node.getSemaType()), StoreVisitor(gen).dispatch(node),
+                                   node.getRefName() + "_elem");
 }
 
 void CodeGenVisitor::visit(FunCallASTNode& node) {
-    auto* retVal = gen.funcHandler->handle(node.getFunName(), node.getArgNodes());
-    value = retVal;
+    try {
+        auto* retVal = gen.funcHandler->handle(gen.sema->getRoutine(node.getRoutineId()), node.getArgNodes());
+        value = retVal;
+    } catch (CodeGenException& e) {
+        // The handlers do not know the call node (e.g. 'readln' of a non-variable), errors of the arguments are
+        // already located
+        e.locate(node.getOffset());
+        throw;
+    }
 }
 
 void CodeGenVisitor::visit(BlockASTNode& node) {
@@ -258,26 +216,17 @@ void CodeGenVisitor::visit(BlockASTNode& node) {
         llvm::BasicBlock* EntryBlock = llvm::BasicBlock::Create(gen.ctx, "entry", funcMain);
         gen.builder.SetInsertPoint(EntryBlock);
 
-        // Find variable and constant declarations and set them as global
-        for (auto& s : node.getStatementNodes()) {
-            if (auto* declNode = dynamic_cast<DeclASTNode*>(s.get())) {
-                declNode->setGlobal(true);
-            }
-        }
-
-        // Find exit statements and set their return value to 0
-        llvm::Value* retV = llvm::ConstantInt::get(llvm::Type::getInt32Ty(gen.ctx), 0);
-        CollectorVisitor<ExitASTNode> exitNodesVisitor;
-        node.accept(exitNodesVisitor);
-        for (auto exitNode : exitNodesVisitor.collectedNodes) {
-            exitNode->setRetV(retV);
-        }
+        // Exit statements of the main block return 0
+        FunctionContext& context = functions.emplace_back();
+        context.exitCode = llvm::ConstantInt::get(llvm::Type::getInt32Ty(gen.ctx), 0);
 
         // Generate code for the block
         for (const auto& s : node.getStatementNodes()) {
             s->accept(*this);
         }
 
+        functions.pop_back();
+
         gen.builder.CreateRet(llvm::ConstantInt::get(llvm::Type::getInt32Ty(gen.ctx), 0));
     } else {
         // func is a pointer to the function that the current insertion block belongs to.
@@ -285,7 +234,7 @@ void CodeGenVisitor::visit(BlockASTNode& node) {
         auto func = gen.builder.GetInsertBlock()->getParent();
 
         if (!func)
-            throw CodeGenException("Parent function is not found");
+            throw CodeGenException("Parent function is not found", node.getOffset());
 
         llvm::BasicBlock* BB = llvm::BasicBlock::Create(gen.ctx, "block", func);
 
@@ -297,16 +246,12 @@ void CodeGenVisitor::visit(BlockASTNode& node) {
         // (new code will be inserted into 'BB' until the insertion point is changed again).
         gen.builder.SetInsertPoint(BB);
 
-        SymbolTable symbolTableCopy = gen.symbolTable;
-
+        // The declarations of the block go into the scope opened by the enclosing procedure/function, together with
+        // its parameters
         for (const auto& s : node.getStatementNodes()) {
             s->accept(*this);
         }
 
-        // Restore the original symbol table.
-        // This effectively undoes any changes to the symbol table made during the code generation of this block's statements.
-        gen.symbolTable = symbolTableCopy;
-
         // This is just code block (statements), not an expression.
         value = nullptr;
     }
@@ -316,7 +261,7 @@ void CodeGenVisitor::visit(CompoundStmtASTNode& node) {
     auto func = gen.builder.GetInsertBlock()->getParent();
 
     if (!func)
-        throw CodeGenException("Parent function is not found");
+        throw CodeGenException("Parent function is not found", node.getOffset());
 
     for (const auto& s : node.getStatementNodes()) {
         s->accept(*this);
@@ -326,22 +271,14 @@ void CodeGenVisitor::visit(CompoundStmtASTNode& node) {
 }
 
 void CodeGenVisitor::visit(VarDeclASTNode& node) {
-    if (gen.symbolTable.contains(node.getDeclName()))
-        throw CodeGenException("Variable is already declared: " + node.getDeclName());
-
-    // Get variable type
-    GenTypeVisitor genTypeVisitor(gen);
-    node.getTypeNode()->accept(genTypeVisitor);
-    auto* type = genTypeVisitor.getType();
+    auto* type = gen.lowerType(gen.sema->getSymbol(node.getSymbolId()).type);
 
     // Default value for initializing variable (0 for integers, 0.0 for reals)
     llvm::Constant* defaultV = getDefaultValueForType(type, gen.ctx);
 
     if (node.isGlobal()) {
-        auto* gVar = new llvm::GlobalVariable(gen.module, type, false, llvm::GlobalValue::ExternalLinkage, defaultV,
-                                              node.getDeclName());
-
-        gen.symbolTable.addSymbol(node.getDeclName(), {node.getDeclName(), node.getTypeNode().get(), gVar, false});
+        gen.symbolStorage[node.getSymbolId()] = new llvm::GlobalVariable(
+            gen.module, type, false, llvm::GlobalValue::ExternalLinkage, defaultV, node.getDeclName());
     } else {
         // CreateAlloca creates an allocation instruction in the IR.
         // This instruction allocated memory on the stack for the variable.
@@ -349,36 +286,19 @@ void CodeGenVisitor::visit(VarDeclASTNode& node) {
         auto* memPtr = gen.builder.CreateAlloca(type, nullptr, node.getDeclName());
         gen.builder.CreateStore(defaultV, memPtr);
 
-        gen.symbolTable.addSymbol(node.getDeclName(), {node.getDeclName(), node.getTypeNode().get(), memPtr, false});
+        gen.symbolStorage[node.getSymbolId()] = memPtr;
     }
 
     value = nullptr;
 }
 
 void CodeGenVisitor::visit(ArrayDeclASTNode& node) {
-    // Validations
-    if (gen.symbolTable.contains(node.getDeclName()))
-        throw CodeGenException("Array is already declared: " + node.getDeclName());
-
-    if (node.getTypeNode()->getLowerBound() > node.getTypeNode()->getUpperBound())
-        throw CodeGenException("Array lower bound is greater than upper bound: " + node.getDeclName());
-
-    if (node.getTypeNode()->getUpperBound() - node.getTypeNode()->getLowerBound() > 1000)
-        throw CodeGenException("Array size is too large: " + node.getDeclName());
-
-    if (node.getTypeNode()->getUpperBound() == node.getTypeNode()->getLowerBound())
-        throw CodeGenException("Array size should be at least 2: " + node.getDeclName());
-
-    // Get array type
-    GenTypeVisitor genTypeVisitor(gen);
-    node.getTypeNode()->accept(genTypeVisitor);
-    auto* arrayType = genTypeVisitor.getType();
+    auto* arrayType = gen.lowerType(gen.sema->getSymbol(node.getSymbolId()).type);
 
     if (node.isGlobal()) {
-        auto* gVar = new llvm::GlobalVariable(gen.module, arrayType, false, llvm::GlobalValue::ExternalLinkage,
-                                              llvm::ConstantAggregateZero::get(arrayType), node.getDeclName());
-
-        gen.symbolTable.addSymbol(node.getDeclName(), {node.getDeclName(), node.getTypeNode().get(), gVar, false});
+        gen.symbolStorage[node.getSymbolId()] =
+            new llvm::GlobalVariable(gen.module, arrayType, false, llvm::GlobalValue::ExternalLinkage,
+                                     llvm::ConstantAggregateZero::get(arrayType), node.getDeclName());
     } else {
         llvm::AllocaInst* store = gen.builder.CreateAlloca(arrayType, nullptr, node.getDeclName());
 
@@ -395,281 +315,166 @@ void CodeGenVisitor::visit(ArrayDeclASTNode& node) {
             gen.builder.CreateStore(defaultV, ptrToElem);
         }
 
-        gen.symbolTable.addSymbol(node.getDeclName(), {node.getDeclName(), node.getTypeNode().get(), store, false});
+        gen.symbolStorage[node.getSymbolId()] = store;
     }
 
     value = nullptr;
 }
 
 void CodeGenVisitor::visit(ConstDefASTNode& node) {
-    if (gen.symbolTable.contains(node.getDeclName()))
-        throw CodeGenException("Constant is already defined: " + node.getDeclName());
-
     node.getExprNode()->accept(*this);
     auto* exprV = value;
 
-    if (!exprV)
-        throw CodeGenException("Constant expression value is not found: " + node.getDeclName());
-
-    // Create type node for the constant by inferring type of the expression value
-    if (exprV->getType()->isDoubleTy())
-        node.setTypeNode(std::make_unique<PrimitiveTypeASTNode>(PrimitiveTypeASTNode::PrimitiveType::REAL));
-    else if (exprV->getType()->isIntegerTy())
-        node.setTypeNode(std::make_unique<PrimitiveTypeASTNode>(PrimitiveTypeASTNode::PrimitiveType::INTEGER));
-    else
-        throw CodeGenException("Unsupported constant type: " + node.getDeclName());
+    // The type of the constant is the one of its expression
+    auto* type = gen.lowerType(node.getExprNode()->getSemaType());
 
     if (node.isGlobal()) {
-        llvm::Constant* defaultV = getDefaultValueForType(exprV->getType(), gen.ctx);
+        llvm::Constant* defaultV = getDefaultValueForType(type, gen.ctx);
 
-        auto* gConst = new llvm::GlobalVariable(gen.module, defaultV->getType(), false,
-                                                llvm::GlobalValue::ExternalLinkage, defaultV, node.getDeclName());
+        auto* gConst = new llvm::GlobalVariable(gen.module, type, false, llvm::GlobalValue::ExternalLinkage, defaultV,
+                                                node.getDeclName());
 
         gen.builder.CreateStore(exprV, gConst);
-
-        gen.symbolTable.addSymbol(node.getDeclName(),
-                                  {node.getDeclName(), node.getTypeNode().value().get(), gConst, true});
+        gen.symbolStorage[node.getSymbolId()] = gConst;
     } else {
-        // Create an alloca instruction to store the constant in the symbol table
-        auto* store = gen.builder.CreateAlloca(exprV->getType(), nullptr, node.getDeclName());
+        // Create an alloca instruction to store the constant
+        auto* store = gen.builder.CreateAlloca(type, nullptr, node.getDeclName());
 
         // Store a value 'val' into a memory location 'store'
         gen.builder.CreateStore(exprV, store);
-
-        // Add the constant symbol to the symbol table
-        gen.symbolTable.addSymbol(node.getDeclName(),
-                                  {node.getDeclName(), node.getTypeNode().value().get(), store, true});
+        gen.symbolStorage[node.getSymbolId()] = store;
     }
 
     value = nullptr;
 }
 
-void CodeGenVisitor::visit(ProcDeclASTNode& node) {
-    // Check if this procedure has already been declared
-    auto* proc = gen.module.getFunction(node.getDeclName());
+/**
+ * @brief Returns the LLVM function of the procedure/function, declaring it on its first (forward) declaration
+ */
+static llvm::Function* getRoutineFunction(GenContext& gen, const DeclASTNode& node) {
+    llvm::Function*& function = gen.routineFunctions[node.getSymbolId()];
+    if (function)
+        return function;
 
-    if (proc) {
-        if (!node.getBlockNode().has_value())
-            throw CodeGenException("Redeclaration of procedure '" + node.getDeclName() + "'");
+    const Routine& routine = gen.sema->getRoutine(node.getSymbolId());
 
-        if (!proc->empty())
-            throw CodeGenException("Redefinition of procedure '" + node.getDeclName() + "'");
+    std::vector<llvm::Type*> paramTypes;
+    for (const auto* paramType : routine.paramTypes)
+        paramTypes.push_back(gen.lowerType(paramType));
 
-        if (proc->arg_size() != node.getParamNodes().size())
-            throw CodeGenException("Procedure '" + node.getDeclName() + "' expects " +
-                                   std::to_string(proc->arg_size()) + " arguments in declaration, but " +
-                                   std::to_string(node.getParamNodes().size()) + " were provided in definition");
+    auto* retType = routine.isFunction() ? gen.lowerType(routine.returnType) : llvm::Type::getVoidTy(gen.ctx);
 
-        for (auto& arg : proc->args()) {
-            GenTypeVisitor genTypeVisitor(gen);
-            node.getParamNodes()[arg.getArgNo()]->getTypeNode()->accept(genTypeVisitor);
-            auto* defArgType = genTypeVisitor.getType();
+    llvm::FunctionType* funcType = llvm::FunctionType::get(retType, paramTypes, false);
+    // ExternalLinkage means the function can be called from other modules, gen.module is the module where the function will be added.
+    function = llvm::Function::Create(funcType, llvm::Function::ExternalLinkage, node.getDeclName(), gen.module);
+    return function;
+}
 
-            if (arg.getType() != defArgType)
-                throw CodeGenException("Procedure '" + node.getDeclName() + "' expects argument $" +
-                                       std::to_string(arg.getArgNo()) + " to be of type provided in the declaration");
-        }
+/**
+ * @brief Allocates space for the parameters of the procedure/function and copies the argument values into it
+ */
+static void storeParams(GenContext& gen, llvm::Function* function, llvm::ArrayRef<VarDeclASTNode*> paramNodes) {
+    for (auto& arg : function->args()) {
+        VarDeclASTNode* paramNode = paramNodes[arg.getArgNo()];
+        arg.setName(paramNode->getDeclName());
 
-    } else {
-        // Procedure has not been declared yet, so declare it now
-
-        // Get procedure's parameters types
-        std::vector<llvm::Type*> paramTypes;
-        for (const auto& p : node.getParamNodes()) {
-            GenTypeVisitor genTypeVisitor(gen);
-            p->getTypeNode()->accept(genTypeVisitor);
-            paramTypes.push_back(genTypeVisitor.getType());
-        }
+        // Create an entry in the stack frame for this argument and store the argument's value in it
+        auto* store = gen.builder.CreateAlloca(arg.getType(), nullptr, arg.getName());
+        gen.builder.CreateStore(&arg, store);
+        gen.symbolStorage[paramNode->getSymbolId()] = store;
+    }
+}
 
-        // Create the procedure
-        llvm::FunctionType* funcType = llvm::FunctionType::get(llvm::Type::getVoidTy(gen.ctx), paramTypes, false);
-        // ExternalLinkage means the function can be called from other modules, gen.module is the module where the function will be added.
-        proc = llvm::Function::Create(funcType, llvm::Function::ExternalLinkage, node.getDeclName(), gen.module);
+void CodeGenVisitor::visit(ProcDeclASTNode& node) {
+    PhaseTimer timer("Function codegen", node.getDeclName());
 
-        // If it's just a forward declaration (no body), return
-        if (!node.getBlockNode().has_value()) {
-            value = nullptr;
-            return;
-        }
-    }
+    // Declarations and definitions were matched by the semantic analysis
+    auto* proc = getRoutineFunction(gen, node);
 
-    // At this point, procedure is either a new declaration or a forward declaration needing a body
+    // If it's just a forward declaration (no body), return
+    if (!node.getBlockNode().has_value()) {
+        value = nullptr;
+        return;
+    }
 
     // Save to restore it later
     auto* prevBB = gen.builder.GetInsertBlock();
-    auto symbolTableCopy = gen.symbolTable;
 
     // Set up the entry block for that new procedure
     llvm::BasicBlock* BB = llvm::BasicBlock::Create(gen.ctx, "entry", proc);
     gen.builder.SetInsertPoint(BB);
 
-    // Allocate space for procedure parameters and copy argument values into that allocated space
-    unsigned i = 0;
-    for (auto& arg : proc->args()) {
-        // Name the argument
-        arg.setName(node.getParamNodes()[i]->getDeclName());
+    storeParams(gen, proc, node.getParamNodes());
 
-        // Create an entry in the procedure's stack frame for this argument and store the argument's value in it
-        auto* store = gen.builder.CreateAlloca(arg.getType(), nullptr, arg.getName());
-        gen.builder.CreateStore(&arg, store);
-
-        gen.symbolTable.addSymbol(arg.getName().str(),
-                                  {arg.getName().str(), node.getParamNodes()[i]->getTypeNode().get(), store, false});
-        ++i;
-    }
-
-    // Find exit statements and set the return value to void
-    CollectorVisitor<ExitASTNode> exitNodesVisitor;
-    node.accept(exitNodesVisitor);
-    for (auto exitNode : exitNodesVisitor.collectedNodes) {
-        exitNode->setRetV(std::monostate{});
-    }
+    // Exit statements return void
+    functions.emplace_back();
 
     // Generate code for the procedure's block
     node.getBlockNode().value()->accept(*this);
 
+    functions.pop_back();
+
     // Set return void
     gen.builder.CreateRetVoid();
 
     //    llvm::verifyFunction(*proc, &llvm::errs()); // DEBUG
 
-    // Restore the previous insertion point and symbol table
+    // Restore the previous insertion point
     gen.builder.SetInsertPoint(prevBB);
-    gen.symbolTable = symbolTableCopy;
 
     value = nullptr;
 }
 
 void CodeGenVisitor::visit(FunDeclASTNode& node) {
-    auto* func = gen.module.getFunction(node.getDeclName());
+    PhaseTimer timer("Function codegen", node.getDeclName());
 
-    // Validations and function declaration
-    if (func) {
-        if (!node.getBlockNode().has_value())
-            throw CodeGenException("Redeclaration of function '" + node.getDeclName() + "'");
+    auto* func = getRoutineFunction(gen, node);
 
-        if (!func->empty())
-            throw CodeGenException("Redefinition of function '" + node.getDeclName() + "'");
-
-        if (func->arg_size() != node.getParamNodes().size())
-            throw CodeGenException("Function '" + node.getDeclName() + "' expects " + std::to_string(func->arg_size()) +
-                                   " arguments in declaration, but " + std::to_string(node.getParamNodes().size()) +
-                                   " were provided in definition");
-
-        for (auto& arg : func->args()) {
-            GenTypeVisitor genTypeVisitor(gen);
-            node.getParamNodes()[arg.getArgNo()]->getTypeNode()->accept(genTypeVisitor);
-            auto* defArgType = genTypeVisitor.getType();
-
-            if (arg.getType() != defArgType)
-                throw CodeGenException("Function '" + node.getDeclName() + "' expects argument $" +
-                                       std::to_string(arg.getArgNo()) + " to be of type provided in the declaration");
-        }
-    } else {
-        for (const auto& p : node.getParamNodes())
-            if (p->getDeclName() == node.getDeclName())
-                throw CodeGenException("Function parameter has the same name as the function itself: '" +
-                                       node.getDeclName() + "'");
-
-        std::vector<llvm::Type*> paramTypes;
-        for (const auto& p : node.getParamNodes()) {
-            GenTypeVisitor genTypeVisitor(gen);
-            p->getTypeNode()->accept(genTypeVisitor);
-            paramTypes.push_back(genTypeVisitor.getType());
-        }
-
-        GenTypeVisitor genTypeVisitor(gen);
-        node.getRetTypeNode()->accept(genTypeVisitor);
-        auto* retType = genTypeVisitor.getType();
-
-        llvm::FunctionType* funcType = llvm::FunctionType::get(retType, paramTypes, false);
-        func = llvm::Function::Create(funcType, llvm::Function::ExternalLinkage, node.getDeclName(), gen.module);
-
-        if (!node.getBlockNode().has_value()) {
-            value = nullptr;
-            return;
-        }
+    if (!node.getBlockNode().has_value()) {
+        value = nullptr;
+        return;
     }
 
-    // At this point, function is either a new declaration or a forward declaration needing a body, so proceed to the body
     auto prevBB = gen.builder.GetInsertBlock();
-    auto symbolTableCopy = gen.symbolTable;
 
     llvm::BasicBlock* BB = llvm::BasicBlock::Create(gen.ctx, "entry", func);
     gen.builder.SetInsertPoint(BB);
 
-    unsigned i = 0;
-    for (auto& arg : func->args()) {
-        arg.setName(node.getParamNodes()[i]->getDeclName());
-        auto* store = gen.builder.CreateAlloca(arg.getType(), nullptr, arg.getName());
-        gen.builder.CreateStore(&arg, store);
-        gen.symbolTable.addSymbol(arg.getName().str(),
-                                  {arg.getName().str(), node.getParamNodes()[i]->getTypeNode().get(), store, false});
-        ++i;
-    }
-
-    // Get function's return type
-    GenTypeVisitor genTypeVisitor(gen);
-    node.getRetTypeNode()->accept(genTypeVisitor);
-    auto* retType = genTypeVisitor.getType();
+    storeParams(gen, func, node.getParamNodes());
 
     // Create a variable that represents the function's return value. It has the name of the function
+    auto* retType = func->getReturnType();
     auto* retValStore = gen.builder.CreateAlloca(retType, nullptr, node.getDeclName());
     llvm::Constant* defaultV = getDefaultValueForType(retType, gen.ctx);
     gen.builder.CreateStore(defaultV, retValStore);
-    gen.symbolTable.addSymbol(node.getDeclName(),
-                              {node.getDeclName(), node.getRetTypeNode().get(), retValStore, false});
+    gen.symbolStorage[node.getResultSymbolId()] = retValStore;
 
-    // Load the return value from the variable that represents the function's return value
-    auto loadReturnV = [&]() {
-        auto* loadedReturnV = gen.builder.CreateLoad(retType, retValStore, node.getDeclName());
-        return loadedReturnV;
-    };
-
-    // Find exit statements and set the return value
-    CollectorVisitor<ExitASTNode> exitNodesVisitor;
-    node.getBlockNode().value()->accept(exitNodesVisitor);
-    for (auto exitNode : exitNodesVisitor.collectedNodes) {
-        exitNode->setRetV(loadReturnV);
-    }
+    // Exit statements return the value of that variable
+    functions.emplace_back().resultStore = retValStore;
 
     // Emit body code
     node.getBlockNode().value()->accept(*this);
 
-    gen.builder.CreateRet(loadReturnV());
+    functions.pop_back();
+
+    gen.builder.CreateRet(gen.builder.CreateLoad(retType, retValStore, node.getDeclName()));
 
     //    llvm::verifyFunction(*func, &llvm::errs()); // DEBUG
 
     gen.builder.SetInsertPoint(prevBB);
-    gen.symbolTable = symbolTableCopy;
 
     value = nullptr;
 }
 
 void CodeGenVisitor::visit(AssignASTNode& node) {
-    if (!gen.symbolTable.contains(node.getVarNode()->getRefName()))
-        throw CodeGenException("Variable not found: " + node.getVarNode()->getRefName());
-
-    if (gen.symbolTable.getSymbol(node.getVarNode()->getRefName()).immutable)
-        throw CodeGenException("Cannot assign to a constant: " + node.getVarNode()->getRefName());
-
     // Get memory location of the variable
-    StoreVisitor storeVisitor(gen);
-    node.getVarNode()->accept(storeVisitor);
-    auto* store = storeVisitor.getStore();
+    auto* store = StoreVisitor(gen).dispatch(*node.getVarNode());
 
     node.getExprNode()->accept(*this);
     auto* exprVal = value;
 
-    if (!exprVal)
-        throw CodeGenException("Assignment failed - expression value is not found");
-
-    if (exprVal->getType()->isDoubleTy() && store->getType()->getPointerElementType()->isIntegerTy())
-        throw CodeGenException("Assignment failed - cannot assign real value to an integer variable: " +
-                               node.getVarNode()->getRefName());
-
     // Handle implicit conversion int -> double
-    if (store->getType()->getPointerElementType()->isDoubleTy())
+    if (node.getVarNode()->getSemaType()->isReal() && node.getExprNode()->getSemaType()->isInteger())
         exprVal = gen.builder.CreateSIToFP(exprVal, llvm::Type::getDoubleTy(gen.ctx));
 
     gen.builder.CreateStore(exprVal, store);
@@ -681,36 +486,54 @@ void CodeGenVisitor::visit(IfASTNode& node) {
     auto* func = gen.builder.GetInsertBlock()->getParent();
 
     if (!func)
-        throw CodeGenException("Parent function is not found");
+        throw CodeGenException("Parent function is not found", node.getOffset());
 
-    llvm::BasicBlock* BBbody = llvm::BasicBlock::Create(gen.ctx, "body", func);
-    llvm::BasicBlock* BBelseBody = llvm::BasicBlock::Create(gen.ctx, "elseBody", func);
-    llvm::BasicBlock* BBafter = llvm::BasicBlock::Create(gen.ctx, "after", func);
+    // The branches of an 'else if' chain share the block after it, the chain is walked by a loop
+    llvm::BasicBlock* BBafter = llvm::BasicBlock::Create(gen.ctx, "after");
+    std::optional<StatementASTNode*> elseBodyNode;
 
-    node.getCondNode()->accept(*this);
-    auto* condVal = value;
-    gen.builder.CreateCondBr(condVal, BBbody, BBelseBody);
+    for (IfASTNode* ifNode = &node; ifNode;) {
+        llvm::BasicBlock* BBbody = llvm::BasicBlock::Create(gen.ctx, "body", func);
+        llvm::BasicBlock* BBelseBody = llvm::BasicBlock::Create(gen.ctx, "elseBody", func);
 
-    gen.builder.SetInsertPoint(BBbody);
-    node.getBodyNode()->accept(*this);
-    gen.builder.CreateBr(BBafter);
+        ifNode->getCondNode()->accept(*this);
+        auto* condVal = value;
+        gen.builder.CreateCondBr(condVal, BBbody, BBelseBody);
+
+        gen.builder.SetInsertPoint(BBbody);
+        ifNode->getBodyNode()->accept(*this);
+        gen.builder.CreateBr(BBafter);
 
-    gen.builder.SetInsertPoint(BBelseBody);
-    if (node.getElseBodyNode().has_value()) {
-        node.getElseBodyNode().value()->accept(*this);
+        gen.builder.SetInsertPoint(BBelseBody);
+        elseBodyNode = ifNode->getElseBodyNode();
+        ifNode = elseBodyNode.has_value() ? llvm::dyn_cast<IfASTNode>(elseBodyNode.value()) : nullptr;
     }
+
+    if (elseBodyNode.has_value())
+        elseBodyNode.value()->accept(*this);
     gen.builder.CreateBr(BBafter);
 
+    BBafter->insertInto(func);
     gen.builder.SetInsertPoint(BBafter);
 
     value = nullptr;
 }
 
+void CodeGenVisitor::generateLoopBody(StatementASTNode& bodyNode, llvm::BasicBlock* afterBB) {
+    if (functions.empty())
+        throw CodeGenException("Loop outside of a procedure/function", bodyNode.getOffset());
+
+    std::vector<llvm::BasicBlock*>& breakTargets = functions.back().breakTargets;
+    breakTargets.push_back(afterBB);
+    bodyNode.accept(*this);
+    breakTargets.pop_back();
+}
+
 void CodeGenVisitor::visit(WhileASTNode& node) {
     auto* func = gen.builder.GetInsertBlock()->getParent();
 
     if (!func)
-        throw CodeGenException("Parent function is not found");
+        throw CodeGenException("Parent function is not found", node.getOffset());
 
     llvm::BasicBlock* BBcond = llvm::BasicBlock::Create(gen.ctx, "cond", func);
     llvm::BasicBlock* BBbody = llvm::BasicBlock::Create(gen.ctx, "body", func);
@@ -725,13 +548,7 @@ void CodeGenVisitor::visit(WhileASTNode& node) {
 
     gen.builder.SetInsertPoint(BBbody);
 
-    // Find break statements and set their break block
-    CollectorVisitor<BreakASTNode> breakNodesVisitor;
-    node.getBodyNode()->accept(breakNodesVisitor);
-    for (auto breakNode : breakNodesVisitor.collectedNodes)
-        breakNode->setBreakBlock(BBafter);
-
-    node.getBodyNode()->accept(*this);
+    generateLoopBody(*node.getBodyNode(), BBafter);
 
     gen.builder.CreateBr(BBcond);
 
@@ -744,7 +561,7 @@ void CodeGenVisitor::visit(ForASTNode& node) {
     auto* func = gen.builder.GetInsertBlock()->getParent();
 
     if (!func)
-        throw CodeGenException("Parent function is not found");
+        throw CodeGenException("Parent function is not found", node.getOffset());
 
     llvm::BasicBlock* BBinit = llvm::BasicBlock::Create(gen.ctx, "init", func);
     llvm::BasicBlock* BBcond = llvm::BasicBlock::Create(gen.ctx, "cond", func);
@@ -761,9 +578,7 @@ void CodeGenVisitor::visit(ForASTNode& node) {
     // Emit code for the condition block
     gen.builder.SetInsertPoint(BBcond);
     // Get memory location of the variable
-    StoreVisitor storeVisitor(gen);
-    node.getInitNode()->getVarNode()->accept(storeVisitor);
-    auto* fromStore = storeVisitor.getStore();
+    auto* fromStore = StoreVisitor(gen).dispatch(*node.getInitNode()->getVarNode());
     auto fromVal = [&]() {
         node.getInitNode()->getVarNode()->accept(*this);
         return value;
@@ -776,13 +591,7 @@ void CodeGenVisitor::visit(ForASTNode& node) {
 
     // Generate code for the body block
     gen.builder.SetInsertPoint(BBbody);
-    // Find break statements and set their break block
-    CollectorVisitor<BreakASTNode> breakNodesVisitor;
-    node.getBodyNode()->accept(breakNodesVisitor);
-    for (auto breakNode : breakNodesVisitor.collectedNodes)
-        breakNode->setBreakBlock(BBafter);
-
-    node.getBodyNode()->accept(*this);
+    generateLoopBody(*node.getBodyNode(), BBafter);
 
     auto* incrementedVal = gen.builder.CreateAdd(fromVal(), gen.builder.getInt32(node.isIncreasing() ? 1 : -1));
     gen.builder.CreateStore(incrementedVal, fromStore);
@@ -794,7 +603,12 @@ void CodeGenVisitor::visit(ForASTNode& node) {
 }
 
 void CodeGenVisitor::visit(ProcCallASTNode& node) {
-    gen.funcHandler->handle(node.getProcName(), node.getArgNodes());
+    try {
+        gen.funcHandler->handle(gen.sema->getRoutine(node.getRoutineId()), node.getArgNodes());
+    } catch (CodeGenException& e) {
+        e.locate(node.getOffset());
+        throw;
+    }
 }
 
 void CodeGenVisitor::visit([[maybe_unused]] EmptyStmtASTNode& node) {
@@ -807,13 +621,14 @@ void CodeGenVisitor::visit(ProgramASTNode& node) {
     value = nullptr;
 }
 
-void CodeGenVisitor::visit(BreakASTNode& node) {
-    if (!node.getBreakBlock()) {
+void CodeGenVisitor::visit([[maybe_unused]] BreakASTNode& node) {
+    // A break outside of a loop does nothing
+    if (functions.empty() || functions.back().breakTargets.empty()) {
         value = nullptr;
         return;
     }
 
-    gen.builder.CreateBr(node.getBreakBlock());
+    gen.builder.CreateBr(functions.back().breakTargets.back());
 
     auto* func = gen.builder.GetInsertBlock()->getParent();
     llvm::BasicBlock* afterBreakBlock = llvm::BasicBlock::Create(gen.ctx, "afterBreak", func);
@@ -823,13 +638,17 @@ void CodeGenVisitor::visit(BreakASTNode& node) {
 }
 
 void CodeGenVisitor::visit(ExitASTNode& node) {
-    if (std::holds_alternative<std::monostate>(node.getRetV()))
-        gen.builder.CreateRetVoid();
-    else if (std::holds_alternative<llvm::Value*>(node.getRetV()))
-        gen.builder.CreateRet(std::get<llvm::Value*>(node.getRetV()));
+    if (functions.empty())
+        throw CodeGenException("Exit statement outside of a procedure/function", node.getOffset());
+
+    const FunctionContext& context = functions.back();
+    if (context.resultStore)
+        gen.builder.CreateRet(gen.builder.CreateLoad(context.resultStore->getAllocatedType(), context.resultStore,
+                                                     context.resultStore->getName()));
+    else if (context.exitCode)
+        gen.builder.CreateRet(context.exitCode);
     else
-        gen.builder.CreateRet(std::get<std::function<llvm::LoadInst*()>>(
-            node.getRetV())());  // calls load instruction which returns ret value
+        gen.builder.CreateRetVoid();
 
     // Any emitted LLVM IR code after the exit statement is unreachable and will be removed by the optimizer.
     auto* func = gen.builder.GetInsertBlock()->getParent();
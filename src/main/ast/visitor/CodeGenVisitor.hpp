@@ -10,6 +10,42 @@ class CodeGenVisitor : public ASTNodeVisitor {
     GenContext& gen;
     llvm::Value* value = nullptr;
 
+    /**
+     * @brief Procedure/function (or main block) being generated, tells 'exit' and 'break' where to go
+     */
+    struct FunctionContext {
+        /**
+         * @brief Variable holding the result of a function, loaded and returned by 'exit'
+         */
+        llvm::AllocaInst* resultStore = nullptr;
+
+        /**
+         * @brief Returned by 'exit' from the main block (its exit code)
+         */
+        llvm::Value* exitCode = nullptr;
+
+        /**
+         * @brief Blocks after the enclosing loops, innermost last
+         */
+        std::vector<llvm::BasicBlock*> breakTargets;
+    };
+
+    /**
+     * @brief Innermost last, maintained during the single traversal instead of sweeping the bodies for exit/break
+     */
+    std::vector<FunctionContext> functions;
+
+    /**
+     * @brief Generates the loop body with 'afterBB' as the target of its breaks
+     */
+    void generateLoopBody(StatementASTNode& bodyNode, llvm::BasicBlock* afterBB);
+
+    /**
+     * @brief Generates the operator over the values of its (already generated) operands into 'value'
+     */
+    void generateBinOp(BinOpASTNode& node, llvm::Value* lhsV, llvm::Value* rhsV);
+    void generateUnaryOp(UnaryOpASTNode& node, llvm::Value* exprV);
+
    public:
     explicit CodeGenVisitor(GenContext& gen);
 
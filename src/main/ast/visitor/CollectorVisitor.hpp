@@ -1,142 +1,165 @@
 #pragma once
-#include <type_traits>
+#include <cstddef>
 #include <vector>
-#include "ASTNodeVisitor.hpp"
+#include "llvm/ADT/SmallVector.h"
+#include "StaticVisitor.hpp"
 
 /**
- * @brief Visitor that collects all nodes of type T
+ * @brief Visitor that collects all nodes of type T (also an abstract one, e.g. ExprASTNode), start with 'dispatch'
  */
 template <typename T>
-class CollectorVisitor : public ASTNodeVisitor {
+class CollectorVisitor : public StaticVisitor<CollectorVisitor<T>> {
    public:
     std::vector<T*> collectedNodes;
 
-    template <typename N>
-    void tryAddNode(N* node) {
-        if constexpr (std::is_same_v<N*, T*>) {
-            collectedNodes.push_back(static_cast<T*>(node));
-        }
+    /**
+     * @brief Number of nodes the traversal went through (for '--stats')
+     */
+    size_t visitedNodes = 0;
+
+    void tryAddNode(ASTNode* node) {
+        ++visitedNodes;
+        if (llvm::isa<T>(node))
+            collectedNodes.push_back(llvm::cast<T>(node));
     }
 
-    void visit(PrimitiveTypeASTNode& node) override { tryAddNode(&node); }
+    void visit(PrimitiveTypeASTNode& node) { tryAddNode(&node); }
 
-    void visit(ArrayTypeASTNode& node) override {
+    void visit(ArrayTypeASTNode& node) {
         tryAddNode(&node);
-        node.getElemTypeNode()->accept(*this);
+        this->dispatch(*node.getElemTypeNode());
     }
 
-    void visit(BinOpASTNode& node) override {
+    void visit(BinOpASTNode& node) {
+        // Operator chains ('a + b + c ...', '- - a') and 'else if' chains are walked by loops, they are as deep as they
+        // are long
+        llvm::SmallVector<BinOpASTNode*, 8> spine{&node};
         tryAddNode(&node);
-        node.getLhsExprNode()->accept(*this);
-        node.getRhsExprNode()->accept(*this);
+        while (auto* lhsNode = llvm::dyn_cast<BinOpASTNode>(spine.back()->getLhsExprNode())) {
+            spine.push_back(lhsNode);
+            tryAddNode(lhsNode);
+        }
+
+        this->dispatch(*spine.back()->getLhsExprNode());
+        for (auto it = spine.rbegin(); it != spine.rend(); ++it)
+            this->dispatch(*(*it)->getRhsExprNode());
     }
 
-    void visit(UnaryOpASTNode& node) override {
-        tryAddNode(&node);
-        node.getExprNode()->accept(*this);
+    void visit(UnaryOpASTNode& node) {
+        UnaryOpASTNode* unaryNode = &node;
+        tryAddNode(unaryNode);
+        while (auto* exprNode = llvm::dyn_cast<UnaryOpASTNode>(unaryNode->getExprNode())) {
+            unaryNode = exprNode;
+            tryAddNode(unaryNode);
+        }
+        this->dispatch(*unaryNode->getExprNode());
     }
 
-    void visit(LiteralASTNode& node) override { tryAddNode(&node); }
+    void visit(LiteralASTNode& node) { tryAddNode(&node); }
 
-    void visit(DeclVarRefASTNode& node) override { tryAddNode(&node); }
+    void visit(DeclVarRefASTNode& node) { tryAddNode(&node); }
 
-    void visit(DeclArrayRefASTNode& node) override {
+    void visit(DeclArrayRefASTNode& node) {
         tryAddNode(&node);
-        node.getIndexNode()->accept(*this);
+        this->dispatch(*node.getIndexNode());
     }
 
-    void visit(FunCallASTNode& node) override {
+    void visit(FunCallASTNode& node) {
         tryAddNode(&node);
         for (auto& arg : node.getArgNodes())
-            arg->accept(*this);
+            this->dispatch(*arg);
     }
 
-    void visit(BlockASTNode& node) override {
+    void visit(BlockASTNode& node) {
         tryAddNode(&node);
         for (auto& arg : node.getStatementNodes())
-            arg->accept(*this);
+            this->dispatch(*arg);
     }
 
-    void visit(CompoundStmtASTNode& node) override {
+    void visit(CompoundStmtASTNode& node) {
         tryAddNode(&node);
         for (auto& arg : node.getStatementNodes())
-            arg->accept(*this);
+            this->dispatch(*arg);
     }
 
-    void visit(VarDeclASTNode& node) override {
+    void visit(VarDeclASTNode& node) {
         tryAddNode(&node);
-        node.getTypeNode()->accept(*this);
+        this->dispatch(*node.getTypeNode());
     }
 
-    void visit(ArrayDeclASTNode& node) override {
+    void visit(ArrayDeclASTNode& node) {
         tryAddNode(&node);
-        node.getTypeNode()->accept(*this);
+        this->dispatch(*node.getTypeNode());
     }
 
-    void visit(ConstDefASTNode& node) override {
+    void visit(ConstDefASTNode& node) {
         tryAddNode(&node);
-        if (node.getTypeNode().has_value())
-            node.getTypeNode().value()->accept(*this);
+        this->dispatch(*node.getExprNode());
     }
 
-    void visit(ProcDeclASTNode& node) override {
+    void visit(ProcDeclASTNode& node) {
         tryAddNode(&node);
         for (auto& arg : node.getParamNodes())
-            arg->accept(*this);
+            this->dispatch(*arg);
         if (node.getBlockNode().has_value())
-            node.getBlockNode().value()->accept(*this);
+            this->dispatch(*node.getBlockNode().value());
     }
 
-    void visit(FunDeclASTNode& node) override {
+    void visit(FunDeclASTNode& node) {
         tryAddNode(&node);
         for (auto& arg : node.getParamNodes())
-            arg->accept(*this);
+            this->dispatch(*arg);
         if (node.getBlockNode().has_value())
-            node.getBlockNode().value()->accept(*this);
-        node.getRetTypeNode()->accept(*this);
+            this->dispatch(*node.getBlockNode().value());
+        this->dispatch(*node.getRetTypeNode());
     }
 
-    void visit(AssignASTNode& node) override {
+    void visit(AssignASTNode& node) {
         tryAddNode(&node);
-        node.getExprNode()->accept(*this);
-        node.getVarNode()->accept(*this);
+        this->dispatch(*node.getExprNode());
+        this->dispatch(*node.getVarNode());
     }
 
-    void visit(IfASTNode& node) override {
-        tryAddNode(&node);
-        node.getCondNode()->accept(*this);
-        node.getBodyNode()->accept(*this);
-        if (node.getElseBodyNode().has_value())
-            node.getElseBodyNode().value()->accept(*this);
+    void visit(IfASTNode& node) {
+        for (IfASTNode* ifNode = &node; ifNode;) {
+            tryAddNode(ifNode);
+            this->dispatch(*ifNode->getCondNode());
+            this->dispatch(*ifNode->getBodyNode());
+
+            const std::optional<StatementASTNode*>& elseBodyNode = ifNode->getElseBodyNode();
+            ifNode = elseBodyNode.has_value() ? llvm::dyn_cast<IfASTNode>(elseBodyNode.value()) : nullptr;
+            if (elseBodyNode.has_value() && !ifNode)
+                this->dispatch(*elseBodyNode.value());
+        }
     }
 
-    void visit(WhileASTNode& node) override {
+    void visit(WhileASTNode& node) {
         tryAddNode(&node);
-        node.getBodyNode()->accept(*this);
-        node.getCondNode()->accept(*this);
+        this->dispatch(*node.getBodyNode());
+        this->dispatch(*node.getCondNode());
     }
 
-    void visit(ForASTNode& node) override {
+    void visit(ForASTNode& node) {
         tryAddNode(&node);
-        node.getBodyNode()->accept(*this);
-        node.getInitNode()->accept(*this);
-        node.getToNode()->accept(*this);
+        this->dispatch(*node.getBodyNode());
+        this->dispatch(*node.getInitNode());
+        this->dispatch(*node.getToNode());
     }
 
-    void visit(ProcCallASTNode& node) override {
+    void visit(ProcCallASTNode& node) {
         tryAddNode(&node);
         for (auto& arg : node.getArgNodes())
-            arg->accept(*this);
+            this->dispatch(*arg);
     }
 
-    void visit(EmptyStmtASTNode& node) override { tryAddNode(&node); }
+    void visit(EmptyStmtASTNode& node) { tryAddNode(&node); }
 
-    void visit(ProgramASTNode& node) override {
+    void visit(ProgramASTNode& node) {
         tryAddNode(&node);
-        node.getBlockNode()->accept(*this);
+        this->dispatch(*node.getBlockNode());
     }
 
-    void visit(BreakASTNode& node) override { tryAddNode(&node); }
+    void visit(BreakASTNode& node) { tryAddNode(&node); }
 
-    void visit(ExitASTNode& node) override { tryAddNode(&node); }
+    void visit(ExitASTNode& node) { tryAddNode(&node); }
 };
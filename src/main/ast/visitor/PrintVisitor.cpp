@@ -114,9 +114,6 @@ void PrintVisitor::visit(ArrayDeclASTNode& node) {
 void PrintVisitor::visit(ConstDefASTNode& node) {
     MKINDENT;
     os << "ConstDef " << node.getDeclName() << "\n";
-    indent++;
-    if (node.getTypeNode().has_value()) node.getTypeNode().value()->accept(*this);
-    indent--;
 }
 
 void PrintVisitor::visit(ProcDeclASTNode& node) {
@@ -0,0 +1,504 @@
+#include "SemaVisitor.hpp"
+#include "ast/CodeGenerator.hpp"
+
+SemaVisitor::SemaVisitor(SemaContext& sema) : sema(sema) {
+    for (RoutineId id = 0; id < sema.getNumRoutines(); ++id)
+        routines[sema.getRoutine(id).name] = id;
+}
+
+void SemaVisitor::analyze(ASTNode& node) {
+    node.accept(*this);
+}
+
+/**
+ * @brief Spelling of the operator in diagnostics
+ */
+static const char* spelling(TokenType op) {
+    switch (op) {
+        case TokenType::PLUS:
+            return "+";
+        case TokenType::MINUS:
+            return "-";
+        case TokenType::MULTIPLY:
+            return "*";
+        case TokenType::DIVIDE:
+            return "/";
+        case TokenType::DIV:
+            return "div";
+        case TokenType::MOD:
+            return "mod";
+        case TokenType::EQUAL:
+            return "=";
+        case TokenType::NOT_EQUAL:
+            return "<>";
+        case TokenType::LESS:
+            return "<";
+        case TokenType::LESS_EQUAL:
+            return "<=";
+        case TokenType::GREATER:
+            return ">";
+        case TokenType::GREATER_EQUAL:
+            return ">=";
+        case TokenType::AND:
+            return "and";
+        case TokenType::OR:
+            return "or";
+        case TokenType::NOT:
+            return "not";
+        default:
+            return "?";
+    }
+}
+
+/**
+ * @brief Type name with an indefinite article, e.g. "an integer"
+ */
+static std::string withArticle(const SemaType* type) {
+    return (type->isInteger() || type->isArray() ? "an " : "a ") + type->toString();
+}
+
+const SemaType* SemaVisitor::resolveType(TypeASTNode& node) {
+    node.accept(*this);
+    return type;
+}
+
+const SemaType* SemaVisitor::analyzeExpr(ExprASTNode& node) {
+    node.accept(*this);
+    node.setSemaType(type);
+    return type;
+}
+
+DeclId SemaVisitor::declare(DeclASTNode& node, const SemaType* symbolType, bool immutable) {
+    DeclId id = sema.addSymbol({node.getDeclName(), symbolType, immutable, global});
+    symbols.addSymbol(node.getDeclName(), id);
+    node.setSymbolId(id);
+    node.setGlobal(global);
+    return id;
+}
+
+void SemaVisitor::visit(PrimitiveTypeASTNode& node) {
+    switch (node.getPrimitiveType()) {
+        case PrimitiveTypeASTNode::PrimitiveType::INTEGER:
+            type = sema.getIntegerType();
+            break;
+        case PrimitiveTypeASTNode::PrimitiveType::REAL:
+            type = sema.getRealType();
+            break;
+        default:
+            throw CodeGenException("Unknown Primitive type", node.getOffset());
+    }
+}
+
+void SemaVisitor::visit(ArrayTypeASTNode& node) {
+    const SemaType* elementType = resolveType(*node.getElemTypeNode());
+    type = sema.getArrayType(elementType, node.getLowerBound(), node.getUpperBound());
+}
+
+void SemaVisitor::visit(BinOpASTNode& node) {
+    // A chain 'a + b + c ...' is a left spine as deep as it is long, it is walked by a loop instead of recursion
+    llvm::SmallVector<BinOpASTNode*, 8> spine{&node};
+    while (auto* lhsNode = llvm::dyn_cast<BinOpASTNode>(spine.back()->getLhsExprNode()))
+        spine.push_back(lhsNode);
+
+    const SemaType* lhsType = analyzeExpr(*spine.back()->getLhsExprNode());
+    for (auto it = spine.rbegin(); it != spine.rend(); ++it) {
+        analyzeBinOp(**it, lhsType, analyzeExpr(*(*it)->getRhsExprNode()));
+        (*it)->setSemaType(type);
+        lhsType = type;
+    }
+}
+
+void SemaVisitor::analyzeBinOp(BinOpASTNode& node, const SemaType* lhsType, const SemaType* rhsType) {
+    const TokenType op = node.getOp().getType();
+
+    auto mismatch = [&]() {
+        return CodeGenException("Operator '" + std::string(spelling(op)) + "' cannot be applied to " +
+                                    lhsType->toString() + " and " + rhsType->toString(),
+                                node.getOffset());
+    };
+
+    bool numeric = lhsType->isNumeric() && rhsType->isNumeric();
+    bool dblArith = lhsType->isReal() || rhsType->isReal();
+
+    switch (op) {
+        case TokenType::PLUS:
+        case TokenType::MINUS:
+        case TokenType::MULTIPLY:
+        case TokenType::DIV:
+        case TokenType::DIVIDE:
+        case TokenType::MOD:
+            if (!numeric)
+                throw mismatch();
+            type = dblArith ? sema.getRealType() : sema.getIntegerType();
+            break;
+        case TokenType::EQUAL:
+        case TokenType::NOT_EQUAL:
+        case TokenType::LESS:
+        case TokenType::LESS_EQUAL:
+        case TokenType::GREATER:
+        case TokenType::GREATER_EQUAL:
+            // Comparisons of comparisons are fine too, e.g. '(a < b) = (c < d)'
+            if (!numeric && !(lhsType->isBoolean() && rhsType->isBoolean()))
+                throw mismatch();
+            type = sema.getBooleanType();
+            break;
+        case TokenType::AND:
+        case TokenType::OR:
+            // Bitwise on integers, logical on booleans
+            if (dblArith)
+                throw CodeGenException(std::string("Unsupported logical ") + (op == TokenType::AND ? "AND" : "OR") +
+                                           " operation for real type",
+                                       node.getOffset());
+            if (lhsType != rhsType || lhsType->isArray())
+                throw mismatch();
+            type = lhsType;
+            break;
+        default:
+            throw CodeGenException("Unknown binary operator", node.getOffset());
+    }
+}
+
+void SemaVisitor::visit(UnaryOpASTNode& node) {
+    // A run of unary operators is walked by a loop as well, from the innermost one
+    llvm::SmallVector<UnaryOpASTNode*, 4> run{&node};
+    while (auto* exprNode = llvm::dyn_cast<UnaryOpASTNode>(run.back()->getExprNode()))
+        run.push_back(exprNode);
+
+    const SemaType* exprType = analyzeExpr(*run.back()->getExprNode());
+    for (auto it = run.rbegin(); it != run.rend(); ++it) {
+        analyzeUnaryOp(**it, exprType);
+        (*it)->setSemaType(type);
+        exprType = type;
+    }
+}
+
+void SemaVisitor::analyzeUnaryOp(UnaryOpASTNode& node, const SemaType* exprType) {
+    switch (node.getOp().getType()) {
+        case TokenType::MINUS:
+            if (!exprType->isNumeric())
+                throw CodeGenException("Unsupported negation of " + exprType->toString() + " type", node.getOffset());
+            type = exprType;
+            break;
+        case TokenType::NOT:
+            // Flips the lowest bit of integers, like the logical operators over integers are bitwise
+            if (exprType->isReal())
+                throw CodeGenException("Unsupported NOT operation for real type", node.getOffset());
+            type = exprType;
+            break;
+        default:
+            throw CodeGenException("Unknown unary operator", node.getOffset());
+    }
+}
+
+void SemaVisitor::visit(LiteralASTNode& node) {
+    TokenValue tokenValue = node.getValue();
+
+    if (std::holds_alternative<int>(tokenValue))
+        type = sema.getIntegerType();
+    else if (std::holds_alternative<double>(tokenValue))
+        type = sema.getRealType();
+    else
+        throw CodeGenException("Unknown literal type", node.getOffset());
+}
+
+void SemaVisitor::visit(DeclVarRefASTNode& node) {
+    std::optional<DeclId> id = symbols.lookup(node.getRefName());
+    if (!id)
+        throw CodeGenException("Variable/Constant not found: " + node.getRefName(), node.getOffset());
+
+    const Symbol& symbol = sema.getSymbol(*id);
+    if (symbol.type->isArray())
+        throw CodeGenException("Array is used without an index: " + node.getRefName(), node.getOffset());
+
+    node.setSymbolId(*id);
+    type = symbol.type;
+}
+
+void SemaVisitor::visit(DeclArrayRefASTNode& node) {
+    std::optional<DeclId> id = symbols.lookup(node.getRefName());
+    if (!id)
+        throw CodeGenException("Array identifier not found: " + node.getRefName(), node.getOffset());
+
+    const Symbol& symbol = sema.getSymbol(*id);
+    if (!symbol.type->isArray())
+        throw CodeGenException("Identifier is not an array: " + node.getRefName(), node.getOffset());
+
+    if (!analyzeExpr(*node.getIndexNode())->isInteger())
+        throw CodeGenException("Array index value is not an integer: " + node.getRefName(), node.getOffset());
+
+    node.setSymbolId(*id);
+    type = symbol.type->getElementType();
+}
+
+const Routine& SemaVisitor::analyzeCall(const std::string& name, llvm::ArrayRef<ExprASTNode*> argNodes,
+                                        uint32_t offset) {
+    auto it = routines.find(name);
+    if (it == routines.end())
+        throw CodeGenException("Function/Procedure not found: " + name, offset);
+
+    const Routine& routine = sema.getRoutine(it->second);
+
+    if (routine.builtin != Builtin::NONE) {
+        const std::string kind = routine.isFunction() ? "function" : "procedure";
+        if (argNodes.size() != 1)
+            throw CodeGenException("'" + name + "' " + kind + " expects 1 argument, but " +
+                                       std::to_string(argNodes.size()) + " were provided",
+                                   offset);
+
+        if (!analyzeExpr(*argNodes[0])->isNumeric())
+            throw CodeGenException("Unsupported argument type for '" + name + "' " + kind, offset);
+
+        if (routine.builtin == Builtin::READLN) {
+            auto* declRefNode = llvm::dyn_cast<DeclRefASTNode>(argNodes[0]);
+            if (!declRefNode)
+                throw CodeGenException("'readln' procedure failed, argument is not a variable", offset);
+            if (sema.getSymbol(declRefNode->getSymbolId()).immutable)
+                throw CodeGenException("Cannot read into a constant: " + declRefNode->getRefName(), offset);
+        }
+
+        return routine;
+    }
+
+    if (routine.paramTypes.size() != argNodes.size())
+        throw CodeGenException("Function/Procedure " + name + " expects " + std::to_string(routine.paramTypes.size()) +
+                                   " arguments, but " + std::to_string(argNodes.size()) + " were provided",
+                               offset);
+
+    for (size_t i = 0; i < argNodes.size(); ++i) {
+        const SemaType* argType = analyzeExpr(*argNodes[i]);
+        const SemaType* paramType = routine.paramTypes[i];
+
+        // Integer arguments are converted to real parameters
+        if (argType != paramType && !(paramType->isReal() && argType->isInteger()))
+            throw CodeGenException("Function/Procedure " + name + " expects argument $" + std::to_string(i) +
+                                       " of type " + paramType->toString() + ", but " + argType->toString() +
+                                       " was provided",
+                                   argNodes[i]->getOffset());
+    }
+
+    return routine;
+}
+
+void SemaVisitor::visit(FunCallASTNode& node) {
+    const Routine& routine = analyzeCall(node.getFunName(), node.getArgNodes(), node.getOffset());
+
+    if (!routine.isFunction())
+        throw CodeGenException("Procedure '" + node.getFunName() + "' does not return a value", node.getOffset());
+
+    node.setRoutineId(routine.id);
+    type = routine.returnType;
+}
+
+void SemaVisitor::visit(BlockASTNode& node) {
+    // The declarations of a procedure/function body go into the scope opened by the procedure/function itself,
+    // together with its parameters
+    for (const auto& s : node.getStatementNodes())
+        s->accept(*this);
+}
+
+void SemaVisitor::visit(CompoundStmtASTNode& node) {
+    for (const auto& s : node.getStatementNodes())
+        s->accept(*this);
+}
+
+void SemaVisitor::visit(VarDeclASTNode& node) {
+    if (symbols.containsInScope(node.getDeclName()))
+        throw CodeGenException("Variable is already declared: " + node.getDeclName(), node.getOffset());
+
+    declare(node, resolveType(*node.getTypeNode()), false);
+}
+
+void SemaVisitor::visit(ArrayDeclASTNode& node) {
+    if (symbols.containsInScope(node.getDeclName()))
+        throw CodeGenException("Array is already declared: " + node.getDeclName(), node.getOffset());
+
+    if (node.getTypeNode()->getLowerBound() > node.getTypeNode()->getUpperBound())
+        throw CodeGenException("Array lower bound is greater than upper bound: " + node.getDeclName(),
+                               node.getOffset());
+
+    if (node.getTypeNode()->getUpperBound() - node.getTypeNode()->getLowerBound() > 1000)
+        throw CodeGenException("Array size is too large: " + node.getDeclName(), node.getOffset());
+
+    if (node.getTypeNode()->getUpperBound() == node.getTypeNode()->getLowerBound())
+        throw CodeGenException("Array size should be at least 2: " + node.getDeclName(), node.getOffset());
+
+    declare(node, resolveType(*node.getTypeNode()), false);
+}
+
+void SemaVisitor::visit(ConstDefASTNode& node) {
+    if (symbols.containsInScope(node.getDeclName()))
+        throw CodeGenException("Constant is already defined: " + node.getDeclName(), node.getOffset());
+
+    const SemaType* exprType = analyzeExpr(*node.getExprNode());
+    if (!exprType->isNumeric())
+        throw CodeGenException("Unsupported constant type: " + node.getDeclName(), node.getOffset());
+
+    declare(node, exprType, true);
+}
+
+Routine& SemaVisitor::declareRoutine(DeclASTNode& node, llvm::ArrayRef<VarDeclASTNode*> paramNodes,
+                                     const std::optional<BlockASTNode*>& optBlockNode, const SemaType* returnType) {
+    const std::string& name = node.getDeclName();
+    const std::string kind = returnType ? "function" : "procedure";
+    const std::string Kind = returnType ? "Function" : "Procedure";
+
+    std::vector<const SemaType*> paramTypes;
+    for (const auto& p : paramNodes)
+        paramTypes.push_back(resolveType(*p->getTypeNode()));
+
+    auto [it, inserted] = routines.try_emplace(name, 0);
+    if (inserted) {
+        it->second = sema.addRoutine({0, name, Builtin::NONE, returnType, std::move(paramTypes), false});
+    } else {
+        Routine& declared = sema.getRoutine(it->second);
+
+        if (!optBlockNode.has_value() || declared.builtin != Builtin::NONE ||
+            declared.isFunction() != (returnType != nullptr))
+            throw CodeGenException("Redeclaration of " + kind + " '" + name + "'", node.getOffset());
+
+        if (declared.defined)
+            throw CodeGenException("Redefinition of " + kind + " '" + name + "'", node.getOffset());
+
+        if (declared.paramTypes.size() != paramTypes.size())
+            throw CodeGenException(Kind + " '" + name + "' expects " + std::to_string(declared.paramTypes.size()) +
+                                       " arguments in declaration, but " + std::to_string(paramTypes.size()) +
+                                       " were provided in definition",
+                                   node.getOffset());
+
+        for (size_t i = 0; i < paramTypes.size(); ++i) {
+            if (declared.paramTypes[i] != paramTypes[i])
+                throw CodeGenException(Kind + " '" + name + "' expects argument $" + std::to_string(i) +
+                                           " to be of type provided in the declaration",
+                                       node.getOffset());
+        }
+
+        if (declared.returnType != returnType)
+            throw CodeGenException(Kind + " '" + name + "' expects the return type provided in the declaration",
+                                   node.getOffset());
+    }
+
+    Routine& routine = sema.getRoutine(it->second);
+    routine.defined = optBlockNode.has_value();
+    node.setSymbolId(routine.id);
+    return routine;
+}
+
+void SemaVisitor::visit(ProcDeclASTNode& node) {
+    declareRoutine(node, node.getParamNodes(), node.getBlockNode(), nullptr);
+    if (!node.getBlockNode().has_value())
+        return;
+
+    // Parameters and locals live in a scope of their own, which may shadow globals
+    SymbolTable::Scope scope(symbols);
+    bool wasGlobal = std::exchange(global, false);
+
+    for (const auto& p : node.getParamNodes())
+        p->accept(*this);
+
+    node.getBlockNode().value()->accept(*this);
+
+    global = wasGlobal;
+}
+
+void SemaVisitor::visit(FunDeclASTNode& node) {
+    for (const auto& p : node.getParamNodes())
+        if (p->getDeclName() == node.getDeclName())
+            throw CodeGenException("Function parameter has the same name as the function itself: '" +
+                                       node.getDeclName() + "'",
+                                   node.getOffset());
+
+    const Routine& routine =
+        declareRoutine(node, node.getParamNodes(), node.getBlockNode(), resolveType(*node.getRetTypeNode()));
+    if (!node.getBlockNode().has_value())
+        return;
+
+    SymbolTable::Scope scope(symbols);
+    bool wasGlobal = std::exchange(global, false);
+
+    for (const auto& p : node.getParamNodes())
+        p->accept(*this);
+
+    // The result is assigned to a variable of the function's name
+    DeclId resultId = sema.addSymbol({node.getDeclName(), routine.returnType, false, false});
+    symbols.addSymbol(node.getDeclName(), resultId);
+    node.setResultSymbolId(resultId);
+
+    node.getBlockNode().value()->accept(*this);
+
+    global = wasGlobal;
+}
+
+void SemaVisitor::visit(AssignASTNode& node) {
+    DeclRefASTNode* varNode = node.getVarNode();
+
+    std::optional<DeclId> id = symbols.lookup(varNode->getRefName());
+    if (!id)
+        throw CodeGenException("Variable not found: " + varNode->getRefName(), varNode->getOffset());
+
+    if (sema.getSymbol(*id).immutable)
+        throw CodeGenException("Cannot assign to a constant: " + varNode->getRefName(), varNode->getOffset());
+
+    const SemaType* varType = analyzeExpr(*varNode);
+    const SemaType* exprType = analyzeExpr(*node.getExprNode());
+
+    // Integers are converted to reals
+    if (varType != exprType && !(varType->isReal() && exprType->isInteger()))
+        throw CodeGenException("Assignment failed - cannot assign " + exprType->toString() + " value to " +
+                                   withArticle(varType) + " variable: " + varNode->getRefName(),
+                               node.getOffset());
+}
+
+void SemaVisitor::visit(IfASTNode& node) {
+    // Each 'else if' is nested in the else branch of the previous one, the chain is walked by a loop
+    for (IfASTNode* ifNode = &node; ifNode;) {
+        if (!analyzeExpr(*ifNode->getCondNode())->isBoolean())
+            throw CodeGenException("Condition must be a boolean expression", ifNode->getCondNode()->getOffset());
+
+        ifNode->getBodyNode()->accept(*this);
+
+        const std::optional<StatementASTNode*>& elseBodyNode = ifNode->getElseBodyNode();
+        ifNode = elseBodyNode.has_value() ? llvm::dyn_cast<IfASTNode>(elseBodyNode.value()) : nullptr;
+        if (elseBodyNode.has_value() && !ifNode)
+            elseBodyNode.value()->accept(*this);
+    }
+}
+
+void SemaVisitor::visit(WhileASTNode& node) {
+    if (!analyzeExpr(*node.getCondNode())->isBoolean())
+        throw CodeGenException("Condition must be a boolean expression", node.getCondNode()->getOffset());
+
+    node.getBodyNode()->accept(*this);
+}
+
+void SemaVisitor::visit(ForASTNode& node) {
+    node.getInitNode()->accept(*this);
+
+    DeclRefASTNode* varNode = node.getInitNode()->getVarNode();
+    if (!varNode->getSemaType()->isInteger())
+        throw CodeGenException("Loop variable must be an integer: " + varNode->getRefName(), varNode->getOffset());
+
+    if (!analyzeExpr(*node.getToNode())->isInteger())
+        throw CodeGenException("Loop bound must be an integer", node.getToNode()->getOffset());
+
+    node.getBodyNode()->accept(*this);
+}
+
+void SemaVisitor::visit(ProcCallASTNode& node) {
+    // Functions may be called as procedures, the result is discarded
+    const Routine& routine = analyzeCall(node.getProcName(), node.getArgNodes(), node.getOffset());
+    node.setRoutineId(routine.id);
+}
+
+void SemaVisitor::visit([[maybe_unused]] EmptyStmtASTNode& node) {}
+
+void SemaVisitor::visit(ProgramASTNode& node) {
+    node.getBlockNode()->setMain(true);
+
+    bool wasGlobal = std::exchange(global, true);
+    node.getBlockNode()->accept(*this);
+    global = wasGlobal;
+}
+
+void SemaVisitor::visit([[maybe_unused]] BreakASTNode& node) {}
+
+void SemaVisitor::visit([[maybe_unused]] ExitASTNode& node) {}
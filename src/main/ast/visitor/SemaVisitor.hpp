@@ -0,0 +1,84 @@
+#pragma once
+#include "ASTNodeVisitor.hpp"
+#include "ast/SemaContext.hpp"
+
+/**
+ * @brief Semantic analysis: binds every reference and call to its symbol or routine and every expression to its type
+ * @note Runs once before codegen, which then only reads the bindings off the nodes. Errors (unknown names, type
+ * mismatches, ...) are reported as CodeGenException located at the offending node.
+ */
+class SemaVisitor : public ASTNodeVisitor {
+   private:
+    SemaContext& sema;
+    SymbolTable symbols;
+    llvm::StringMap<RoutineId> routines;
+
+    /**
+     * @brief Type of the last visited expression or type node
+     */
+    const SemaType* type = nullptr;
+
+    /**
+     * @brief Declarations of the main block are global
+     */
+    bool global = false;
+
+    const SemaType* resolveType(TypeASTNode& node);
+    const SemaType* analyzeExpr(ExprASTNode& node);
+
+    /**
+     * @brief Checks the operator against the types of its (already analyzed) operands and sets the type of the result
+     */
+    void analyzeBinOp(BinOpASTNode& node, const SemaType* lhsType, const SemaType* rhsType);
+    void analyzeUnaryOp(UnaryOpASTNode& node, const SemaType* exprType);
+
+    /**
+     * @brief Declares a variable, parameter or constant in the innermost scope
+     */
+    DeclId declare(DeclASTNode& node, const SemaType* symbolType, bool immutable);
+
+    /**
+     * @brief Resolves the routine and checks the arguments of a procedure or function call
+     */
+    const Routine& analyzeCall(const std::string& name, llvm::ArrayRef<ExprASTNode*> argNodes, uint32_t offset);
+
+    /**
+     * @brief Registers the procedure/function or matches it against its forward declaration
+     * @param returnType nullptr for procedures
+     */
+    Routine& declareRoutine(DeclASTNode& node, llvm::ArrayRef<VarDeclASTNode*> paramNodes,
+                            const std::optional<BlockASTNode*>& optBlockNode, const SemaType* returnType);
+
+   public:
+    explicit SemaVisitor(SemaContext& sema);
+
+    /**
+     * @brief Analyzes the program (or any other node), binding its nodes to the types, symbols and routines of 'sema'
+     */
+    void analyze(ASTNode& node);
+
+    void visit(PrimitiveTypeASTNode& node) override;
+    void visit(ArrayTypeASTNode& node) override;
+    void visit(BinOpASTNode& node) override;
+    void visit(UnaryOpASTNode& node) override;
+    void visit(LiteralASTNode& node) override;
+    void visit(DeclVarRefASTNode& node) override;
+    void visit(DeclArrayRefASTNode& node) override;
+    void visit(FunCallASTNode& node) override;
+    void visit(BlockASTNode& node) override;
+    void visit(CompoundStmtASTNode& node) override;
+    void visit(VarDeclASTNode& node) override;
+    void visit(ArrayDeclASTNode& node) override;
+    void visit(ConstDefASTNode& node) override;
+    void visit(ProcDeclASTNode& node) override;
+    void visit(FunDeclASTNode& node) override;
+    void visit(AssignASTNode& node) override;
+    void visit(IfASTNode& node) override;
+    void visit(WhileASTNode& node) override;
+    void visit(ForASTNode& node) override;
+    void visit(ProcCallASTNode& node) override;
+    void visit(EmptyStmtASTNode& node) override;
+    void visit(ProgramASTNode& node) override;
+    void visit(BreakASTNode& node) override;
+    void visit(ExitASTNode& node) override;
+};
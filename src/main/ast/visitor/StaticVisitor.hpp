@@ -0,0 +1,73 @@
+#pragma once
+#include "ast/AST.hpp"
+
+/**
+ * @brief Visitor base dispatching on the kind of the node at compile time (CRTP), without virtual calls
+ * @note 'dispatch' calls the 'visit' overload of Derived that best matches the concrete class of the node, so an
+ * overload for an abstract class (e.g. visit(ExprASTNode&)) handles all of its subclasses without an own overload.
+ * Nodes Derived has no overload for fall back to visit(ASTNode&), which does nothing unless Derived declares its own
+ * (or brings this one into scope with 'using StaticVisitor::visit').
+ * @tparam Derived The visitor itself
+ * @tparam RetTy Result of the visits, default constructed by the fallback
+ */
+template <typename Derived, typename RetTy = void>
+class StaticVisitor {
+   public:
+    RetTy dispatch(ASTNode& node) {
+        auto& derived = static_cast<Derived&>(*this);
+
+        switch (node.getKind()) {
+            case ASTNode::Kind::PRIMITIVE_TYPE:
+                return derived.visit(llvm::cast<PrimitiveTypeASTNode>(node));
+            case ASTNode::Kind::ARRAY_TYPE:
+                return derived.visit(llvm::cast<ArrayTypeASTNode>(node));
+            case ASTNode::Kind::BIN_OP:
+                return derived.visit(llvm::cast<BinOpASTNode>(node));
+            case ASTNode::Kind::UNARY_OP:
+                return derived.visit(llvm::cast<UnaryOpASTNode>(node));
+            case ASTNode::Kind::LITERAL:
+                return derived.visit(llvm::cast<LiteralASTNode>(node));
+            case ASTNode::Kind::DECL_VAR_REF:
+                return derived.visit(llvm::cast<DeclVarRefASTNode>(node));
+            case ASTNode::Kind::DECL_ARRAY_REF:
+                return derived.visit(llvm::cast<DeclArrayRefASTNode>(node));
+            case ASTNode::Kind::FUN_CALL:
+                return derived.visit(llvm::cast<FunCallASTNode>(node));
+            case ASTNode::Kind::BLOCK:
+                return derived.visit(llvm::cast<BlockASTNode>(node));
+            case ASTNode::Kind::COMPOUND_STMT:
+                return derived.visit(llvm::cast<CompoundStmtASTNode>(node));
+            case ASTNode::Kind::VAR_DECL:
+                return derived.visit(llvm::cast<VarDeclASTNode>(node));
+            case ASTNode::Kind::ARRAY_DECL:
+                return derived.visit(llvm::cast<ArrayDeclASTNode>(node));
+            case ASTNode::Kind::CONST_DEF:
+                return derived.visit(llvm::cast<ConstDefASTNode>(node));
+            case ASTNode::Kind::PROC_DECL:
+                return derived.visit(llvm::cast<ProcDeclASTNode>(node));
+            case ASTNode::Kind::FUN_DECL:
+                return derived.visit(llvm::cast<FunDeclASTNode>(node));
+            case ASTNode::Kind::ASSIGN:
+                return derived.visit(llvm::cast<AssignASTNode>(node));
+            case ASTNode::Kind::IF:
+                return derived.visit(llvm::cast<IfASTNode>(node));
+            case ASTNode::Kind::WHILE:
+                return derived.visit(llvm::cast<WhileASTNode>(node));
+            case ASTNode::Kind::FOR:
+                return derived.visit(llvm::cast<ForASTNode>(node));
+            case ASTNode::Kind::PROC_CALL:
+                return derived.visit(llvm::cast<ProcCallASTNode>(node));
+            case ASTNode::Kind::EMPTY_STMT:
+                return derived.visit(llvm::cast<EmptyStmtASTNode>(node));
+            case ASTNode::Kind::BREAK:
+                return derived.visit(llvm::cast<BreakASTNode>(node));
+            case ASTNode::Kind::EXIT:
+                return derived.visit(llvm::cast<ExitASTNode>(node));
+            case ASTNode::Kind::PROGRAM:
+                return derived.visit(llvm::cast<ProgramASTNode>(node));
+        }
+        llvm_unreachable("Unknown AST node kind");
+    }
+
+    RetTy visit([[maybe_unused]] ASTNode& node) { return RetTy(); }
+};
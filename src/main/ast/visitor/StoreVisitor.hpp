@@ -1,29 +1,28 @@
 #pragma once
-#include "DefaultVisitor.hpp"
+#include "StaticVisitor.hpp"
 #include "ast/CodeGenerator.hpp"
 
 /**
- * @brief Visitor for getting pointer to the allocated memory
- * @note ! Only for nodes that represent values in memory
+ * @brief Visitor for getting pointer to the allocated memory, dispatch returns the pointer
+ * @note ! Only for nodes that represent values in memory, others throw
  */
-class StoreVisitor : public DefaultVisitor {
+class StoreVisitor : public StaticVisitor<StoreVisitor, llvm::Value*> {
    private:
     GenContext& gen;
 
-    /**
-     * @brief The pointer to the allocated memory of variable (of declaration reference generally)
-     */
-    llvm::Value* store = nullptr;
-
    public:
     explicit StoreVisitor(GenContext& gen);
 
-    [[nodiscard]] llvm::Value* getStore() const;
-
-    void visit(DeclVarRefASTNode& node) override;
+    /**
+     * @return The pointer to the allocated memory of variable (of declaration reference generally)
+     */
+    llvm::Value* visit(DeclVarRefASTNode& node);
 
     /**
-     * @note 'store' would be not be of llvm::AllocaInst* type, because elements within an array are not individually allocated with 'alloca'
+     * @note The pointer would be not be of llvm::AllocaInst* type, because elements within an array are not
+     * individually allocated with 'alloca'
      */
-    void visit(DeclArrayRefASTNode& node) override;
+    llvm::Value* visit(DeclArrayRefASTNode& node);
+
+    llvm::Value* visit(ASTNode& node);
 };
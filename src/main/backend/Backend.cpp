@@ -0,0 +1,301 @@
+#include "Backend.hpp"
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FileUtilities.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "utils/PhaseTimer.hpp"
+
+// Both are set by CMake: the runtime archive built from external/io.c and the C compiler driver used to link against it
+#ifndef MILA_RUNTIME_LIB
+#define MILA_RUNTIME_LIB "libmila_runtime.a"
+#endif
+
+#ifndef MILA_LINKER
+#define MILA_LINKER "cc"
+#endif
+
+void Backend::initializeNativeTarget() {
+    static std::once_flag initFlag;
+    std::call_once(initFlag, []() {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+        llvm::InitializeNativeTargetAsmParser();
+    });
+}
+
+static llvm::CodeGenOpt::Level toCodeGenOptLevel(OptLevel level) {
+    switch (level) {
+        case OptLevel::O0:
+            return llvm::CodeGenOpt::None;
+        case OptLevel::O1:
+            return llvm::CodeGenOpt::Less;
+        case OptLevel::O3:
+            return llvm::CodeGenOpt::Aggressive;
+        default:
+            return llvm::CodeGenOpt::Default;
+    }
+}
+
+Backend::Backend(OptLevel optLevel) {
+    initializeNativeTarget();
+
+    std::string triple = llvm::sys::getProcessTriple();
+    std::string error;
+    const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple, error);
+    if (!target)
+        throw BackendException("Failed to lookup target '" + triple + "': " + error);
+
+    // Position independent code, so that the result can be linked into a PIE executable (former 'llc -relocation-model=pic')
+    targetMachine.reset(target->createTargetMachine(triple, "generic", "", llvm::TargetOptions(), llvm::Reloc::PIC_,
+                                                    llvm::None, toCodeGenOptLevel(optLevel)));
+    if (!targetMachine)
+        throw BackendException("Failed to create target machine for '" + triple + "'");
+}
+
+void Backend::configureModule(llvm::Module& module) const {
+    module.setTargetTriple(targetMachine->getTargetTriple().str());
+    module.setDataLayout(targetMachine->createDataLayout());
+}
+
+void Backend::emit(llvm::Module& module, llvm::raw_pwrite_stream& os) const {
+    PhaseTimer timer("Emission");
+
+    llvm::legacy::PassManager passManager;
+    if (targetMachine->addPassesToEmitFile(passManager, os, nullptr, llvm::CGFT_ObjectFile))
+        throw BackendException("Target machine cannot emit object files");
+
+    passManager.run(module);
+}
+
+void Backend::emitObject(llvm::Module& module, llvm::SmallVectorImpl<char>& objBuffer) const {
+    llvm::raw_svector_ostream os(objBuffer);
+    emit(module, os);
+}
+
+void Backend::emitObject(llvm::Module& module, const std::string& objFile) const {
+    std::error_code EC;
+    llvm::raw_fd_ostream os(objFile, EC, llvm::sys::fs::OF_None);
+
+    if (EC)
+        throw BackendException("Failed to open file: " + objFile);
+
+    emit(module, os);
+    os.flush();
+
+    if (os.has_error())
+        throw BackendException("Failed to write object file: " + objFile);
+}
+
+namespace {
+
+/**
+ * @brief Linker command line of the driver, the object and the output file are substituted per link
+ */
+struct DirectLinkCommand {
+    std::string linker;
+    std::vector<std::string> args;
+    size_t objArg = 0;
+    size_t outArg = 0;
+};
+
+}  // namespace
+
+/**
+ * @brief Set once by Backend::enableDirectLink, null while the links go through the driver
+ */
+static std::atomic<const DirectLinkCommand*> directLinkCommand{nullptr};
+
+/**
+ * @brief Splits a command line printed by '-###', arguments may be quoted (with backslash escapes inside the quotes)
+ */
+static std::vector<std::string> splitCommandLine(llvm::StringRef line) {
+    std::vector<std::string> args;
+    size_t i = 0;
+    while (i < line.size()) {
+        if (line[i] == ' ') {
+            ++i;
+            continue;
+        }
+
+        std::string arg;
+        if (line[i] == '"') {
+            for (++i; i < line.size() && line[i] != '"'; ++i) {
+                if (line[i] == '\\' && i + 1 < line.size())
+                    ++i;
+                arg += line[i];
+            }
+            ++i;
+        } else {
+            for (; i < line.size() && line[i] != ' '; ++i)
+                arg += line[i];
+        }
+        args.push_back(std::move(arg));
+    }
+    return args;
+}
+
+/**
+ * @brief Asks the driver for the linker command line of an executable ('-###' prints the commands without running
+ * them) and keeps the linker part
+ */
+static std::optional<DirectLinkCommand> resolveDirectLinkCommand(const std::string& driver) {
+    static constexpr llvm::StringLiteral objPlaceholder = "mila-link-object.o";
+    static constexpr llvm::StringLiteral outPlaceholder = "mila-link-output";
+
+    // gold links an executable in about half the time of the default BFD linker
+    auto gold = llvm::sys::findProgramByName("ld.gold");
+    llvm::SmallVector<llvm::StringRef, 10> driverArgs = {driver, "-###", objPlaceholder, MILA_RUNTIME_LIB, "-lm",
+                                                         "-o", outPlaceholder};
+    if (gold)
+        driverArgs.push_back("-fuse-ld=gold");
+
+    llvm::SmallString<128> commandsFile;
+    if (llvm::sys::fs::createTemporaryFile("mila-link", "txt", commandsFile))
+        return std::nullopt;
+    llvm::FileRemover commandsFileRemover(commandsFile);
+
+    llvm::Optional<llvm::StringRef> redirects[] = {llvm::None, llvm::StringRef(commandsFile),
+                                                   llvm::StringRef(commandsFile)};
+    if (llvm::sys::ExecuteAndWait(driver, driverArgs, llvm::None, redirects) != 0)
+        return std::nullopt;
+
+    auto commands = llvm::MemoryBuffer::getFile(commandsFile);
+    if (!commands)
+        return std::nullopt;
+
+    // The last command mentioning the object is the linker: the driver's own helper (collect2 of GCC, which only
+    // forwards to the linker) or the linker itself (Clang)
+    std::vector<std::string> args;
+    llvm::SmallVector<llvm::StringRef, 16> lines;
+    (*commands)->getBuffer().split(lines, '\n');
+    for (llvm::StringRef line : lines) {
+        if (line.contains(objPlaceholder))
+            args = splitCommandLine(line);
+    }
+    if (args.empty())
+        return std::nullopt;
+
+    DirectLinkCommand command;
+    if (llvm::sys::path::filename(args.front()).startswith("collect2")) {
+        auto linker = gold ? gold : llvm::sys::findProgramByName("ld");
+        if (!linker)
+            return std::nullopt;
+        command.linker = *linker;
+    } else {
+        command.linker = args.front();
+    }
+
+    // The LTO plugin arguments of collect2 refer to temporary files of the driver run, the objects are native anyway
+    command.args.push_back(command.linker);
+    bool objFound = false, outFound = false;
+    for (size_t i = 1; i < args.size(); ++i) {
+        llvm::StringRef arg = args[i];
+        if (arg == "-plugin") {
+            ++i;
+            continue;
+        }
+        if (arg.startswith("-plugin-opt=") || arg.startswith("-fuse-ld="))
+            continue;
+
+        if (arg == objPlaceholder) {
+            command.objArg = command.args.size();
+            objFound = true;
+        } else if (arg == outPlaceholder) {
+            command.outArg = command.args.size();
+            outFound = true;
+        }
+        command.args.push_back(args[i]);
+    }
+    if (!objFound || !outFound)
+        return std::nullopt;
+
+    return command;
+}
+
+bool Backend::enableDirectLink() {
+    static std::once_flag resolveFlag;
+    std::call_once(resolveFlag, []() {
+        auto driver = llvm::sys::findProgramByName(MILA_LINKER);
+        if (!driver)
+            return;
+
+        if (auto command = resolveDirectLinkCommand(*driver))
+            directLinkCommand = new DirectLinkCommand(std::move(*command));  // kept for the lifetime of the process
+    });
+
+    return directLinkCommand != nullptr;
+}
+
+void Backend::link(const std::string& objFile, const std::string& outFile) const {
+    PhaseTimer timer("Linking");
+
+    std::string errMsg;
+    if (const DirectLinkCommand* command = directLinkCommand) {
+        llvm::SmallVector<llvm::StringRef, 64> args(command->args.begin(), command->args.end());
+        args[command->objArg] = objFile;
+        args[command->outArg] = outFile;
+
+        // A failure of the direct link is retried through the driver, which reports its own error
+        if (llvm::sys::ExecuteAndWait(command->linker, args, llvm::None, {}, 0, 0, &errMsg) == 0)
+            return;
+        errMsg.clear();
+    }
+
+    auto linker = llvm::sys::findProgramByName(MILA_LINKER);
+    if (!linker)
+        throw BackendException(std::string("Linker not found: ") + MILA_LINKER);
+
+    // 'fmod' (real 'mod') lives in libm
+    llvm::SmallVector<llvm::StringRef, 8> args = {*linker, objFile, MILA_RUNTIME_LIB, "-lm", "-o", outFile};
+
+    int exitCode = llvm::sys::ExecuteAndWait(*linker, args, llvm::None, {}, 0, 0, &errMsg);
+
+    if (exitCode != 0)
+        throw BackendException("Linking failed with exit code " + std::to_string(exitCode) +
+                               (errMsg.empty() ? "" : ": " + errMsg));
+}
+
+void Backend::compile(llvm::Module& module, const std::string& outFile) const {
+    int fd;
+    llvm::SmallString<128> objFile;
+    if (llvm::sys::fs::createTemporaryFile("mila", "o", fd, objFile))
+        throw BackendException("Failed to create temporary object file");
+
+    // Removes the temporary object file when going out of scope
+    llvm::FileRemover objFileRemover(objFile);
+
+    {
+        llvm::raw_fd_ostream os(fd, /*shouldClose*/ true);
+        emit(module, os);
+        os.flush();
+
+        if (os.has_error())
+            throw BackendException("Failed to write object file: " + objFile.str().str());
+    }
+
+    link(objFile.str().str(), outFile);
+}
+
+const llvm::TargetMachine& Backend::getTargetMachine() const {
+    return *targetMachine;
+}
+
+llvm::TargetMachine& Backend::getTargetMachine() {
+    return *targetMachine;
+}
+
+BackendException::BackendException(std::string msg) : message(std::move(msg)) {}
+
+const char* BackendException::what() const noexcept {
+    return message.c_str();
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+#include <memory>
+#include <string>
+#include "ast/CodeGenerator.hpp"
+
+/**
+ * @brief In-process native backend: LLVM module -> object file -> executable
+ * @note Replaces the former 'llc' + 'clang' pipeline. The only child process spawned is the final linker (through the
+ * driver, or directly after 'enableDirectLink').
+ */
+class Backend {
+   private:
+    std::unique_ptr<llvm::TargetMachine> targetMachine;
+
+    void emit(llvm::Module& module, llvm::raw_pwrite_stream& os) const;
+
+   public:
+    /**
+     * @brief Initializes the native target (once per process) and creates a target machine for the host triple
+     * @param optLevel Selects the matching code generator optimization level (instruction selection, scheduling, ...)
+     */
+    explicit Backend(OptLevel optLevel = OptLevel::O0);
+
+    /**
+     * @brief Sets the target triple and data layout of the module, should be called before code generation
+     */
+    void configureModule(llvm::Module& module) const;
+
+    /**
+     * @brief Emits native object code of the module into the memory buffer
+     */
+    void emitObject(llvm::Module& module, llvm::SmallVectorImpl<char>& objBuffer) const;
+
+    /**
+     * @brief Emits native object code of the module into the file 'objFile'
+     */
+    void emitObject(llvm::Module& module, const std::string& objFile) const;
+
+    /**
+     * @brief Links the object file against the prebuilt Mila runtime into the executable 'outFile'
+     */
+    void link(const std::string& objFile, const std::string& outFile) const;
+
+    /**
+     * @brief Emits the module to a temporary object file (outside the working directory) and links it to 'outFile'
+     */
+    void compile(llvm::Module& module, const std::string& outFile) const;
+
+    [[nodiscard]] const llvm::TargetMachine& getTargetMachine() const;
+
+    /**
+     * @brief Registers the native target, its asm printer and parser with LLVM, safe to be called repeatedly
+     */
+    static void initializeNativeTarget();
+
+    /**
+     * @brief Resolves the command line the driver runs the linker with (once per process, preferring gold if it is
+     * installed), 'link' then spawns the linker directly instead of the driver and its helpers (cc, collect2, ld)
+     * @returns False if the command line could not be resolved, 'link' keeps using the driver then
+     * @note Costs a run of the driver, pays off in a process linking many executables (the compile server)
+     */
+    static bool enableDirectLink();
+
+    [[nodiscard]] llvm::TargetMachine& getTargetMachine();
+};
+
+class BackendException : public std::exception {
+   private:
+    std::string message;
+
+   public:
+    explicit BackendException(std::string msg);
+
+    [[nodiscard]] const char* what() const noexcept override;
+};
@@ -0,0 +1,97 @@
+#include "JIT.hpp"
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <cstdio>
+#include <thread>
+#include "Backend.hpp"
+
+// Prefixed copy of the runtime (external/io.c built with MILA_RUNTIME_PREFIX) linked into the compiler
+extern "C" {
+int mila_rt_write_int(int x);
+int mila_rt_write_double(double x);
+int mila_rt_writeln_int(int x);
+int mila_rt_writeln_double(double x);
+int mila_rt_readln_int(int* x);
+int mila_rt_readln_double(double* x);
+int mila_rt_error(char* s);
+}
+
+template <typename T>
+static std::string toErrorString(llvm::Expected<T>& expected) {
+    return llvm::toString(expected.takeError());
+}
+
+JIT::JIT(unsigned compileThreads) {
+    Backend::initializeNativeTarget();
+
+    auto lazyJIT = llvm::orc::LLLazyJITBuilder().setNumCompileThreads(compileThreads).create();
+    if (!lazyJIT)
+        throw JITException("Failed to create the JIT: " + toErrorString(lazyJIT));
+
+    jit = std::move(*lazyJIT);
+    defineRuntimeSymbols();
+}
+
+void JIT::defineRuntimeSymbols() {
+    auto symbol = [](auto* address) {
+        return llvm::JITEvaluatedSymbol(llvm::pointerToJITTargetAddress(address), llvm::JITSymbolFlags::Exported);
+    };
+
+    // Defined symbols take precedence over the generator below, so 'error' never resolves to the glibc one
+    llvm::orc::JITDylib& mainDylib = jit->getMainJITDylib();
+    llvm::Error err = mainDylib.define(llvm::orc::absoluteSymbols({
+        {jit->mangleAndIntern("write_int"), symbol(&mila_rt_write_int)},
+        {jit->mangleAndIntern("write_double"), symbol(&mila_rt_write_double)},
+        {jit->mangleAndIntern("writeln_int"), symbol(&mila_rt_writeln_int)},
+        {jit->mangleAndIntern("writeln_double"), symbol(&mila_rt_writeln_double)},
+        {jit->mangleAndIntern("readln_int"), symbol(&mila_rt_readln_int)},
+        {jit->mangleAndIntern("readln_double"), symbol(&mila_rt_readln_double)},
+        {jit->mangleAndIntern("error"), symbol(&mila_rt_error)},
+    }));
+    if (err)
+        throw JITException("Failed to define runtime symbols: " + llvm::toString(std::move(err)));
+
+    // Anything else (e.g. 'fmod' emitted for real 'mod') comes from the libraries loaded into the compiler process
+    auto processSymbols =
+        llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(jit->getDataLayout().getGlobalPrefix());
+    if (!processSymbols)
+        throw JITException("Failed to expose process symbols: " + toErrorString(processSymbols));
+
+    mainDylib.addGenerator(std::move(*processSymbols));
+}
+
+void JIT::configureModule(llvm::Module& module) const {
+    module.setTargetTriple(jit->getTargetTriple().str());
+    module.setDataLayout(jit->getDataLayout());
+}
+
+void JIT::addModule(GenContext& gen) {
+    auto [ctx, module] = gen.release();
+    llvm::orc::ThreadSafeModule threadSafeModule(std::move(module), std::move(ctx));
+
+    if (llvm::Error err = jit->addLazyIRModule(std::move(threadSafeModule)))
+        throw JITException("Failed to add module: " + llvm::toString(std::move(err)));
+}
+
+int JIT::runMain() {
+    auto mainSymbol = jit->lookup("main");
+    if (!mainSymbol)
+        throw JITException("Failed to look up 'main': " + toErrorString(mainSymbol));
+
+    auto* mainFn = llvm::jitTargetAddressToFunction<int (*)()>(mainSymbol->getAddress());
+    int exitCode = mainFn();
+
+    // The runtime writes through C stdio, flush it before the compiler prints anything else
+    std::fflush(stdout);
+
+    return exitCode;
+}
+
+unsigned JIT::defaultCompileThreads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+JITException::JITException(std::string msg) : message(std::move(msg)) {}
+
+const char* JITException::what() const noexcept {
+    return message.c_str();
+}
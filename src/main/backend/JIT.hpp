@@ -0,0 +1,53 @@
+#pragma once
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <memory>
+#include <string>
+#include "ast/CodeGenerator.hpp"
+
+/**
+ * @brief In-process execution of Mila programs on the LLVM ORC lazy JIT
+ * @note Functions and procedures are compiled on their first call (on background compile threads), so that
+ * programs with mostly cold procedures start without compiling them. Runtime builtins are resolved to the copy of
+ * the runtime linked into the compiler.
+ */
+class JIT {
+   private:
+    std::unique_ptr<llvm::orc::LLLazyJIT> jit;
+
+    void defineRuntimeSymbols();
+
+   public:
+    /**
+     * @brief Initializes the native target (once per process) and creates the lazy JIT for the host
+     * @param compileThreads Number of background compile threads, 0 compiles on the calling thread
+     */
+    explicit JIT(unsigned compileThreads = defaultCompileThreads());
+
+    /**
+     * @brief Sets the target triple and data layout of the module, should be called before code generation
+     */
+    void configureModule(llvm::Module& module) const;
+
+    /**
+     * @brief Hands the module of 'gen' over to the JIT, 'gen' must not be used afterwards
+     * @note Nothing is compiled yet, each function is compiled when it is called for the first time
+     */
+    void addModule(GenContext& gen);
+
+    /**
+     * @brief Looks up and runs the program's 'main', returns its exit code
+     */
+    int runMain();
+
+    [[nodiscard]] static unsigned defaultCompileThreads();
+};
+
+class JITException : public std::exception {
+   private:
+    std::string message;
+
+   public:
+    explicit JITException(std::string msg);
+
+    [[nodiscard]] const char* what() const noexcept override;
+};
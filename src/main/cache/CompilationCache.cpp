@@ -0,0 +1,196 @@
+#include "CompilationCache.hpp"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/SHA1.h>
+#include <algorithm>
+#include <vector>
+
+// Set by CMake from the project version and the built runtime library, both part of the build identity
+#ifndef MILA_VERSION
+#define MILA_VERSION "unknown"
+#endif
+#ifndef MILA_RUNTIME_LIB
+#define MILA_RUNTIME_LIB "libmila_runtime.a"
+#endif
+
+// In-flight copies, never considered to be entries. Ones older than 'staleTmpAge' were left by a crashed process.
+static const char* const tmpPrefix = "tmp-";
+static constexpr std::chrono::minutes staleTmpAge(10);
+
+CompilationCache::CompilationCache(std::string directory, uint64_t maxSize)
+    : directory(std::move(directory)), maxSize(maxSize) {
+    if (std::error_code EC = llvm::sys::fs::create_directories(this->directory))
+        throw CacheException("Failed to create cache directory '" + this->directory + "': " + EC.message());
+}
+
+std::string CompilationCache::defaultDirectory() {
+    llvm::SmallString<128> path;
+
+    if (auto xdgCacheHome = llvm::sys::Process::GetEnv("XDG_CACHE_HOME"); xdgCacheHome && !xdgCacheHome->empty()) {
+        path = *xdgCacheHome;
+    } else if (auto home = llvm::sys::Process::GetEnv("HOME"); home && !home->empty()) {
+        path = *home;
+        llvm::sys::path::append(path, ".cache");
+    } else {
+        throw CacheException("Failed to locate cache directory - neither XDG_CACHE_HOME nor HOME is set");
+    }
+
+    llvm::sys::path::append(path, "milac");
+    return path.str().str();
+}
+
+const std::string& CompilationCache::buildIdentity() {
+    static const std::string identity = []() {
+        llvm::SHA1 hasher;
+        hasher.update(MILA_VERSION);
+
+        // A rebuilt compiler or runtime with an unchanged version must not reuse entries produced by the old one
+        static int anchor;
+        const std::string executable = llvm::sys::fs::getMainExecutable(nullptr, &anchor);
+        for (const std::string& file : {executable, std::string(MILA_RUNTIME_LIB)}) {
+            hasher.update(llvm::StringRef("\0", 1));
+            if (auto buffer = llvm::MemoryBuffer::getFile(file, /*IsText*/ false, /*RequiresNullTerminator*/ false))
+                hasher.update((*buffer)->getBuffer());
+            else
+                hasher.update(file);
+        }
+
+        return llvm::toHex(hasher.final(), /*LowerCase*/ true);
+    }();
+
+    return identity;
+}
+
+std::string CompilationCache::computeKey(std::string_view source, std::string_view flags, std::string_view triple) {
+    llvm::SHA1 hasher;
+
+    // Every part is terminated by '\0', so that e.g. moving bytes between the flags and the triple changes the key
+    for (std::string_view part : {std::string_view(buildIdentity()), flags, triple, source}) {
+        hasher.update(llvm::StringRef(part.data(), part.size()));
+        hasher.update(llvm::StringRef("\0", 1));
+    }
+
+    return llvm::toHex(hasher.final(), /*LowerCase*/ true);
+}
+
+std::string CompilationCache::entryPath(const std::string& key) const {
+    llvm::SmallString<128> path(directory);
+    llvm::sys::path::append(path, key);
+    return path.str().str();
+}
+
+bool CompilationCache::lookup(const std::string& key, const std::string& outFile) {
+    std::string path = entryPath(key);
+
+    // Refreshes the modification time, which is what the LRU eviction orders by. Fails if there is no such entry.
+    int fd;
+    if (llvm::sys::fs::openFileForRead(path, fd)) {
+        ++misses;
+        return false;
+    }
+    llvm::sys::fs::setLastAccessAndModificationTime(fd, std::chrono::system_clock::now());
+    llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+
+    // A concurrent eviction may remove the entry in the meantime, which is just a miss
+    auto permissions = llvm::sys::fs::getPermissions(path);
+    if (!permissions || llvm::sys::fs::copy_file(path, outFile) ||
+        llvm::sys::fs::setPermissions(outFile, *permissions)) {
+        ++misses;
+        return false;
+    }
+
+    ++hits;
+    return true;
+}
+
+void CompilationCache::store(const std::string& key, const std::string& artifactFile) {
+    auto permissions = llvm::sys::fs::getPermissions(artifactFile);
+    if (!permissions)
+        throw CacheException("Failed to read permissions of '" + artifactFile + "'");
+
+    int fd;
+    llvm::SmallString<128> tmpPath;
+    if (std::error_code EC = llvm::sys::fs::createUniqueFile(directory + "/" + tmpPrefix + "%%%%%%%%%%%%", fd, tmpPath))
+        throw CacheException("Failed to create temporary cache file: " + EC.message());
+
+    // Copies into the cache directory first and then renames, so that readers never see a partially written entry
+    std::error_code EC = llvm::sys::fs::copy_file(artifactFile, fd);
+    llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+
+    if (!EC)
+        EC = llvm::sys::fs::setPermissions(tmpPath, *permissions);
+    if (!EC)
+        EC = llvm::sys::fs::rename(tmpPath, entryPath(key));
+
+    if (EC) {
+        llvm::sys::fs::remove(tmpPath);
+        throw CacheException("Failed to store cache entry '" + key + "': " + EC.message());
+    }
+
+    evict();
+}
+
+void CompilationCache::evict() const {
+    struct Entry {
+        std::string path;
+        uint64_t size;
+        llvm::sys::TimePoint<> lastUsed;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t totalSize = 0;
+
+    const auto staleTmpTime = std::chrono::system_clock::now() - staleTmpAge;
+
+    std::error_code EC;
+    for (llvm::sys::fs::directory_iterator it(directory, EC), end; it != end && !EC; it.increment(EC)) {
+        llvm::sys::fs::file_status status;
+        if (llvm::sys::fs::status(it->path(), status) || status.type() != llvm::sys::fs::file_type::regular_file)
+            continue;
+
+        if (llvm::sys::path::filename(it->path()).startswith(tmpPrefix)) {
+            if (status.getLastModificationTime() < staleTmpTime)
+                llvm::sys::fs::remove(it->path());
+            continue;
+        }
+
+        entries.push_back({it->path(), status.getSize(), status.getLastModificationTime()});
+        totalSize += status.getSize();
+    }
+
+    if (totalSize <= maxSize)
+        return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+
+    for (const Entry& entry : entries) {
+        if (totalSize <= maxSize)
+            break;
+
+        // Another process may have evicted it already, the space is freed either way
+        llvm::sys::fs::remove(entry.path);
+        totalSize -= entry.size;
+    }
+}
+
+const std::string& CompilationCache::getDirectory() const {
+    return directory;
+}
+
+unsigned CompilationCache::getHits() const {
+    return hits;
+}
+
+unsigned CompilationCache::getMisses() const {
+    return misses;
+}
+
+CacheException::CacheException(std::string msg) : message(std::move(msg)) {}
+
+const char* CacheException::what() const noexcept {
+    return message.c_str();
+}
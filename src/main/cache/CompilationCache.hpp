@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Persistent content-addressed cache of compiled executables
+ * @note Entries are keyed by a hash of everything the output depends on (source bytes, compiler build, flags, target
+ * triple), so a hit skips the whole compilation. Entries are published with an atomic rename, hence concurrent
+ * compiler processes may share the cache. The total size is bounded by evicting the least recently used entries.
+ */
+class CompilationCache {
+   private:
+    std::string directory;
+    uint64_t maxSize;
+
+    std::atomic<unsigned> hits{0};
+    std::atomic<unsigned> misses{0};
+
+    [[nodiscard]] std::string entryPath(const std::string& key) const;
+
+   public:
+    static constexpr uint64_t defaultMaxSize = 256ULL * 1024 * 1024;
+
+    /**
+     * @brief Opens (and creates if needed) the cache in 'directory'
+     * @param maxSize Upper bound of the total size of the entries in bytes
+     */
+    explicit CompilationCache(std::string directory, uint64_t maxSize = defaultMaxSize);
+
+    /**
+     * @brief Returns '$XDG_CACHE_HOME/milac', or '$HOME/.cache/milac' if XDG_CACHE_HOME is not set
+     */
+    [[nodiscard]] static std::string defaultDirectory();
+
+    /**
+     * @brief Returns the hash of the compiler version, executable and runtime library, computed once per process
+     */
+    [[nodiscard]] static const std::string& buildIdentity();
+
+    /**
+     * @brief Computes the cache key (SHA-1 hex digest) of the source and everything else affecting the output
+     * @param flags Canonical spelling of the options affecting the output, e.g. "-O2"
+     */
+    [[nodiscard]] static std::string computeKey(std::string_view source, std::string_view flags,
+                                                std::string_view triple);
+
+    /**
+     * @brief On a hit copies the cached executable to 'outFile' and marks the entry as recently used
+     * @returns True on a hit, false on a miss
+     */
+    bool lookup(const std::string& key, const std::string& outFile);
+
+    /**
+     * @brief Atomically publishes a copy of 'artifactFile' under 'key' and evicts entries over the size bound
+     */
+    void store(const std::string& key, const std::string& artifactFile);
+
+    /**
+     * @brief Removes the least recently used entries until the total size fits into the bound
+     * @note Also removes temporary files abandoned by crashed processes
+     */
+    void evict() const;
+
+    [[nodiscard]] const std::string& getDirectory() const;
+    [[nodiscard]] unsigned getHits() const;
+    [[nodiscard]] unsigned getMisses() const;
+};
+
+class CacheException : public std::exception {
+   private:
+    std::string message;
+
+   public:
+    explicit CacheException(std::string msg);
+
+    [[nodiscard]] const char* what() const noexcept override;
+};
@@ -0,0 +1,131 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include "Token.hpp"
+
+/**
+ * @brief Keyword recognition by a perfect hash generated at compile time
+ * @note The hash mixes the length, the first two and the last character with a seed that the compiler searches for,
+ * such that no two keywords share a slot. A lookup is then one hash, one table load and one length-checked memcmp,
+ * without any global constructor.
+ */
+namespace Keywords {
+
+struct Keyword {
+    std::string_view spelling;
+    TokenType type;
+};
+
+inline constexpr std::array<Keyword, 27> keywords = {{
+    {"integer", TokenType::INTEGER},
+    {"real", TokenType::REAL},
+    {"program", TokenType::PROGRAM},
+    {"var", TokenType::VAR},
+    {"const", TokenType::CONST},
+    {"begin", TokenType::BEGIN},
+    {"end", TokenType::END},
+    {"array", TokenType::ARRAY},
+    {"function", TokenType::FUNCTION},
+    {"procedure", TokenType::PROCEDURE},
+    {"if", TokenType::IF},
+    {"then", TokenType::THEN},
+    {"else", TokenType::ELSE},
+    {"while", TokenType::WHILE},
+    {"for", TokenType::FOR},
+    {"do", TokenType::DO},
+    {"to", TokenType::TO},
+    {"downto", TokenType::DOWNTO},
+    {"exit", TokenType::EXIT},
+    {"break", TokenType::BREAK},
+    {"forward", TokenType::FORWARD},
+    {"of", TokenType::OF},
+    {"or", TokenType::OR},
+    {"not", TokenType::NOT},
+    {"and", TokenType::AND},
+    {"mod", TokenType::MOD},
+    {"div", TokenType::DIV},
+}};
+
+inline constexpr size_t minLength = 2;
+inline constexpr size_t maxLength = 9;
+
+inline constexpr unsigned tableBits = 7;
+inline constexpr size_t tableSize = size_t(1) << tableBits;
+
+/**
+ * @pre minLength <= length <= maxLength
+ */
+constexpr uint32_t hash(const char* s, size_t length, uint32_t seed) {
+    constexpr uint32_t prime = 0x01000193;
+    uint32_t h = seed;
+    h = (h ^ static_cast<unsigned char>(s[0])) * prime;
+    h = (h ^ static_cast<unsigned char>(s[1])) * prime;
+    h = (h ^ static_cast<unsigned char>(s[length - 1])) * prime;
+    h = (h ^ static_cast<uint32_t>(length)) * prime;
+    return (h ^ (h >> 16)) & (tableSize - 1);
+}
+
+/**
+ * @return The first seed without collisions among the keywords, 0 if there is none
+ */
+constexpr uint32_t findSeed() {
+    for (uint32_t seed = 1; seed < 100000; ++seed) {
+        std::array<bool, tableSize> used{};
+        bool perfect = true;
+        for (const Keyword& keyword : keywords) {
+            uint32_t slot = hash(keyword.spelling.data(), keyword.spelling.size(), seed);
+            if (used[slot]) {
+                perfect = false;
+                break;
+            }
+            used[slot] = true;
+        }
+
+        if (perfect)
+            return seed;
+    }
+
+    return 0;
+}
+
+inline constexpr uint32_t seed = findSeed();
+static_assert(seed != 0, "no perfect hash seed for the keywords, increase tableBits");
+
+/**
+ * @brief Slot -> index into 'keywords', -1 for empty slots
+ */
+inline constexpr std::array<int8_t, tableSize> slots = []() {
+    std::array<int8_t, tableSize> table{};
+    for (auto& slot : table)
+        slot = -1;
+    for (size_t i = 0; i < keywords.size(); ++i)
+        table[hash(keywords[i].spelling.data(), keywords[i].spelling.size(), seed)] = static_cast<int8_t>(i);
+    return table;
+}();
+
+/**
+ * @return The keyword token type of the identifier, std::nullopt if it is not a keyword
+ */
+inline std::optional<TokenType> lookup(const char* s, size_t length) {
+    if (length < minLength || length > maxLength)
+        return std::nullopt;
+
+    int8_t index = slots[hash(s, length, seed)];
+    if (index < 0)
+        return std::nullopt;
+
+    const Keyword& keyword = keywords[index];
+    if (keyword.spelling.size() != length || std::memcmp(keyword.spelling.data(), s, length) != 0)
+        return std::nullopt;
+
+    return keyword.type;
+}
+
+inline std::optional<TokenType> lookup(std::string_view identifier) {
+    return lookup(identifier.data(), identifier.size());
+}
+
+}  // namespace Keywords
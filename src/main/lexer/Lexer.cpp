@@ -1,13 +1,140 @@
 #include "Lexer.hpp"
-#include <map>
+#include "Keywords.hpp"
+#include "Scanner.hpp"
+#include <array>
+#include <charconv>
 #include <sstream>
+#include "utils/Statistic.hpp"
+
+MILA_STATISTIC(NumTokensLexed, "lexer", "Number of tokens lexed");
+
+namespace {
+/**
+ * @brief Character classes of the lexer (whitespace is Scanner's business), ASCII only (independent of the locale, unlike std::isalpha & co.)
+ */
+enum CharClass : uint8_t {
+    Letter = 1 << 0,
+    Digit = 1 << 1,
+    Underscore = 1 << 2,
+    /**
+     * @brief Digits and 'a' to 'f' (hexadecimal literals are lower case only)
+     */
+    HexDigit = 1 << 3,
+    IdentifierStart = Letter | Underscore,
+};
+
+constexpr std::array<uint8_t, 256> charClasses = []() {
+    std::array<uint8_t, 256> table{};
+    for (int c = 'a'; c <= 'z'; ++c)
+        table[c] |= Letter;
+    for (int c = 'A'; c <= 'Z'; ++c)
+        table[c] |= Letter;
+    for (int c = '0'; c <= '9'; ++c)
+        table[c] |= Digit | HexDigit;
+    for (int c = 'a'; c <= 'f'; ++c)
+        table[c] |= HexDigit;
+    table['_'] |= Underscore;
+    return table;
+}();
+
+inline bool hasClass(int c, uint8_t charClass) {
+    return c != EOF && (charClasses[c] & charClass);
+}
+
+/**
+ * @return The first character in [cur, end) not of the class, or 'end'
+ */
+inline const char* skipClass(const char* cur, const char* end, uint8_t charClass) {
+    while (cur < end && hasClass(static_cast<unsigned char>(*cur), charClass))
+        ++cur;
+    return cur;
+}
+
+/**
+ * @brief Skips an exponent "(e|E)[+|-]digits"
+ * @return The end of the exponent, or 'cur' if there is none (an 'e' not followed by digits is not part of the literal,
+ * e.g. "1else")
+ */
+inline const char* skipExponent(const char* cur, const char* end) {
+    if (cur == end || (*cur != 'e' && *cur != 'E'))
+        return cur;
+
+    const char* exponent = cur + 1;
+    if (exponent < end && (*exponent == '+' || *exponent == '-'))
+        ++exponent;
+    if (exponent == end || !hasClass(static_cast<unsigned char>(*exponent), Digit))
+        return cur;
+
+    return skipClass(exponent, end, Digit);
+}
+}  // namespace
+
+Lexer::Lexer(std::istream& is)
+    : ownedSource(SourceBuffer::fromStream(is)),
+      begin(ownedSource->begin()),
+      cur(ownedSource->begin()),
+      end(ownedSource->end()),
+      sourceManager(begin, end),
+      nextToken(readNextToken()) {}
+
+Lexer::Lexer(const SourceBuffer& source) : Lexer(source.begin(), source.end()) {}
+
+Lexer::Lexer(const char* begin, const char* end)
+    : begin(begin), cur(begin), end(end), sourceManager(begin, end), nextToken(readNextToken()) {}
+
+Lexer::~Lexer() {
+    NumTokensLexed += tokensLexed;
+}
+
+int Lexer::parseInteger(const char* first, const char* last, int base) const {
+    int value = 0;
+    auto [ptr, errc] = std::from_chars(first, last, value, base);
+    if (errc == std::errc::result_out_of_range)
+        throw error("Integer literal '" + std::string(first, last) + "' does not fit into 32 bits.", first);
+    return value;
+}
+
+double Lexer::parseReal(const char* first, const char* last) const {
+    double value = 0.0;
+    auto [ptr, errc] = std::from_chars(first, last, value, std::chars_format::general);
+    if (errc == std::errc::result_out_of_range)
+        throw error("Real literal '" + std::string(first, last) + "' is out of range.", first);
+    return value;
+}
 
-Lexer::Lexer(std::istream& is) : is(is), curPos(), tokenStartPos(), nextToken(readNextToken()) {}
+LexerException Lexer::error(const std::string& message, const char* at) const {
+    return {message, sourceManager.getPosition(at - begin)};
+}
 
-Token Lexer::peek() const {
+const Token& Lexer::peek() const {
     return nextToken;
 }
 
+Token Lexer::next() {
+    Token curToken = nextToken;
+    nextToken = readNextToken();
+    return curToken;
+}
+
+StringInterner Lexer::takeInterner() {
+    if (nextToken.getType() != TokenType::EOI)
+        throw error("Failed to take the interner - the input is not fully lexed.", cur);
+
+    return std::move(interner);
+}
+
+StringInterner& Lexer::getInterner() {
+    return interner;
+}
+
+const StringInterner& Lexer::getInterner() const {
+    return interner;
+}
+
+const SourceManager& Lexer::getSourceManager() const {
+    return sourceManager;
+}
+
 std::optional<Token> Lexer::match(TokenType tokenType) {
     if (peek().getType() == tokenType) {
         auto curToken = nextToken;
@@ -18,303 +145,199 @@ std::optional<Token> Lexer::match(TokenType tokenType) {
     return std::nullopt;
 }
 
-std::map<std::string, TokenType> keywords = {
-    {"integer", TokenType::INTEGER},
-    {"real", TokenType::REAL},
-    {"program", TokenType::PROGRAM},
-    {"var", TokenType::VAR},
-    {"const", TokenType::CONST},
-    {"begin", TokenType::BEGIN},
-    {"end", TokenType::END},
-    {"array", TokenType::ARRAY},
-    {"function", TokenType::FUNCTION},
-    {"procedure", TokenType::PROCEDURE},
-    {"if", TokenType::IF},
-    {"then", TokenType::THEN},
-    {"else", TokenType::ELSE},
-    {"while", TokenType::WHILE},
-    {"for", TokenType::FOR},
-    {"do", TokenType::DO},
-    {"to", TokenType::TO},
-    {"downto", TokenType::DOWNTO},
-    {"exit", TokenType::EXIT},
-    {"break", TokenType::BREAK},
-    {"forward", TokenType::FORWARD},
-    {"of", TokenType::OF},
-    {"or", TokenType::OR},
-    {"not", TokenType::NOT},
-    {"and", TokenType::AND},
-    {"mod", TokenType::MOD},
-    {"div", TokenType::DIV},
-};
-
-std::optional<TokenType> isKeyword(const std::string& identifier) {
-    auto it = keywords.find(identifier);
-    if (it != keywords.end()) {
-        return it->second;
-    }
-
-    return std::nullopt;
-}
-
 Token Lexer::readNextToken() {
-    std::string identifierBuffer;
-    int intNumberBuffer = 0;
-    double doubleNumberBuffer = 0.0;
-    int dividerBuffer = 10;
-
-qStart:
-    if (is.peek() == EOF) {
-        return {TokenType::EOI, curPos};
-    }
+    ++tokensLexed;
 
-    if (std::isspace(is.peek())) {
+    const char* identifierStart = nullptr;
+    const char* numberStart = nullptr;
+    uint32_t tokenStart;
 
-        if (is.peek() == '\n') {
-            curPos.nextLine();
-        } else {
-            curPos.advance();
-        }
-        is.get();
+qStart:
+    // Whitespace is skipped in blocks, see Scanner
+    cur = Scanner::skipWhitespace(cur, end);
+    tokenStart = cur - begin;
 
-        goto qStart;
+    if (peekChar() == EOF) {
+        return {TokenType::EOI, tokenStart};
     }
 
-    switch (is.peek()) {
+    switch (peekChar()) {
         case '{':
-            is.get();
+            ++cur;
             goto qComment;
         case '+':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
-            return {TokenType::PLUS, tokenStartPos};
+            ++cur;
+            return {TokenType::PLUS, tokenStart};
         case '-':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
-            return {TokenType::MINUS, tokenStartPos};
+            ++cur;
+            return {TokenType::MINUS, tokenStart};
         case '*':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
-            return {TokenType::MULTIPLY, tokenStartPos};
+            ++cur;
+            return {TokenType::MULTIPLY, tokenStart};
         case '/':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
-            return {TokenType::DIVIDE, tokenStartPos};
+            ++cur;
+            return {TokenType::DIVIDE, tokenStart};
         case '=':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
-            return {TokenType::EQUAL, tokenStartPos};
+            ++cur;
+            return {TokenType::EQUAL, tokenStart};
         case '<':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
+            ++cur;
             goto qLess;
         case '>':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
+            ++cur;
             goto qGreater;
         case ':':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
+            ++cur;
             goto qColon;
         case ';':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
-            return {TokenType::SEMICOLON, tokenStartPos};
+            ++cur;
+            return {TokenType::SEMICOLON, tokenStart};
         case ',':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
-            return {TokenType::COMMA, tokenStartPos};
+            ++cur;
+            return {TokenType::COMMA, tokenStart};
         case '.':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
+            ++cur;
             goto qDot;
         case '(':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
-            return {TokenType::LEFT_PAREN, tokenStartPos};
+            ++cur;
+            return {TokenType::LEFT_PAREN, tokenStart};
         case ')':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
-            return {TokenType::RIGHT_PAREN, tokenStartPos};
+            ++cur;
+            return {TokenType::RIGHT_PAREN, tokenStart};
         case '[':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
-            return {TokenType::LEFT_BRACKET, tokenStartPos};
+            ++cur;
+            return {TokenType::LEFT_BRACKET, tokenStart};
         case ']':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
-            return {TokenType::RIGHT_BRACKET, tokenStartPos};
+            ++cur;
+            return {TokenType::RIGHT_BRACKET, tokenStart};
         case '&':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
+            ++cur;
+            numberStart = cur;
             goto qInt8;
         case '$':
-            is.get();
-            tokenStartPos = curPos;
-            curPos.advance();
+            ++cur;
+            numberStart = cur;
             goto qInt16;
         default:;
     }
 
-    if (std::isalpha(is.peek()) || is.peek() == '_') {
-        identifierBuffer.clear();
-        identifierBuffer.push_back((char)is.peek());
-        is.get();
-        tokenStartPos = curPos;
-        curPos.advance();
+    if (hasClass(peekChar(), IdentifierStart)) {
+        identifierStart = cur;
+        ++cur;
         goto qIdentifier;
     }
 
-    if (std::isdigit(is.peek())) {
-        intNumberBuffer = is.get() - '0';
-        tokenStartPos = curPos;
-        curPos.advance();
+    if (hasClass(peekChar(), Digit)) {
+        numberStart = cur;
         goto qInt10;
     }
 
-    throw LexerException("Unable to lex next token.", curPos);
+    throw error("Unable to lex next token.", cur);
 
 qComment:
-    switch (is.peek()) {
-        case '}':
-            is.get();
-            goto qStart;
-        case EOF:
-            throw LexerException("Unexpected end of file in a comment.", curPos);
-        default:
-            is.get();
-            goto qComment;
-    }
+    cur = Scanner::skipComment(cur, end);
+    if (peekChar() == EOF)
+        throw error("Unexpected end of file in a comment.", cur);
+
+    ++cur;
+    goto qStart;
 
 qLess:
-    switch (is.peek()) {
+    switch (peekChar()) {
         case '>':
-            is.get();
-            curPos.advance();
-            return {TokenType::NOT_EQUAL, tokenStartPos};
+            ++cur;
+            return {TokenType::NOT_EQUAL, tokenStart};
         case '=':
-            is.get();
-            curPos.advance();
-            return {TokenType::LESS_EQUAL, tokenStartPos};
+            ++cur;
+            return {TokenType::LESS_EQUAL, tokenStart};
         default:
-            return {TokenType::LESS, tokenStartPos};
+            return {TokenType::LESS, tokenStart};
     }
 
 qGreater:
-    switch (is.peek()) {
+    switch (peekChar()) {
         case '=':
-            is.get();
-            curPos.advance();
-            return {TokenType::GREATER_EQUAL, tokenStartPos};
+            ++cur;
+            return {TokenType::GREATER_EQUAL, tokenStart};
         default:
-            return {TokenType::GREATER, tokenStartPos};
+            return {TokenType::GREATER, tokenStart};
     }
 
 qColon:
-    switch (is.peek()) {
+    switch (peekChar()) {
         case '=':
-            is.get();
-            curPos.advance();
-            return {TokenType::ASSIGN, tokenStartPos};
+            ++cur;
+            return {TokenType::ASSIGN, tokenStart};
         default:
-            return {TokenType::COLON, tokenStartPos};
+            return {TokenType::COLON, tokenStart};
     }
 
 qDot:
-    switch (is.peek()) {
+    switch (peekChar()) {
         case '.':
-            is.get();
-            curPos.advance();
-            return {TokenType::DOUBLE_DOT, tokenStartPos};
+            ++cur;
+            return {TokenType::DOUBLE_DOT, tokenStart};
         default:
-            return {TokenType::DOT, tokenStartPos};
+            return {TokenType::DOT, tokenStart};
     }
 
 qIdentifier:
-    if (std::isdigit(is.peek()) || std::isalpha(is.peek()) || is.peek() == '_') {
-        identifierBuffer.push_back((char)is.peek());
-        is.get();
-        curPos.advance();
+    if (hasClass(peekChar(), IdentifierStart | Digit)) {
+        ++cur;
         goto qIdentifier;
     } else {
-        auto maybeKeyword = isKeyword(identifierBuffer);
+        auto maybeKeyword = Keywords::lookup(identifierStart, cur - identifierStart);
         if (maybeKeyword.has_value()) {
-            return {maybeKeyword.value(), tokenStartPos};
+            return {maybeKeyword.value(), tokenStart};
         } else {
-            return {TokenType::IDENTIFIER, tokenStartPos, identifierBuffer};
+            SymbolId symbol = interner.intern({identifierStart, size_t(cur - identifierStart)});
+            return {TokenType::IDENTIFIER, tokenStart, symbol};
         }
     }
 
 qInt10:
-    if (std::isdigit(is.peek())) {
-        intNumberBuffer = intNumberBuffer * 10 + is.get() - '0';
-        curPos.advance();
-        goto qInt10;
-    } else if (is.peek() == '.') {
-        is.get();
-        curPos.advance();
-
-        // there must be at least one digit after the dot
-        if (!std::isdigit(is.peek()))
-            throw LexerException("Expected a digit after the dot in a real number.", curPos);
-
-        doubleNumberBuffer = intNumberBuffer;
+    // The literal is delimited first, then converted at once
+    cur = skipClass(cur, end, Digit);
+    if (peekChar() == '.' && (cur + 1 == end || cur[1] != '.')) {
+        // there must be at least one digit after the dot ("1..5" is a range)
+        if (cur + 1 == end || !hasClass(static_cast<unsigned char>(cur[1]), Digit)) {
+            throw error("Expected a digit after the dot in a real number.", cur + 1);
+        }
+        cur = skipExponent(skipClass(cur + 2, end, Digit), end);
+        goto qDouble;
+    } else if (const char* exponentEnd = skipExponent(cur, end); exponentEnd != cur) {
+        cur = exponentEnd;
         goto qDouble;
     } else {
-        return {TokenType::INTEGER_LITERAL, tokenStartPos, intNumberBuffer};
+        return {TokenType::INTEGER_LITERAL, tokenStart, parseInteger(numberStart, cur, 10)};
     }
 
 qInt8:
-    if (std::isdigit(is.peek())) {
-        if (is.peek() > '7')
-            throw LexerException("Invalid octal digit.", curPos);
-
-        intNumberBuffer = intNumberBuffer * 8 + is.get() - '0';
-        curPos.advance();
-        goto qInt8;
-    } else {
-        return {TokenType::INTEGER_LITERAL, tokenStartPos, intNumberBuffer};
+    cur = skipClass(cur, end, Digit);
+    for (const char* digit = numberStart; digit < cur; ++digit) {
+        if (*digit > '7') {
+            throw error("Invalid octal digit '" + std::string(1, *digit) + "'.", digit);
+        }
     }
+    if (cur == numberStart)
+        throw error("Expected an octal digit after '&'.", cur);
+
+    return {TokenType::INTEGER_LITERAL, tokenStart, parseInteger(numberStart, cur, 8)};
 
 qInt16:
-    if (std::isdigit(is.peek()) || std::isalpha(is.peek())) {
-        if (std::isalpha(is.peek()) && !(is.peek() >= 'a' && is.peek() <= 'f'))
-            throw LexerException("Invalid hex digit: " + std::to_string(is.peek()), curPos);
-
-        int digit = (std::isalpha(is.peek())) ? (is.get() - 'a' + 10) : (is.get() - '0');
-        intNumberBuffer = intNumberBuffer * 16 + digit;
-        curPos.advance();
-        goto qInt16;
-    } else {
-        return {TokenType::INTEGER_LITERAL, tokenStartPos, intNumberBuffer};
+    cur = skipClass(cur, end, Letter | Digit);
+    for (const char* digit = numberStart; digit < cur; ++digit) {
+        if (!hasClass(static_cast<unsigned char>(*digit), HexDigit)) {
+            throw error("Invalid hex digit '" + std::string(1, *digit) + "'.", digit);
+        }
     }
+    if (cur == numberStart)
+        throw error("Expected a hex digit after '$'.", cur);
+
+    return {TokenType::INTEGER_LITERAL, tokenStart, parseInteger(numberStart, cur, 16)};
 
 qDouble:
-    if (std::isdigit(is.peek())) {
-        auto digit = (double)(is.get() - '0');
-        doubleNumberBuffer += digit / dividerBuffer;
-        dividerBuffer *= 10;
-        curPos.advance();
-        goto qDouble;
-    } else {
-        return {TokenType::REAL_LITERAL, tokenStartPos, doubleNumberBuffer};
-    }
+    return {TokenType::REAL_LITERAL, tokenStart, parseReal(numberStart, cur)};
 }
 
 LexerException::LexerException(const std::string& message, const Position& position) {
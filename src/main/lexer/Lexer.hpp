@@ -1,42 +1,123 @@
 #pragma once
+#include <optional>
+#include "SourceBuffer.hpp"
+#include "SourceManager.hpp"
 #include "Token.hpp"
 
+class LexerException;
+
+/**
+ * @brief Scans the source code with a pointer cursor over a contiguous buffer
+ */
 class Lexer {
     /**
-     * @brief Input stream with source code
+     * @brief Source read by the std::istream constructor, empty if the lexer scans a buffer owned by the caller
      */
-    std::istream& is;
+    std::optional<SourceBuffer> ownedSource;
 
     /**
-     * @brief Current position in the source code
+     * @brief Names of the identifiers, tokens hold their SymbolId
      */
-    Position curPos;
+    StringInterner interner;
 
     /**
-     * @brief Position where currently scanning token starts
+     * @brief Cursor into the source code [begin, end)
      */
-    Position tokenStartPos;
+    const char* begin;
+    const char* cur;
+    const char* end;
+
+    /**
+     * @brief Resolves offsets to positions, only for the diagnostics (the scanning loop does no line bookkeeping)
+     */
+    SourceManager sourceManager;
 
     Token nextToken;
 
+    /**
+     * @brief Tokens read by this lexer, added to the process-wide statistic once on destruction, so the scanning loop
+     * does no atomic increment per token
+     */
+    uint64_t tokensLexed = 0;
+
     /**
      * @brief Eats next token
      */
     Token readNextToken();
 
+    /**
+     * @brief Creates an exception for the error at the given character (its position is computed only here)
+     */
+    [[nodiscard]] LexerException error(const std::string& message, const char* at) const;
+
+    /**
+     * @brief Converts the digits [first, last) with std::from_chars, which detects overflow (unlike accumulating into
+     * an int)
+     */
+    [[nodiscard]] int parseInteger(const char* first, const char* last, int base) const;
+
+    /**
+     * @brief Converts [first, last) ("digits[.digits][(e|E)[+|-]digits]") to the nearest double. std::from_chars is
+     * correctly rounded and (libstdc++ 12+) uses the Eisel-Lemire fast path, no locale and no copy to a string.
+     */
+    [[nodiscard]] double parseReal(const char* first, const char* last) const;
+
+    /**
+     * @return The current character or EOF at the end of the source
+     */
+    [[nodiscard]] int peekChar() const { return cur < end ? static_cast<unsigned char>(*cur) : EOF; }
+
    public:
+    /**
+     * @brief Reads the whole stream (in chunks) into an owned buffer, then scans it
+     */
     explicit Lexer(std::istream& is);
 
+    /**
+     * @brief Scans the buffer in place, it must outlive the lexer
+     */
+    explicit Lexer(const SourceBuffer& source);
+
+    /**
+     * @brief Scans the range [begin, end) in place, it must outlive the lexer
+     */
+    Lexer(const char* begin, const char* end);
+
+    ~Lexer();
+
+    // The cursor points into the (possibly owned) buffer
+    Lexer(const Lexer&) = delete;
+    Lexer& operator=(const Lexer&) = delete;
+
     /**
      * @brief Matches the next token with the given token type. If successful, the token is consumed
      * @return The matched token or std::nullopt if the token does not match the given token type.
      */
     std::optional<Token> match(TokenType tokenType);
 
+    /**
+     * @brief Consumes and returns the next token, whatever its type
+     */
+    Token next();
+
     /**
      * @return Next token without consuming it
      */
-    [[nodiscard]] Token peek() const;
+    [[nodiscard]] const Token& peek() const;
+
+    [[nodiscard]] StringInterner& getInterner();
+    [[nodiscard]] const StringInterner& getInterner() const;
+
+    /**
+     * @brief Resolves token offsets to lines and columns
+     */
+    [[nodiscard]] const SourceManager& getSourceManager() const;
+
+    /**
+     * @brief Moves the interner out, for consumers that outlive the lexer (e.g. TokenStream). Only valid at the end
+     * of the input, when no more identifiers are interned.
+     */
+    [[nodiscard]] StringInterner takeInterner();
 };
 
 class LexerException : public std::exception {
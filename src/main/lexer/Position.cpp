@@ -1,13 +1,6 @@
 #include "Position.hpp"
 
-void Position::advance() {
-    col++;
-}
-
-void Position::nextLine() {
-    line++;
-    col = 1;
-}
+Position::Position(unsigned line, unsigned col) : line(line), col(col) {}
 
 unsigned Position::getLine() const {
     return line;
@@ -2,22 +2,15 @@
 #include <iostream>
 
 /**
- * @brief Represents a position in the source code
+ * @brief Represents a position (line and column) in the source code, see SourceManager
  */
 class Position {
     unsigned line = 1;
     unsigned col = 1;
 
    public:
-    /**
-     * @brief Advances the column by one
-     */
-    void advance();
-
-    /**
-     * @brief Advances the line by one and resets the column to 1
-     */
-    void nextLine();
+    Position() = default;
+    Position(unsigned line, unsigned col);
 
     [[nodiscard]] unsigned getLine() const;
 
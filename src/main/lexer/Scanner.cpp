@@ -0,0 +1,148 @@
+#include "Scanner.hpp"
+#include <cstdint>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define MILA_SCANNER_X86 1
+#endif
+
+namespace Scanner {
+
+namespace {
+inline bool isWhitespace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+const char* skipWhitespaceScalar(const char* cur, const char* end) {
+    while (cur < end && isWhitespace(*cur))
+        ++cur;
+    return cur;
+}
+
+const char* skipCommentScalar(const char* cur, const char* end) {
+    while (cur < end && *cur != '}')
+        ++cur;
+    return cur;
+}
+
+#ifdef MILA_SCANNER_X86
+const char* skipWhitespaceSSE2(const char* cur, const char* end) {
+    const __m128i space = _mm_set1_epi8(' ');
+    // '\t' to '\r' as a signed range, bytes >= 0x80 are negative and thus outside
+    const __m128i beforeTab = _mm_set1_epi8('\t' - 1);
+    const __m128i afterCr = _mm_set1_epi8('\r' + 1);
+
+    for (; end - cur >= 16; cur += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+        __m128i controls = _mm_and_si128(_mm_cmpgt_epi8(block, beforeTab), _mm_cmplt_epi8(block, afterCr));
+        __m128i whitespace = _mm_or_si128(_mm_cmpeq_epi8(block, space), controls);
+
+        uint32_t other = ~uint32_t(_mm_movemask_epi8(whitespace)) & 0xFFFF;
+        if (other)
+            return cur + __builtin_ctz(other);
+    }
+
+    return skipWhitespaceScalar(cur, end);
+}
+
+const char* skipCommentSSE2(const char* cur, const char* end) {
+    const __m128i closing = _mm_set1_epi8('}');
+
+    for (; end - cur >= 16; cur += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+        uint32_t closings = _mm_movemask_epi8(_mm_cmpeq_epi8(block, closing));
+        if (closings)
+            return cur + __builtin_ctz(closings);
+    }
+
+    return skipCommentScalar(cur, end);
+}
+
+__attribute__((target("avx2"))) const char* skipWhitespaceAVX2(const char* cur, const char* end) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i beforeTab = _mm256_set1_epi8('\t' - 1);
+    const __m256i afterCr = _mm256_set1_epi8('\r' + 1);
+
+    for (; end - cur >= 32; cur += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+        __m256i controls =
+            _mm256_and_si256(_mm256_cmpgt_epi8(block, beforeTab), _mm256_cmpgt_epi8(afterCr, block));
+        __m256i whitespace = _mm256_or_si256(_mm256_cmpeq_epi8(block, space), controls);
+
+        uint32_t other = ~uint32_t(_mm256_movemask_epi8(whitespace));
+        if (other)
+            return cur + __builtin_ctz(other);
+    }
+
+    return skipWhitespaceSSE2(cur, end);
+}
+
+__attribute__((target("avx2"))) const char* skipCommentAVX2(const char* cur, const char* end) {
+    const __m256i closing = _mm256_set1_epi8('}');
+
+    for (; end - cur >= 32; cur += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur));
+        uint32_t closings = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, closing));
+        if (closings)
+            return cur + __builtin_ctz(closings);
+    }
+
+    return skipCommentSSE2(cur, end);
+}
+#endif
+}  // namespace
+
+Isa detectIsa() {
+    static const Isa isa = []() {
+        if (isSupported(Isa::AVX2))
+            return Isa::AVX2;
+        if (isSupported(Isa::SSE2))
+            return Isa::SSE2;
+        return Isa::Scalar;
+    }();
+    return isa;
+}
+
+bool isSupported(Isa isa) {
+    switch (isa) {
+#ifdef MILA_SCANNER_X86
+        case Isa::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case Isa::SSE2:
+            // Part of the x86-64 baseline
+            return true;
+#endif
+        case Isa::Scalar:
+            return true;
+        default:
+            return false;
+    }
+}
+
+const char* skipWhitespace(const char* cur, const char* end, Isa isa) {
+    switch (isa) {
+#ifdef MILA_SCANNER_X86
+        case Isa::AVX2:
+            return skipWhitespaceAVX2(cur, end);
+        case Isa::SSE2:
+            return skipWhitespaceSSE2(cur, end);
+#endif
+        default:
+            return skipWhitespaceScalar(cur, end);
+    }
+}
+
+const char* skipComment(const char* cur, const char* end, Isa isa) {
+    switch (isa) {
+#ifdef MILA_SCANNER_X86
+        case Isa::AVX2:
+            return skipCommentAVX2(cur, end);
+        case Isa::SSE2:
+            return skipCommentSSE2(cur, end);
+#endif
+        default:
+            return skipCommentScalar(cur, end);
+    }
+}
+
+}  // namespace Scanner
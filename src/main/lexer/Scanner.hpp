@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+ * @brief Vectorized skipping of whitespace and comment bodies, the bulk of machine-generated sources
+ * @note Blocks of 16 (SSE2) or 32 (AVX2) bytes are classified at once, no line/column bookkeeping is needed (tokens
+ * store offsets, see SourceManager). The instruction set is picked at runtime, with a scalar fallback for other
+ * targets.
+ */
+namespace Scanner {
+
+enum class Isa { Scalar, SSE2, AVX2 };
+
+/**
+ * @brief Returns the best instruction set supported by the CPU (detected once)
+ */
+[[nodiscard]] Isa detectIsa();
+
+/**
+ * @brief Returns whether the CPU (and the build target) supports the instruction set
+ */
+[[nodiscard]] bool isSupported(Isa isa);
+
+/**
+ * @brief Skips whitespace (' ', '\t', '\n', '\v', '\f', '\r')
+ * @return The first non-whitespace character or 'end'
+ */
+[[nodiscard]] const char* skipWhitespace(const char* cur, const char* end, Isa isa = detectIsa());
+
+/**
+ * @brief Skips the body of a '{ ... }' comment
+ * @return The closing '}' or 'end' if the comment is not terminated
+ */
+[[nodiscard]] const char* skipComment(const char* cur, const char* end, Isa isa = detectIsa());
+
+}  // namespace Scanner
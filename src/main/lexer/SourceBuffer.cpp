@@ -0,0 +1,139 @@
+#include "SourceBuffer.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+SourceBuffer SourceBuffer::fromFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw SourceBufferException("cannot open input file: " + path + ": " + std::strerror(errno));
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        // Pipes, character devices, ... cannot be mapped (and an empty mapping is invalid)
+        try {
+            SourceBuffer buffer = fromFileDescriptor(fd, path);
+            ::close(fd);
+            return buffer;
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+    }
+
+    try {
+        checkSize(st.st_size, path);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+
+    void* mapping = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        throw SourceBufferException("cannot map input file: " + path + ": " + std::strerror(errno));
+
+    // The lexer scans the source exactly once from front to back
+    ::madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+
+    SourceBuffer buffer;
+    buffer.data = static_cast<const char*>(mapping);
+    buffer.size = st.st_size;
+    buffer.mappedSize = st.st_size;
+    return buffer;
+}
+
+SourceBuffer SourceBuffer::fromFileDescriptor(int fd, const std::string& name) {
+    std::string content;
+    size_t used = 0;
+    while (true) {
+        content.resize(used + chunkSize);
+        ssize_t n = ::read(fd, content.data() + used, chunkSize);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            throw SourceBufferException("cannot read input: " + name + ": " + std::strerror(errno));
+        }
+        if (n == 0)
+            break;
+        used += n;
+        checkSize(used, name);
+    }
+    content.resize(used);
+
+    return fromString(std::move(content));
+}
+
+SourceBuffer SourceBuffer::fromStream(std::istream& is) {
+    std::string content;
+    size_t used = 0;
+    while (is) {
+        content.resize(used + chunkSize);
+        is.read(content.data() + used, chunkSize);
+        used += is.gcount();
+        checkSize(used, "<stream>");
+    }
+    content.resize(used);
+
+    return fromString(std::move(content));
+}
+
+SourceBuffer SourceBuffer::fromString(std::string source) {
+    checkSize(source.size(), "<string>");
+
+    SourceBuffer buffer;
+    buffer.ownedData = std::move(source);
+    buffer.data = buffer.ownedData.data();
+    buffer.size = buffer.ownedData.size();
+    return buffer;
+}
+
+SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept {
+    *this = std::move(other);
+}
+
+SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+    if (this == &other)
+        return *this;
+
+    release();
+    size = other.size;
+    mappedSize = other.mappedSize;
+    ownedData = std::move(other.ownedData);
+    // A moved (short) string may live at a new address
+    data = mappedSize > 0 ? other.data : ownedData.data();
+
+    other.data = nullptr;
+    other.size = 0;
+    other.mappedSize = 0;
+    return *this;
+}
+
+SourceBuffer::~SourceBuffer() {
+    release();
+}
+
+void SourceBuffer::release() noexcept {
+    if (mappedSize > 0)
+        ::munmap(const_cast<char*>(data), mappedSize);
+
+    data = nullptr;
+    size = 0;
+    mappedSize = 0;
+    ownedData.clear();
+}
+
+void SourceBuffer::checkSize(size_t size, const std::string& name) {
+    if (size > maxSize)
+        throw SourceBufferException("input is too large: " + name + ": sources of up to " + std::to_string(maxSize) +
+                                    " bytes are supported");
+}
+
+SourceBufferException::SourceBufferException(std::string msg) : message(std::move(msg)) {}
+
+const char* SourceBufferException::what() const noexcept {
+    return message.c_str();
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Contiguous, immutable source code the Lexer scans with a pointer cursor
+ * @note Files are memory-mapped (no read into a string, no copy into a stream), other input is read in chunks into an
+ * owned buffer. Move-only, the mapping/buffer is released with the object.
+ */
+class SourceBuffer {
+   private:
+    const char* data = nullptr;
+    size_t size = 0;
+
+    /**
+     * @brief Length of the memory mapping, 0 if 'data' points into 'ownedData' instead
+     */
+    size_t mappedSize = 0;
+
+    std::string ownedData;
+
+    SourceBuffer() = default;
+
+    void release() noexcept;
+
+    /**
+     * @throws SourceBufferException If the source of the given size does not fit 'maxSize'
+     */
+    static void checkSize(size_t size, const std::string& name);
+
+   public:
+    /**
+     * @brief Size of the chunks read from non-mappable input (stdin, pipes, streams)
+     */
+    static constexpr size_t chunkSize = 64 * 1024;
+
+    /**
+     * @brief Largest supported source, tokens and AST nodes locate themselves by a 32-bit offset
+     */
+    static constexpr size_t maxSize = UINT32_MAX;
+
+    /**
+     * @brief Memory-maps the file, falls back to chunked reading if it cannot be mapped (e.g. a pipe or /dev/stdin)
+     * @throws SourceBufferException If the file cannot be opened or read, or is larger than 'maxSize'
+     */
+    [[nodiscard]] static SourceBuffer fromFile(const std::string& path);
+
+    /**
+     * @brief Reads the file descriptor until EOF in chunks of 'chunkSize', the descriptor is not closed
+     */
+    [[nodiscard]] static SourceBuffer fromFileDescriptor(int fd, const std::string& name = "<stdin>");
+
+    /**
+     * @brief Reads the stream until EOF in chunks of 'chunkSize'
+     */
+    [[nodiscard]] static SourceBuffer fromStream(std::istream& is);
+
+    [[nodiscard]] static SourceBuffer fromString(std::string source);
+
+    SourceBuffer(SourceBuffer&& other) noexcept;
+    SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+    ~SourceBuffer();
+
+    [[nodiscard]] const char* begin() const { return data; }
+    [[nodiscard]] const char* end() const { return data + size; }
+    [[nodiscard]] size_t getSize() const { return size; }
+    [[nodiscard]] std::string_view getContent() const { return {data, size}; }
+
+    /**
+     * @brief Whether the content is memory-mapped (rather than copied into an owned buffer)
+     */
+    [[nodiscard]] bool isMapped() const { return mappedSize > 0; }
+};
+
+class SourceBufferException : public std::exception {
+   private:
+    std::string message;
+
+   public:
+    explicit SourceBufferException(std::string msg);
+
+    [[nodiscard]] const char* what() const noexcept override;
+};
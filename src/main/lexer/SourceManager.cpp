@@ -0,0 +1,48 @@
+#include "SourceManager.hpp"
+#include <algorithm>
+#include <cstring>
+
+SourceManager::SourceManager(const char* begin, const char* end, std::string name)
+    : begin(begin), end(end), name(std::move(name)) {}
+
+SourceManager::SourceManager(const SourceBuffer& source, std::string name)
+    : SourceManager(source.begin(), source.end(), std::move(name)) {}
+
+void SourceManager::buildLineStarts() const {
+    lineStarts.push_back(0);
+    const char* newline = begin;
+    while ((newline = static_cast<const char*>(std::memchr(newline, '\n', end - newline)))) {
+        ++newline;
+        lineStarts.push_back(newline - begin);
+    }
+}
+
+const std::string& SourceManager::getName() const {
+    return name;
+}
+
+size_t SourceManager::getSize() const {
+    return end - begin;
+}
+
+Position SourceManager::getPosition(uint32_t offset) const {
+    if (lineStarts.empty())
+        buildLineStarts();
+
+    offset = std::min<size_t>(offset, getSize());
+    // The last line starting at or before the offset
+    auto lineStart = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset) - 1;
+    return {unsigned(lineStart - lineStarts.begin() + 1), offset - *lineStart + 1};
+}
+
+std::string_view SourceManager::getLine(unsigned line) const {
+    if (lineStarts.empty())
+        buildLineStarts();
+
+    if (line == 0 || line > lineStarts.size())
+        return {};
+
+    const char* lineBegin = begin + lineStarts[line - 1];
+    const char* lineEnd = line < lineStarts.size() ? begin + lineStarts[line] - 1 : end;
+    return {lineBegin, size_t(lineEnd - lineBegin)};
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Position.hpp"
+#include "SourceBuffer.hpp"
+
+/**
+ * @brief Maps byte offsets in the source code to lines and columns
+ * @note Tokens and AST nodes store only a 32-bit offset. The line-start index is built (one memchr pass) on the first
+ * query, i.e. only when a diagnostic is actually formatted, and each query is a binary search over it.
+ */
+class SourceManager {
+    /**
+     * @brief Source code [begin, end), owned by the caller
+     */
+    const char* begin;
+    const char* end;
+
+    /**
+     * @brief Name of the source for diagnostics (e.g. the file name), may be empty
+     */
+    std::string name;
+
+    /**
+     * @brief Offset of the first character of each line, built lazily
+     */
+    mutable std::vector<uint32_t> lineStarts;
+
+    void buildLineStarts() const;
+
+   public:
+    /**
+     * @brief The range must outlive the source manager
+     */
+    SourceManager(const char* begin, const char* end, std::string name = "");
+
+    /**
+     * @brief The buffer must outlive the source manager
+     */
+    explicit SourceManager(const SourceBuffer& source, std::string name = "");
+
+    [[nodiscard]] const std::string& getName() const;
+
+    [[nodiscard]] size_t getSize() const;
+
+    /**
+     * @return Line and column (both starting at 1) of the character at 'offset', offsets past the end map to the end
+     */
+    [[nodiscard]] Position getPosition(uint32_t offset) const;
+
+    /**
+     * @return Text of the line (without the newline), empty if there is no such line
+     */
+    [[nodiscard]] std::string_view getLine(unsigned line) const;
+};
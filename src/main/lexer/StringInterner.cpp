@@ -0,0 +1,27 @@
+#include "StringInterner.hpp"
+#include "utils/Statistic.hpp"
+
+MILA_STATISTIC(NumInternedNames, "lexer", "Number of distinct identifiers interned");
+
+SymbolId StringInterner::intern(std::string_view name) {
+    auto [it, inserted] = ids.try_emplace(llvm::StringRef(name.data(), name.size()), SymbolId(names.size()));
+    if (inserted) {
+        ++NumInternedNames;
+        names.emplace_back(it->getKey().data(), it->getKey().size());
+    }
+
+    return it->getValue();
+}
+
+std::string_view StringInterner::getName(SymbolId id) const {
+    return names.at(static_cast<uint32_t>(id));
+}
+
+size_t StringInterner::size() const {
+    return names.size();
+}
+
+size_t StringInterner::getMemoryUsage() const {
+    return ids.getAllocator().getTotalMemory() + ids.getNumBuckets() * (sizeof(void*) + sizeof(uint32_t)) +
+           names.capacity() * sizeof(std::string_view);
+}
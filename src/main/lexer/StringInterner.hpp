@@ -0,0 +1,44 @@
+#pragma once
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/Allocator.h>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Stable 32-bit ID of an interned identifier, equal IDs mean equal names (within one interner)
+ */
+enum class SymbolId : uint32_t {};
+
+/**
+ * @brief Maps each distinct identifier of a compilation to a SymbolId
+ * @note Every distinct name is stored once in a bump allocated arena, so tokens carry just the ID and names are
+ * compared as integers. The views returned by getName() stay valid for the lifetime of the interner.
+ */
+class StringInterner {
+   private:
+    llvm::StringMap<SymbolId, llvm::BumpPtrAllocator> ids;
+
+    /**
+     * @brief SymbolId -> name, pointing into the entries of 'ids'
+     */
+    std::vector<std::string_view> names;
+
+   public:
+    /**
+     * @brief Returns the ID of the name, assigning the next free one on the first occurrence
+     */
+    SymbolId intern(std::string_view name);
+
+    [[nodiscard]] std::string_view getName(SymbolId id) const;
+
+    /**
+     * @brief Number of distinct names
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * @brief Bytes held by the interner (arena, hash table and ID table)
+     */
+    [[nodiscard]] size_t getMemoryUsage() const;
+};
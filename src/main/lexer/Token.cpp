@@ -1,4 +1,5 @@
 #include "Token.hpp"
+#include <cassert>
 
 std::ostream& operator<<(std::ostream& os, TokenType tokenType) noexcept {
     switch (tokenType) {
@@ -109,19 +110,61 @@ std::ostream& operator<<(std::ostream& os, TokenType tokenType) noexcept {
     }
 }
 
-Token::Token(TokenType tokenType, const Position& position, const std::optional<TokenValue>& value)
-    : type(tokenType), position(position), value(value) {}
+Token::Token(TokenType type, uint32_t offset) : offset(offset), type(type), intValue(0) {}
 
-Position Token::getPosition() const {
-    return position;
+Token::Token(TokenType type, uint32_t offset, int value) : Token(type, offset) {
+    intValue = value;
 }
 
-TokenType Token::getType() const {
-    return type;
+Token::Token(TokenType type, uint32_t offset, double value) : Token(type, offset) {
+    realValue = value;
 }
 
-std::optional<TokenValue> Token::getValue() const {
-    return value;
+Token::Token(TokenType type, uint32_t offset, SymbolId symbol) : Token(type, offset) {
+    this->symbol = symbol;
+}
+
+int Token::getInt() const {
+    assert(type == TokenType::INTEGER_LITERAL);
+    return intValue;
+}
+
+double Token::getReal() const {
+    assert(type == TokenType::REAL_LITERAL);
+    return realValue;
+}
+
+SymbolId Token::getSymbol() const {
+    assert(type == TokenType::IDENTIFIER);
+    return symbol;
+}
+
+TokenValue Token::getLiteralValue() const {
+    if (type == TokenType::REAL_LITERAL)
+        return realValue;
+
+    assert(type == TokenType::INTEGER_LITERAL);
+    return intValue;
+}
+
+std::optional<TokenValue> Token::getValue(const StringInterner& interner) const {
+    switch (type) {
+        case TokenType::INTEGER_LITERAL:
+            return intValue;
+        case TokenType::REAL_LITERAL:
+            return realValue;
+        case TokenType::IDENTIFIER:
+            return std::string(interner.getName(symbol));
+        default:
+            return std::nullopt;
+    }
+}
+
+void Token::print(std::ostream& os, const StringInterner& interner) const {
+    os << "(Token " << type;
+    if (auto value = getValue(interner))
+        os << " " << *value;
+    os << ")";
 }
 
 struct PrintVisitor {
@@ -143,9 +186,9 @@ std::ostream& operator<<(std::ostream& os, const TokenValue& tokVal) noexcept {
 
 std::ostream& operator<<(std::ostream& os, const Token& token) noexcept {
     os << "(Token " << token.getType();
-    if (token.getValue()) {
-        os << " ";
-        os << *token.getValue();
-    }
+    if (token.getType() == TokenType::IDENTIFIER)
+        os << " symbol: " << static_cast<uint32_t>(token.getSymbol());
+    else if (token.getType() == TokenType::INTEGER_LITERAL || token.getType() == TokenType::REAL_LITERAL)
+        os << " " << token.getLiteralValue();
     return os << ")";
 }
@@ -1,10 +1,11 @@
 #pragma once
+#include <cstdint>
 #include <iostream>
 #include <optional>
 #include <variant>
-#include "Position.hpp"
+#include "StringInterner.hpp"
 
-enum class TokenType {
+enum class TokenType : uint8_t {
     // end of file
     EOI,  // EOF
 
@@ -76,23 +77,68 @@ std::ostream& operator<<(std::ostream& os, TokenType tokenType) noexcept;
 using TokenValue = std::variant<int, double, std::string>;
 std::ostream& operator<<(std::ostream& os, const TokenValue& tokVal) noexcept;
 
+/**
+ * @brief Trivially copyable 16-byte token, identifiers are referred to by their SymbolId in the lexer's StringInterner
+ */
 class Token {
+    /**
+     * @brief Offset in the source code where the token starts, line and column are resolved by the SourceManager
+     */
+    uint32_t offset;
+
     TokenType type;
 
+    union {
+        int intValue;
+        double realValue;
+        SymbolId symbol;
+    };
+
+   public:
+    Token(TokenType type, uint32_t offset);
+    Token(TokenType type, uint32_t offset, int value);
+    Token(TokenType type, uint32_t offset, double value);
+    Token(TokenType type, uint32_t offset, SymbolId symbol);
+
+    [[nodiscard]] TokenType getType() const { return type; }
+    [[nodiscard]] uint32_t getOffset() const { return offset; }
+
     /**
-     * @brief Position in the source code where the token starts
+     * @pre The token is an INTEGER_LITERAL
      */
-    Position position;
+    [[nodiscard]] int getInt() const;
 
-    std::optional<TokenValue> value;
+    /**
+     * @pre The token is a REAL_LITERAL
+     */
+    [[nodiscard]] double getReal() const;
 
-   public:
-    Token(TokenType type, const Position& position,
-          const std::optional<TokenValue>& value = std::nullopt);
+    /**
+     * @pre The token is an IDENTIFIER
+     */
+    [[nodiscard]] SymbolId getSymbol() const;
+
+    /**
+     * @return The value of an INTEGER_LITERAL or REAL_LITERAL token
+     */
+    [[nodiscard]] TokenValue getLiteralValue() const;
+
+    /**
+     * @return The literal value or the identifier name (resolved with the lexer's interner), std::nullopt for tokens
+     * without a value
+     */
+    [[nodiscard]] std::optional<TokenValue> getValue(const StringInterner& interner) const;
 
-    [[nodiscard]] TokenType getType() const;
-    [[nodiscard]] Position getPosition() const;
-    [[nodiscard]] std::optional<TokenValue> getValue() const;
+    /**
+     * @brief Prints the token like operator<<, with identifiers resolved to their names
+     */
+    void print(std::ostream& os, const StringInterner& interner) const;
 };
 
+static_assert(sizeof(Token) == 16, "tokens are passed and stored by value, keep them compact");
+static_assert(std::is_trivially_copyable_v<Token>);
+
+/**
+ * @brief Prints the token, identifiers as their SymbolId
+ */
 std::ostream& operator<<(std::ostream& os, const Token& token) noexcept;
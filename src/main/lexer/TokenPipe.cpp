@@ -0,0 +1,124 @@
+#include "TokenPipe.hpp"
+#include <llvm/Support/MathExtras.h>
+#include <algorithm>
+
+namespace {
+/**
+ * @brief Backs off while the other side catches up: spins briefly (the common case is a short stall), then yields the
+ * core
+ */
+void backOff(unsigned& attempts) {
+    if (++attempts > 64)
+        std::this_thread::yield();
+}
+}  // namespace
+
+TokenPipe::TokenPipe(const char* begin, const char* end, size_t capacity)
+    : begin(begin),
+      end(end),
+      slots(std::make_unique<Slot[]>(llvm::PowerOf2Ceil(std::max<size_t>(capacity, 2)))),
+      mask(llvm::PowerOf2Ceil(std::max<size_t>(capacity, 2)) - 1),
+      sourceManager(begin, end),
+      timings(PhaseTimings::active()),
+      producer(&TokenPipe::produce, this) {}
+
+TokenPipe::TokenPipe(const SourceBuffer& source, size_t capacity) : TokenPipe(source.begin(), source.end(), capacity) {}
+
+TokenPipe::~TokenPipe() {
+    stopped.store(true, std::memory_order_relaxed);
+    producer.join();
+}
+
+void TokenPipe::produce() {
+    std::optional<PhaseTimings::Activation> activation;
+    if (timings)
+        activation.emplace(*timings);
+
+    PhaseTimer timer("Lexing (pipelined)");
+    try {
+        lexer.emplace(begin, end);
+        while (true) {
+            Token token = lexer->next();
+            if (!push(token) || token.getType() == TokenType::EOI)
+                break;
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    finished.store(true, std::memory_order_release);
+}
+
+bool TokenPipe::push(const Token& token) {
+    size_t index = tail.load(std::memory_order_relaxed);
+    unsigned attempts = 0;
+    while (index - cachedHead > mask) {
+        if (stopped.load(std::memory_order_relaxed))
+            return false;
+        backOff(attempts);
+        cachedHead = head.load(std::memory_order_acquire);
+    }
+
+    Slot& slot = slots[index & mask];
+    slot.token = token;
+    if (token.getType() == TokenType::IDENTIFIER)
+        slot.name = lexer->getInterner().getName(token.getSymbol());
+    tail.store(index + 1, std::memory_order_release);
+    return true;
+}
+
+void TokenPipe::fetch() {
+    size_t index = head.load(std::memory_order_relaxed);
+    unsigned attempts = 0;
+    while (index == cachedTail) {
+        cachedTail = tail.load(std::memory_order_acquire);
+        if (index != cachedTail)
+            break;
+
+        // Tokens pushed before the producer finished are visible once 'finished' is
+        if (finished.load(std::memory_order_acquire)) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (index != cachedTail)
+                break;
+            std::rethrow_exception(error);
+        }
+        backOff(attempts);
+    }
+
+    const Slot& slot = slots[index & mask];
+    // First occurrence of the name, the consumer assigns the same ID as the producer did
+    if (slot.token.getType() == TokenType::IDENTIFIER &&
+        static_cast<uint32_t>(slot.token.getSymbol()) >= interner.size())
+        interner.intern(slot.name);
+    current = slot.token;
+}
+
+const Token& TokenPipe::peek() {
+    if (!current)
+        fetch();
+    return *current;
+}
+
+Token TokenPipe::next() {
+    Token token = peek();
+    // EOI stays in the ring, like the lexer keeps returning it at the end of the input
+    if (token.getType() != TokenType::EOI) {
+        current.reset();
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    return token;
+}
+
+std::optional<Token> TokenPipe::match(TokenType tokenType) {
+    if (peek().getType() != tokenType)
+        return std::nullopt;
+    return next();
+}
+
+const StringInterner& TokenPipe::getInterner() const {
+    return interner;
+}
+
+const SourceManager& TokenPipe::getSourceManager() const {
+    return sourceManager;
+}
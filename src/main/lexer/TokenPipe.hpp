@@ -0,0 +1,144 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include "Lexer.hpp"
+#include "SourceManager.hpp"
+#include "StringInterner.hpp"
+#include "Token.hpp"
+#include "utils/PhaseTimer.hpp"
+
+/**
+ * @brief Lexes on a producer thread into a bounded single-producer/single-consumer ring, the parser (the consumer)
+ * pops the tokens concurrently, so lexing overlaps with parsing
+ * @note The ring is lock-free: each side owns one index and publishes it with a release store, the other side
+ * acquires it and keeps a cached copy so it touches the shared cache line only when the ring looks full/empty. A full
+ * ring blocks the producer (back-pressure) and an empty one the consumer. Identifier names travel with the tokens and
+ * are re-interned on the consumer side on their first occurrence (the IDs match, they are assigned in the order of the
+ * first occurrence on both sides), so the threads never share the interner. A LexerException of the producer is
+ * rethrown to the consumer once it has popped all the tokens lexed before the error.
+ */
+class TokenPipe {
+   public:
+    /**
+     * @brief Default number of slots of the ring (a power of two), 32 B each
+     */
+    static constexpr size_t defaultCapacity = 4096;
+
+    /**
+     * @brief Starts lexing [begin, end) on the producer thread, the range must outlive the pipe
+     * @param capacity Number of slots of the ring, rounded up to a power of two
+     */
+    TokenPipe(const char* begin, const char* end, size_t capacity = defaultCapacity);
+    explicit TokenPipe(const SourceBuffer& source, size_t capacity = defaultCapacity);
+
+    /**
+     * @brief Stops the producer (even if it waits on a full ring) and joins it
+     */
+    ~TokenPipe();
+
+    // The producer thread refers to the pipe
+    TokenPipe(const TokenPipe&) = delete;
+    TokenPipe& operator=(const TokenPipe&) = delete;
+
+    /**
+     * @return Next token without consuming it, waits for the producer if the ring is empty
+     * @throws LexerException If the producer failed to lex the next token
+     */
+    [[nodiscard]] const Token& peek();
+
+    /**
+     * @brief Consumes and returns the next token (the final EOI is never consumed)
+     * @throws LexerException If the producer failed to lex the next token
+     */
+    Token next();
+
+    /**
+     * @brief Matches the next token with the given token type. If successful, the token is consumed
+     * @return The matched token or std::nullopt if the token does not match the given token type.
+     */
+    std::optional<Token> match(TokenType tokenType);
+
+    /**
+     * @brief Names of the identifiers popped so far (consumer side)
+     */
+    [[nodiscard]] const StringInterner& getInterner() const;
+
+    [[nodiscard]] const SourceManager& getSourceManager() const;
+
+   private:
+    struct Slot {
+        Token token{TokenType::EOI, 0};
+
+        /**
+         * @brief Name of an IDENTIFIER, points into the interner of the producer's lexer
+         */
+        std::string_view name;
+    };
+
+    const char* begin;
+    const char* end;
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+
+    /**
+     * @brief Producer side: the next slot to fill ('tail' is published to the consumer), the consumer's index as last
+     * seen
+     */
+    alignas(64) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+
+    /**
+     * @brief Consumer side: the next slot to pop ('head' is published to the producer), the producer's index as last
+     * seen
+     */
+    alignas(64) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+
+    /**
+     * @brief Set by the producer after its last push (EOI or error), 'error' is written before it
+     */
+    alignas(64) std::atomic<bool> finished{false};
+    std::exception_ptr error;
+
+    /**
+     * @brief Set by the destructor to release a producer blocked on a full ring
+     */
+    std::atomic<bool> stopped{false};
+
+    /**
+     * @brief Consumer side: the token at 'head' once it has been fetched, and the re-interned names
+     */
+    std::optional<Token> current;
+    StringInterner interner;
+    SourceManager sourceManager;
+
+    /**
+     * @brief Phase registry of the thread that created the pipe, activated on the producer thread too
+     */
+    PhaseTimings* timings;
+
+    /**
+     * @brief Owned by the producer thread, it keeps the names of the slots alive until the pipe is destroyed
+     */
+    std::optional<Lexer> lexer;
+
+    std::thread producer;
+
+    void produce();
+
+    /**
+     * @return Whether the token was pushed, false if the pipe is being destroyed
+     */
+    bool push(const Token& token);
+
+    /**
+     * @brief Makes the token at 'head' the current one, waits for the producer if needed
+     */
+    void fetch();
+};
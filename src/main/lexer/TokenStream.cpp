@@ -0,0 +1,105 @@
+#include "TokenStream.hpp"
+#include <algorithm>
+#include <cassert>
+#include "Lexer.hpp"
+#include "utils/PhaseTimer.hpp"
+
+TokenStream::TokenStream(const char* begin, const char* end) : sourceManager(begin, end) {}
+
+TokenStream TokenStream::lex(const char* begin, const char* end) {
+    PhaseTimer timer("Lexing");
+    TokenStream stream(begin, end);
+
+    // Roughly one token per 4 characters of typical source, avoids most of the regrowth
+    size_t expectedTokens = (end - begin) / 4 + 1;
+    stream.kinds.reserve(expectedTokens);
+    stream.offsets.reserve(expectedTokens);
+    stream.payloads.reserve(expectedTokens);
+
+    Lexer lexer(begin, end);
+    while (true) {
+        Token token = lexer.next();
+
+        uint32_t payload = 0;
+        switch (token.getType()) {
+            case TokenType::IDENTIFIER:
+                payload = static_cast<uint32_t>(token.getSymbol());
+                break;
+            case TokenType::INTEGER_LITERAL:
+                payload = static_cast<uint32_t>(token.getInt());
+                break;
+            case TokenType::REAL_LITERAL:
+                payload = stream.realLiterals.size();
+                stream.realLiterals.push_back(token.getReal());
+                break;
+            default:
+                break;
+        }
+
+        stream.kinds.push_back(token.getType());
+        stream.offsets.push_back(token.getOffset());
+        stream.payloads.push_back(payload);
+
+        if (token.getType() == TokenType::EOI)
+            break;
+    }
+
+    // The estimate is generous for long identifiers, the stream lives as long as the parse
+    stream.kinds.shrink_to_fit();
+    stream.offsets.shrink_to_fit();
+    stream.payloads.shrink_to_fit();
+
+    stream.interner = lexer.takeInterner();
+    return stream;
+}
+
+TokenStream TokenStream::lex(const SourceBuffer& source) {
+    return lex(source.begin(), source.end());
+}
+
+uint32_t TokenStream::getOffset(size_t index) const {
+    return offsets[std::min(index, offsets.size() - 1)];
+}
+
+Token TokenStream::getToken(size_t index) const {
+    index = std::min(index, kinds.size() - 1);
+
+    switch (kinds[index]) {
+        case TokenType::IDENTIFIER:
+            return {TokenType::IDENTIFIER, offsets[index], SymbolId(payloads[index])};
+        case TokenType::INTEGER_LITERAL:
+            return {TokenType::INTEGER_LITERAL, offsets[index], static_cast<int>(payloads[index])};
+        case TokenType::REAL_LITERAL:
+            return {TokenType::REAL_LITERAL, offsets[index], realLiterals[payloads[index]]};
+        default:
+            return {kinds[index], offsets[index]};
+    }
+}
+
+size_t TokenStream::findMatchingEnd(size_t beginIndex) const {
+    assert(getKind(beginIndex) == TokenType::BEGIN);
+
+    unsigned depth = 0;
+    for (size_t i = beginIndex; i < kinds.size(); ++i) {
+        if (kinds[i] == TokenType::BEGIN) {
+            ++depth;
+        } else if (kinds[i] == TokenType::END && --depth == 0) {
+            return i;
+        }
+    }
+
+    return kinds.size() - 1;
+}
+
+const StringInterner& TokenStream::getInterner() const {
+    return interner;
+}
+
+const SourceManager& TokenStream::getSourceManager() const {
+    return sourceManager;
+}
+
+size_t TokenStream::getMemoryUsage() const {
+    return kinds.capacity() * sizeof(TokenType) + offsets.capacity() * sizeof(uint32_t) +
+           payloads.capacity() * sizeof(uint32_t) + realLiterals.capacity() * sizeof(double);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "SourceBuffer.hpp"
+#include "SourceManager.hpp"
+#include "StringInterner.hpp"
+#include "Token.hpp"
+
+/**
+ * @brief The whole source lexed up front into parallel arrays (structure of arrays), consumed by an index cursor
+ * @note Parsing then walks dense arrays sequentially, any token is reachable in O(1) (k-token lookahead) and blocks can
+ * be skipped by scanning just the kinds. The stream is immutable once lexed and owns the identifier names, positions
+ * are resolved from the offsets by the SourceManager (the source must outlive the stream).
+ */
+class TokenStream {
+   private:
+    std::vector<TokenType> kinds;
+
+    /**
+     * @brief Offset of the first character of the token in the source code
+     */
+    std::vector<uint32_t> offsets;
+
+    /**
+     * @brief SymbolId of an IDENTIFIER, value of an INTEGER_LITERAL, index into 'realLiterals' of a REAL_LITERAL
+     */
+    std::vector<uint32_t> payloads;
+
+    std::vector<double> realLiterals;
+
+    StringInterner interner;
+
+    SourceManager sourceManager;
+
+    TokenStream(const char* begin, const char* end);
+
+   public:
+    /**
+     * @brief Lexes [begin, end) completely, the range must outlive the stream (for the SourceManager only)
+     * @throws LexerException On the first invalid token
+     */
+    [[nodiscard]] static TokenStream lex(const char* begin, const char* end);
+    [[nodiscard]] static TokenStream lex(const SourceBuffer& source);
+
+    /**
+     * @brief Number of tokens, including the final EOI
+     */
+    [[nodiscard]] size_t size() const { return kinds.size(); }
+
+    /**
+     * @return Kind of the token at 'index', EOI past the end
+     */
+    [[nodiscard]] TokenType getKind(size_t index) const {
+        return index < kinds.size() ? kinds[index] : TokenType::EOI;
+    }
+
+    [[nodiscard]] uint32_t getOffset(size_t index) const;
+
+    /**
+     * @brief Materializes the token at 'index' (the EOI token past the end)
+     */
+    [[nodiscard]] Token getToken(size_t index) const;
+
+    /**
+     * @brief Finds the END closing the BEGIN at 'beginIndex' by counting the nesting depth over the kinds only
+     * @return Index of the matching END, or of the EOI token if the block is not closed
+     */
+    [[nodiscard]] size_t findMatchingEnd(size_t beginIndex) const;
+
+    [[nodiscard]] const StringInterner& getInterner() const;
+
+    [[nodiscard]] const SourceManager& getSourceManager() const;
+
+    /**
+     * @brief Bytes held by the token arrays (without the interner and the line index of the SourceManager)
+     */
+    [[nodiscard]] size_t getMemoryUsage() const;
+};
@@ -1,109 +1,169 @@
 #include "Parser.hpp"
+#include <array>
+#include <tuple>
 
-Parser::Parser(Lexer& lexer, bool dumpRules) : lexer(lexer), dumpRules(dumpRules) {}
+Parser::Parser(Lexer& lexer, ASTContext& context, bool dumpRules, std::ostream& dumpOut)
+    : lexer(&lexer), tracer(dumpRules ? std::make_unique<RuleTracer>(dumpOut) : nullptr), context(context) {}
 
-void Parser::report(const std::string& rule) const {
-    if (!dumpRules)
-        return;
-    std::cout << rule << std::endl;
+Parser::Parser(TokenPipe& pipe, ASTContext& context, bool dumpRules, std::ostream& dumpOut)
+    : pipe(&pipe), tracer(dumpRules ? std::make_unique<RuleTracer>(dumpOut) : nullptr), context(context) {}
+
+Parser::Parser(const TokenStream& stream, ASTContext& context, bool dumpRules, std::ostream& dumpOut)
+    : stream(&stream), tracer(dumpRules ? std::make_unique<RuleTracer>(dumpOut) : nullptr), context(context) {}
+
+Token Parser::peek() const {
+    if (stream)
+        return stream->getToken(cursor);
+    return pipe ? pipe->peek() : lexer->peek();
+}
+
+TokenType Parser::peekType() const {
+    if (stream)
+        return stream->getKind(cursor);
+    return pipe ? pipe->peek().getType() : lexer->peek().getType();
+}
+
+const StringInterner& Parser::getInterner() const {
+    if (stream)
+        return stream->getInterner();
+    return pipe ? pipe->getInterner() : lexer->getInterner();
 }
 
-Token Parser::match(std::initializer_list<TokenType> tokenTypes, const std::string& rule) {
+const SourceManager& Parser::getSourceManager() const {
+    if (stream)
+        return stream->getSourceManager();
+    return pipe ? pipe->getSourceManager() : lexer->getSourceManager();
+}
+
+ParserException Parser::error(std::string_view rule, const std::set<TokenType>& expectedTokenTypes) const {
+    Token actualToken = peek();
+    return {std::string(rule), actualToken, getSourceManager().getPosition(actualToken.getOffset()),
+            expectedTokenTypes};
+}
+
+const std::string& Parser::getName(SymbolId symbol) {
+    auto index = static_cast<uint32_t>(symbol);
+    if (index >= names.size())
+        names.resize(index + 1, nullptr);
+    if (!names[index])
+        names[index] = &context.getName(getInterner().getName(symbol));
+    return *names[index];
+}
+
+Parser::NestingGuard::NestingGuard(Parser& parser, std::string_view rule) : parser(parser) {
+    if (parser.nestingDepth == maxNestingDepth) {
+        Token token = parser.peek();
+        throw ParserException(std::string(rule), parser.getSourceManager().getPosition(token.getOffset()),
+                              "Nesting is deeper than " + std::to_string(maxNestingDepth) + " levels.");
+    }
+    ++parser.nestingDepth;
+}
+
+Parser::NestingGuard::~NestingGuard() {
+    --parser.nestingDepth;
+}
+
+Token Parser::match(std::initializer_list<TokenType> tokenTypes, std::string_view rule) {
     for (const auto& tokenType : tokenTypes) {
-        if (auto token = lexer.match(tokenType)) {
-            std::ostringstream oss;
-            oss << "match " << token.value();
-            report(oss.str());
+        std::optional<Token> token;
+        if (stream) {
+            if (stream->getKind(cursor) == tokenType)
+                token = stream->getToken(cursor++);
+        } else if (pipe) {
+            token = pipe->match(tokenType);
+        } else {
+            token = lexer->match(tokenType);
+        }
+
+        if (token) {
+            if (tracer)
+                tracer->matched(*token, getInterner());
 
             return token.value();
         }
     }
 
-    throw ParserException(rule, lexer.peek(), tokenTypes);
+    throw error(rule, tokenTypes);
 }
 
-Token Parser::match(TokenType tokenType, const std::string& rule) {
+Token Parser::match(TokenType tokenType, std::string_view rule) {
     return match({tokenType}, rule);
 }
 
 /* ----------------- Recursive descent functions ----------------- */
 
-std::unique_ptr<ProgramASTNode> Parser::parseProgram() {
-    switch (lexer.peek().getType()) {
+ProgramASTNode* Parser::parseProgram() {
+    switch (peekType()) {
         case TokenType::PROGRAM: {
             report("Program -> <PROGRAM> <IDENTIFIER> <SEMICOLON> Block <DOT>");
-            match(TokenType::PROGRAM, "Program");
+            auto programToken = match(TokenType::PROGRAM, "Program");
             auto identToken = match(TokenType::IDENTIFIER, "Program");
             match(TokenType::SEMICOLON, "Program");
             auto blockNode = parseBlock();
             match(TokenType::DOT, "Program");
-            return std::make_unique<ProgramASTNode>(std::get<std::string>(identToken.getValue().value()),
-                                                    std::move(blockNode));
+            return at(programToken,
+                      context.create<ProgramASTNode>(getName(identToken.getSymbol()), blockNode));
         }
         default:
-            throw ParserException("Program", lexer.peek(), {TokenType::PROGRAM});
+            throw error("Program", {TokenType::PROGRAM});
     }
 }
 
-std::unique_ptr<BlockASTNode> Parser::parseBlock() {
-    switch (lexer.peek().getType()) {
+BlockASTNode* Parser::parseBlock() {
+    switch (peekType()) {
         case TokenType::CONST:
         case TokenType::VAR:
         case TokenType::PROCEDURE:
         case TokenType::FUNCTION:
         case TokenType::BEGIN: {
             report("Block -> BlockDecl CompoundStatement");
-            std::vector<std::unique_ptr<StatementASTNode>> statementNodes;
+            std::vector<StatementASTNode*> statementNodes;
             parseBlockDecl(statementNodes);
             statementNodes.push_back(parseCompoundStatement());
-            return std::make_unique<BlockASTNode>(std::move(statementNodes));
+            return context.create<BlockASTNode>(context.copyArray(statementNodes));
         }
         default:
-            throw ParserException(
-                "Block", lexer.peek(),
-                {TokenType::CONST, TokenType::VAR, TokenType::PROCEDURE, TokenType::FUNCTION, TokenType::BEGIN});
+            throw error("Block", {TokenType::CONST, TokenType::VAR, TokenType::PROCEDURE, TokenType::FUNCTION,
+                                  TokenType::BEGIN});
     }
 }
 
-void Parser::parseBlockDecl(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes) {
-    switch (lexer.peek().getType()) {
-        case TokenType::CONST: {
-            report("BlockDecl ⟶ ConstantDefinitionList BlockDecl");
-            parseConstantDefinitionList(statementNodes);
-            parseBlockDecl(statementNodes);
-            break;
-        }
-        case TokenType::VAR: {
-            report("BlockDecl ⟶ VariableDeclarationList BlockDecl");
-            parseVariableDeclarationList(statementNodes);
-            parseBlockDecl(statementNodes);
-            break;
-        }
-        case TokenType::PROCEDURE: {
-            report("BlockDecl ⟶ ProcedureDeclaration BlockDecl");
-            parseProcedureDeclaration(statementNodes);
-            parseBlockDecl(statementNodes);
-            break;
-        }
-        case TokenType::FUNCTION: {
-            report("BlockDecl ⟶ FunctionDeclaration BlockDecl");
-            parseFunctionDeclaration(statementNodes);
-            parseBlockDecl(statementNodes);
-            break;
-        }
-        case TokenType::BEGIN: {
-            report("BlockDecl ->");
-            break;
+void Parser::parseBlockDecl(std::vector<StatementASTNode*>& statementNodes) {
+    while (true) {
+        switch (peekType()) {
+            case TokenType::CONST: {
+                report("BlockDecl ⟶ ConstantDefinitionList BlockDecl");
+                parseConstantDefinitionList(statementNodes);
+                break;
+            }
+            case TokenType::VAR: {
+                report("BlockDecl ⟶ VariableDeclarationList BlockDecl");
+                parseVariableDeclarationList(statementNodes);
+                break;
+            }
+            case TokenType::PROCEDURE: {
+                report("BlockDecl ⟶ ProcedureDeclaration BlockDecl");
+                parseProcedureDeclaration(statementNodes);
+                break;
+            }
+            case TokenType::FUNCTION: {
+                report("BlockDecl ⟶ FunctionDeclaration BlockDecl");
+                parseFunctionDeclaration(statementNodes);
+                break;
+            }
+            case TokenType::BEGIN: {
+                report("BlockDecl ->");
+                return;
+            }
+            default:
+                throw error("BlockDecl", {TokenType::CONST, TokenType::VAR, TokenType::PROCEDURE, TokenType::FUNCTION,
+                                          TokenType::BEGIN});
         }
-        default:
-            throw ParserException(
-                "BlockDecl", lexer.peek(),
-                {TokenType::CONST, TokenType::VAR, TokenType::PROCEDURE, TokenType::FUNCTION, TokenType::BEGIN});
     }
 }
 
 Token Parser::parseUnsignedNumber() {
-    switch (lexer.peek().getType()) {
+    switch (peekType()) {
         case TokenType::INTEGER_LITERAL: {
             report("UnsignedNumber -> <INTEGER_LITERAL>");
             return match(TokenType::INTEGER_LITERAL, "UnsignedNumber");
@@ -113,13 +173,13 @@ Token Parser::parseUnsignedNumber() {
             return match(TokenType::REAL_LITERAL, "UnsignedNumber");
         }
         default:
-            throw ParserException("UnsignedNumber", lexer.peek(),
-                                  {TokenType::REAL_LITERAL, TokenType::INTEGER_LITERAL});
+            throw error("UnsignedNumber", {TokenType::REAL_LITERAL, TokenType::INTEGER_LITERAL});
     }
 }
 
-std::unique_ptr<TypeASTNode> Parser::parseType() {
-    switch (lexer.peek().getType()) {
+TypeASTNode* Parser::parseType() {
+    NestingGuard guard(*this, "Type");
+    switch (peekType()) {
         case TokenType::INTEGER:
         case TokenType::REAL: {
             report("Type -> PrimitiveType");
@@ -130,29 +190,29 @@ std::unique_ptr<TypeASTNode> Parser::parseType() {
             return parseArrayType();
         }
         default:
-            throw ParserException("Type", lexer.peek(), {TokenType::REAL, TokenType::INTEGER, TokenType::ARRAY});
+            throw error("Type", {TokenType::REAL, TokenType::INTEGER, TokenType::ARRAY});
     }
 }
 
-std::unique_ptr<PrimitiveTypeASTNode> Parser::parsePrimitiveType() {
-    switch (lexer.peek().getType()) {
+PrimitiveTypeASTNode* Parser::parsePrimitiveType() {
+    switch (peekType()) {
         case TokenType::REAL: {
             report("PrimitiveType -> <REAL>");
             match(TokenType::REAL, "PrimitiveType");
-            return std::make_unique<PrimitiveTypeASTNode>(PrimitiveTypeASTNode::PrimitiveType::REAL);
+            return context.create<PrimitiveTypeASTNode>(PrimitiveTypeASTNode::PrimitiveType::REAL);
         }
         case TokenType::INTEGER: {
             report("PrimitiveType -> <INTEGER>");
             match(TokenType::INTEGER, "PrimitiveType");
-            return std::make_unique<PrimitiveTypeASTNode>(PrimitiveTypeASTNode::PrimitiveType::INTEGER);
+            return context.create<PrimitiveTypeASTNode>(PrimitiveTypeASTNode::PrimitiveType::INTEGER);
         }
         default:
-            throw ParserException("PrimitiveType", lexer.peek(), {TokenType::REAL, TokenType::INTEGER});
+            throw error("PrimitiveType", {TokenType::REAL, TokenType::INTEGER});
     }
 }
 
-std::unique_ptr<ArrayTypeASTNode> Parser::parseArrayType() {
-    switch (lexer.peek().getType()) {
+ArrayTypeASTNode* Parser::parseArrayType() {
+    switch (peekType()) {
         case TokenType::ARRAY: {
             report(
                 "ArrayType -> <ARRAY> <LEFT_BRACKET> SignedInteger <DOUBLE_DOT> SignedInteger <RIGHT_BRACKET> <OF> "
@@ -165,35 +225,35 @@ std::unique_ptr<ArrayTypeASTNode> Parser::parseArrayType() {
             match(TokenType::RIGHT_BRACKET, "ArrayType");
             match(TokenType::OF, "ArrayType");
             auto typeNode = parsePrimitiveType();
-            return std::make_unique<ArrayTypeASTNode>(std::move(typeNode), lowerBound, upperBound);
+            return context.create<ArrayTypeASTNode>(typeNode, lowerBound, upperBound);
         }
         default:
-            throw ParserException("ArrayType", lexer.peek(), {TokenType::ARRAY});
+            throw error("ArrayType", {TokenType::ARRAY});
     }
 }
 
 int Parser::parseSignedInteger() {
-    switch (lexer.peek().getType()) {
+    switch (peekType()) {
         case TokenType::INTEGER_LITERAL: {
             report("SignedInteger -> <INTEGER_LITERAL>");
             auto intToken = match(TokenType::INTEGER_LITERAL, "SignedInteger");
-            int value = std::get<int>(intToken.getValue().value());
+            int value = intToken.getInt();
             return value;
         }
         case TokenType::MINUS: {
             report("SignedInteger -> <MINUS> <INTEGER_LITERAL>");
             match(TokenType::MINUS, "SignedInteger");
             auto intToken = match(TokenType::INTEGER_LITERAL, "SignedInteger");
-            int value = std::get<int>(intToken.getValue().value());
+            int value = intToken.getInt();
             return -value;
         }
         default:
-            throw ParserException("SignedInteger", lexer.peek(), {TokenType::INTEGER_LITERAL, TokenType::MINUS});
+            throw error("SignedInteger", {TokenType::INTEGER_LITERAL, TokenType::MINUS});
     }
 }
 
-void Parser::parseConstantDefinitionList(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes) {
-    switch (lexer.peek().getType()) {
+void Parser::parseConstantDefinitionList(std::vector<StatementASTNode*>& statementNodes) {
+    switch (peekType()) {
         case TokenType::CONST: {
             report("ConstantDefinitionList -> <CONST> ConstantDefinition ConstantDefinitionListR");
             match(TokenType::CONST, "ConstantDefinitionList");
@@ -202,53 +262,52 @@ void Parser::parseConstantDefinitionList(std::vector<std::unique_ptr<StatementAS
             break;
         }
         default:
-            throw ParserException("ConstantDefinitionList", lexer.peek(), {TokenType::CONST});
+            throw error("ConstantDefinitionList", {TokenType::CONST});
     }
 }
 
-void Parser::parseConstantDefinitionListR(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes) {
-    switch (lexer.peek().getType()) {
-        case TokenType::IDENTIFIER: {
-            report("ConstantDefinitionListR -> ConstantDefinition ConstantDefinitionListR");
-            parseConstantDefinition(statementNodes);
-            parseConstantDefinitionListR(statementNodes);
-            break;
-        }
-        case TokenType::CONST:
-        case TokenType::VAR:
-        case TokenType::PROCEDURE:
-        case TokenType::FUNCTION:
-        case TokenType::BEGIN: {
-            report("ConstantDefinitionListR ->");
-            break;
+void Parser::parseConstantDefinitionListR(std::vector<StatementASTNode*>& statementNodes) {
+    while (true) {
+        switch (peekType()) {
+            case TokenType::IDENTIFIER: {
+                report("ConstantDefinitionListR -> ConstantDefinition ConstantDefinitionListR");
+                parseConstantDefinition(statementNodes);
+                break;
+            }
+            case TokenType::CONST:
+            case TokenType::VAR:
+            case TokenType::PROCEDURE:
+            case TokenType::FUNCTION:
+            case TokenType::BEGIN: {
+                report("ConstantDefinitionListR ->");
+                return;
+            }
+            default:
+                throw error("ConstantDefinitionListR", {TokenType::IDENTIFIER, TokenType::CONST, TokenType::VAR,
+                                                        TokenType::PROCEDURE, TokenType::FUNCTION, TokenType::BEGIN});
         }
-        default:
-            throw ParserException("ConstantDefinitionListR", lexer.peek(),
-                                  {TokenType::IDENTIFIER, TokenType::CONST, TokenType::VAR, TokenType::PROCEDURE,
-                                   TokenType::FUNCTION, TokenType::BEGIN});
     }
 }
 
-void Parser::parseConstantDefinition(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes) {
-    switch (lexer.peek().getType()) {
+void Parser::parseConstantDefinition(std::vector<StatementASTNode*>& statementNodes) {
+    switch (peekType()) {
         case TokenType::IDENTIFIER: {
             report("ConstantDefinition -> <IDENTIFIER> <EQUAL> Expression <SEMICOLON>");
             auto identToken = match(TokenType::IDENTIFIER, "ConstantDefinition");
             match(TokenType::EQUAL, "ConstantDefinition");
             auto exprNode = parseExpression();
             match(TokenType::SEMICOLON, "ConstantDefinition");
-            auto constDefNode = std::make_unique<ConstDefASTNode>(std::get<std::string>(identToken.getValue().value()),
-                                                                  std::move(exprNode));
-            statementNodes.push_back(std::move(constDefNode));
+            statementNodes.push_back(
+                at(identToken, context.create<ConstDefASTNode>(getName(identToken.getSymbol()), exprNode)));
             break;
         }
         default:
-            throw ParserException("ConstantDefinition", lexer.peek(), {TokenType::IDENTIFIER});
+            throw error("ConstantDefinition", {TokenType::IDENTIFIER});
     }
 }
 
-void Parser::parseVariableDeclarationList(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes) {
-    switch (lexer.peek().getType()) {
+void Parser::parseVariableDeclarationList(std::vector<StatementASTNode*>& statementNodes) {
+    switch (peekType()) {
         case TokenType::VAR: {
             report("VariableDeclarationList -> <VAR> VariableDeclarationGroup VariableDeclarationListR");
             match(TokenType::VAR, "VariableDeclarationList");
@@ -257,86 +316,88 @@ void Parser::parseVariableDeclarationList(std::vector<std::unique_ptr<StatementA
             break;
         }
         default:
-            throw ParserException("VariableDeclarationList", lexer.peek(), {TokenType::VAR});
+            throw error("VariableDeclarationList", {TokenType::VAR});
     }
 }
 
-void Parser::parseVariableDeclarationListR(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes) {
-    switch (lexer.peek().getType()) {
-        case TokenType::IDENTIFIER: {
-            report("VariableDeclarationListR -> VariableDeclarationGroup VariableDeclarationListR");
-            parseVariableDeclarationGroup(statementNodes);
-            parseVariableDeclarationListR(statementNodes);
-            break;
-        }
-        case TokenType::CONST:
-        case TokenType::VAR:
-        case TokenType::PROCEDURE:
-        case TokenType::FUNCTION:
-        case TokenType::BEGIN: {
-            report("VariableDeclarationListR ->");
-            break;
+void Parser::parseVariableDeclarationListR(std::vector<StatementASTNode*>& statementNodes) {
+    while (true) {
+        switch (peekType()) {
+            case TokenType::IDENTIFIER: {
+                report("VariableDeclarationListR -> VariableDeclarationGroup VariableDeclarationListR");
+                parseVariableDeclarationGroup(statementNodes);
+                break;
+            }
+            case TokenType::CONST:
+            case TokenType::VAR:
+            case TokenType::PROCEDURE:
+            case TokenType::FUNCTION:
+            case TokenType::BEGIN: {
+                report("VariableDeclarationListR ->");
+                return;
+            }
+            default:
+                throw error("VariableDeclarationListR", {TokenType::IDENTIFIER, TokenType::CONST, TokenType::VAR,
+                                                         TokenType::PROCEDURE, TokenType::FUNCTION, TokenType::BEGIN});
         }
-        default:
-            throw ParserException("VariableDeclarationListR", lexer.peek(),
-                                  {TokenType::IDENTIFIER, TokenType::CONST, TokenType::VAR, TokenType::PROCEDURE,
-                                   TokenType::FUNCTION, TokenType::BEGIN});
     }
 }
 
-void Parser::parseVariableDeclarationGroup(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes) {
-    switch (lexer.peek().getType()) {
+void Parser::parseVariableDeclarationGroup(std::vector<StatementASTNode*>& statementNodes) {
+    switch (peekType()) {
         case TokenType::IDENTIFIER: {
             report("VariableDeclarationGroup -> IdentifierList <COLON> Type <SEMICOLON>");
             auto idents = parseIdentifierList();
             match(TokenType::COLON, "VariableDeclarationGroup");
             auto commonTypeNode = parseType();
-            for (const auto& ident : idents)
-                statementNodes.push_back(commonTypeNode->createDeclNode(ident));
+            for (const Token& ident : idents)
+                statementNodes.push_back(
+                    at(ident, commonTypeNode->createDeclNode(context, getName(ident.getSymbol()))));
             match(TokenType::SEMICOLON, "VariableDeclarationGroup");
             break;
         }
         default:
-            throw ParserException("VariableDeclarationGroup", lexer.peek(), {TokenType::IDENTIFIER});
+            throw error("VariableDeclarationGroup", {TokenType::IDENTIFIER});
     }
 }
 
-std::vector<std::string> Parser::parseIdentifierList() {
-    switch (lexer.peek().getType()) {
+std::vector<Token> Parser::parseIdentifierList() {
+    switch (peekType()) {
         case TokenType::IDENTIFIER: {
             report("IdentifierList -> <IDENTIFIER> IdentifierListR");
             auto identToken = match(TokenType::IDENTIFIER, "IdentifierList");
-            std::vector<std::string> idents;
-            idents.push_back(std::get<std::string>(identToken.getValue().value()));
+            std::vector<Token> idents;
+            idents.push_back(identToken);
             parseIdentifierListR(idents);
             return idents;
         }
         default:
-            throw ParserException("IdentifierList", lexer.peek(), {TokenType::IDENTIFIER});
+            throw error("IdentifierList", {TokenType::IDENTIFIER});
     }
 }
 
-void Parser::parseIdentifierListR(std::vector<std::string>& identifiers) {
-    switch (lexer.peek().getType()) {
-        case TokenType::COMMA: {
-            report("IdentifierListR -> <COMMA> <IDENTIFIER> IdentifierListR");
-            match(TokenType::COMMA, "IdentifierListR");
-            auto identToken = match(TokenType::IDENTIFIER, "IdentifierListR");
-            identifiers.push_back(std::get<std::string>(identToken.getValue().value()));
-            parseIdentifierListR(identifiers);
-            break;
-        }
-        case TokenType::COLON: {
-            report("IdentifierListR ->");
-            break;
+void Parser::parseIdentifierListR(std::vector<Token>& identifiers) {
+    while (true) {
+        switch (peekType()) {
+            case TokenType::COMMA: {
+                report("IdentifierListR -> <COMMA> <IDENTIFIER> IdentifierListR");
+                match(TokenType::COMMA, "IdentifierListR");
+                auto identToken = match(TokenType::IDENTIFIER, "IdentifierListR");
+                identifiers.push_back(identToken);
+                break;
+            }
+            case TokenType::COLON: {
+                report("IdentifierListR ->");
+                return;
+            }
+            default:
+                throw error("IdentifierListR", {TokenType::COMMA, TokenType::COLON});
         }
-        default:
-            throw ParserException("IdentifierListR", lexer.peek(), {TokenType::COMMA, TokenType::COLON});
     }
 }
 
-void Parser::parseProcedureDeclaration(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes) {
-    switch (lexer.peek().getType()) {
+void Parser::parseProcedureDeclaration(std::vector<StatementASTNode*>& statementNodes) {
+    switch (peekType()) {
         case TokenType::PROCEDURE: {
             report(
                 "ProcedureDeclaration -> <PROCEDURE> <IDENTIFIER> FunctionParameters <SEMICOLON> "
@@ -346,18 +407,19 @@ void Parser::parseProcedureDeclaration(std::vector<std::unique_ptr<StatementASTN
             auto paramNodes = parseFunctionParameters();
             match(TokenType::SEMICOLON, "ProcedureDeclaration");
             auto optBlockNode = parseBodyOrForward();
-            statementNodes.push_back(std::make_unique<ProcDeclASTNode>(
-                std::get<std::string>(identToken.getValue().value()), std::move(paramNodes), std::move(optBlockNode)));
+            statementNodes.push_back(at(identToken, context.create<ProcDeclASTNode>(getName(identToken.getSymbol()),
+                                                                                    context.copyArray(paramNodes),
+                                                                                    optBlockNode)));
             match(TokenType::SEMICOLON, "ProcedureDeclaration");
             break;
         }
         default:
-            throw ParserException("ProcedureDeclaration", lexer.peek(), {TokenType::PROCEDURE});
+            throw error("ProcedureDeclaration", {TokenType::PROCEDURE});
     }
 }
 
-void Parser::parseFunctionDeclaration(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes) {
-    switch (lexer.peek().getType()) {
+void Parser::parseFunctionDeclaration(std::vector<StatementASTNode*>& statementNodes) {
+    switch (peekType()) {
         case TokenType::FUNCTION: {
             report(
                 "FunctionDeclaration -> <FUNCTION> <IDENTIFIER> FunctionParameters <COLON> PrimitiveType "
@@ -370,19 +432,19 @@ void Parser::parseFunctionDeclaration(std::vector<std::unique_ptr<StatementASTNo
             auto retPrimitiveTypeNode = parsePrimitiveType();
             match(TokenType::SEMICOLON, "FunctionDeclaration");
             auto optBlockNode = parseBodyOrForward();
-            statementNodes.push_back(std::make_unique<FunDeclASTNode>(
-                std::get<std::string>(identToken.getValue().value()), std::move(paramNodes), std::move(optBlockNode),
-                std::move(retPrimitiveTypeNode)));
+            statementNodes.push_back(at(identToken, context.create<FunDeclASTNode>(
+                                                        getName(identToken.getSymbol()), context.copyArray(paramNodes),
+                                                        optBlockNode, retPrimitiveTypeNode)));
             match(TokenType::SEMICOLON, "FunctionDeclaration");
             break;
         }
         default:
-            throw ParserException("FunctionDeclaration", lexer.peek(), {TokenType::FUNCTION});
+            throw error("FunctionDeclaration", {TokenType::FUNCTION});
     }
 }
 
-std::vector<std::unique_ptr<VarDeclASTNode>> Parser::parseFunctionParameters() {
-    switch (lexer.peek().getType()) {
+std::vector<VarDeclASTNode*> Parser::parseFunctionParameters() {
+    switch (peekType()) {
         case TokenType::LEFT_PAREN: {
             report("FunctionParameters -> <LEFT_PAREN> FormalParameterList <RIGHT_PAREN>");
             match(TokenType::LEFT_PAREN, "FunctionDeclaration");
@@ -391,15 +453,15 @@ std::vector<std::unique_ptr<VarDeclASTNode>> Parser::parseFunctionParameters() {
             return paramNodes;
         }
         default:
-            throw ParserException("FunctionParameters", lexer.peek(), {TokenType::LEFT_PAREN});
+            throw error("FunctionParameters", {TokenType::LEFT_PAREN});
     }
 }
 
-std::vector<std::unique_ptr<VarDeclASTNode>> Parser::parseFormalParameterList() {
-    switch (lexer.peek().getType()) {
+std::vector<VarDeclASTNode*> Parser::parseFormalParameterList() {
+    switch (peekType()) {
         case TokenType::IDENTIFIER: {
             report("FormalParameterList -> ParameterGroup FormalParameterListR");
-            std::vector<std::unique_ptr<VarDeclASTNode>> paramNodes;
+            std::vector<VarDeclASTNode*> paramNodes;
             parseParameterGroup(paramNodes);
             parseFormalParameterListR(paramNodes);
             return paramNodes;
@@ -409,48 +471,50 @@ std::vector<std::unique_ptr<VarDeclASTNode>> Parser::parseFormalParameterList()
             return {};
         }
         default:
-            throw ParserException("FormalParameterList", lexer.peek(), {TokenType::IDENTIFIER, TokenType::RIGHT_PAREN});
+            throw error("FormalParameterList", {TokenType::IDENTIFIER, TokenType::RIGHT_PAREN});
     }
 }
 
-void Parser::parseFormalParameterListR(std::vector<std::unique_ptr<VarDeclASTNode>>& parameterNodes) {
-    switch (lexer.peek().getType()) {
-        case TokenType::SEMICOLON: {
-            report("FormalParameterListR -> <SEMICOLON> ParameterGroup FormalParameterListR");
-            match(TokenType::SEMICOLON, "FormalParameterListR");
-            parseParameterGroup(parameterNodes);
-            parseFormalParameterListR(parameterNodes);
-            break;
-        }
-        case TokenType::RIGHT_PAREN: {
-            report("FormalParameterListR ->");
-            break;
+void Parser::parseFormalParameterListR(std::vector<VarDeclASTNode*>& parameterNodes) {
+    while (true) {
+        switch (peekType()) {
+            case TokenType::SEMICOLON: {
+                report("FormalParameterListR -> <SEMICOLON> ParameterGroup FormalParameterListR");
+                match(TokenType::SEMICOLON, "FormalParameterListR");
+                parseParameterGroup(parameterNodes);
+                break;
+            }
+            case TokenType::RIGHT_PAREN: {
+                report("FormalParameterListR ->");
+                return;
+            }
+            default:
+                throw error("FormalParameterListR", {TokenType::SEMICOLON, TokenType::RIGHT_PAREN});
         }
-        default:
-            throw ParserException("FormalParameterListR", lexer.peek(), {TokenType::SEMICOLON, TokenType::RIGHT_PAREN});
     }
 }
 
-void Parser::parseParameterGroup(std::vector<std::unique_ptr<VarDeclASTNode>>& parameterNodes) {
-    switch (lexer.peek().getType()) {
+void Parser::parseParameterGroup(std::vector<VarDeclASTNode*>& parameterNodes) {
+    switch (peekType()) {
         case TokenType::IDENTIFIER: {
             report("ParameterGroup -> IdentifierList <COLON> PrimitiveType");
             auto idents = parseIdentifierList();
             match(TokenType::COLON, "ParameterGroup");
             auto commonTypeNode = parsePrimitiveType();
-            for (const auto& ident : idents) {
-                auto typeNode = std::make_unique<PrimitiveTypeASTNode>(commonTypeNode->getPrimitiveType());
-                parameterNodes.push_back(std::make_unique<VarDeclASTNode>(ident, std::move(typeNode)));
+            for (const Token& ident : idents) {
+                auto typeNode = context.create<PrimitiveTypeASTNode>(commonTypeNode->getPrimitiveType());
+                parameterNodes.push_back(
+                    at(ident, context.create<VarDeclASTNode>(getName(ident.getSymbol()), typeNode)));
             }
             break;
         }
         default:
-            throw ParserException("ParameterGroup", lexer.peek(), {TokenType::IDENTIFIER});
+            throw error("ParameterGroup", {TokenType::IDENTIFIER});
     }
 }
 
-std::optional<std::unique_ptr<BlockASTNode>> Parser::parseBodyOrForward() {
-    switch (lexer.peek().getType()) {
+std::optional<BlockASTNode*> Parser::parseBodyOrForward() {
+    switch (peekType()) {
         case TokenType::FORWARD: {
             report("BodyOrForward -> <FORWARD>");
             match(TokenType::FORWARD, "BodyOrForward");
@@ -463,53 +527,53 @@ std::optional<std::unique_ptr<BlockASTNode>> Parser::parseBodyOrForward() {
             return parseBody();
         }
         default:
-            throw ParserException("BodyOrForward", lexer.peek(),
-                                  {TokenType::FORWARD, TokenType::BEGIN, TokenType::CONST, TokenType::VAR});
+            throw error("BodyOrForward", {TokenType::FORWARD, TokenType::BEGIN, TokenType::CONST, TokenType::VAR});
     }
 }
 
-std::unique_ptr<BlockASTNode> Parser::parseBody() {
-    switch (lexer.peek().getType()) {
+BlockASTNode* Parser::parseBody() {
+    switch (peekType()) {
         case TokenType::CONST:
         case TokenType::VAR:
         case TokenType::BEGIN: {
             report("Body -> BodyDecl CompoundStatement");
-            std::vector<std::unique_ptr<StatementASTNode>> statementNodes;
+            std::vector<StatementASTNode*> statementNodes;
             parseBodyDecl(statementNodes);
             statementNodes.push_back(parseCompoundStatement());
-            return std::make_unique<BlockASTNode>(std::move(statementNodes));
+            return context.create<BlockASTNode>(context.copyArray(statementNodes));
         }
         default:
-            throw ParserException("Body", lexer.peek(), {TokenType::BEGIN, TokenType::CONST, TokenType::VAR});
+            throw error("Body", {TokenType::BEGIN, TokenType::CONST, TokenType::VAR});
     }
 
 }
 
-void Parser::parseBodyDecl(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes) {
-    switch (lexer.peek().getType()) {
-        case TokenType::CONST: {
-            report("BodyDecl -> ConstantDefinitionList BodyDecl");
-            parseConstantDefinitionList(statementNodes);
-            parseBodyDecl(statementNodes);
-            break;
-        }
-        case TokenType::VAR: {
-            report("BodyDecl -> VariableDeclarationList BodyDecl");
-            parseVariableDeclarationList(statementNodes);
-            parseBodyDecl(statementNodes);
-            break;
-        }
-        case TokenType::BEGIN: {
-            report("BodyDecl ->");
-            break;
+void Parser::parseBodyDecl(std::vector<StatementASTNode*>& statementNodes) {
+    while (true) {
+        switch (peekType()) {
+            case TokenType::CONST: {
+                report("BodyDecl -> ConstantDefinitionList BodyDecl");
+                parseConstantDefinitionList(statementNodes);
+                break;
+            }
+            case TokenType::VAR: {
+                report("BodyDecl -> VariableDeclarationList BodyDecl");
+                parseVariableDeclarationList(statementNodes);
+                break;
+            }
+            case TokenType::BEGIN: {
+                report("BodyDecl ->");
+                return;
+            }
+            default:
+                throw error("BodyDecl", {TokenType::CONST, TokenType::VAR, TokenType::BEGIN});
         }
-        default:
-            throw ParserException("BodyDecl", lexer.peek(), {TokenType::CONST, TokenType::VAR, TokenType::BEGIN});
     }
 }
 
-std::unique_ptr<StatementASTNode> Parser::parseStatement() {
-    switch (lexer.peek().getType()) {
+StatementASTNode* Parser::parseStatement() {
+    NestingGuard guard(*this, "Statement");
+    switch (peekType()) {
         case TokenType::EXIT:
         case TokenType::BREAK:
         case TokenType::IDENTIFIER:
@@ -527,15 +591,14 @@ std::unique_ptr<StatementASTNode> Parser::parseStatement() {
             return parseComplexStatement();
         }
         default:
-            throw ParserException(
-                "Statement", lexer.peek(),
-                {TokenType::ELSE, TokenType::BREAK, TokenType::SEMICOLON, TokenType::EXIT, TokenType::IDENTIFIER,
-                 TokenType::BEGIN, TokenType::IF, TokenType::FOR, TokenType::WHILE, TokenType::END});
+            throw error("Statement", {TokenType::ELSE, TokenType::BREAK, TokenType::SEMICOLON, TokenType::EXIT,
+                                      TokenType::IDENTIFIER, TokenType::BEGIN, TokenType::IF, TokenType::FOR,
+                                      TokenType::WHILE, TokenType::END});
     }
 }
 
-std::unique_ptr<StatementASTNode> Parser::parseSimpleStatement() {
-    switch (lexer.peek().getType()) {
+StatementASTNode* Parser::parseSimpleStatement() {
+    switch (peekType()) {
         case TokenType::ELSE:
         case TokenType::END:
         case TokenType::SEMICOLON: {
@@ -544,52 +607,53 @@ std::unique_ptr<StatementASTNode> Parser::parseSimpleStatement() {
         }
         case TokenType::EXIT: {
             report("SimpleStatement -> <EXIT>");
-            match(TokenType::EXIT, "SimpleStatement");
-            return std::make_unique<ExitASTNode>();
+            auto exitToken = match(TokenType::EXIT, "SimpleStatement");
+            return at(exitToken, context.create<ExitASTNode>());
         }
         case TokenType::BREAK: {
             report("SimpleStatement -> <BREAK>");
-            match(TokenType::BREAK, "SimpleStatement");
-            return std::make_unique<BreakASTNode>();
+            auto breakToken = match(TokenType::BREAK, "SimpleStatement");
+            return at(breakToken, context.create<BreakASTNode>());
         }
         case TokenType::IDENTIFIER: {
             report("SimpleStatement -> <IDENTIFIER> SimpleStatementIdentifierContinuation");
             auto identifierToken = match(TokenType::IDENTIFIER, "SimpleStatement");
-            return parseSimpleStatementIdentifierContinuation(
-                std::get<std::string>(identifierToken.getValue().value()));
+            return parseSimpleStatementIdentifierContinuation(identifierToken);
         }
         default:
-            throw ParserException("SimpleStatement", lexer.peek(),
-                                  {TokenType::ELSE, TokenType::END, TokenType::BREAK, TokenType::SEMICOLON,
-                                   TokenType::EXIT, TokenType::IDENTIFIER});
+            throw error("SimpleStatement", {TokenType::ELSE, TokenType::END, TokenType::BREAK, TokenType::SEMICOLON,
+                                            TokenType::EXIT, TokenType::IDENTIFIER});
     }
 }
 
-std::unique_ptr<StatementASTNode> Parser::parseSimpleStatementIdentifierContinuation(const std::string& identifier) {
-    switch (lexer.peek().getType()) {
+StatementASTNode* Parser::parseSimpleStatementIdentifierContinuation(const Token& identifier) {
+    switch (peekType()) {
         case TokenType::LEFT_PAREN: {
             report("SimpleStatementIdentifierContinuation -> FunctionArgs");
-            return std::make_unique<ProcCallASTNode>(identifier, parseFunctionArgs());
+            return at(identifier, context.create<ProcCallASTNode>(getName(identifier.getSymbol()),
+                                                                  context.copyArray(parseFunctionArgs())));
         }
         case TokenType::LEFT_BRACKET:
         case TokenType::ASSIGN: {
             report("SimpleStatementIdentifierContinuation -> OptionalArrayAccess <ASSIGN> Expression");
             auto arrayRefNode = parseOptionalArrayAccess(identifier);
-            match(TokenType::ASSIGN, "SimpleStatementIdentifierContinuation");
+            auto assignToken = match(TokenType::ASSIGN, "SimpleStatementIdentifierContinuation");
             if (arrayRefNode)
-                return std::make_unique<AssignASTNode>(std::move(arrayRefNode), parseExpression());
+                return at(assignToken, context.create<AssignASTNode>(arrayRefNode, parseExpression()));
             else
-                return std::make_unique<AssignASTNode>(std::make_unique<DeclVarRefASTNode>(identifier),
-                                                       parseExpression());
+                return at(assignToken,
+                          context.create<AssignASTNode>(
+                              at(identifier, context.create<DeclVarRefASTNode>(getName(identifier.getSymbol()))),
+                              parseExpression()));
         }
         default:
-            throw ParserException("SimpleStatementIdentifierContinuation", lexer.peek(),
-                                  {TokenType::ASSIGN, TokenType::LEFT_BRACKET, TokenType::LEFT_PAREN});
+            throw error("SimpleStatementIdentifierContinuation",
+                        {TokenType::ASSIGN, TokenType::LEFT_BRACKET, TokenType::LEFT_PAREN});
     }
 }
 
-std::unique_ptr<DeclArrayRefASTNode> Parser::parseOptionalArrayAccess(const std::string& identifier) {
-    switch (lexer.peek().getType()) {
+DeclArrayRefASTNode* Parser::parseOptionalArrayAccess(const Token& identifier) {
+    switch (peekType()) {
         case TokenType::LEFT_BRACKET: {
             report("OptionalArrayAccess -> ArrayAccess");
             return parseArrayAccess(identifier);
@@ -599,40 +663,40 @@ std::unique_ptr<DeclArrayRefASTNode> Parser::parseOptionalArrayAccess(const std:
             return nullptr;
         }
         default:
-            throw ParserException("ArrayAccess", lexer.peek(), {TokenType::LEFT_BRACKET, TokenType::ASSIGN});
+            throw error("ArrayAccess", {TokenType::LEFT_BRACKET, TokenType::ASSIGN});
     }
 }
 
-std::unique_ptr<DeclArrayRefASTNode> Parser::parseArrayAccess(const std::string& identifier) {
-    switch (lexer.peek().getType()) {
+DeclArrayRefASTNode* Parser::parseArrayAccess(const Token& identifier) {
+    switch (peekType()) {
         case TokenType::LEFT_BRACKET: {
             report("ArrayAccess -> <LEFT_BRACKET> Expression <RIGHT_BRACKET>");
             match(TokenType::LEFT_BRACKET, "ArrayAccess");
             auto indexNode = parseExpression();
             match(TokenType::RIGHT_BRACKET, "ArrayAccess");
-            return std::make_unique<DeclArrayRefASTNode>(identifier, std::move(indexNode));
+            return at(identifier,
+                      context.create<DeclArrayRefASTNode>(getName(identifier.getSymbol()), indexNode));
         }
         default:
-            throw ParserException("ArrayAccess", lexer.peek(), {TokenType::LEFT_BRACKET});
+            throw error("ArrayAccess", {TokenType::LEFT_BRACKET});
     }
 }
 
-std::unique_ptr<StatementASTNode> Parser::parseEmptyStatement() {
-    switch (lexer.peek().getType()) {
+StatementASTNode* Parser::parseEmptyStatement() {
+    switch (peekType()) {
         case TokenType::ELSE:
         case TokenType::END:
         case TokenType::SEMICOLON: {
             report("EmptyStatement ->");
-            return std::make_unique<EmptyStmtASTNode>();
+            return context.create<EmptyStmtASTNode>();
         }
         default:
-            throw ParserException("EmptyStatement", lexer.peek(),
-                                  {TokenType::ELSE, TokenType::SEMICOLON, TokenType::END});
+            throw error("EmptyStatement", {TokenType::ELSE, TokenType::SEMICOLON, TokenType::END});
     }
 }
 
-std::unique_ptr<StatementASTNode> Parser::parseComplexStatement() {
-    switch (lexer.peek().getType()) {
+StatementASTNode* Parser::parseComplexStatement() {
+    switch (peekType()) {
         case TokenType::BEGIN: {
             report("ComplexStatement -> CompoundStatement");
             return parseCompoundStatement();
@@ -650,120 +714,137 @@ std::unique_ptr<StatementASTNode> Parser::parseComplexStatement() {
             return parseForStatement();
         }
         default:
-            throw ParserException("ComplexStatement", lexer.peek(),
-                                  {TokenType::BEGIN, TokenType::IF, TokenType::FOR, TokenType::WHILE});
+            throw error("ComplexStatement", {TokenType::BEGIN, TokenType::IF, TokenType::FOR, TokenType::WHILE});
     }
 }
 
-std::unique_ptr<CompoundStmtASTNode> Parser::parseCompoundStatement() {
-    switch (lexer.peek().getType()) {
+CompoundStmtASTNode* Parser::parseCompoundStatement() {
+    switch (peekType()) {
         case TokenType::BEGIN: {
             report("CompoundStatement -> <BEGIN> Statement CompoundStatementR <END>");
-            std::vector<std::unique_ptr<StatementASTNode>> statementNodes;
+            std::vector<StatementASTNode*> statementNodes;
             match(TokenType::BEGIN, "CompoundStatement");
             statementNodes.push_back(parseStatement());
             parseCompoundStatementR(statementNodes);
             match(TokenType::END, "CompoundStatement");
-            return std::make_unique<CompoundStmtASTNode>(std::move(statementNodes));
+            return context.create<CompoundStmtASTNode>(context.copyArray(statementNodes));
         }
         default:
-            throw ParserException("CompoundStatement", lexer.peek(), {TokenType::BEGIN});
+            throw error("CompoundStatement", {TokenType::BEGIN});
     }
 }
 
-void Parser::parseCompoundStatementR(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes) {
-    switch (lexer.peek().getType()) {
-        case TokenType::SEMICOLON: {
-            report("CompoundStatementR -> <SEMICOLON> Statement CompoundStatementR");
-            match(TokenType::SEMICOLON, "CompoundStatementR");
-            statementNodes.push_back(parseStatement());
-            parseCompoundStatementR(statementNodes);
-            break;
-        }
-        case TokenType::END: {
-            report("CompoundStatementR ->");
-            break;
+void Parser::parseCompoundStatementR(std::vector<StatementASTNode*>& statementNodes) {
+    while (true) {
+        switch (peekType()) {
+            case TokenType::SEMICOLON: {
+                report("CompoundStatementR -> <SEMICOLON> Statement CompoundStatementR");
+                match(TokenType::SEMICOLON, "CompoundStatementR");
+                statementNodes.push_back(parseStatement());
+                break;
+            }
+            case TokenType::END: {
+                report("CompoundStatementR ->");
+                return;
+            }
+            default:
+                throw error("CompoundStatementR", {TokenType::SEMICOLON, TokenType::END});
         }
-        default:
-            throw ParserException("CompoundStatementR", lexer.peek(), {TokenType::SEMICOLON, TokenType::END});
     }
 }
 
-std::unique_ptr<StatementASTNode> Parser::parseIfStatement() {
-    switch (lexer.peek().getType()) {
+StatementASTNode* Parser::parseIfStatement() {
+    switch (peekType()) {
         case TokenType::IF: {
-            report("IfStatement -> <IF> Expression <THEN> Statement ElseStatement");
-            match(TokenType::IF, "IfStatement");
-            auto condNode = parseExpression();
-            match(TokenType::THEN, "IfStatement");
-            auto bodyNode = parseStatement();
-            auto elseBodyNode = parseElseStatement();
-            return std::make_unique<IfASTNode>(std::move(condNode), std::move(bodyNode), std::move(elseBodyNode));
-        }
-        default:
-            throw ParserException("IfStatement", lexer.peek(), {TokenType::IF});
-    }
-}
+            // An 'else if' chain is parsed by this loop instead of recursing into each else branch, the IfASTNodes are
+            // then linked from the last one back to the first
+            std::vector<std::tuple<Token, ExprASTNode*, StatementASTNode*>> chain;
+            std::optional<StatementASTNode*> elseBodyNode;
+            bool elseIf = true;
+            while (elseIf) {
+                report("IfStatement -> <IF> Expression <THEN> Statement ElseStatement");
+                auto ifToken = match(TokenType::IF, "IfStatement");
+                auto condNode = parseExpression();
+                match(TokenType::THEN, "IfStatement");
+                auto bodyNode = parseStatement();
+                chain.emplace_back(ifToken, condNode, bodyNode);
+
+                // !!! Else statement is always connected with the deepest if statement to solve ambiguity
+                switch (peekType()) {
+                    case TokenType::ELSE: {
+                        report("ElseStatement-> <ELSE> Statement");
+                        match(TokenType::ELSE, "ElseStatement");
+                        if (peekType() == TokenType::IF) {
+                            report("Statement -> ComplexStatement");
+                            report("ComplexStatement -> IfStatement");
+                        } else {
+                            elseBodyNode = parseStatement();
+                            elseIf = false;
+                        }
+                        break;
+                    }
+                    case TokenType::END:
+                    case TokenType::SEMICOLON: {
+                        report("ElseStatement ->");
+                        elseIf = false;
+                        break;
+                    }
+                    default:
+                        throw error("ElseStatement", {TokenType::ELSE, TokenType::END, TokenType::SEMICOLON});
+                }
+            }
 
-// !!! Else statement is always connected with the deepest if statement to solve ambiguity
-std::optional<std::unique_ptr<StatementASTNode>> Parser::parseElseStatement() {
-    switch (lexer.peek().getType()) {
-        case TokenType::ELSE: {
-            report("ElseStatement-> <ELSE> Statement");
-            match(TokenType::ELSE, "ElseStatement");
-            return parseStatement();
-        }
-        case TokenType::END:
-        case TokenType::SEMICOLON: {
-            report("ElseStatement ->");
-            return std::nullopt;
+            for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+                auto& [ifToken, condNode, bodyNode] = *it;
+                elseBodyNode = at(ifToken, context.create<IfASTNode>(condNode, bodyNode, elseBodyNode));
+            }
+            return elseBodyNode.value();
         }
         default:
-            throw ParserException("ElseStatement", lexer.peek(),
-                                  {TokenType::ELSE, TokenType::END, TokenType::SEMICOLON});
+            throw error("IfStatement", {TokenType::IF});
     }
 }
 
-std::unique_ptr<WhileASTNode> Parser::parseWhileStatement() {
-    switch (lexer.peek().getType()) {
+WhileASTNode* Parser::parseWhileStatement() {
+    switch (peekType()) {
         case TokenType::WHILE: {
             report("WhileStatement -> <WHILE> Expression <DO> Statement");
-            match(TokenType::WHILE, "WhileStatement");
+            auto whileToken = match(TokenType::WHILE, "WhileStatement");
             auto condNode = parseExpression();
             match(TokenType::DO, "WhileStatement");
             auto bodyNode = parseStatement();
-            return std::make_unique<WhileASTNode>(std::move(condNode), std::move(bodyNode));
+            return at(whileToken, context.create<WhileASTNode>(condNode, bodyNode));
         }
         default:
-            throw ParserException("WhileStatement", lexer.peek(), {TokenType::WHILE});
+            throw error("WhileStatement", {TokenType::WHILE});
     }
 }
 
-std::unique_ptr<ForASTNode> Parser::parseForStatement() {
-    switch (lexer.peek().getType()) {
+ForASTNode* Parser::parseForStatement() {
+    switch (peekType()) {
         case TokenType::FOR: {
             report("ForStatement -> <FOR> <IDENTIFIER> <ASSIGN> Expression <TO> Expression <DO> Statement");
-            match(TokenType::FOR, "ForStatement");
+            auto forToken = match(TokenType::FOR, "ForStatement");
             auto identToken = match(TokenType::IDENTIFIER, "ForStatement");
-            match(TokenType::ASSIGN, "ForStatement");
-            auto initNode = std::make_unique<AssignASTNode>(
-                std::make_unique<DeclVarRefASTNode>(std::get<std::string>(identToken.getValue().value())),
-                parseExpression());
+            auto assignToken = match(TokenType::ASSIGN, "ForStatement");
+            auto initNode = at(assignToken, context.create<AssignASTNode>(
+                                                at(identToken, context.create<DeclVarRefASTNode>(
+                                                                   getName(identToken.getSymbol()))),
+                                                parseExpression()));
             auto toToken = parseTo();
             bool increasing = toToken.getType() == TokenType::TO;
             auto toNode = parseExpression();
             match(TokenType::DO, "ForStatement");
             auto statementNode = parseStatement();
-            return std::make_unique<ForASTNode>(std::move(initNode), std::move(toNode), std::move(statementNode),
-                                                increasing);
+            return at(forToken, context.create<ForASTNode>(initNode, toNode, statementNode, increasing));
         }
         default:
-            throw ParserException("ForStatement", lexer.peek(), {TokenType::FOR});
+            throw error("ForStatement", {TokenType::FOR});
     }
 }
 
 Token Parser::parseTo() {
-    switch (lexer.peek().getType()) {
+    switch (peekType()) {
         case TokenType::TO: {
             report("To -> <TO>");
             return match(TokenType::TO, "To");
@@ -773,182 +854,129 @@ Token Parser::parseTo() {
             return match(TokenType::DOWNTO, "To");
         }
         default:
-            throw ParserException("To", lexer.peek(), {TokenType::TO, TokenType::DOWNTO});
-    }
-}
-
-std::unique_ptr<ExprASTNode> Parser::parseExpression() {
-    switch (lexer.peek().getType()) {
+            throw error("To", {TokenType::TO, TokenType::DOWNTO});
+    }
+}
+
+namespace {
+
+/**
+ * @brief Binary operator of the precedence-climbing loop, the binding power is its precedence level (0 = not a binary
+ * operator) and the rule consumes it
+ */
+struct BinaryOperator {
+    int bindingPower = 0;
+    Token (Parser::*parseOperator)() = nullptr;
+};
+
+constexpr std::array<BinaryOperator, size_t(TokenType::DIV) + 1> makeBinaryOperators() {
+    std::array<BinaryOperator, size_t(TokenType::DIV) + 1> operators{};
+    operators[size_t(TokenType::OR)] = {1, &Parser::parseLogicalOrOperator};
+    operators[size_t(TokenType::AND)] = {2, &Parser::parseLogicalAndOperator};
+    operators[size_t(TokenType::EQUAL)] = {3, &Parser::parseEqualityOperator};
+    operators[size_t(TokenType::NOT_EQUAL)] = {3, &Parser::parseEqualityOperator};
+    operators[size_t(TokenType::LESS)] = {4, &Parser::parseRelationalOperator};
+    operators[size_t(TokenType::LESS_EQUAL)] = {4, &Parser::parseRelationalOperator};
+    operators[size_t(TokenType::GREATER)] = {4, &Parser::parseRelationalOperator};
+    operators[size_t(TokenType::GREATER_EQUAL)] = {4, &Parser::parseRelationalOperator};
+    operators[size_t(TokenType::PLUS)] = {5, &Parser::parseAdditiveOperator};
+    operators[size_t(TokenType::MINUS)] = {5, &Parser::parseAdditiveOperator};
+    operators[size_t(TokenType::MULTIPLY)] = {6, &Parser::parseMultiplicativeOperator};
+    operators[size_t(TokenType::DIVIDE)] = {6, &Parser::parseMultiplicativeOperator};
+    operators[size_t(TokenType::MOD)] = {6, &Parser::parseMultiplicativeOperator};
+    operators[size_t(TokenType::DIV)] = {6, &Parser::parseMultiplicativeOperator};
+    return operators;
+}
+
+// Indexed by TokenType, the levels of grammar.txt from LogicalOrExpression (loosest) to MultiplicativeExpression
+constexpr std::array<BinaryOperator, size_t(TokenType::DIV) + 1> binaryOperators = makeBinaryOperators();
+
+constexpr int lowestBindingPower = 1;
+
+}  // namespace
+
+ExprASTNode* Parser::parseExpression() {
+    NestingGuard guard(*this, "Expression");
+    switch (peekType()) {
         case TokenType::MINUS:
         case TokenType::NOT:
         case TokenType::IDENTIFIER:
         case TokenType::LEFT_PAREN:
         case TokenType::INTEGER_LITERAL:
         case TokenType::REAL_LITERAL: {
-            report("Expression -> LogicalOrExpression");
-            return parseLogicalOrExpression();
+            report("Expression -> BinaryExpression");
+            auto exprNode = parseBinaryExpression(lowestBindingPower);
+
+            // The loop stops at any token that is not a binary operator, only the follow set may end an expression
+            switch (peekType()) {
+                case TokenType::SEMICOLON:
+                case TokenType::RIGHT_BRACKET:
+                case TokenType::THEN:
+                case TokenType::DO:
+                case TokenType::TO:
+                case TokenType::DOWNTO:
+                case TokenType::RIGHT_PAREN:
+                case TokenType::COMMA:
+                case TokenType::END:
+                case TokenType::ELSE:
+                    return exprNode;
+                default:
+                    throw error("BinaryExpressionR",
+                                {TokenType::OR, TokenType::AND, TokenType::EQUAL, TokenType::NOT_EQUAL,
+                                 TokenType::LESS, TokenType::LESS_EQUAL, TokenType::GREATER, TokenType::GREATER_EQUAL,
+                                 TokenType::PLUS, TokenType::MINUS, TokenType::MULTIPLY, TokenType::DIVIDE,
+                                 TokenType::MOD, TokenType::DIV, TokenType::SEMICOLON, TokenType::RIGHT_BRACKET,
+                                 TokenType::THEN, TokenType::DO, TokenType::TO, TokenType::DOWNTO,
+                                 TokenType::RIGHT_PAREN, TokenType::COMMA, TokenType::END, TokenType::ELSE});
+            }
         }
         default:
-            throw ParserException("Expression", lexer.peek(),
-                                  {TokenType::MINUS, TokenType::NOT, TokenType::IDENTIFIER, TokenType::LEFT_PAREN,
-                                   TokenType::INTEGER_LITERAL, TokenType::REAL_LITERAL});
+            throw error("Expression", {TokenType::MINUS, TokenType::NOT, TokenType::IDENTIFIER, TokenType::LEFT_PAREN,
+                                       TokenType::INTEGER_LITERAL, TokenType::REAL_LITERAL});
     }
 }
 
-std::unique_ptr<ExprASTNode> Parser::parseLogicalOrExpression() {
-    switch (lexer.peek().getType()) {
-        case TokenType::MINUS:
-        case TokenType::NOT:
-        case TokenType::IDENTIFIER:
-        case TokenType::LEFT_PAREN:
-        case TokenType::INTEGER_LITERAL:
-        case TokenType::REAL_LITERAL: {
-            report("LogicalOrExpression -> LogicalAndExpression LogicalOrExpressionR");
-            auto lhsExprNode = parseLogicalAndExpression();
-            return parseLogicalOrExpressionR(std::move(lhsExprNode));
-        }
-        default:
-            throw ParserException("LogicalOrExpression", lexer.peek(),
-                                  {TokenType::MINUS, TokenType::NOT, TokenType::IDENTIFIER, TokenType::LEFT_PAREN,
-                                   TokenType::INTEGER_LITERAL, TokenType::REAL_LITERAL});
-    }
-}
+ExprASTNode* Parser::parseBinaryExpression(int minBindingPower) {
+    auto lhsExprNode = parseUnaryExpression();
 
-std::unique_ptr<ExprASTNode> Parser::parseLogicalOrExpressionR(std::unique_ptr<ExprASTNode> lhsExprNode) {
-    switch (lexer.peek().getType()) {
-        case TokenType::OR: {
-            report("LogicalOrExpressionR -> <OR> LogicalAndExpression LogicalOrExpressionR");
-            auto op = match(TokenType::OR, "LogicalOrExpressionR");
-            auto rhsExprNode = parseLogicalAndExpression();
-            auto newLhsExprNode = std::make_unique<BinOpASTNode>(op, std::move(lhsExprNode), std::move(rhsExprNode));
-            return parseLogicalOrExpressionR(std::move(newLhsExprNode));
-        }
-        case TokenType::SEMICOLON:
-        case TokenType::RIGHT_BRACKET:
-        case TokenType::THEN:
-        case TokenType::DO:
-        case TokenType::TO:
-        case TokenType::DOWNTO:
-        case TokenType::RIGHT_PAREN:
-        case TokenType::COMMA:
-        case TokenType::END:
-        case TokenType::ELSE: {
-            report("LogicalOrExpressionR ->");
+    // Operators binding at least as tightly as minBindingPower extend the left operand, the right operand only takes
+    // the tighter ones, so each level is left-associative exactly as the ...ExpressionR rules of grammar.txt
+    while (true) {
+        const BinaryOperator& binaryOperator = binaryOperators[size_t(peekType())];
+        if (binaryOperator.bindingPower < minBindingPower)
             return lhsExprNode;
-        }
-        default:
-            throw ParserException("LogicalOrExpressionR", lexer.peek(),
-                                  {TokenType::OR, TokenType::RIGHT_BRACKET, TokenType::THEN, TokenType::DO,
-                                   TokenType::TO, TokenType::DOWNTO, TokenType::RIGHT_PAREN, TokenType::COMMA,
-                                   TokenType::SEMICOLON, TokenType::END, TokenType::ELSE});
-    }
-}
-
-std::unique_ptr<ExprASTNode> Parser::parseLogicalAndExpression() {
-    switch (lexer.peek().getType()) {
-        case TokenType::MINUS:
-        case TokenType::NOT:
-        case TokenType::IDENTIFIER:
-        case TokenType::LEFT_PAREN:
-        case TokenType::INTEGER_LITERAL:
-        case TokenType::REAL_LITERAL: {
-            report("LogicalAndExpression -> EqualityExpression LogicalAndExpressionR");
-            auto lhsExprNode = parseEqualityExpression();
-            return parseLogicalAndExpressionR(std::move(lhsExprNode));
-        }
-        default:
-            throw ParserException("LogicalAndExpression", lexer.peek(),
-                                  {TokenType::MINUS, TokenType::NOT, TokenType::IDENTIFIER, TokenType::LEFT_PAREN,
-                                   TokenType::INTEGER_LITERAL, TokenType::REAL_LITERAL});
-    }
-}
 
-std::unique_ptr<ExprASTNode> Parser::parseLogicalAndExpressionR(std::unique_ptr<ExprASTNode> lhsExprNode) {
-    switch (lexer.peek().getType()) {
-        case TokenType::AND: {
-            report("LogicalAndExpressionR -> <AND> EqualityExpression LogicalAndExpressionR");
-            auto op = match(TokenType::AND, "LogicalAndExpressionR");
-            auto rhsExprNode = parseEqualityExpression();
-            auto newLhsExprNode = std::make_unique<BinOpASTNode>(op, std::move(lhsExprNode), std::move(rhsExprNode));
-            return parseLogicalAndExpressionR(std::move(newLhsExprNode));
-        }
-        case TokenType::OR:
-        case TokenType::SEMICOLON:
-        case TokenType::RIGHT_BRACKET:
-        case TokenType::THEN:
-        case TokenType::DO:
-        case TokenType::TO:
-        case TokenType::DOWNTO:
-        case TokenType::RIGHT_PAREN:
-        case TokenType::COMMA:
-        case TokenType::END:
-        case TokenType::ELSE: {
-            report("LogicalAndExpressionR ->");
-            return lhsExprNode;
-        }
-        default:
-            throw ParserException("LogicalAndExpressionR", lexer.peek(),
-                                  {TokenType::AND, TokenType::OR, TokenType::RIGHT_BRACKET, TokenType::THEN,
-                                   TokenType::DO, TokenType::TO, TokenType::DOWNTO, TokenType::RIGHT_PAREN,
-                                   TokenType::COMMA, TokenType::SEMICOLON, TokenType::END, TokenType::ELSE});
+        report("BinaryExpressionR -> BinaryOperator BinaryExpression BinaryExpressionR");
+        auto op = (this->*binaryOperator.parseOperator)();
+        auto rhsExprNode = parseBinaryExpression(binaryOperator.bindingPower + 1);
+        lhsExprNode = at(op, context.create<BinOpASTNode>(op, lhsExprNode, rhsExprNode));
     }
 }
 
-std::unique_ptr<ExprASTNode> Parser::parseEqualityExpression() {
-    switch (lexer.peek().getType()) {
-        case TokenType::MINUS:
-        case TokenType::NOT:
-        case TokenType::IDENTIFIER:
-        case TokenType::LEFT_PAREN:
-        case TokenType::INTEGER_LITERAL:
-        case TokenType::REAL_LITERAL: {
-            report("EqualityExpression -> RelationalExpression EqualityExpressionR");
-            auto lhsExprNode = parseRelationalExpression();
-            return parseEqualityExpressionR(std::move(lhsExprNode));
+Token Parser::parseLogicalOrOperator() {
+    switch (peekType()) {
+        case TokenType::OR: {
+            report("LogicalOrOperator -> <OR>");
+            return match(TokenType::OR, "LogicalOrOperator");
         }
         default:
-            throw ParserException("EqualityExpression", lexer.peek(),
-                                  {TokenType::MINUS, TokenType::NOT, TokenType::IDENTIFIER, TokenType::LEFT_PAREN,
-                                   TokenType::INTEGER_LITERAL, TokenType::REAL_LITERAL});
+            throw error("LogicalOrOperator", {TokenType::OR});
     }
 }
 
-std::unique_ptr<ExprASTNode> Parser::parseEqualityExpressionR(std::unique_ptr<ExprASTNode> lhsExprNode) {
-    switch (lexer.peek().getType()) {
-        case TokenType::EQUAL:
-        case TokenType::NOT_EQUAL: {
-            report("EqualityExpressionR -> EqualityOperator RelationalExpression EqualityExpressionR");
-            auto op = parseEqualityOperator();
-            auto rhsExprNode = parseRelationalExpression();
-            auto newLhsExprNode = std::make_unique<BinOpASTNode>(op, std::move(lhsExprNode), std::move(rhsExprNode));
-            return parseEqualityExpressionR(std::move(newLhsExprNode));
-        }
-        case TokenType::AND:
-        case TokenType::OR:
-        case TokenType::SEMICOLON:
-        case TokenType::RIGHT_BRACKET:
-        case TokenType::THEN:
-        case TokenType::DO:
-        case TokenType::TO:
-        case TokenType::DOWNTO:
-        case TokenType::RIGHT_PAREN:
-        case TokenType::COMMA:
-        case TokenType::END:
-        case TokenType::ELSE: {
-            report("EqualityExpressionR ->");
-            return lhsExprNode;
+Token Parser::parseLogicalAndOperator() {
+    switch (peekType()) {
+        case TokenType::AND: {
+            report("LogicalAndOperator -> <AND>");
+            return match(TokenType::AND, "LogicalAndOperator");
         }
         default:
-            throw ParserException(
-                "EqualityExpressionR", lexer.peek(),
-                {TokenType::EQUAL, TokenType::NOT_EQUAL, TokenType::AND, TokenType::OR, TokenType::RIGHT_BRACKET,
-                 TokenType::THEN, TokenType::DO, TokenType::TO, TokenType::DOWNTO, TokenType::RIGHT_PAREN,
-                 TokenType::COMMA, TokenType::SEMICOLON, TokenType::END, TokenType::ELSE});
+            throw error("LogicalAndOperator", {TokenType::AND});
     }
 }
 
 Token Parser::parseEqualityOperator() {
-    switch (lexer.peek().getType()) {
+    switch (peekType()) {
         case TokenType::EQUAL: {
             report("EqualityOperator -> <EQUAL>");
             return match(TokenType::EQUAL, "EqualityOperator");
@@ -958,70 +986,12 @@ Token Parser::parseEqualityOperator() {
             return match(TokenType::NOT_EQUAL, "EqualityOperator");
         }
         default:
-            throw ParserException("EqualityOperator", lexer.peek(), {TokenType::EQUAL, TokenType::NOT_EQUAL});
-    }
-}
-
-std::unique_ptr<ExprASTNode> Parser::parseRelationalExpression() {
-    switch (lexer.peek().getType()) {
-        case TokenType::MINUS:
-        case TokenType::NOT:
-        case TokenType::IDENTIFIER:
-        case TokenType::LEFT_PAREN:
-        case TokenType::INTEGER_LITERAL:
-        case TokenType::REAL_LITERAL: {
-            report("RelationalExpression -> AdditiveExpression RelationalExpressionR");
-            auto lhsExprNode = parseAdditiveExpression();
-            return parseRelationalExpressionR(std::move(lhsExprNode));
-        }
-        default:
-            throw ParserException("RelationalExpression", lexer.peek(),
-                                  {TokenType::MINUS, TokenType::NOT, TokenType::IDENTIFIER, TokenType::LEFT_PAREN,
-                                   TokenType::INTEGER_LITERAL, TokenType::REAL_LITERAL});
-    }
-}
-
-std::unique_ptr<ExprASTNode> Parser::parseRelationalExpressionR(std::unique_ptr<ExprASTNode> lhsExprNode) {
-    switch (lexer.peek().getType()) {
-        case TokenType::LESS:
-        case TokenType::LESS_EQUAL:
-        case TokenType::GREATER:
-        case TokenType::GREATER_EQUAL: {
-            report("RelationalExpressionR -> RelationalOperator AdditiveExpression RelationalExpressionR");
-            auto op = parseRelationalOperator();
-            auto rhsExprNode = parseAdditiveExpression();
-            auto newLhsExprNode = std::make_unique<BinOpASTNode>(op, std::move(lhsExprNode), std::move(rhsExprNode));
-            return parseRelationalExpressionR(std::move(newLhsExprNode));
-        }
-        case TokenType::EQUAL:
-        case TokenType::NOT_EQUAL:
-        case TokenType::AND:
-        case TokenType::OR:
-        case TokenType::RIGHT_BRACKET:
-        case TokenType::THEN:
-        case TokenType::DO:
-        case TokenType::TO:
-        case TokenType::DOWNTO:
-        case TokenType::RIGHT_PAREN:
-        case TokenType::COMMA:
-        case TokenType::SEMICOLON:
-        case TokenType::END:
-        case TokenType::ELSE: {
-            report("RelationalExpressionR ->");
-            return lhsExprNode;
-        }
-        default:
-            throw ParserException(
-                "RelationalExpressionR", lexer.peek(),
-                {TokenType::LESS, TokenType::LESS_EQUAL, TokenType::GREATER, TokenType::GREATER_EQUAL, TokenType::EQUAL,
-                 TokenType::NOT_EQUAL, TokenType::AND, TokenType::OR, TokenType::RIGHT_BRACKET, TokenType::THEN,
-                 TokenType::DO, TokenType::TO, TokenType::DOWNTO, TokenType::RIGHT_PAREN, TokenType::COMMA,
-                 TokenType::SEMICOLON, TokenType::END, TokenType::ELSE});
+            throw error("EqualityOperator", {TokenType::EQUAL, TokenType::NOT_EQUAL});
     }
 }
 
 Token Parser::parseRelationalOperator() {
-    switch (lexer.peek().getType()) {
+    switch (peekType()) {
         case TokenType::LESS: {
             report("RelationalOperator -> <LESS>");
             return match(TokenType::LESS, "RelationalOperator");
@@ -1039,88 +1009,13 @@ Token Parser::parseRelationalOperator() {
             return match(TokenType::GREATER_EQUAL, "RelationalOperator");
         }
         default:
-            throw ParserException(
-                "RelationalOperator", lexer.peek(),
-                {TokenType::LESS, TokenType::LESS_EQUAL, TokenType::GREATER, TokenType::GREATER_EQUAL});
-    }
-}
-
-std::unique_ptr<ExprASTNode> Parser::parseAdditiveExpression() {
-    switch (lexer.peek().getType()) {
-        case TokenType::MINUS:
-        case TokenType::NOT:
-        case TokenType::IDENTIFIER:
-        case TokenType::LEFT_PAREN:
-        case TokenType::INTEGER_LITERAL:
-        case TokenType::REAL_LITERAL: {
-            report("AdditiveExpression -> MultiplicativeExpression AdditiveExpressionR");
-            auto lhsExprNode = parseMultiplicativeExpression();
-            return parseAdditiveExpressionR(std::move(lhsExprNode));
-        }
-        default:
-            throw ParserException("AdditiveExpression", lexer.peek(),
-                                  {TokenType::MINUS, TokenType::NOT, TokenType::IDENTIFIER, TokenType::LEFT_PAREN,
-                                   TokenType::INTEGER_LITERAL, TokenType::REAL_LITERAL});
-    }
-}
-
-std::unique_ptr<ExprASTNode> Parser::parseAdditiveExpressionR(std::unique_ptr<ExprASTNode> lhsExprNode) {
-    switch (lexer.peek().getType()) {
-        case TokenType::PLUS:
-        case TokenType::MINUS: {
-            report("AdditiveExpressionR -> AdditiveOperator MultiplicativeExpression AdditiveExpressionR");
-            auto op = parseAdditiveOperator();
-            auto rhsExprNode = parseMultiplicativeExpression();
-            auto newLhsExprNode = std::make_unique<BinOpASTNode>(op, std::move(lhsExprNode), std::move(rhsExprNode));
-            return parseAdditiveExpressionR(std::move(newLhsExprNode));
-        }
-        case TokenType::LESS:
-        case TokenType::LESS_EQUAL:
-        case TokenType::GREATER:
-        case TokenType::GREATER_EQUAL:
-        case TokenType::EQUAL:
-        case TokenType::NOT_EQUAL:
-        case TokenType::AND:
-        case TokenType::OR:
-        case TokenType::RIGHT_BRACKET:
-        case TokenType::THEN:
-        case TokenType::DO:
-        case TokenType::TO:
-        case TokenType::DOWNTO:
-        case TokenType::RIGHT_PAREN:
-        case TokenType::COMMA:
-        case TokenType::SEMICOLON:
-        case TokenType::END:
-        case TokenType::ELSE: {
-            report("AdditiveExpressionR ->");
-            return lhsExprNode;
-        }
-        default:
-            throw ParserException("AdditiveExpressionR", lexer.peek(), {TokenType::PLUS,
-                                                                        TokenType::MINUS,
-                                                                        TokenType::LESS,
-                                                                        TokenType::LESS_EQUAL,
-                                                                        TokenType::GREATER,
-                                                                        TokenType::GREATER_EQUAL,
-                                                                        TokenType::EQUAL,
-                                                                        TokenType::NOT_EQUAL,
-                                                                        TokenType::AND,
-                                                                        TokenType::OR,
-                                                                        TokenType::RIGHT_BRACKET,
-                                                                        TokenType::THEN,
-                                                                        TokenType::DO,
-                                                                        TokenType::TO,
-                                                                        TokenType::DOWNTO,
-                                                                        TokenType::RIGHT_PAREN,
-                                                                        TokenType::COMMA,
-                                                                        TokenType::SEMICOLON,
-                                                                        TokenType::END,
-                                                                        TokenType::ELSE});
+            throw error("RelationalOperator", {TokenType::LESS, TokenType::LESS_EQUAL, TokenType::GREATER,
+                                               TokenType::GREATER_EQUAL});
     }
 }
 
 Token Parser::parseAdditiveOperator() {
-    switch (lexer.peek().getType()) {
+    switch (peekType()) {
         case TokenType::PLUS: {
             report("AdditiveOperator -> <PLUS>");
             return match(TokenType::PLUS, "AdditiveOperator");
@@ -1130,79 +1025,12 @@ Token Parser::parseAdditiveOperator() {
             return match(TokenType::MINUS, "AdditiveOperator");
         }
         default:
-            throw ParserException("AdditiveOperator", lexer.peek(), {TokenType::PLUS, TokenType::MINUS});
-    }
-}
-
-std::unique_ptr<ExprASTNode> Parser::parseMultiplicativeExpression() {
-    switch (lexer.peek().getType()) {
-        case TokenType::MINUS:
-        case TokenType::NOT:
-        case TokenType::IDENTIFIER:
-        case TokenType::LEFT_PAREN:
-        case TokenType::INTEGER_LITERAL:
-        case TokenType::REAL_LITERAL: {
-            report("MultiplicativeExpression -> UnaryExpression MultiplicativeExpressionR");
-            auto lhsExprNode = parseUnaryExpression();
-            return parseMultiplicativeExpressionR(std::move(lhsExprNode));
-        }
-        default:
-            throw ParserException("MultiplicativeExpression", lexer.peek(),
-                                  {TokenType::MINUS, TokenType::NOT, TokenType::IDENTIFIER, TokenType::LEFT_PAREN,
-                                   TokenType::INTEGER_LITERAL, TokenType::REAL_LITERAL});
-    }
-}
-
-std::unique_ptr<ExprASTNode> Parser::parseMultiplicativeExpressionR(std::unique_ptr<ExprASTNode> lhsExprNode) {
-    switch (lexer.peek().getType()) {
-        case TokenType::MULTIPLY:
-        case TokenType::DIVIDE:
-        case TokenType::MOD:
-        case TokenType::DIV: {
-            report("MultiplicativeExpressionR -> MultiplicativeOperator UnaryExpression MultiplicativeExpressionR");
-            auto op = parseMultiplicativeOperator();
-            auto rhsExprNode = parseUnaryExpression();
-            auto newLhsExprNode = std::make_unique<BinOpASTNode>(op, std::move(lhsExprNode), std::move(rhsExprNode));
-            return parseMultiplicativeExpressionR(std::move(newLhsExprNode));
-        }
-        case TokenType::PLUS:
-        case TokenType::MINUS:
-        case TokenType::LESS:
-        case TokenType::LESS_EQUAL:
-        case TokenType::GREATER:
-        case TokenType::GREATER_EQUAL:
-        case TokenType::EQUAL:
-        case TokenType::NOT_EQUAL:
-        case TokenType::AND:
-        case TokenType::OR:
-        case TokenType::RIGHT_BRACKET:
-        case TokenType::THEN:
-        case TokenType::DO:
-        case TokenType::TO:
-        case TokenType::DOWNTO:
-        case TokenType::RIGHT_PAREN:
-        case TokenType::COMMA:
-        case TokenType::SEMICOLON:
-        case TokenType::END:
-        case TokenType::ELSE: {
-            report("MultiplicativeExpressionR ->");
-            return lhsExprNode;
-        }
-        default:
-            throw ParserException("MultiplicativeExpressionR", lexer.peek(),
-                                  {TokenType::MULTIPLY,      TokenType::DIVIDE,      TokenType::MOD,
-                                   TokenType::DIV,           TokenType::PLUS,        TokenType::MINUS,
-                                   TokenType::LESS,          TokenType::LESS_EQUAL,  TokenType::GREATER,
-                                   TokenType::GREATER_EQUAL, TokenType::EQUAL,       TokenType::NOT_EQUAL,
-                                   TokenType::AND,           TokenType::OR,          TokenType::RIGHT_BRACKET,
-                                   TokenType::THEN,          TokenType::DO,          TokenType::TO,
-                                   TokenType::DOWNTO,        TokenType::RIGHT_PAREN, TokenType::COMMA,
-                                   TokenType::SEMICOLON,     TokenType::END,         TokenType::ELSE});
+            throw error("AdditiveOperator", {TokenType::PLUS, TokenType::MINUS});
     }
 }
 
 Token Parser::parseMultiplicativeOperator() {
-    switch (lexer.peek().getType()) {
+    switch (peekType()) {
         case TokenType::MULTIPLY: {
             report("MultiplicativeOperator -> <MULTIPLY>");
             return match(TokenType::MULTIPLY, "MultiplicativeOperator");
@@ -1220,19 +1048,26 @@ Token Parser::parseMultiplicativeOperator() {
             return match(TokenType::DIV, "MultiplicativeOperator");
         }
         default:
-            throw ParserException("MultiplicativeOperator", lexer.peek(),
-                                  {TokenType::MULTIPLY, TokenType::DIVIDE, TokenType::MOD, TokenType::DIV});
+            throw error("MultiplicativeOperator", {TokenType::MULTIPLY, TokenType::DIVIDE, TokenType::MOD,
+                                                   TokenType::DIV});
     }
 }
 
-std::unique_ptr<ExprASTNode> Parser::parseUnaryExpression() {
-    switch (lexer.peek().getType()) {
+ExprASTNode* Parser::parseUnaryExpression() {
+    switch (peekType()) {
         case TokenType::MINUS:
         case TokenType::NOT: {
-            report("UnaryExpression -> UnaryOperator UnaryExpression");
-            auto op = parseUnaryOperator();
+            // A run of unary operators is collected first and applied from the innermost one, without recursion
+            std::vector<Token> ops;
+            while (peekType() == TokenType::MINUS || peekType() == TokenType::NOT) {
+                report("UnaryExpression -> UnaryOperator UnaryExpression");
+                ops.push_back(parseUnaryOperator());
+            }
+
             auto exprNode = parseUnaryExpression();
-            return std::make_unique<UnaryOpASTNode>(op, std::move(exprNode));
+            for (auto it = ops.rbegin(); it != ops.rend(); ++it)
+                exprNode = at(*it, context.create<UnaryOpASTNode>(*it, exprNode));
+            return exprNode;
         }
         case TokenType::IDENTIFIER:
         case TokenType::LEFT_PAREN:
@@ -1242,14 +1077,14 @@ std::unique_ptr<ExprASTNode> Parser::parseUnaryExpression() {
             return parsePrimaryExpression();
         }
         default:
-            throw ParserException("UnaryExpression", lexer.peek(),
-                                  {TokenType::MINUS, TokenType::NOT, TokenType::IDENTIFIER, TokenType::LEFT_PAREN,
-                                   TokenType::INTEGER_LITERAL, TokenType::REAL_LITERAL});
+            throw error("UnaryExpression", {TokenType::MINUS, TokenType::NOT, TokenType::IDENTIFIER,
+                                            TokenType::LEFT_PAREN, TokenType::INTEGER_LITERAL,
+                                            TokenType::REAL_LITERAL});
     }
 }
 
 Token Parser::parseUnaryOperator() {
-    switch (lexer.peek().getType()) {
+    switch (peekType()) {
         case TokenType::MINUS: {
             report("UnaryOperator -> <MINUS>");
             return match(TokenType::MINUS, "UnaryOperator");
@@ -1259,17 +1094,16 @@ Token Parser::parseUnaryOperator() {
             return match(TokenType::NOT, "UnaryOperator");
         }
         default:
-            throw ParserException("UnaryOperator", lexer.peek(), {TokenType::MINUS, TokenType::NOT});
+            throw error("UnaryOperator", {TokenType::MINUS, TokenType::NOT});
     }
 }
 
-std::unique_ptr<ExprASTNode> Parser::parsePrimaryExpression() {
-    switch (lexer.peek().getType()) {
+ExprASTNode* Parser::parsePrimaryExpression() {
+    switch (peekType()) {
         case TokenType::IDENTIFIER: {
             report("PrimaryExpression -> <IDENTIFIER> PrimaryExpressionIdentifierContinuation");
             auto identifierToken = match(TokenType::IDENTIFIER, "PrimaryExpression");
-            std::string identifier = std::get<std::string>(identifierToken.getValue().value());
-            return parsePrimaryExpressionIdentifierContinuation(identifier);
+            return parsePrimaryExpressionIdentifierContinuation(identifierToken);
         }
         case TokenType::LEFT_PAREN: {
             report("PrimaryExpression -> <LEFT_PAREN> Expression <RIGHT_PAREN>");
@@ -1282,20 +1116,22 @@ std::unique_ptr<ExprASTNode> Parser::parsePrimaryExpression() {
         case TokenType::REAL_LITERAL: {
             report("PrimaryExpression -> UnsignedNumber");
             auto numToken = parseUnsignedNumber();
-            return std::make_unique<LiteralASTNode>(numToken.getValue().value());
+            if (numToken.getType() == TokenType::INTEGER_LITERAL)
+                return at(numToken, context.create<LiteralASTNode>(numToken.getInt()));
+            return at(numToken, context.create<LiteralASTNode>(numToken.getReal()));
         }
         default:
-            throw ParserException(
-                "PrimaryExpression", lexer.peek(),
-                {TokenType::IDENTIFIER, TokenType::LEFT_PAREN, TokenType::INTEGER_LITERAL, TokenType::REAL_LITERAL});
+            throw error("PrimaryExpression", {TokenType::IDENTIFIER, TokenType::LEFT_PAREN, TokenType::INTEGER_LITERAL,
+                                              TokenType::REAL_LITERAL});
     }
 }
 
-std::unique_ptr<ExprASTNode> Parser::parsePrimaryExpressionIdentifierContinuation(const std::string& identifier) {
-    switch (lexer.peek().getType()) {
+ExprASTNode* Parser::parsePrimaryExpressionIdentifierContinuation(const Token& identifier) {
+    switch (peekType()) {
         case TokenType::LEFT_PAREN: {
             report("PrimaryExpressionIdentifierContinuation -> FunctionArgs");
-            return std::make_unique<FunCallASTNode>(identifier, parseFunctionArgs());
+            return at(identifier, context.create<FunCallASTNode>(getName(identifier.getSymbol()),
+                                                                 context.copyArray(parseFunctionArgs())));
         }
         case TokenType::LEFT_BRACKET: {
             report("PrimaryExpressionIdentifierContinuation -> ArrayAccess");
@@ -1326,23 +1162,21 @@ std::unique_ptr<ExprASTNode> Parser::parsePrimaryExpressionIdentifierContinuatio
         case TokenType::END:
         case TokenType::ELSE: {
             report("PrimaryExpressionIdentifierContinuation ->");
-            return std::make_unique<DeclVarRefASTNode>(identifier);
+            return at(identifier, context.create<DeclVarRefASTNode>(getName(identifier.getSymbol())));
         }
         default:
-            throw ParserException(
-                "PrimaryExpressionIdentifierContinuation", lexer.peek(),
-                {TokenType::LEFT_PAREN, TokenType::LEFT_BRACKET,  TokenType::MULTIPLY,    TokenType::DIVIDE,
-                 TokenType::MOD,        TokenType::DIV,           TokenType::PLUS,        TokenType::MINUS,
-                 TokenType::LESS,       TokenType::LESS_EQUAL,    TokenType::GREATER,     TokenType::GREATER_EQUAL,
-                 TokenType::EQUAL,      TokenType::NOT_EQUAL,     TokenType::AND,         TokenType::OR,
-                 TokenType::SEMICOLON,  TokenType::RIGHT_BRACKET, TokenType::THEN,        TokenType::DO,
-                 TokenType::TO,         TokenType::DOWNTO,        TokenType::RIGHT_PAREN, TokenType::COMMA,
-                 TokenType::END,        TokenType::ELSE});
+            throw error("PrimaryExpressionIdentifierContinuation",
+                        {TokenType::LEFT_PAREN, TokenType::LEFT_BRACKET, TokenType::MULTIPLY, TokenType::DIVIDE,
+                         TokenType::MOD, TokenType::DIV, TokenType::PLUS, TokenType::MINUS, TokenType::LESS,
+                         TokenType::LESS_EQUAL, TokenType::GREATER, TokenType::GREATER_EQUAL, TokenType::EQUAL,
+                         TokenType::NOT_EQUAL, TokenType::AND, TokenType::OR, TokenType::SEMICOLON,
+                         TokenType::RIGHT_BRACKET, TokenType::THEN, TokenType::DO, TokenType::TO, TokenType::DOWNTO,
+                         TokenType::RIGHT_PAREN, TokenType::COMMA, TokenType::END, TokenType::ELSE});
     }
 }
 
-std::vector<std::unique_ptr<ExprASTNode>> Parser::parseFunctionArgs() {
-    switch (lexer.peek().getType()) {
+std::vector<ExprASTNode*> Parser::parseFunctionArgs() {
+    switch (peekType()) {
         case TokenType::LEFT_PAREN: {
             report("FunctionArgs -> <LEFT_PAREN> ArgumentList <RIGHT_PAREN>");
             match(TokenType::LEFT_PAREN, "FunctionArgs");
@@ -1351,12 +1185,12 @@ std::vector<std::unique_ptr<ExprASTNode>> Parser::parseFunctionArgs() {
             return paramNodes;
         }
         default:
-            throw ParserException("FunctionArgs", lexer.peek(), {TokenType::LEFT_PAREN});
+            throw error("FunctionArgs", {TokenType::LEFT_PAREN});
     }
 }
 
-std::vector<std::unique_ptr<ExprASTNode>> Parser::parseArgumentList() {
-    switch (lexer.peek().getType()) {
+std::vector<ExprASTNode*> Parser::parseArgumentList() {
+    switch (peekType()) {
         case TokenType::MINUS:
         case TokenType::NOT:
         case TokenType::IDENTIFIER:
@@ -1364,7 +1198,7 @@ std::vector<std::unique_ptr<ExprASTNode>> Parser::parseArgumentList() {
         case TokenType::REAL_LITERAL:
         case TokenType::INTEGER_LITERAL: {
             report("ArgumentList -> Expression ArgumentListR");
-            std::vector<std::unique_ptr<ExprASTNode>> argNodes;
+            std::vector<ExprASTNode*> argNodes;
             argNodes.push_back(parseExpression());
             parseArgumentListR(argNodes);
             return argNodes;
@@ -1374,34 +1208,34 @@ std::vector<std::unique_ptr<ExprASTNode>> Parser::parseArgumentList() {
             return {};
         }
         default:
-            throw ParserException("ArgumentList", lexer.peek(),
-                                  {TokenType::MINUS, TokenType::NOT, TokenType::IDENTIFIER, TokenType::LEFT_PAREN,
-                                   TokenType::REAL_LITERAL, TokenType::INTEGER_LITERAL, TokenType::RIGHT_PAREN});
+            throw error("ArgumentList", {TokenType::MINUS, TokenType::NOT, TokenType::IDENTIFIER, TokenType::LEFT_PAREN,
+                                         TokenType::REAL_LITERAL, TokenType::INTEGER_LITERAL, TokenType::RIGHT_PAREN});
     }
 }
 
-void Parser::parseArgumentListR(std::vector<std::unique_ptr<ExprASTNode>>& argNodes) {
-    switch (lexer.peek().getType()) {
-        case TokenType::COMMA: {
-            report("ArgumentListR -> <COMMA> Expression ArgumentListR");
-            match(TokenType::COMMA, "ArgumentListR");
-            argNodes.push_back(parseExpression());
-            parseArgumentListR(argNodes);
-            break;
-        }
-        case TokenType::RIGHT_PAREN: {
-            report("ArgumentListR ->");
-            break;
+void Parser::parseArgumentListR(std::vector<ExprASTNode*>& argNodes) {
+    while (true) {
+        switch (peekType()) {
+            case TokenType::COMMA: {
+                report("ArgumentListR -> <COMMA> Expression ArgumentListR");
+                match(TokenType::COMMA, "ArgumentListR");
+                argNodes.push_back(parseExpression());
+                break;
+            }
+            case TokenType::RIGHT_PAREN: {
+                report("ArgumentListR ->");
+                return;
+            }
+            default:
+                throw error("ArgumentListR", {TokenType::COMMA, TokenType::RIGHT_PAREN});
         }
-        default:
-            throw ParserException("ArgumentListR", lexer.peek(), {TokenType::COMMA, TokenType::RIGHT_PAREN});
     }
 }
 
-ParserException::ParserException(const std::string& rule, const Token& actualToken,
+ParserException::ParserException(const std::string& rule, const Token& actualToken, const Position& position,
                                  const std::set<TokenType>& expectedTokenTypes) {
     std::ostringstream oss;
-    oss << "Rule " << rule << " at position " << actualToken.getPosition() << ". ";
+    oss << "Rule " << rule << " at position " << position << ". ";
     oss << "Actual token was: " << actualToken.getType() << ". ";
 
     if (expectedTokenTypes.size() > 1) {
@@ -1416,6 +1250,12 @@ ParserException::ParserException(const std::string& rule, const Token& actualTok
     message = oss.str();
 }
 
+ParserException::ParserException(const std::string& rule, const Position& position, const std::string& reason) {
+    std::ostringstream oss;
+    oss << "Rule " << rule << " at position " << position << ". " << reason;
+    message = oss.str();
+}
+
 const char* ParserException::what() const noexcept {
     return message.c_str();
 }
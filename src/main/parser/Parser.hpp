@@ -1,95 +1,166 @@
 #pragma once
 #include <experimental/iterator>
 #include <iostream>
+#include <memory>
 #include <set>
 #include <sstream>
 #include "ast/AST.hpp"
 #include "lexer/Lexer.hpp"
+#include "lexer/TokenPipe.hpp"
+#include "lexer/TokenStream.hpp"
+#include "RuleTracer.hpp"
+
+class ParserException;
 
 class Parser {
     /**
-     * @brief The lexer used to read tokens
+     * @brief Source of the tokens, either a lexer (one token of lookahead, lexing interleaved with parsing), a
+     * TokenPipe (lexing on another thread) or a pre-lexed TokenStream consumed through 'cursor'
+     */
+    Lexer* lexer = nullptr;
+    TokenPipe* pipe = nullptr;
+    const TokenStream* stream = nullptr;
+    size_t cursor = 0;
+
+    [[nodiscard]] Token peek() const;
+    [[nodiscard]] TokenType peekType() const;
+    [[nodiscard]] const StringInterner& getInterner() const;
+    [[nodiscard]] const SourceManager& getSourceManager() const;
+
+    /**
+     * @brief Creates an exception for the unexpected next token (its position is computed only here)
+     */
+    [[nodiscard]] ParserException error(std::string_view rule, const std::set<TokenType>& expectedTokenTypes) const;
+
+    /**
+     * @brief Records where the node starts in the source code, for the diagnostics of the later phases
+     */
+    template <typename Node>
+    Node* at(const Token& token, Node* node) const {
+        node->setOffset(token.getOffset());
+        return node;
+    }
+
+    // Rules are string literals, taken as views so that matching does not allocate
+    Token match(std::initializer_list<TokenType> tokenTypes, std::string_view rule = "[unspecified_rule]");
+    Token match(TokenType tokenType, std::string_view rule = "[unspecified_rule]");
+
+    /**
+     * @brief Prints the grammar rules used during parsing, only exists when they are dumped
+     */
+    std::unique_ptr<RuleTracer> tracer;
+
+    void report(std::string_view rule) const {
+        if (tracer)
+            tracer->rule(rule);
+    }
+
+    /**
+     * @brief Limit of the nesting of statements, expressions and types, deeper input is rejected instead of
+     * overflowing the stack of the parser or of the recursive passes after it
+     * @note Lists, 'else if' chains and operator chains ('a + b + c ...', '- - a') are parsed iteratively and do not
+     * count, the passes walk those chains iteratively too
      */
-    Lexer lexer;
+    static constexpr size_t maxNestingDepth = 1024;
+    size_t nestingDepth = 0;
 
-    Token match(std::initializer_list<TokenType> tokenTypes, const std::string& rule = "[unspecified_rule]");
-    Token match(TokenType tokenType, const std::string& rule = "[unspecified_rule]");
+    /**
+     * @brief Counts one level of nesting for the lifetime of the rule that recurses
+     */
+    class NestingGuard {
+        Parser& parser;
+
+       public:
+        NestingGuard(Parser& parser, std::string_view rule);
+        ~NestingGuard();
+    };
+
+    /**
+     * @brief Owns the nodes created by the parser
+     */
+    ASTContext& context;
 
     /**
-     * @brief Whether to print all grammar rules used during parsing
+     * @brief SymbolId -> name pooled by the context, so each distinct identifier is copied into the AST once
      */
-    bool dumpRules;
+    std::vector<const std::string*> names;
 
-    void report(const std::string& rule) const;
+    /**
+     * @brief Returns the name of the interned identifier, pooled by the context
+     */
+    [[nodiscard]] const std::string& getName(SymbolId symbol);
 
    public:
-    explicit Parser(Lexer& lexer, bool dumpRules = false);
+    /**
+     * @param context Receives the nodes of the AST, it must outlive them (the parser may be destroyed before)
+     */
+    Parser(Lexer& lexer, ASTContext& context, bool dumpRules = false, std::ostream& dumpOut = std::cout);
+
+    /**
+     * @param pipe Must outlive the parser
+     */
+    Parser(TokenPipe& pipe, ASTContext& context, bool dumpRules = false, std::ostream& dumpOut = std::cout);
+
+    /**
+     * @param stream Must outlive the parser
+     */
+    Parser(const TokenStream& stream, ASTContext& context, bool dumpRules = false, std::ostream& dumpOut = std::cout);
 
     /* ----------------- Recursive descent functions ----------------- */
 
-    std::unique_ptr<ProgramASTNode> parseProgram();
-    std::unique_ptr<BlockASTNode> parseBlock();
-    void parseBlockDecl(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes);
+    ProgramASTNode* parseProgram();
+    BlockASTNode* parseBlock();
+    void parseBlockDecl(std::vector<StatementASTNode*>& statementNodes);
     Token parseUnsignedNumber();
-    std::unique_ptr<TypeASTNode> parseType();
-    std::unique_ptr<PrimitiveTypeASTNode> parsePrimitiveType();
-    std::unique_ptr<ArrayTypeASTNode> parseArrayType();
+    TypeASTNode* parseType();
+    PrimitiveTypeASTNode* parsePrimitiveType();
+    ArrayTypeASTNode* parseArrayType();
     int parseSignedInteger();
-    void parseConstantDefinitionList(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes);
-    void parseConstantDefinitionListR(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes);
-    void parseConstantDefinition(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes);
-    void parseVariableDeclarationList(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes);
-    void parseVariableDeclarationListR(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes);
-    void parseVariableDeclarationGroup(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes);
-    std::vector<std::string> parseIdentifierList();
-    void parseIdentifierListR(std::vector<std::string>& identifiers);
-    void parseProcedureDeclaration(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes);
-    void parseFunctionDeclaration(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes);
-    std::vector<std::unique_ptr<VarDeclASTNode>> parseFunctionParameters();
-    std::vector<std::unique_ptr<VarDeclASTNode>> parseFormalParameterList();
-    void parseFormalParameterListR(std::vector<std::unique_ptr<VarDeclASTNode>>& parameterNodes);
-    void parseParameterGroup(std::vector<std::unique_ptr<VarDeclASTNode>>& parameterNodes);
-    std::optional<std::unique_ptr<BlockASTNode>> parseBodyOrForward();
-    std::unique_ptr<BlockASTNode> parseBody(); // Body is just a block without function/procedure declarations
-    void parseBodyDecl(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes);
-    std::unique_ptr<StatementASTNode> parseStatement();
-    std::unique_ptr<StatementASTNode> parseSimpleStatement();
-    std::unique_ptr<StatementASTNode> parseSimpleStatementIdentifierContinuation(const std::string& identifier);
-    std::unique_ptr<DeclArrayRefASTNode> parseOptionalArrayAccess(const std::string& identifier);
-    std::unique_ptr<DeclArrayRefASTNode> parseArrayAccess(const std::string& identifier);
-    std::unique_ptr<StatementASTNode> parseEmptyStatement();
-    std::unique_ptr<StatementASTNode> parseComplexStatement();
-    std::unique_ptr<CompoundStmtASTNode> parseCompoundStatement();
-    void parseCompoundStatementR(std::vector<std::unique_ptr<StatementASTNode>>& statementNodes);
-    std::unique_ptr<StatementASTNode> parseIfStatement();
-    std::optional<std::unique_ptr<StatementASTNode>> parseElseStatement();
-    std::unique_ptr<WhileASTNode> parseWhileStatement();
-    std::unique_ptr<ForASTNode> parseForStatement();
+    void parseConstantDefinitionList(std::vector<StatementASTNode*>& statementNodes);
+    void parseConstantDefinitionListR(std::vector<StatementASTNode*>& statementNodes);
+    void parseConstantDefinition(std::vector<StatementASTNode*>& statementNodes);
+    void parseVariableDeclarationList(std::vector<StatementASTNode*>& statementNodes);
+    void parseVariableDeclarationListR(std::vector<StatementASTNode*>& statementNodes);
+    void parseVariableDeclarationGroup(std::vector<StatementASTNode*>& statementNodes);
+    std::vector<Token> parseIdentifierList();
+    void parseIdentifierListR(std::vector<Token>& identifiers);
+    void parseProcedureDeclaration(std::vector<StatementASTNode*>& statementNodes);
+    void parseFunctionDeclaration(std::vector<StatementASTNode*>& statementNodes);
+    std::vector<VarDeclASTNode*> parseFunctionParameters();
+    std::vector<VarDeclASTNode*> parseFormalParameterList();
+    void parseFormalParameterListR(std::vector<VarDeclASTNode*>& parameterNodes);
+    void parseParameterGroup(std::vector<VarDeclASTNode*>& parameterNodes);
+    std::optional<BlockASTNode*> parseBodyOrForward();
+    BlockASTNode* parseBody(); // Body is just a block without function/procedure declarations
+    void parseBodyDecl(std::vector<StatementASTNode*>& statementNodes);
+    StatementASTNode* parseStatement();
+    StatementASTNode* parseSimpleStatement();
+    StatementASTNode* parseSimpleStatementIdentifierContinuation(const Token& identifier);
+    DeclArrayRefASTNode* parseOptionalArrayAccess(const Token& identifier);
+    DeclArrayRefASTNode* parseArrayAccess(const Token& identifier);
+    StatementASTNode* parseEmptyStatement();
+    StatementASTNode* parseComplexStatement();
+    CompoundStmtASTNode* parseCompoundStatement();
+    void parseCompoundStatementR(std::vector<StatementASTNode*>& statementNodes);
+    StatementASTNode* parseIfStatement();
+    WhileASTNode* parseWhileStatement();
+    ForASTNode* parseForStatement();
     Token parseTo();
-    std::unique_ptr<ExprASTNode> parseExpression();
-    std::unique_ptr<ExprASTNode> parseLogicalOrExpression();
-    std::unique_ptr<ExprASTNode> parseLogicalOrExpressionR(std::unique_ptr<ExprASTNode> lhsExprNode);
-    std::unique_ptr<ExprASTNode> parseLogicalAndExpression();
-    std::unique_ptr<ExprASTNode> parseLogicalAndExpressionR(std::unique_ptr<ExprASTNode> lhsExprNode);
-    std::unique_ptr<ExprASTNode> parseEqualityExpression();
-    std::unique_ptr<ExprASTNode> parseEqualityExpressionR(std::unique_ptr<ExprASTNode> lhsExprNode);
+    ExprASTNode* parseExpression();
+    ExprASTNode* parseBinaryExpression(int minBindingPower);
+    Token parseLogicalOrOperator();
+    Token parseLogicalAndOperator();
     Token parseEqualityOperator();
-    std::unique_ptr<ExprASTNode> parseRelationalExpression();
-    std::unique_ptr<ExprASTNode> parseRelationalExpressionR(std::unique_ptr<ExprASTNode> lhsExprNode);
     Token parseRelationalOperator();
-    std::unique_ptr<ExprASTNode> parseAdditiveExpression();
-    std::unique_ptr<ExprASTNode> parseAdditiveExpressionR(std::unique_ptr<ExprASTNode> lhsExprNode);
     Token parseAdditiveOperator();
-    std::unique_ptr<ExprASTNode> parseMultiplicativeExpression();
-    std::unique_ptr<ExprASTNode> parseMultiplicativeExpressionR(std::unique_ptr<ExprASTNode> lhsExprNode);
     Token parseMultiplicativeOperator();
-    std::unique_ptr<ExprASTNode> parseUnaryExpression();
+    ExprASTNode* parseUnaryExpression();
     Token parseUnaryOperator();
-    std::unique_ptr<ExprASTNode> parsePrimaryExpression();
-    std::unique_ptr<ExprASTNode> parsePrimaryExpressionIdentifierContinuation(const std::string& identifier);
-    std::vector<std::unique_ptr<ExprASTNode>> parseFunctionArgs();
-    std::vector<std::unique_ptr<ExprASTNode>> parseArgumentList();
-    void parseArgumentListR(std::vector<std::unique_ptr<ExprASTNode>>& argNodes);
+    ExprASTNode* parsePrimaryExpression();
+    ExprASTNode* parsePrimaryExpressionIdentifierContinuation(const Token& identifier);
+    std::vector<ExprASTNode*> parseFunctionArgs();
+    std::vector<ExprASTNode*> parseArgumentList();
+    void parseArgumentListR(std::vector<ExprASTNode*>& argNodes);
 };
 
 class ParserException : public std::exception {
@@ -97,7 +168,9 @@ class ParserException : public std::exception {
     std::string message;
 
    public:
-    ParserException(const std::string& rule, const Token& actualToken, const std::set<TokenType>& expectedTokenTypes);
+    ParserException(const std::string& rule, const Token& actualToken, const Position& position,
+                    const std::set<TokenType>& expectedTokenTypes);
+    ParserException(const std::string& rule, const Position& position, const std::string& reason);
 
     [[nodiscard]] const char* what() const noexcept override;
 };
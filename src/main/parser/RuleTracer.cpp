@@ -0,0 +1,13 @@
+#include "RuleTracer.hpp"
+
+RuleTracer::RuleTracer(std::ostream& out) : out(out) {}
+
+void RuleTracer::rule(std::string_view rule) {
+    out << rule << std::endl;
+}
+
+void RuleTracer::matched(const Token& token, const StringInterner& interner) {
+    out << "match ";
+    token.print(out, interner);
+    out << std::endl;
+}
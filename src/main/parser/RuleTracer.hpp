@@ -0,0 +1,21 @@
+#pragma once
+#include <ostream>
+#include <string_view>
+#include "lexer/StringInterner.hpp"
+#include "lexer/Token.hpp"
+
+/**
+ * @brief Prints the grammar rules used during parsing and the tokens they match ('-v')
+ * @note The parser creates a tracer only when the rules are dumped, otherwise every trace point is a single test of a
+ * null pointer, and nothing is formatted.
+ */
+class RuleTracer {
+   private:
+    std::ostream& out;
+
+   public:
+    explicit RuleTracer(std::ostream& out);
+
+    void rule(std::string_view rule);
+    void matched(const Token& token, const StringInterner& interner);
+};
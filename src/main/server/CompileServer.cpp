@@ -0,0 +1,281 @@
+#include "CompileServer.hpp"
+#include <llvm/Support/Path.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+
+void LatencyHistogram::record(uint64_t latencyUs) {
+    unsigned bucket = 0;
+    while (bucket + 1 < bucketCount && (uint64_t(1) << bucket) <= latencyUs)
+        ++bucket;
+
+    ++buckets[bucket];
+    ++count;
+    totalUs += latencyUs;
+    maxUs = std::max(maxUs, latencyUs);
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const {
+    auto rank = static_cast<uint64_t>(std::ceil(percent / 100.0 * count));
+    uint64_t seen = 0;
+    for (unsigned bucket = 0; bucket < bucketCount; ++bucket) {
+        seen += buckets[bucket];
+        if (seen >= rank && seen > 0)
+            return bucket + 1 < bucketCount ? uint64_t(1) << bucket : maxUs;
+    }
+    return 0;
+}
+
+uint64_t LatencyHistogram::getCount() const {
+    return count;
+}
+
+void LatencyHistogram::print(std::ostream& os) const {
+    os << "Latency (us): avg " << (count ? totalUs / count : 0) << ", p50 <" << percentile(50) << ", p90 <"
+       << percentile(90) << ", p99 <" << percentile(99) << ", max " << maxUs << "\n";
+
+    for (unsigned bucket = 0; bucket < bucketCount; ++bucket) {
+        if (!buckets[bucket])
+            continue;
+
+        if (bucket + 1 < bucketCount)
+            os << "  < " << std::setw(9) << (uint64_t(1) << bucket);
+        else
+            os << "  >=" << std::setw(9) << (uint64_t(1) << (bucket - 1));
+        os << " us: " << buckets[bucket] << "\n";
+    }
+}
+
+CompileService::CompileService(size_t contextPoolSize) : contextPoolSize(contextPoolSize) {
+    // Target initialization and target machine creation are paid once per server, not once per request
+    for (OptLevel level : {OptLevel::O0, OptLevel::O1, OptLevel::O2, OptLevel::O3, OptLevel::Os})
+        backends[level] = std::make_unique<Backend>(level);
+
+    // Linking dominates the latency of small programs, the linker is spawned without the driver in front of it
+    Backend::enableDirectLink();
+
+    refillContextPool();
+}
+
+void CompileService::refillContextPool() {
+    while (contextPool.size() < contextPoolSize) {
+        auto gen = std::make_unique<GenContext>("mila-module");
+        backends.at(OptLevel::O0)->configureModule(gen->module);
+        contextPool.push_back(std::move(gen));
+    }
+}
+
+Protocol::Response CompileService::compile(const Protocol::CompileRequest& request) {
+    auto start = std::chrono::steady_clock::now();
+    Protocol::Response response;
+    std::ostringstream err;
+
+    auto finish = [&](int exitCode) {
+        response.exitCode = exitCode;
+        response.err = err.str();
+        failedRequests += exitCode != EXIT_SUCCESS;
+        latency.record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+                           .count());
+        return response;
+    };
+
+    OptLevel optLevel = OptLevel::O0;
+    for (const auto& flag : request.flags) {
+        if (auto level = optLevelFromString(flag)) {
+            optLevel = *level;
+        } else {
+            err << "Error: unsupported option for the compile server: " << flag << std::endl;
+            return finish(EXIT_FAILURE);
+        }
+    }
+
+    // Requests come from the user running the server only (see CompileServer::serve), the path must not depend on the
+    // working directory of the server though
+    if (!llvm::sys::path::is_absolute(request.outputFile)) {
+        err << "Error: the output file must be an absolute path: " << request.outputFile << std::endl;
+        return finish(EXIT_FAILURE);
+    }
+
+    SourceManager sources(request.source.data(), request.source.data() + request.source.size());
+
+    ASTContext astContext;
+    ProgramASTNode* programNode = nullptr;
+    try {
+        TokenStream tokens = TokenStream::lex(request.source.data(), request.source.data() + request.source.size());
+        Parser parser(tokens, astContext);
+        programNode = parser.parseProgram();
+    } catch (const ParserException& e) {
+        err << "Parser error: " << e.what() << std::endl;
+        return finish(EXIT_FAILURE);
+    } catch (const LexerException& e) {
+        err << "Lexer error: " << e.what() << std::endl;
+        return finish(EXIT_FAILURE);
+    }
+
+    // A context is used for a single module only, the pool is refilled after the response is sent
+    if (contextPool.empty())
+        refillContextPool();
+    std::unique_ptr<GenContext> gen = std::move(contextPool.front());
+    contextPool.pop_front();
+
+    try {
+        Backend& backend = *backends.at(optLevel);
+        CodeGenerator(programNode).generate(*gen);
+        CodeGenerator::optimize(gen->module, optLevel, &backend.getTargetMachine());
+        backend.compile(gen->module, request.outputFile);
+    } catch (const CodeGenException& e) {
+        err << "Code generation error: " << e.format(sources) << std::endl;
+        return finish(EXIT_FAILURE);
+    } catch (const BackendException& e) {
+        err << "Backend error: " << e.what() << std::endl;
+        return finish(EXIT_FAILURE);
+    }
+
+    return finish(EXIT_SUCCESS);
+}
+
+std::string CompileService::stats() const {
+    std::ostringstream os;
+    os << "Requests: " << latency.getCount() << " (" << failedRequests << " failed)\n";
+    latency.print(os);
+    return os.str();
+}
+
+CompileServer::CompileServer(std::string socketPath, std::chrono::milliseconds ioTimeout)
+    : socketPath(std::move(socketPath)), ioTimeout(ioTimeout) {
+    sockaddr_un address{};
+    if (this->socketPath.size() >= sizeof(address.sun_path))
+        throw ServerException("Socket path is too long: " + this->socketPath);
+
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, this->socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0)
+        throw ServerException(std::string("Failed to create socket: ") + std::strerror(errno));
+
+    // A socket file left behind by a previous (killed) server would make bind fail, it is replaced only if nothing
+    // answers on it. Anything else at the path is left alone.
+    struct stat status {};
+    if (lstat(this->socketPath.c_str(), &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) {
+            close(listenFd);
+            throw ServerException("'" + this->socketPath + "' exists and is not a socket");
+        }
+        if (status.st_uid != geteuid()) {
+            close(listenFd);
+            throw ServerException("'" + this->socketPath + "' is owned by another user");
+        }
+
+        int probeFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        bool inUse = probeFd >= 0 && connect(probeFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        if (probeFd >= 0)
+            close(probeFd);
+        if (inUse) {
+            close(listenFd);
+            throw ServerException("A compile server is already listening on '" + this->socketPath + "'");
+        }
+
+        unlink(this->socketPath.c_str());
+    }
+
+    // Only the owner may connect: the socket is created without access for others (the umask closes the window
+    // between bind and chmod), the chmod does not depend on the umask the server was started with
+    mode_t previousMask = umask(S_IRWXG | S_IRWXO | S_IXUSR);
+    bool bound = bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    umask(previousMask);
+
+    if (!bound || chmod(this->socketPath.c_str(), S_IRUSR | S_IWUSR) < 0 || listen(listenFd, 16) < 0) {
+        std::string error = std::strerror(errno);
+        close(listenFd);
+        throw ServerException("Failed to listen on '" + this->socketPath + "': " + error);
+    }
+}
+
+CompileServer::~CompileServer() {
+    close(listenFd);
+    unlink(socketPath.c_str());
+}
+
+void CompileServer::serve() {
+    while (true) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR)
+                continue;
+            throw ServerException(std::string("Failed to accept connection: ") + std::strerror(errno));
+        }
+
+        // The permissions of the socket are the first line, the credentials of the peer the second: the server writes
+        // executables wherever the requests say, so only the user running it may send them
+        ucred peer{};
+        socklen_t peerSize = sizeof(peer);
+        if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &peerSize) < 0 || peer.uid != geteuid()) {
+            ++rejectedConnections;
+            close(fd);
+            continue;
+        }
+
+        // The server is single-threaded, a client that stops sending or reading must not stall it
+        timeval timeout{};
+        timeout.tv_sec = ioTimeout.count() / 1000;
+        timeout.tv_usec = ioTimeout.count() % 1000 * 1000;
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        bool keepServing = true;
+        try {
+            keepServing = handleConnection(fd);
+        } catch (const std::exception& e) {
+            // A misbehaving client (or a request the service fails on) must not bring the server down
+            std::cerr << "Compile server: " << e.what() << std::endl;
+        }
+        close(fd);
+
+        if (!keepServing)
+            return;
+
+        service.refillContextPool();
+    }
+}
+
+bool CompileServer::handleConnection(int fd) {
+    std::string payload;
+    if (!Protocol::readFrame(fd, payload))
+        return true;
+
+    Protocol::Response response;
+    switch (Protocol::messageType(payload)) {
+        case Protocol::MessageType::Compile:
+            response = service.compile(Protocol::decodeCompileRequest(payload));
+            break;
+        case Protocol::MessageType::Stats:
+            response.out = service.stats() + "Rejected connections of other users: " +
+                           std::to_string(rejectedConnections) + "\n";
+            break;
+        case Protocol::MessageType::Shutdown:
+            Protocol::writeFrame(fd, Protocol::encodeResponse(response));
+            return false;
+        default:
+            throw ProtocolException("Malformed message - unknown message type");
+    }
+
+    Protocol::writeFrame(fd, Protocol::encodeResponse(response));
+    return true;
+}
+
+ServerException::ServerException(std::string msg) : message(std::move(msg)) {}
+
+const char* ServerException::what() const noexcept {
+    return message.c_str();
+}
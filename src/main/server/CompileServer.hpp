@@ -0,0 +1,129 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include "ast/CodeGenerator.hpp"
+#include "backend/Backend.hpp"
+#include "server/Protocol.hpp"
+
+/**
+ * @brief Latency histogram with power of two buckets (in microseconds)
+ */
+class LatencyHistogram {
+   private:
+    /**
+     * @brief Bucket i counts latencies in [2^(i-1), 2^i) us, the last one everything above
+     */
+    static constexpr unsigned bucketCount = 24;
+
+    std::array<uint64_t, bucketCount> buckets{};
+    uint64_t count = 0;
+    uint64_t totalUs = 0;
+    uint64_t maxUs = 0;
+
+   public:
+    void record(uint64_t latencyUs);
+
+    /**
+     * @brief Returns the upper bound (in us) of the bucket containing the given percentile (0-100)
+     */
+    [[nodiscard]] uint64_t percentile(double percent) const;
+
+    [[nodiscard]] uint64_t getCount() const;
+
+    /**
+     * @brief Prints the summary and the non-empty buckets
+     */
+    void print(std::ostream& os) const;
+};
+
+/**
+ * @brief Compiles requests with warm LLVM state: initialized target machines (one per optimization level) and a pool
+ * of prebuilt code generation contexts (with the runtime builtins already declared)
+ * @note Not thread-safe, the server handles one request at a time
+ */
+class CompileService {
+   private:
+    std::map<OptLevel, std::unique_ptr<Backend>> backends;
+    std::deque<std::unique_ptr<GenContext>> contextPool;
+    size_t contextPoolSize;
+
+    LatencyHistogram latency;
+    uint64_t failedRequests = 0;
+
+   public:
+    /**
+     * @param contextPoolSize Number of code generation contexts kept ready
+     */
+    explicit CompileService(size_t contextPoolSize = 4);
+
+    /**
+     * @brief Compiles the request's source into its output executable
+     */
+    Protocol::Response compile(const Protocol::CompileRequest& request);
+
+    /**
+     * @brief Tops the context pool up, should be called off the critical path (after a response is sent)
+     */
+    void refillContextPool();
+
+    /**
+     * @brief Returns request counts and the latency histogram as human readable text
+     */
+    [[nodiscard]] std::string stats() const;
+};
+
+/**
+ * @brief 'milac --serve' daemon: accepts requests on a Unix domain socket and answers them with the CompileService
+ */
+class CompileServer {
+   private:
+    std::string socketPath;
+    int listenFd = -1;
+
+    /**
+     * @brief Limit of a single read from or write to a client
+     */
+    std::chrono::milliseconds ioTimeout;
+
+    CompileService service;
+
+    /**
+     * @brief Connections closed without reading because the peer runs as another user
+     */
+    uint64_t rejectedConnections = 0;
+
+    /**
+     * @returns False if the request was a shutdown request
+     */
+    bool handleConnection(int fd);
+
+   public:
+    /**
+     * @brief Binds and listens on the socket (replacing a stale socket file), accessible to its owner only
+     * @throws ServerException If the path is not a socket, belongs to another user or another server is listening on it
+     */
+    explicit CompileServer(std::string socketPath, std::chrono::milliseconds ioTimeout = std::chrono::seconds(10));
+    ~CompileServer();
+
+    CompileServer(const CompileServer&) = delete;
+    CompileServer& operator=(const CompileServer&) = delete;
+
+    /**
+     * @brief Serves requests until a shutdown request arrives
+     */
+    void serve();
+};
+
+class ServerException : public std::exception {
+   private:
+    std::string message;
+
+   public:
+    explicit ServerException(std::string msg);
+
+    [[nodiscard]] const char* what() const noexcept override;
+};
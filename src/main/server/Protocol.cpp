@@ -0,0 +1,223 @@
+#include "Protocol.hpp"
+#include <llvm/Support/Process.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace Protocol {
+
+/**
+ * @brief Sequential reader of the payload fields
+ */
+class PayloadReader {
+   private:
+    const std::string& payload;
+    size_t offset = 1;  // skips the message type
+
+   public:
+    explicit PayloadReader(const std::string& payload) : payload(payload) {}
+
+    uint32_t readUInt32() {
+        if (offset + 4 > payload.size())
+            throw ProtocolException("Malformed message - truncated integer");
+
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+            value = (value << 8) | static_cast<unsigned char>(payload[offset++]);
+        return value;
+    }
+
+    std::string readString() {
+        uint32_t length = readUInt32();
+        if (offset + length > payload.size())
+            throw ProtocolException("Malformed message - truncated string");
+
+        std::string value = payload.substr(offset, length);
+        offset += length;
+        return value;
+    }
+};
+
+static void appendUInt32(std::string& payload, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8)
+        payload += static_cast<char>((value >> shift) & 0xff);
+}
+
+static void appendString(std::string& payload, const std::string& value) {
+    appendUInt32(payload, value.size());
+    payload += value;
+}
+
+std::string defaultSocketPath() {
+    if (auto runtimeDir = llvm::sys::Process::GetEnv("XDG_RUNTIME_DIR"); runtimeDir && !runtimeDir->empty())
+        return *runtimeDir + "/milac.sock";
+
+    return "/tmp/milac-" + std::to_string(getuid()) + ".sock";
+}
+
+std::string encodeCompileRequest(const CompileRequest& request) {
+    std::string payload(1, static_cast<char>(MessageType::Compile));
+    appendString(payload, request.source);
+    appendString(payload, request.outputFile);
+    appendUInt32(payload, request.flags.size());
+    for (const auto& flag : request.flags)
+        appendString(payload, flag);
+    return payload;
+}
+
+std::string encodeResponse(const Response& response) {
+    std::string payload(1, static_cast<char>(MessageType::Response));
+    appendUInt32(payload, static_cast<uint32_t>(response.exitCode));
+    appendString(payload, response.out);
+    appendString(payload, response.err);
+    return payload;
+}
+
+CompileRequest decodeCompileRequest(const std::string& payload) {
+    if (messageType(payload) != MessageType::Compile)
+        throw ProtocolException("Malformed message - compile request expected");
+
+    PayloadReader reader(payload);
+    CompileRequest request;
+    request.source = reader.readString();
+    request.outputFile = reader.readString();
+    for (uint32_t count = reader.readUInt32(); count > 0; --count)
+        request.flags.push_back(reader.readString());
+    return request;
+}
+
+Response decodeResponse(const std::string& payload) {
+    if (messageType(payload) != MessageType::Response)
+        throw ProtocolException("Malformed message - response expected");
+
+    PayloadReader reader(payload);
+    Response response;
+    response.exitCode = static_cast<int>(reader.readUInt32());
+    response.out = reader.readString();
+    response.err = reader.readString();
+    return response;
+}
+
+MessageType messageType(const std::string& payload) {
+    if (payload.empty())
+        throw ProtocolException("Malformed message - empty payload");
+
+    return static_cast<MessageType>(payload[0]);
+}
+
+static void writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        // MSG_NOSIGNAL - a disconnected peer is reported as an error instead of killing the process with SIGPIPE
+        ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            throw ProtocolException(std::string("Failed to write to socket: ") + std::strerror(errno));
+
+        data += written;
+        size -= written;
+    }
+}
+
+/**
+ * @returns Number of bytes read, less than 'size' only if the peer closed the connection
+ */
+static size_t readAll(int fd, char* data, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+        ssize_t received = recv(fd, data + total, size - total, 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            throw ProtocolException("Timed out reading from socket");
+        if (received < 0)
+            throw ProtocolException(std::string("Failed to read from socket: ") + std::strerror(errno));
+        if (received == 0)
+            break;
+
+        total += received;
+    }
+    return total;
+}
+
+void writeFrame(int fd, const std::string& payload) {
+    std::string frame;
+    frame.reserve(4 + payload.size());
+    appendUInt32(frame, payload.size());
+    frame += payload;
+    writeAll(fd, frame.data(), frame.size());
+}
+
+bool readFrame(int fd, std::string& payload) {
+    unsigned char header[4];
+    size_t headerSize = readAll(fd, reinterpret_cast<char*>(header), sizeof(header));
+    if (headerSize == 0)
+        return false;
+    if (headerSize < sizeof(header))
+        throw ProtocolException("Connection closed in the middle of a frame");
+
+    uint32_t length = (uint32_t(header[0]) << 24) | (uint32_t(header[1]) << 16) | (uint32_t(header[2]) << 8) | header[3];
+    if (length > maxFrameSize)
+        throw ProtocolException("Malformed message - frame of " + std::to_string(length) + " bytes exceeds the limit of " +
+                                std::to_string(maxFrameSize));
+
+    payload.resize(length);
+    if (readAll(fd, payload.data(), length) < length)
+        throw ProtocolException("Connection closed in the middle of a frame");
+
+    return true;
+}
+
+Response request(const std::string& socketPath, const std::string& payload) {
+    sockaddr_un address{};
+    if (socketPath.size() >= sizeof(address.sun_path))
+        throw ProtocolException("Socket path is too long: " + socketPath);
+
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    // Another user could have created the socket (e.g. at the '/tmp' fallback path) to receive the sources, the owner
+    // of the file is checked before connecting and the user of the listening process after
+    struct stat status {};
+    if (lstat(socketPath.c_str(), &status) == 0 && (!S_ISSOCK(status.st_mode) || status.st_uid != geteuid()))
+        throw ProtocolException("Refusing to connect to '" + socketPath + "': not a socket owned by the current user");
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        throw ProtocolException(std::string("Failed to create socket: ") + std::strerror(errno));
+
+    try {
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+            throw ProtocolException("Failed to connect to compile server at '" + socketPath +
+                                    "': " + std::strerror(errno));
+
+        ucred peer{};
+        socklen_t peerSize = sizeof(peer);
+        if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &peerSize) < 0 || peer.uid != geteuid())
+            throw ProtocolException("Refusing to use the compile server at '" + socketPath +
+                                    "': it runs as another user");
+
+        writeFrame(fd, payload);
+
+        std::string responsePayload;
+        if (!readFrame(fd, responsePayload))
+            throw ProtocolException("Compile server closed the connection without a response");
+
+        close(fd);
+        return decodeResponse(responsePayload);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+}
+
+}  // namespace Protocol
+
+ProtocolException::ProtocolException(std::string msg) : message(std::move(msg)) {}
+
+const char* ProtocolException::what() const noexcept {
+    return message.c_str();
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Wire protocol between the compile server ('milac --serve') and its clients
+ * @note Every message is a frame: 32-bit big-endian payload length followed by the payload. The payload starts with
+ * the message type byte, strings inside are again prefixed by their 32-bit big-endian length.
+ */
+namespace Protocol {
+
+enum class MessageType : char {
+    Compile = 'C',
+    Stats = 'S',
+    Shutdown = 'Q',
+    Response = 'R',
+};
+
+/**
+ * @brief Source plus flags, the server writes the executable to 'outputFile' (an absolute path)
+ */
+struct CompileRequest {
+    std::string source;
+    std::string outputFile;
+    std::vector<std::string> flags;
+};
+
+/**
+ * @brief Exit code and the diagnostics the compiler would print to standard and error output
+ */
+struct Response {
+    int exitCode = 0;
+    std::string out;
+    std::string err;
+};
+
+/**
+ * @brief Largest payload accepted from a peer, the length of a frame is not trusted beyond it
+ */
+constexpr uint32_t maxFrameSize = 256 * 1024 * 1024;
+
+/**
+ * @brief Returns '$XDG_RUNTIME_DIR/milac.sock', or '/tmp/milac-<uid>.sock' if XDG_RUNTIME_DIR is not set
+ */
+std::string defaultSocketPath();
+
+std::string encodeCompileRequest(const CompileRequest& request);
+std::string encodeResponse(const Response& response);
+CompileRequest decodeCompileRequest(const std::string& payload);
+Response decodeResponse(const std::string& payload);
+
+/**
+ * @brief Returns the type of the message in 'payload'
+ */
+MessageType messageType(const std::string& payload);
+
+/**
+ * @brief Writes 'payload' as one frame to the socket
+ */
+void writeFrame(int fd, const std::string& payload);
+
+/**
+ * @brief Reads one frame from the socket
+ * @returns False if the peer closed the connection before the frame started
+ * @throws ProtocolException If the frame is larger than maxFrameSize or the socket timed out
+ */
+bool readFrame(int fd, std::string& payload);
+
+/**
+ * @brief Connects to the server and exchanges one request for a response
+ * @throws ProtocolException If the socket or the server belongs to another user, or the exchange fails
+ */
+Response request(const std::string& socketPath, const std::string& payload);
+
+}  // namespace Protocol
+
+class ProtocolException : public std::exception {
+   private:
+    std::string message;
+
+   public:
+    explicit ProtocolException(std::string msg);
+
+    [[nodiscard]] const char* what() const noexcept override;
+};
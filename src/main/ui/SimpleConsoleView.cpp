@@ -1,15 +1,64 @@
 #include "SimpleConsoleView.hpp"
 #include "ast/CodeGenerator.hpp"
 #include "ast/visitor/PrintVisitor.hpp"
+#include "backend/Backend.hpp"
+#include "backend/JIT.hpp"
 #include "lexer/Lexer.hpp"
 #include "parser/Parser.hpp"
+#include "server/CompileServer.hpp"
+#include "utils/Statistic.hpp"
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/TimeProfiler.h>
+#include <unistd.h>
+#include <algorithm>
+#include <optional>
+
+/**
+ * @brief Gives a (worker) thread its own time trace profiler, merged into the trace on write. No-op on threads that
+ * already have one or if tracing is disabled.
+ */
+class ThreadTraceProfiler {
+   private:
+    bool owned;
+
+   public:
+    explicit ThreadTraceProfiler(bool tracing) : owned(tracing && !llvm::getTimeTraceProfilerInstance()) {
+        if (owned)
+            llvm::timeTraceProfilerInitialize(0, "milac");
+    }
+
+    ~ThreadTraceProfiler() {
+        if (owned)
+            llvm::timeTraceProfilerFinishThread();
+    }
+};
+
+SimpleConsoleView::SimpleConsoleView(std::ostream& out, std::ostream& err) : out(out), err(err) {}
 
 void SimpleConsoleView::showHelp() const {
-    std::cout << "Usage: milac [options] source.mila\n"
-              << "Options:\n"
-              << "  --help          Show this help message\n"
-              << "  -v              Enable verbose debugging\n"
-              << "  -o <file>       Specify output executable file name\n";
+    out << "Usage: milac [options] source.mila [source2.mila ...]\n"
+        << "       milac [options] -              (read the source from stdin)\n"
+        << "Options:\n"
+        << "  --help          Show this help message\n"
+        << "  -v              Enable verbose debugging (implies --time-phases)\n"
+        << "  -o <file>       Specify output executable file name (single input only)\n"
+        << "  -j <n>          Compile multiple input files on <n> threads (default: all hardware threads),\n"
+        << "                  each 'dir/source.mila' is compiled to 'dir/source.out'\n"
+        << "  --run           Run the program in the JIT instead of producing an executable\n"
+        << "  --pipeline-lexer Lex on a separate thread concurrently with parsing (for very large sources)\n"
+        << "  --cache         Reuse/store the executable in the compilation cache ($XDG_CACHE_HOME/milac)\n"
+        << "  --cache-dir <d> Same as --cache, but with the cache in directory <d>\n"
+        << "  -O<level>       Optimization level: 0 (default), 1, 2, 3 or s (optimize for size)\n"
+        << "  --time-phases   Print the time spent in each compiler phase (and LLVM pass)\n"
+        << "  --trace=<file>  Write a Chrome trace event file (chrome://tracing, Perfetto) of the compilation\n"
+        << "  --stats[=json]  Print compiler statistics (tokens, AST nodes, symbol lookups, IR size) to stderr\n"
+        << "  --serve         Run the compile server (keeps LLVM state warm between compilations)\n"
+        << "  --connect       Forward the compilation to the compile server (with -O<level> and -o only)\n"
+        << "  --server-stats  Print request counts and latency histogram of the compile server\n"
+        << "  --server-stop   Stop the compile server\n"
+        << "  --socket <path> Socket of the compile server (default: $XDG_RUNTIME_DIR/milac.sock)\n";
 }
 
 int SimpleConsoleView::run(const std::vector<std::string>& args) {
@@ -19,81 +68,284 @@ int SimpleConsoleView::run(const std::vector<std::string>& args) {
     if (!readyToRun)
         return EXIT_SUCCESS;
 
-    std::ifstream file(inputFileName);
-    std::string fileContent((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    std::istringstream input(fileContent);
+    if (serverMode != ServerMode::None)
+        return runServerMode();
+
+    std::optional<CompilationCache> cache;
+    if (useCache && !jitRun) {
+        try {
+            cache.emplace(cacheDir.empty() ? CompilationCache::defaultDirectory() : cacheDir);
+        } catch (const CacheException& e) {
+            err << "Cache warning: " << e.what() << std::endl;
+        }
+    }
+
+    if (!traceFile.empty())
+        llvm::timeTraceProfilerInitialize(0, "milac");
+
+    if (statsFormat != StatsFormat::None) {
+        StatisticRegistry::instance().reset();
+        StatisticRegistry::instance().setEnabled(true);
+    }
+
+    int exitCode = inputFileNames.size() == 1
+                       ? compileFile(inputFileNames.front(), outputFileName, cache ? &*cache : nullptr, out, err)
+                       : compileBatch(cache ? &*cache : nullptr);
+
+    if (phaseTimings)
+        phaseTimings->print(out);
 
-    Lexer lexer(input);
-    Parser parser(lexer, verbose);
+    if (statsFormat != StatsFormat::None) {
+        StatisticRegistry::instance().print(err, statsFormat == StatsFormat::Json);
+        StatisticRegistry::instance().setEnabled(false);
+    }
+
+    if (!traceFile.empty()) {
+        if (llvm::Error error = llvm::timeTraceProfilerWrite(traceFile, traceFile))
+            err << "Error: failed to write trace file: " << llvm::toString(std::move(error)) << std::endl;
+        llvm::timeTraceProfilerCleanup();
+    }
+
+    if (verbose && cache) {
+        out << "---------- CACHE -------------------\n"
+            << "Directory: " << cache->getDirectory() << "\n"
+            << "Hits:      " << cache->getHits() << "\n"
+            << "Misses:    " << cache->getMisses() << "\n";
+    }
+
+    return exitCode;
+}
+
+int SimpleConsoleView::compileFile(const std::string& inputFile, const std::string& outputFile,
+                                   CompilationCache* cache, std::ostream& fileOut, std::ostream& fileErr) const {
+    std::optional<PhaseTimings::Activation> timingsActivation;
+    if (phaseTimings)
+        timingsActivation.emplace(*phaseTimings);
+
+    ThreadTraceProfiler traceProfiler(!traceFile.empty());
+    llvm::TimeTraceScope fileScope("Compile file", inputFile);
+
+    // Files are memory-mapped and lexed in place, '-' is stdin
+    std::optional<SourceBuffer> source;
+    try {
+        PhaseTimer timer("Reading source");
+        source.emplace(inputFile == "-" ? SourceBuffer::fromFileDescriptor(STDIN_FILENO)
+                                        : SourceBuffer::fromFile(inputFile));
+    } catch (const SourceBufferException& e) {
+        fileErr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // A hit skips the whole compilation, the executable is just copied from the cache
+    std::string cacheKey;
+    if (cache) {
+        cacheKey =
+            CompilationCache::computeKey(source->getContent(), toString(optLevel), llvm::sys::getProcessTriple());
+        if (cache->lookup(cacheKey, outputFile))
+            return EXIT_SUCCESS;
+    }
 
     if (verbose) {
-        std::cout << "---------- LEXER -------------------\n";
+        fileOut << "---------- LEXER -------------------\n";
     }
 
-    std::unique_ptr<ProgramASTNode> programNode;
+    // Resolves the offsets stored in the tokens and the AST for the diagnostics
+    SourceManager sources(*source, inputFile);
+
+    // Owns the AST, released in one go at the end of the compilation
+    ASTContext astContext;
+    ProgramASTNode* programNode = nullptr;
 
     try {
-        programNode = parser.parseProgram();
+        if (pipelineLexer) {
+            // The lexer thread fills a bounded ring while the parser consumes it
+            TokenPipe tokens(*source);
+
+            PhaseTimer timer("Parsing");
+            Parser parser(tokens, astContext, verbose, fileOut);
+            programNode = parser.parseProgram();
+        } else {
+            // The whole file is lexed up front, the parser then walks the token arrays
+            TokenStream tokens = TokenStream::lex(*source);
+
+            PhaseTimer timer("Parsing");
+            Parser parser(tokens, astContext, verbose, fileOut);
+            programNode = parser.parseProgram();
+        }
     } catch (const ParserException& e) {
-        std::cerr << "Parser error: " << e.what() << std::endl;
+        fileErr << "Parser error: " << e.what() << std::endl;
         return EXIT_FAILURE;
     } catch (const LexerException& e) {
-        std::cerr << "Lexer error: " << e.what() << std::endl;
+        fileErr << "Lexer error: " << e.what() << std::endl;
         return EXIT_FAILURE;
     }
 
     if (verbose) {
-        std::cout << "---------- PARSED AST --------------\n";
-        PrintVisitor printVisitor(std::cout);
+        fileOut << "---------- PARSED AST --------------\n";
+        PrintVisitor printVisitor(fileOut);
         programNode->accept(printVisitor);
     }
 
-    CodeGenerator codegen(programNode.get());
+    CodeGenerator codegen(programNode);
+
+    if (jitRun)
+        return runInJIT(codegen, sources);
+
+    GenContext gen("mila-module");
 
     try {
-        codegen.generate("output.ir");
+        Backend backend(optLevel);
+        backend.configureModule(gen.module);
+
+        {
+            PhaseTimer timer("Code generation");
+            codegen.generate(gen);
+        }
+
+        CodeGenerator::optimize(gen.module, optLevel, &backend.getTargetMachine());
+
+        // Emits the object file straight from the in-memory module and links it against the prebuilt runtime
+        backend.compile(gen.module, outputFile);
     } catch (const CodeGenException& e) {
-        std::cerr << "Code generation error: " << e.what() << std::endl;
+        fileErr << "Code generation error: " << e.format(sources) << std::endl;
+        return EXIT_FAILURE;
+    } catch (const BackendException& e) {
+        fileErr << "Backend error: " << e.what() << std::endl;
         return EXIT_FAILURE;
     }
 
-    Utils::ProgramRunResult llcResult = Utils::exec(R"(llc "output.ir" -o "output.s" -relocation-model=pic)");
+    if (cache) {
+        // The executable is already produced, failing to cache it is not an error
+        try {
+            cache->store(cacheKey, outputFile);
+        } catch (const CacheException& e) {
+            fileErr << "Cache warning: " << e.what() << std::endl;
+        }
+    }
 
-    if (llcResult.exitCode != 0) {
-        std::cerr << "LLVM IR to assembly compilation failed with exit code " << llcResult.exitCode << std::endl;
-        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
+
+int SimpleConsoleView::compileBatch(CompilationCache* cache) const {
+    struct FileResult {
+        int exitCode = EXIT_FAILURE;
+        std::ostringstream out;
+        std::ostringstream err;
+    };
+
+    std::vector<FileResult> results(inputFileNames.size());
+
+    {
+        // Workers share nothing but the (thread-safe) cache, diagnostics are buffered per file
+        llvm::ThreadPool pool(llvm::hardware_concurrency(jobs));
+        for (size_t i = 0; i < inputFileNames.size(); ++i) {
+            pool.async([this, cache, &results, i]() {
+                const std::string& inputFile = inputFileNames[i];
+                FileResult& result = results[i];
+                result.exitCode =
+                    compileFile(inputFile, batchOutputFileName(inputFile), cache, result.out, result.err);
+            });
+        }
+        pool.wait();
     }
 
-    std::string ioCodeInC =
-        "#include <stdio.h>\n"
-        "#include <stdlib.h>\n"
-        "int write_int(int x) { printf(\"%d\", x); return 0;}int write_double(double x) { printf(\"%.3f\", x); return "
-        "0;}int writeln_int(int x) { printf(\"%d\\n\", x); return 0;}int writeln_double(double x) { "
-        "printf(\"%.3f\\n\", x); return 0;}int readln_int(int *x) { scanf(\"%d\", x); return 0;}int "
-        "readln_double(double *x) { scanf(\"%lf\", x); return 0;} int error(char *s) { printf(\"%s\", s); exit(1); }";
+    unsigned failed = 0;
+    for (size_t i = 0; i < inputFileNames.size(); ++i) {
+        const FileResult& result = results[i];
+        out << result.out.str();
+        err << result.err.str();
 
-    std::ofstream ioFile("io.c");
-    if (!ioFile.is_open()) {
-        std::cerr << "Error: failed to open io.c file for writing" << std::endl;
-        return EXIT_FAILURE;
+        if (result.exitCode == EXIT_SUCCESS) {
+            out << inputFileNames[i] << ": compiled to " << batchOutputFileName(inputFileNames[i]) << "\n";
+        } else {
+            err << inputFileNames[i] << ": failed" << std::endl;
+            ++failed;
+        }
     }
-    ioFile << ioCodeInC;
-    ioFile.close();
 
-    std::string clangCmd = "clang output.s io.c -o " + outputFileName;
-    Utils::ProgramRunResult clangResult = Utils::exec(clangCmd);
+    out << "Compiled " << inputFileNames.size() - failed << " of " << inputFileNames.size() << " files" << std::endl;
 
-    if (clangResult.exitCode != 0) {
-        std::cerr << "Assembly to object compilation failed with exit code " << clangResult.exitCode << std::endl;
-        return EXIT_FAILURE;
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int SimpleConsoleView::runServerMode() const {
+    const std::string socket = socketPath.empty() ? Protocol::defaultSocketPath() : socketPath;
+
+    try {
+        switch (serverMode) {
+            case ServerMode::Serve: {
+                CompileServer server(socket);
+                out << "Compile server listening on " << socket << std::endl;
+                server.serve();
+                return EXIT_SUCCESS;
+            }
+            case ServerMode::Stats: {
+                std::string payload(1, static_cast<char>(Protocol::MessageType::Stats));
+                out << Protocol::request(socket, payload).out;
+                return EXIT_SUCCESS;
+            }
+            case ServerMode::Shutdown: {
+                std::string payload(1, static_cast<char>(Protocol::MessageType::Shutdown));
+                return Protocol::request(socket, payload).exitCode;
+            }
+            default:
+                break;
+        }
+
+        // Thin client, the server reads nothing from the file system but writes the executable to the absolute path
+        int exitCode = EXIT_SUCCESS;
+        for (const auto& inputFile : inputFileNames) {
+            Protocol::CompileRequest request;
+            try {
+                SourceBuffer source = inputFile == "-" ? SourceBuffer::fromFileDescriptor(STDIN_FILENO)
+                                                       : SourceBuffer::fromFile(inputFile);
+                request.source = source.getContent();
+            } catch (const SourceBufferException& e) {
+                err << "Error: " << e.what() << std::endl;
+                exitCode = EXIT_FAILURE;
+                continue;
+            }
+            request.flags = {toString(optLevel)};
+
+            llvm::SmallString<128> outputFile(inputFileNames.size() == 1 ? outputFileName
+                                                                         : batchOutputFileName(inputFile));
+            llvm::sys::fs::make_absolute(outputFile);
+            request.outputFile = outputFile.str().str();
+
+            Protocol::Response response = Protocol::request(socket, Protocol::encodeCompileRequest(request));
+            out << response.out;
+            err << response.err;
+            if (response.exitCode != EXIT_SUCCESS)
+                exitCode = response.exitCode;
+        }
+        return exitCode;
+    } catch (const ProtocolException& e) {
+        err << "Compile server error: " << e.what() << std::endl;
+    } catch (const ServerException& e) {
+        err << "Compile server error: " << e.what() << std::endl;
     }
 
-    // clear all generated files - uncomment if you want to keep them
-    std::remove("output.ir");
-    std::remove("output.s");
-    std::remove("io.c");
+    return EXIT_FAILURE;
+}
 
-    return EXIT_SUCCESS;
+int SimpleConsoleView::runInJIT(const CodeGenerator& codegen, const SourceManager& sources) const {
+    try {
+        JIT jit;
+        GenContext gen("mila-module");
+        jit.configureModule(gen.module);
+        codegen.generate(gen);
+        CodeGenerator::optimize(gen.module, optLevel);
+
+        // Functions are compiled lazily on their first call
+        jit.addModule(gen);
+        return jit.runMain();
+    } catch (const CodeGenException& e) {
+        err << "Code generation error: " << e.format(sources) << std::endl;
+    } catch (const JITException& e) {
+        err << "JIT error: " << e.what() << std::endl;
+    }
+
+    return EXIT_FAILURE;
 }
 
 int SimpleConsoleView::parseArgs(const std::vector<std::string>& args) {
@@ -109,25 +361,112 @@ int SimpleConsoleView::parseArgs(const std::vector<std::string>& args) {
 
     for (unsigned i = 0; i < args.size(); ++i) {
         if (args[i] == "-v") {
+            // The compile times are reported with the phase timings
             verbose = true;
+            if (!phaseTimings)
+                phaseTimings = std::make_unique<PhaseTimings>();
+        } else if (args[i] == "--cache") {
+            useCache = true;
+        } else if (args[i] == "--cache-dir") {
+            if (i + 1 < args.size()) {
+                useCache = true;
+                cacheDir = args[i + 1];
+                ++i;
+            } else {
+                err << "Error: missing cache directory" << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (args[i] == "--time-phases") {
+            if (!phaseTimings)
+                phaseTimings = std::make_unique<PhaseTimings>();
+        } else if (args[i].rfind("--trace=", 0) == 0 && args[i].size() > std::string("--trace=").size()) {
+            traceFile = args[i].substr(std::string("--trace=").size());
+        } else if (args[i] == "--stats") {
+            statsFormat = StatsFormat::Text;
+        } else if (args[i] == "--stats=json") {
+            statsFormat = StatsFormat::Json;
+        } else if (args[i] == "--run") {
+            jitRun = true;
+        } else if (args[i] == "--pipeline-lexer") {
+            pipelineLexer = true;
+        } else if (auto level = optLevelFromString(args[i])) {
+            optLevel = *level;
+        } else if (args[i] == "--serve") {
+            serverMode = ServerMode::Serve;
+        } else if (args[i] == "--connect") {
+            serverMode = ServerMode::Connect;
+        } else if (args[i] == "--server-stats") {
+            serverMode = ServerMode::Stats;
+        } else if (args[i] == "--server-stop") {
+            serverMode = ServerMode::Shutdown;
+        } else if (args[i] == "--socket") {
+            if (i + 1 < args.size()) {
+                socketPath = args[i + 1];
+                ++i;
+            } else {
+                err << "Error: missing socket path" << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (args[i] == "-j") {
+            if (i + 1 < args.size() && !args[i + 1].empty() &&
+                args[i + 1].find_first_not_of("0123456789") == std::string::npos) {
+                jobs = std::stoul(args[i + 1]);
+                ++i;
+            } else {
+                err << "Error: missing or invalid number of jobs" << std::endl;
+                return EXIT_FAILURE;
+            }
         } else if (args[i] == "-o") {
             if (i + 1 < args.size()) {
                 outputFileName = (args[i + 1] + ".out");
                 ++i;
             } else {
-                std::cerr << "Error: missing output filename" << std::endl;
+                err << "Error: missing output filename" << std::endl;
                 return EXIT_FAILURE;
             }
-        } else if (Utils::hasExtension(args[i], ".mila")) {
-            inputFileName = args[i];
+        } else if (Utils::hasExtension(args[i], ".mila") || args[i] == "-") {
+            inputFileNames.push_back(args[i]);
         } else {
-            std::cerr << "Error: unknown option or invalid file: " << args[i] << std::endl;
+            err << "Error: unknown option or invalid file: " << args[i] << std::endl;
             return EXIT_FAILURE;
         }
     }
 
-    if (inputFileName.empty()) {
-        std::cerr << "Error: missing input file" << std::endl;
+    // The server itself and its queries take no input files
+    bool needsInput = serverMode == ServerMode::None || serverMode == ServerMode::Connect;
+    if (!needsInput) {
+        readyToRun = true;
+        return EXIT_SUCCESS;
+    }
+
+    // The server is only sent the optimization level, options it could not honor are refused rather than ignored
+    if (serverMode == ServerMode::Connect &&
+        (jitRun || useCache || verbose || phaseTimings || !traceFile.empty() || statsFormat != StatsFormat::None ||
+         pipelineLexer || jobs != 0)) {
+        err << "Error: --connect only supports -O<level>, -o and --socket (not --run, --cache, -v, --time-phases, "
+               "--trace=, --stats, --pipeline-lexer or -j)"
+            << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (inputFileNames.empty()) {
+        err << "Error: missing input file" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (inputFileNames.size() > 1 && !outputFileName.empty()) {
+        err << "Error: -o cannot be used with multiple input files" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    bool readsStdin = std::find(inputFileNames.begin(), inputFileNames.end(), "-") != inputFileNames.end();
+    if (inputFileNames.size() > 1 && readsStdin) {
+        err << "Error: stdin ('-') cannot be compiled together with other input files" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (inputFileNames.size() > 1 && jitRun) {
+        err << "Error: --run cannot be used with multiple input files" << std::endl;
         return EXIT_FAILURE;
     }
 
@@ -139,3 +478,7 @@ int SimpleConsoleView::parseArgs(const std::vector<std::string>& args) {
 
     return EXIT_SUCCESS;
 }
+
+std::string SimpleConsoleView::batchOutputFileName(const std::string& inputFile) {
+    return inputFile.substr(0, inputFile.size() - std::string(".mila").size()) + ".out";
+}
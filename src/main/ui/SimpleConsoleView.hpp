@@ -3,12 +3,21 @@
 #include <fstream>
 #include <vector>
 #include <string>
+#include "ast/CodeGenerator.hpp"
+#include "cache/CompilationCache.hpp"
+#include "utils/PhaseTimer.hpp"
 #include "utils/Utils.hpp"
 
 /**
  * @note No fancy view nor OOP, just a simple cli args parser to make compiler a bit more user-friendly
  */
 class SimpleConsoleView {
+    /**
+     * @brief Standard and error output of the application
+     */
+    std::ostream& out;
+    std::ostream& err;
+
     /**
      * @brief parseArgs sets this flag if all arguments are valid and ready to run
      */
@@ -20,18 +29,99 @@ class SimpleConsoleView {
     bool verbose = false;
 
     /**
-     * @brief .mila source file
+     * @brief Whether to lex on a separate thread concurrently with parsing ('--pipeline-lexer'), pays off for very
+     * large sources only
+     */
+    bool pipelineLexer = false;
+
+    /**
+     * @brief Optimization level selected by '-O0', '-O1', '-O2', '-O3' or '-Os'
+     */
+    OptLevel optLevel = OptLevel::O0;
+
+    /**
+     * @brief Whether to run the program in the JIT ('--run') instead of producing an executable
+     */
+    bool jitRun = false;
+
+    /**
+     * @brief Whether to look up / store the executable in the compilation cache ('--cache' or '--cache-dir <dir>')
+     */
+    bool useCache = false;
+
+    /**
+     * @brief Cache directory, empty for the default one
+     */
+    std::string cacheDir;
+
+    /**
+     * @brief Number of files compiled in parallel ('-j <n>'), 0 for the number of hardware threads
+     */
+    unsigned jobs = 0;
+
+    /**
+     * @brief Collects the per-phase summary table if '--time-phases' is given
+     */
+    std::unique_ptr<PhaseTimings> phaseTimings;
+
+    /**
+     * @brief Chrome trace event file ('--trace=<file>'), empty if tracing is disabled
+     */
+    std::string traceFile;
+
+    /**
+     * @brief Output format of the compiler statistics ('--stats', '--stats=json'), None if they are not printed
+     */
+    enum class StatsFormat { None, Text, Json } statsFormat = StatsFormat::None;
+
+    /**
+     * @brief Compile server role: '--serve' runs the daemon, '--connect' forwards compilation to it, '--server-stats'
+     * and '--server-stop' query/stop it
+     */
+    enum class ServerMode { None, Serve, Connect, Stats, Shutdown } serverMode = ServerMode::None;
+
+    /**
+     * @brief Unix domain socket of the compile server ('--socket <path>')
      */
-    std::string inputFileName;
+    std::string socketPath;
 
     /**
-     * @brief output executable file
+     * @brief .mila source files
+     */
+    std::vector<std::string> inputFileNames;
+
+    /**
+     * @brief output executable file, only used with a single input file
      */
     std::string outputFileName;
 
     void showHelp() const;
 
+    /**
+     * @brief Compiles 'inputFile' into the executable 'outputFile', all diagnostics go to the given streams
+     * @note Thread-safe, every call owns its contexts, target machine and temporary files
+     */
+    int compileFile(const std::string& inputFile, const std::string& outputFile, CompilationCache* cache,
+                    std::ostream& fileOut, std::ostream& fileErr) const;
+
+    /**
+     * @brief Compiles all input files on a thread pool and reports the results per file (in the order of the inputs)
+     */
+    int compileBatch(CompilationCache* cache) const;
+
+    /**
+     * @brief Runs the compile server or the client side of the chosen ServerMode
+     */
+    int runServerMode() const;
+
+    /**
+     * @brief Generates the module, runs it in the JIT and returns the exit code of the program
+     */
+    int runInJIT(const CodeGenerator& codegen, const SourceManager& sources) const;
+
    public:
+    explicit SimpleConsoleView(std::ostream& out = std::cout, std::ostream& err = std::cerr);
+
     /**
      * @brief Starts the application
      */
@@ -41,4 +131,9 @@ class SimpleConsoleView {
      * @brief Parses the command line arguments
      */
     int parseArgs(const std::vector<std::string>& args);
-};
\ No newline at end of file
+
+    /**
+     * @brief Output executable name of the input file in batch mode, e.g. 'dir/prog.mila' -> 'dir/prog.out'
+     */
+    [[nodiscard]] static std::string batchOutputFileName(const std::string& inputFile);
+};
@@ -0,0 +1,99 @@
+#include "PhaseTimer.hpp"
+#include <llvm/Support/TimeProfiler.h>
+#include <iomanip>
+
+static thread_local PhaseTimings* activeTimings = nullptr;
+
+/**
+ * @brief Nesting depth of the PhaseTimer scopes on the calling thread
+ */
+static thread_local unsigned timerDepth = 0;
+
+PhaseTimings::Activation::Activation(PhaseTimings& timings) : previous(activeTimings) {
+    activeTimings = &timings;
+}
+
+PhaseTimings::Activation::~Activation() {
+    activeTimings = previous;
+}
+
+PhaseTimings* PhaseTimings::active() {
+    return activeTimings;
+}
+
+PhaseTimings::Phase& PhaseTimings::findOrCreate(const std::string& phase, unsigned level) {
+    for (auto& entry : phases) {
+        if (entry.name == phase && entry.level == level)
+            return entry;
+    }
+
+    return phases.emplace_back(Phase{phase, level, 0, 0});
+}
+
+void PhaseTimings::registerPhase(const std::string& phase, unsigned level) {
+    std::lock_guard<std::mutex> lock(mutex);
+    (void)findOrCreate(phase, level);
+}
+
+void PhaseTimings::add(const std::string& phase, unsigned level, double ms) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Phase& entry = findOrCreate(phase, level);
+    ++entry.count;
+    entry.totalMs += ms;
+}
+
+void PhaseTimings::addPassReport(const std::string& report) {
+    std::lock_guard<std::mutex> lock(mutex);
+    passReport += report;
+}
+
+void PhaseTimings::print(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    double totalMs = 0;
+    for (const auto& entry : phases) {
+        if (entry.level == 0)
+            totalMs += entry.totalMs;
+    }
+
+    os << "---------- PHASE TIMES -------------\n"
+       << std::left << std::setw(32) << "Phase" << std::right << std::setw(8) << "Count" << std::setw(12) << "Time (ms)"
+       << std::setw(8) << "%" << "\n";
+
+    std::ios_base::fmtflags flags = os.flags();
+    os << std::fixed << std::setprecision(3);
+    for (const auto& entry : phases) {
+        os << std::left << std::setw(32) << (std::string(2 * entry.level, ' ') + entry.name) << std::right
+           << std::setw(8) << entry.count << std::setw(12) << entry.totalMs << std::setw(8) << std::setprecision(1)
+           << (totalMs > 0 ? 100 * entry.totalMs / totalMs : 0) << std::setprecision(3) << "\n";
+    }
+    os << std::left << std::setw(32) << "Total" << std::right << std::setw(8) << "" << std::setw(12) << totalMs
+       << "\n";
+    os.flags(flags);
+
+    os << passReport;
+}
+
+PhaseTimer::PhaseTimer(const char* phase, const std::string& detail)
+    : timings(PhaseTimings::active()), phase(phase), traced(llvm::timeTraceProfilerEnabled()) {
+    if (this->traced)
+        llvm::timeTraceProfilerBegin(phase, detail);
+
+    if (timings) {
+        timings->registerPhase(phase, timerDepth);
+        ++timerDepth;
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+PhaseTimer::~PhaseTimer() {
+    if (timings) {
+        --timerDepth;
+        timings->add(phase, timerDepth,
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    if (traced)
+        llvm::timeTraceProfilerEnd();
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Thread-safe registry of the wall time spent in the compiler phases ('--time-phases')
+ * @note Phases are recorded by PhaseTimer scopes into the registry activated on the calling thread, so that no
+ * component needs to be handed the registry explicitly. Without an active registry the scopes cost next to nothing.
+ */
+class PhaseTimings {
+   private:
+    struct Phase {
+        std::string name;
+        /**
+         * @brief Nesting depth of the phase (e.g. lexing happens inside parsing)
+         */
+        unsigned level;
+        unsigned count;
+        double totalMs;
+    };
+
+    mutable std::mutex mutex;
+
+    [[nodiscard]] Phase& findOrCreate(const std::string& phase, unsigned level);
+
+    /**
+     * @brief In the order of the first occurrence, which keeps nested phases right below their parents
+     */
+    std::vector<Phase> phases;
+
+    std::string passReport;
+
+   public:
+    /**
+     * @brief Makes the registry active on the calling thread for the lifetime of the object
+     */
+    class Activation {
+       private:
+        PhaseTimings* previous;
+
+       public:
+        explicit Activation(PhaseTimings& timings);
+        ~Activation();
+
+        Activation(const Activation&) = delete;
+        Activation& operator=(const Activation&) = delete;
+    };
+
+    /**
+     * @brief Returns the registry active on the calling thread, nullptr if there is none
+     */
+    [[nodiscard]] static PhaseTimings* active();
+
+    /**
+     * @brief Creates the entry of the phase if it does not exist yet, called when a phase starts (so that a parent phase
+     * is listed before the phases nested in it)
+     */
+    void registerPhase(const std::string& phase, unsigned level);
+
+    void add(const std::string& phase, unsigned level, double ms);
+
+    /**
+     * @brief Appends the LLVM pass timing report of one optimization pipeline run
+     */
+    void addPassReport(const std::string& report);
+
+    /**
+     * @brief Prints the summary table followed by the LLVM pass timing reports
+     */
+    void print(std::ostream& os) const;
+};
+
+/**
+ * @brief Scoped timer of a compiler phase, records into the active PhaseTimings and emits a Chrome trace event if the
+ * LLVM time trace profiler is enabled ('--trace')
+ */
+class PhaseTimer {
+   private:
+    PhaseTimings* timings;
+    const char* phase;
+    bool traced;
+    std::chrono::steady_clock::time_point start;
+
+   public:
+    /**
+     * @param detail Shown in the trace event only (e.g. the function name), not aggregated in the summary
+     * @note Meant for whole phases, not per-token scopes: the clock reads would cost more than the work they time
+     */
+    explicit PhaseTimer(const char* phase, const std::string& detail = "");
+    ~PhaseTimer();
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
@@ -0,0 +1,110 @@
+#include "Statistic.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+
+Statistic::Statistic(const char* group, const char* name, const char* description)
+    : group(group), name(name), description(description) {
+    StatisticRegistry::instance().registerStatistic(this);
+}
+
+StatisticRegistry& StatisticRegistry::instance() {
+    // Function local, so that it is constructed before the first (static) Statistic registers itself
+    static StatisticRegistry registry;
+    return registry;
+}
+
+void StatisticRegistry::registerStatistic(Statistic* statistic) {
+    std::lock_guard<std::mutex> lock(mutex);
+    statistics.push_back(statistic);
+}
+
+void StatisticRegistry::setEnabled(bool enable) {
+    enabled = enable;
+}
+
+bool StatisticRegistry::isEnabled() const {
+    return enabled;
+}
+
+void StatisticRegistry::add(const std::string& group, const std::string& name, uint64_t n) {
+    if (!enabled)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    namedCounters[group][name] += n;
+}
+
+uint64_t StatisticRegistry::getValue(const std::string& group, const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const Statistic* statistic : statistics) {
+        if (group == statistic->group && name == statistic->name)
+            return statistic->getValue();
+    }
+
+    auto groupIt = namedCounters.find(group);
+    if (groupIt == namedCounters.end())
+        return 0;
+
+    auto it = groupIt->second.find(name);
+    return it == groupIt->second.end() ? 0 : it->second;
+}
+
+void StatisticRegistry::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (Statistic* statistic : statistics)
+        statistic->value = 0;
+    namedCounters.clear();
+}
+
+void StatisticRegistry::print(std::ostream& os, bool json) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    struct Row {
+        std::string group;
+        std::string name;
+        std::string description;
+        uint64_t value;
+    };
+
+    std::vector<Row> rows;
+    for (const Statistic* statistic : statistics) {
+        if (uint64_t value = statistic->getValue())
+            rows.push_back({statistic->group, statistic->name, statistic->description, value});
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+        return std::tie(a.group, a.name) < std::tie(b.group, b.name);
+    });
+
+    for (const auto& [group, counters] : namedCounters) {
+        for (const auto& [name, value] : counters)
+            rows.push_back({group, name, name, value});
+    }
+
+    if (json) {
+        llvm::json::Object root;
+        for (const auto& row : rows) {
+            llvm::json::Value& groupObject = root[row.group];
+            if (!groupObject.getAsObject())
+                groupObject = llvm::json::Object();
+            (*groupObject.getAsObject())[row.name] = int64_t(row.value);
+        }
+
+        std::string text;
+        llvm::raw_string_ostream textStream(text);
+        textStream << llvm::formatv("{0:2}", llvm::json::Value(std::move(root)));
+        os << textStream.str() << "\n";
+        return;
+    }
+
+    os << "===-------------------------------------------------------------------------===\n"
+       << "                          ... Statistics Collected ...\n"
+       << "===-------------------------------------------------------------------------===\n\n";
+    for (const auto& row : rows)
+        os << std::setw(10) << row.value << " " << std::left << std::setw(10) << row.group << std::right << " - "
+           << row.description << "\n";
+}
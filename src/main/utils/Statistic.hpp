@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Process-wide counter in the spirit of LLVM's STATISTIC, defined with MILA_STATISTIC at namespace scope
+ * @note Increments are relaxed atomics, so counters are always on and safe to bump from the batch worker threads
+ */
+class Statistic {
+   private:
+    const char* group;
+    const char* name;
+    const char* description;
+    std::atomic<uint64_t> value{0};
+
+    friend class StatisticRegistry;
+
+   public:
+    Statistic(const char* group, const char* name, const char* description);
+
+    Statistic(const Statistic&) = delete;
+    Statistic& operator=(const Statistic&) = delete;
+
+    Statistic& operator++() {
+        value.fetch_add(1, std::memory_order_relaxed);
+        return *this;
+    }
+
+    Statistic& operator+=(uint64_t n) {
+        value.fetch_add(n, std::memory_order_relaxed);
+        return *this;
+    }
+
+    [[nodiscard]] uint64_t getValue() const { return value.load(std::memory_order_relaxed); }
+};
+
+/**
+ * @brief Defines a statistic 'VAR' of the translation unit, e.g. MILA_STATISTIC(NumTokens, "lexer", "Tokens lexed")
+ */
+#define MILA_STATISTIC(VAR, GROUP, DESC) static Statistic VAR(GROUP, #VAR, DESC)
+
+/**
+ * @brief Registry of all statistics plus dynamically named counters (e.g. per Mila function IR sizes)
+ */
+class StatisticRegistry {
+   private:
+    mutable std::mutex mutex;
+    std::vector<Statistic*> statistics;
+
+    /**
+     * @brief group -> name -> value
+     */
+    std::map<std::string, std::map<std::string, uint64_t>> namedCounters;
+
+    /**
+     * @brief Whether the (more expensive) named counters should be collected, set by '--stats'
+     */
+    std::atomic<bool> enabled{false};
+
+    StatisticRegistry() = default;
+
+   public:
+    [[nodiscard]] static StatisticRegistry& instance();
+
+    void registerStatistic(Statistic* statistic);
+
+    void setEnabled(bool enable);
+    [[nodiscard]] bool isEnabled() const;
+
+    /**
+     * @brief Adds 'n' to the dynamically named counter, no-op unless the registry is enabled
+     */
+    void add(const std::string& group, const std::string& name, uint64_t n);
+
+    /**
+     * @brief Returns the value of the statistic or named counter, 0 if there is none
+     */
+    [[nodiscard]] uint64_t getValue(const std::string& group, const std::string& name) const;
+
+    /**
+     * @brief Zeroes all statistics and drops the named counters
+     */
+    void reset();
+
+    /**
+     * @brief Prints the non-zero counters, in LLVM's '-stats' text format or as JSON ({"group": {"name": value}})
+     */
+    void print(std::ostream& os, bool json) const;
+};
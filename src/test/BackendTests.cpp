@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <sstream>
+#include "ast/CodeGenerator.hpp"
+#include "backend/Backend.hpp"
+#include "backend/JIT.hpp"
+#include "parser/Parser.hpp"
+#include "utils/Utils.hpp"
+
+TEST(BackendTests, HandlesObjectEmissionToMemory) {
+    std::istringstream input("program test; begin writeln(42); end.");
+    Lexer lexer(input);
+    ASTContext context;
+    Parser parser(lexer, context);
+    auto programNode = parser.parseProgram();
+
+    GenContext gen("mila-module");
+    Backend backend;
+    backend.configureModule(gen.module);
+    CodeGenerator(programNode).generate(gen);
+
+    llvm::SmallVector<char, 0> objBuffer;
+    backend.emitObject(gen.module, objBuffer);
+
+    ASSERT_GE(objBuffer.size(), 4u);
+    EXPECT_EQ(std::string("\x7f" "ELF"), std::string(objBuffer.data(), 4));
+}
+
+TEST(BackendTests, HandlesModuleConfiguration) {
+    GenContext gen("mila-module");
+    Backend backend;
+    backend.configureModule(gen.module);
+
+    EXPECT_EQ(backend.getTargetMachine().getTargetTriple().str(), gen.module.getTargetTriple());
+    EXPECT_FALSE(gen.module.getDataLayoutStr().empty());
+}
+
+TEST(BackendTests, ThrowsOnLinkWithoutMain) {
+    GenContext gen("mila-module");
+    Backend backend;
+    backend.configureModule(gen.module);
+
+    ASSERT_THROW(backend.compile(gen.module, "no_main.out"), BackendException);
+}
+
+TEST(BackendTests, HandlesDirectLink) {
+    ASSERT_TRUE(Backend::enableDirectLink());
+
+    std::istringstream input("program test; begin writeln(42); end.");
+    Lexer lexer(input);
+    ASTContext context;
+    Parser parser(lexer, context);
+    auto programNode = parser.parseProgram();
+
+    GenContext gen("mila-module");
+    Backend backend;
+    backend.configureModule(gen.module);
+    CodeGenerator(programNode).generate(gen);
+    backend.compile(gen.module, "direct_link.out");
+
+    EXPECT_EQ("42\n", Utils::exec("./direct_link.out").output);
+    std::remove("direct_link.out");
+
+    // A failing direct link is reported like one through the driver
+    GenContext noMain("mila-module");
+    backend.configureModule(noMain.module);
+    ASSERT_THROW(backend.compile(noMain.module, "no_main.out"), BackendException);
+}
+
+static int RunInJIT(const std::string& src, std::string& output, unsigned compileThreads = JIT::defaultCompileThreads()) {
+    std::istringstream input(src);
+    Lexer lexer(input);
+    ASTContext context;
+    Parser parser(lexer, context);
+    auto programNode = parser.parseProgram();
+
+    JIT jit(compileThreads);
+    GenContext gen("mila-module");
+    jit.configureModule(gen.module);
+    CodeGenerator(programNode).generate(gen);
+    jit.addModule(gen);
+
+    testing::internal::CaptureStdout();
+    int exitCode = jit.runMain();
+    output = testing::internal::GetCapturedStdout();
+    return exitCode;
+}
+
+TEST(BackendTests, HandlesJITRun) {
+    const std::string src =
+        "program test;\n"
+        "var x: real;\n"
+        "begin\n"
+        "    x := 7.0;\n"
+        "    writeln(42);\n"
+        "    write(x mod 2.0);\n"
+        "end.";
+
+    std::string output;
+    EXPECT_EQ(0, RunInJIT(src, output));
+    EXPECT_EQ("42\n1.000", output);
+}
+
+TEST(BackendTests, HandlesJITLazyCompilation) {
+    const std::string src =
+        "program test;\n"
+        "procedure cold(n: integer);\n"
+        "begin\n"
+        "    writeln(n * 1000);\n"
+        "end;\n"
+        "function fib(n: integer): integer;\n"
+        "begin\n"
+        "    if n < 2 then fib := n else fib := fib(n - 1) + fib(n - 2);\n"
+        "end;\n"
+        "begin\n"
+        "    writeln(fib(10));\n"
+        "    if fib(1) = 2 then cold(1);\n"
+        "end.";
+
+    for (unsigned compileThreads : {0u, 2u}) {
+        std::string output;
+        EXPECT_EQ(0, RunInJIT(src, output, compileThreads));
+        EXPECT_EQ("55\n", output);
+    }
+}
+
+TEST(BackendTests, ThrowsOnJITRunWithoutMain) {
+    JIT jit;
+    GenContext gen("mila-module");
+    jit.configureModule(gen.module);
+    jit.addModule(gen);
+
+    ASSERT_THROW(jit.addModule(gen), CodeGenException);
+    ASSERT_THROW(jit.runMain(), JITException);
+}
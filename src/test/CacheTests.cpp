@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <fstream>
+#include <sstream>
+#include "cache/CompilationCache.hpp"
+
+/**
+ * @brief Fresh cache directory per test, removed afterwards
+ */
+class CacheTests : public testing::Test {
+   protected:
+    llvm::SmallString<128> directory;
+
+    void SetUp() override {
+        ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("mila-cache-test", directory));
+    }
+
+    void TearDown() override {
+        llvm::sys::fs::remove_directories(directory);
+    }
+
+    [[nodiscard]] std::string path(const std::string& name) const {
+        llvm::SmallString<128> result(directory);
+        llvm::sys::path::append(result, name);
+        return result.str().str();
+    }
+
+    static void writeFile(const std::string& file, const std::string& content) {
+        std::ofstream(file, std::ios::binary) << content;
+    }
+
+    static std::string readFile(const std::string& file) {
+        std::ifstream in(file, std::ios::binary);
+        std::stringstream content;
+        content << in.rdbuf();
+        return content.str();
+    }
+};
+
+TEST_F(CacheTests, HandlesKeyComputation) {
+    const std::string source = "program test; begin writeln(1); end.";
+    const std::string key = CompilationCache::computeKey(source, "-O2", "x86_64-pc-linux-gnu");
+
+    EXPECT_EQ(40u, key.size());
+    EXPECT_EQ(key, CompilationCache::computeKey(source, "-O2", "x86_64-pc-linux-gnu"));
+    EXPECT_NE(key, CompilationCache::computeKey(source + " ", "-O2", "x86_64-pc-linux-gnu"));
+    EXPECT_NE(key, CompilationCache::computeKey(source, "-O0", "x86_64-pc-linux-gnu"));
+    EXPECT_NE(key, CompilationCache::computeKey(source, "-O2", "aarch64-unknown-linux-gnu"));
+    EXPECT_NE(CompilationCache::computeKey("b", "a", ""), CompilationCache::computeKey("", "ab", ""));
+
+    EXPECT_EQ(40u, CompilationCache::buildIdentity().size());
+    EXPECT_EQ(&CompilationCache::buildIdentity(), &CompilationCache::buildIdentity());
+}
+
+TEST_F(CacheTests, HandlesStoreAndLookup) {
+    CompilationCache cache(path("cache"));
+    const std::string key = CompilationCache::computeKey("source", "-O0", "triple");
+
+    EXPECT_FALSE(cache.lookup(key, path("out")));
+    EXPECT_FALSE(llvm::sys::fs::exists(path("out")));
+
+    writeFile(path("artifact"), "executable content");
+    llvm::sys::fs::setPermissions(path("artifact"), llvm::sys::fs::all_read | llvm::sys::fs::owner_exe);
+    cache.store(key, path("artifact"));
+
+    EXPECT_TRUE(cache.lookup(key, path("out")));
+    EXPECT_EQ("executable content", readFile(path("out")));
+    EXPECT_TRUE(llvm::sys::fs::can_execute(path("out")));
+
+    EXPECT_EQ(1u, cache.getHits());
+    EXPECT_EQ(1u, cache.getMisses());
+}
+
+TEST_F(CacheTests, HandlesLeastRecentlyUsedEviction) {
+    // Room for two 10 bytes entries only
+    CompilationCache cache(path("cache"), 25);
+    writeFile(path("artifact"), std::string(10, 'x'));
+
+    cache.store("first", path("artifact"));
+    cache.store("second", path("artifact"));
+
+    // Make 'first' the most recently used one, entries' times are backdated since the clock granularity may be coarse
+    int fd;
+    for (const char* entry : {"first", "second"}) {
+        ASSERT_FALSE(llvm::sys::fs::openFileForRead(path("cache/") + entry, fd));
+        llvm::sys::fs::setLastAccessAndModificationTime(fd, std::chrono::system_clock::now() - std::chrono::hours(1));
+        llvm::sys::fs::closeFile(fd);
+    }
+    EXPECT_TRUE(cache.lookup("first", path("out")));
+
+    cache.store("third", path("artifact"));
+
+    EXPECT_TRUE(llvm::sys::fs::exists(path("cache/first")));
+    EXPECT_FALSE(llvm::sys::fs::exists(path("cache/second")));
+    EXPECT_TRUE(llvm::sys::fs::exists(path("cache/third")));
+}
+
+TEST_F(CacheTests, HandlesAbandonedTemporaryFiles) {
+    CompilationCache cache(path("cache"));
+
+    writeFile(path("cache/tmp-abandoned"), "partial");
+    writeFile(path("cache/tmp-inflight"), "partial");
+    int fd;
+    ASSERT_FALSE(llvm::sys::fs::openFileForRead(path("cache/tmp-abandoned"), fd));
+    llvm::sys::fs::setLastAccessAndModificationTime(fd, std::chrono::system_clock::now() - std::chrono::hours(1));
+    llvm::sys::fs::closeFile(fd);
+
+    cache.evict();
+
+    EXPECT_FALSE(llvm::sys::fs::exists(path("cache/tmp-abandoned")));
+    EXPECT_TRUE(llvm::sys::fs::exists(path("cache/tmp-inflight")));
+}
+
+TEST_F(CacheTests, ThrowsOnUnusableDirectory) {
+    writeFile(path("file"), "not a directory");
+
+    ASSERT_THROW(CompilationCache(path("file/cache")), CacheException);
+}
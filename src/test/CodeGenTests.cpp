@@ -3,25 +3,26 @@
 #include <vector>
 #include "ast/AST.hpp"
 #include "ast/CodeGenerator.hpp"
+#include "backend/Backend.hpp"
 #include "parser/Parser.hpp"
 #include "utils/Utils.hpp"
 
 void TestProgram(const std::string& src, const std::optional<std::string>& optInput, const int expectedExitCode,
-                 const std::string& expectedOutput, bool debug = false) {
+                 const std::string& expectedOutput, bool debug = false, OptLevel optLevel = OptLevel::O0) {
     std::istringstream input(src);
     Lexer lexer(input);
-    Parser parser(lexer, debug);
+    ASTContext context;
+    Parser parser(lexer, context, debug);
 
-    std::unique_ptr<ASTNode> programNode = parser.parseProgram();
+    ProgramASTNode* programNode = parser.parseProgram();
 
-    CodeGenerator codeGenerator(programNode.get());
-    codeGenerator.generate("output.ir");
-
-    Utils::ProgramRunResult llcResult = Utils::exec(R"(llc "output.ir" -o "output.s" -relocation-model=pic)");
-    ASSERT_EQ(0, llcResult.exitCode);
-
-    Utils::ProgramRunResult clangResult = Utils::exec(R"(clang "output.s" "io.c" -o "a.out")");
-    ASSERT_EQ(0, clangResult.exitCode);
+    CodeGenerator codeGenerator(programNode);
+    GenContext gen("mila-module");
+    Backend backend(optLevel);
+    backend.configureModule(gen.module);
+    codeGenerator.generate(gen);
+    CodeGenerator::optimize(gen.module, optLevel, &backend.getTargetMachine());
+    backend.compile(gen.module, "a.out");
 
     std::string runCmd = "./a.out";
 
@@ -144,8 +145,7 @@ TEST(CodeGenTests, HandlesGlobalVariables) {
 TEST(CodeGenTests, ThrowsOnVariableConflict) {
     const std::string src =
         "program test;\n"
-        "var y : integer;\n"
-        "procedure proc(); const y = 5; begin end;\n"
+        "procedure proc(y : integer); const y = 5; begin end;\n"
         "begin\n"
         "end.\n";
 
@@ -169,6 +169,25 @@ TEST(CodeGenTests, ThrowsOnAccessingLocalVariableFromOuterScope) {
     ASSERT_THROW(TestProgram(src, std::nullopt, expectedExitCode, expectedOutput), CodeGenException);
 }
 
+TEST(CodeGenTests, HandlesShadowing) {
+    const std::string src =
+        "program test;\n"
+        "var x, y : integer;\n"
+        "procedure proc(x : integer); const y = 5; begin write(x); write(y) end;\n"
+        "function f(y : integer) : integer; var x : integer; begin x := y * 2; f := x end;\n"
+        "begin\n"
+        " x := 1; y := 2;\n"
+        " proc(7);\n"
+        " write(f(10));\n"
+        " write(x); write(y)\n"
+        "end.\n";
+
+    const int expectedExitCode = 0;
+    const std::string expectedOutput = "752012";
+
+    TestProgram(src, std::nullopt, expectedExitCode, expectedOutput);
+}
+
 /* ================== Constants Tests ================== */
 
 TEST(CodeGenTests, HandlesConstantDefinition) {
@@ -985,6 +1004,41 @@ TEST(CodeGenTests, HandlesNestedForLoopWithBreak) {
     TestProgram(src, std::nullopt, expectedExitCode, expectedOutput);
 }
 
+TEST(CodeGenTests, HandlesBreakAndExitInNestedLoops) {
+    const std::string src =
+        "program test;\n"
+        "var I : integer;\n"
+        "function find(n : integer) : integer;\n"
+        "var I, J : integer;\n"
+        "begin\n"
+        " find := -1;\n"
+        " for I := 1 to 9 do begin\n"
+        "  J := 0;\n"
+        "  while J < 9 do begin\n"
+        "   if I * J = n then begin find := I * 10 + J; exit end;\n"
+        "   if J > I then break;\n"
+        "   J := J + 1\n"
+        "  end\n"
+        " end\n"
+        "end;\n"
+        "begin\n"
+        " write(find(12));\n"
+        " write(find(11));\n"
+        " for I := 0 to 5 do\n"
+        "  while 1 = 1 do begin\n"
+        "   if I = 2 then exit;\n"
+        "   write(I);\n"
+        "   break\n"
+        "  end;\n"
+        " write(9)\n"
+        "end.\n";
+
+    const int expectedExitCode = 0;
+    const std::string expectedOutput = "34-101";
+
+    TestProgram(src, std::nullopt, expectedExitCode, expectedOutput);
+}
+
 TEST(CodeGenTests, HandlesDummyForLoop) {
     const std::string src =
         "program test;\n"
@@ -1905,3 +1959,140 @@ TEST(CodeGenTests, HandlesProgramSortBubble) {
 
     TestProgram(src, std::nullopt, expectedExitCode, expectedOutput);
 }
+
+/* ================== Optimization Tests ================== */
+
+TEST(CodeGenTests, HandlesOptimizationLevels) {
+    const std::string src =
+        "program optimization;\n"
+        "\n"
+        "function gcdi(a: integer; b: integer): integer;\n"
+        "var tmp: integer;\n"
+        "begin\n"
+        "    while b <> 0 do\n"
+        "    begin\n"
+        "        tmp := b;\n"
+        "        b := a mod b;\n"
+        "        a := tmp;\n"
+        "    end;\n"
+        "    gcdi := a;\n"
+        "end;\n"
+        "\n"
+        "function fact(n: integer): integer;\n"
+        "begin\n"
+        "    if (n = 0) then\n"
+        "        fact := 1\n"
+        "    else\n"
+        "        fact := n * fact(n - 1);\n"
+        "end;\n"
+        "\n"
+        "var i, sum: integer;\n"
+        "var arr: array [0 .. 9] of integer;\n"
+        "begin\n"
+        "    sum := 0;\n"
+        "    for i := 0 to 9 do\n"
+        "        arr[i] := i * i;\n"
+        "    for i := 9 downto 0 do\n"
+        "        sum := sum + arr[i];\n"
+        "    writeln(sum);\n"
+        "    writeln(gcdi(27*2, 27*3));\n"
+        "    writeln(fact(6));\n"
+        "end.";
+
+    const int expectedExitCode = 0;
+    const std::string expectedOutput = "285\n27\n720\n";
+
+    for (OptLevel level : {OptLevel::O0, OptLevel::O1, OptLevel::O2, OptLevel::O3, OptLevel::Os}) {
+        SCOPED_TRACE(toString(level));
+        TestProgram(src, std::nullopt, expectedExitCode, expectedOutput, false, level);
+    }
+}
+
+TEST(CodeGenTests, HandlesOptimizationPromotesLocals) {
+    const std::string src =
+        "program promote;\n"
+        "function facti(n : integer) : integer;\n"
+        "var i: integer;\n"
+        "begin\n"
+        "    facti := 1;\n"
+        "    for i := 2 to n do\n"
+        "        facti := facti * i;\n"
+        "end;\n"
+        "begin\n"
+        "    writeln(facti(5));\n"
+        "end.";
+
+    auto countAllocas = [&src](OptLevel level) {
+        std::istringstream input(src);
+        Lexer lexer(input);
+        ASTContext context;
+        Parser parser(lexer, context);
+        ProgramASTNode* programNode = parser.parseProgram();
+
+        GenContext gen("mila-module");
+        CodeGenerator(programNode).generate(gen);
+        CodeGenerator::optimize(gen.module, level);
+
+        unsigned allocas = 0;
+        for (const llvm::Function& function : gen.module)
+            for (const llvm::BasicBlock& block : function)
+                for (const llvm::Instruction& instruction : block)
+                    allocas += llvm::isa<llvm::AllocaInst>(instruction);
+        return allocas;
+    };
+
+    EXPECT_GT(countAllocas(OptLevel::O0), 0u);
+    EXPECT_EQ(countAllocas(OptLevel::O2), 0u);
+}
+
+TEST(CodeGenTests, ThrowsOnOptimizingBrokenModule) {
+    GenContext gen("mila-module");
+    auto* type = llvm::FunctionType::get(gen.builder.getVoidTy(), false);
+    auto* function = llvm::Function::Create(type, llvm::Function::ExternalLinkage, "broken", gen.module);
+    // Basic block without a terminator
+    llvm::BasicBlock::Create(gen.ctx, "entry", function);
+
+    EXPECT_THROW(CodeGenerator::optimize(gen.module, OptLevel::O2), CodeGenException);
+}
+
+TEST(CodeGenTests, ReportsErrorLocations) {
+    auto errorOf = [](const std::string& src) -> std::string {
+        std::istringstream input(src);
+        Lexer lexer(input);
+        ASTContext context;
+        Parser parser(lexer, context);
+        ProgramASTNode* programNode = parser.parseProgram();
+
+        GenContext gen("mila-module");
+        try {
+            CodeGenerator(programNode).generate(gen);
+        } catch (const CodeGenException& e) {
+            return e.format(lexer.getSourceManager());
+        }
+        return "";
+    };
+
+    EXPECT_EQ("at [3:16] - Variable/Constant not found: y",
+              errorOf("program test;\nvar x : integer;\nbegin x := 1 + y;\nend."));
+    EXPECT_EQ("at [3:7] - Variable not found: z", errorOf("program test;\nbegin\n      z := 1\nend."));
+    EXPECT_EQ("at [4:5] - Variable is already declared: x",
+              errorOf("program test;\nvar x : integer;\nvar\n    x : integer;\nbegin end."));
+    // Calls are checked by the semantic analysis, the error is located at the call
+    EXPECT_EQ("at [2:13] - 'writeln' procedure expects 1 argument, but 2 were provided",
+              errorOf("program test;\nbegin       writeln(1, 2)\nend."));
+}
+
+TEST(CodeGenTests, HandlesDeepChains) {
+    // Well past Parser::maxNestingDepth, the passes walk operator and 'else if' chains without recursion
+    const int length = 5000;
+
+    std::string src = "program test;\nvar x, y : integer;\nbegin\n readln(x);\n y := 0";
+    for (int i = 0; i < length; ++i)
+        src += " + 1";
+    src += ";\n writeln(y);\n ";
+    for (int i = 0; i < length; ++i)
+        src += "if x = " + std::to_string(i) + " then writeln(" + std::to_string(i) + ") else ";
+    src += "writeln(-1);\nend.\n";
+
+    TestProgram(src, "777", 0, "5000\n777\n");
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <llvm/Support/FileSystem.h>
+#include <fstream>
+#include <sstream>
+#include "ui/SimpleConsoleView.hpp"
+#include "utils/Statistic.hpp"
+
+/**
+ * @brief Fresh working directory per test (for sources and executables), removed afterwards
+ */
+class ConsoleViewTests : public testing::Test {
+   protected:
+    std::string directory;
+
+    void SetUp() override {
+        llvm::SmallString<128> path;
+        ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("mila-view-test", path));
+        directory = path.str().str();
+    }
+
+    void TearDown() override {
+        llvm::sys::fs::remove_directories(directory);
+    }
+
+    [[nodiscard]] std::string writeSource(const std::string& name, const std::string& src) const {
+        std::string file = directory + "/" + name;
+        std::ofstream(file) << src;
+        return file;
+    }
+};
+
+TEST_F(ConsoleViewTests, HandlesBatchCompilation) {
+    std::vector<std::string> args = {"-j", "2", "-O1"};
+    for (int i = 0; i < 4; ++i)
+        args.push_back(writeSource("prog" + std::to_string(i) + ".mila",
+                                   "program test; begin writeln(" + std::to_string(i * 10) + "); end."));
+
+    std::ostringstream out, err;
+    SimpleConsoleView view(out, err);
+
+    ASSERT_EQ(EXIT_SUCCESS, view.run(args));
+    EXPECT_TRUE(err.str().empty());
+    EXPECT_NE(std::string::npos, out.str().find("Compiled 4 of 4 files"));
+
+    for (int i = 0; i < 4; ++i) {
+        Utils::ProgramRunResult result = Utils::exec(directory + "/prog" + std::to_string(i) + ".out");
+        EXPECT_EQ(0, result.exitCode);
+        EXPECT_EQ(std::to_string(i * 10) + "\n", result.output);
+    }
+}
+
+TEST_F(ConsoleViewTests, HandlesBatchDiagnosticsPerFile) {
+    std::string good = writeSource("good.mila", "program good; begin writeln(1); end.");
+    std::string bad = writeSource("bad.mila", "program bad; begin x := ; end.");
+    std::string undeclared = writeSource("undeclared.mila", "program undeclared; begin y := 1; end.");
+
+    std::ostringstream out, err;
+    SimpleConsoleView view(out, err);
+
+    ASSERT_EQ(EXIT_FAILURE, view.run({good, bad, undeclared}));
+    EXPECT_TRUE(llvm::sys::fs::exists(directory + "/good.out"));
+    EXPECT_FALSE(llvm::sys::fs::exists(directory + "/bad.out"));
+
+    // Diagnostics of a file are reported together with its result, in the order of the inputs
+    const std::string diagnostics = err.str();
+    size_t parserError = diagnostics.find("Parser error");
+    size_t badFailed = diagnostics.find(bad + ": failed");
+    size_t codegenError = diagnostics.find("Code generation error");
+    size_t undeclaredFailed = diagnostics.find(undeclared + ": failed");
+
+    ASSERT_NE(std::string::npos, undeclaredFailed);
+    EXPECT_LT(parserError, badFailed);
+    EXPECT_LT(badFailed, codegenError);
+    EXPECT_LT(codegenError, undeclaredFailed);
+    EXPECT_NE(std::string::npos, diagnostics.find("at [" + undeclared + ":1:27] - Variable not found: y"));
+    EXPECT_NE(std::string::npos, out.str().find("Compiled 1 of 3 files"));
+}
+
+TEST_F(ConsoleViewTests, HandlesBatchArguments) {
+    std::ostringstream out, err;
+    SimpleConsoleView view(out, err);
+
+    EXPECT_EQ(EXIT_FAILURE, view.parseArgs({"a.mila", "b.mila", "-o", "out"}));
+    EXPECT_EQ(EXIT_FAILURE, SimpleConsoleView(out, err).parseArgs({"a.mila", "-j", "x"}));
+    EXPECT_EQ(EXIT_SUCCESS, SimpleConsoleView(out, err).parseArgs({"a.mila", "b.mila", "-j", "3"}));
+    EXPECT_EQ("dir/prog.out", SimpleConsoleView::batchOutputFileName("dir/prog.mila"));
+}
+
+TEST_F(ConsoleViewTests, HandlesPhaseTimingAndTrace) {
+    std::string src = writeSource("prog.mila",
+                                  "program test;\n"
+                                  "function twice(n: integer): integer; begin twice := 2 * n; end;\n"
+                                  "begin writeln(twice(21)); end.");
+    std::string traceFile = directory + "/trace.json";
+
+    std::ostringstream out, err;
+    SimpleConsoleView view(out, err);
+
+    ASSERT_EQ(EXIT_SUCCESS, view.run({src, "-O2", "-o", directory + "/prog", "--time-phases", "--trace=" + traceFile}))
+        << err.str();
+
+    for (const char* phase : {"Parsing", "Lexing", "Code generation", "Function codegen", "Optimization", "Linking"})
+        EXPECT_NE(std::string::npos, out.str().find(phase)) << phase;
+    EXPECT_NE(std::string::npos, out.str().find("Pass execution timing report"));
+
+    std::ifstream trace(traceFile);
+    std::string traceContent((std::istreambuf_iterator<char>(trace)), std::istreambuf_iterator<char>());
+    EXPECT_NE(std::string::npos, traceContent.find("\"traceEvents\""));
+    EXPECT_NE(std::string::npos, traceContent.find("\"twice\""));
+    EXPECT_NE(std::string::npos, traceContent.find("InstCombinePass"));
+
+    // The verbose output reports the compile times with the same phase timings
+    std::ostringstream verboseOut, verboseErr;
+    ASSERT_EQ(EXIT_SUCCESS, SimpleConsoleView(verboseOut, verboseErr).run({src, "-v", "-o", directory + "/prog"}))
+        << verboseErr.str();
+    EXPECT_NE(std::string::npos, verboseOut.str().find("Code generation"));
+    EXPECT_NE(std::string::npos, verboseOut.str().find("Linking"));
+    EXPECT_EQ(std::string::npos, verboseOut.str().find("COMPILE TIME"));
+}
+
+TEST_F(ConsoleViewTests, HandlesStatistics) {
+    std::string src = writeSource("prog.mila",
+                                  "program test;\n"
+                                  "function twice(n: integer): integer; begin twice := 2 * n; end;\n"
+                                  "begin writeln(twice(21)); end.");
+
+    std::ostringstream out, err;
+    SimpleConsoleView view(out, err);
+
+    ASSERT_EQ(EXIT_SUCCESS, view.run({src, "-O2", "-o", directory + "/prog", "--stats=json"})) << err.str();
+
+    for (const char* counter : {"\"NumTokensLexed\"", "\"NumFunDeclNodes\": 1", "\"NumSymbolLookups\"",
+                                "\"twice.instructions.before\"", "\"main.blocks.after\""})
+        EXPECT_NE(std::string::npos, err.str().find(counter)) << counter;
+    EXPECT_FALSE(StatisticRegistry::instance().isEnabled());
+}
+
+TEST_F(ConsoleViewTests, RejectsUnsupportedConnectOptions) {
+    const std::string source = writeSource("prog.mila", "program test; begin end.");
+
+    for (const char* option : {"-v", "--time-phases", "--stats", "--pipeline-lexer", "--run"}) {
+        std::ostringstream out, err;
+        SimpleConsoleView view(out, err);
+
+        EXPECT_EQ(EXIT_FAILURE, view.run({"--connect", "--socket", directory + "/none.sock", option, source}))
+            << option;
+        EXPECT_NE(std::string::npos, err.str().find("--connect only supports")) << option;
+    }
+}
@@ -1,6 +1,13 @@
 #include <gtest/gtest.h>
+#include <llvm/Support/FileSystem.h>
+#include <unistd.h>
+#include <fstream>
+#include <random>
 #include <sstream>
+#include "lexer/Keywords.hpp"
 #include "lexer/Lexer.hpp"
+#include "lexer/Scanner.hpp"
+#include "lexer/TokenStream.hpp"
 
 TEST(LexerTests, HandlesIdentifiers) {
     std::istringstream input("MyVar _MY__VAR_ my_var123");
@@ -8,15 +15,15 @@ TEST(LexerTests, HandlesIdentifiers) {
 
     auto tk1 = lexer.match(TokenType::IDENTIFIER);
     ASSERT_TRUE(tk1.has_value());
-    ASSERT_EQ("MyVar", std::get<std::string>(tk1.value().getValue().value()));
+    ASSERT_EQ("MyVar", std::get<std::string>(tk1.value().getValue(lexer.getInterner()).value()));
 
     auto tk2 = lexer.match(TokenType::IDENTIFIER);
     ASSERT_TRUE(tk2.has_value());
-    ASSERT_EQ("_MY__VAR_", std::get<std::string>(tk2.value().getValue().value()));
+    ASSERT_EQ("_MY__VAR_", std::get<std::string>(tk2.value().getValue(lexer.getInterner()).value()));
 
     auto tk3 = lexer.match(TokenType::IDENTIFIER);
     ASSERT_TRUE(tk3.has_value());
-    ASSERT_EQ("my_var123", std::get<std::string>(tk3.value().getValue().value()));
+    ASSERT_EQ("my_var123", std::get<std::string>(tk3.value().getValue(lexer.getInterner()).value()));
 }
 
 TEST(LexerTests, HandlesOperators) {
@@ -32,7 +39,7 @@ TEST(LexerTests, HandlesOperators) {
 
     for (const auto& token : tokens) {
         ASSERT_TRUE(token.has_value());
-        ASSERT_EQ(std::nullopt, token.value().getValue());
+        ASSERT_EQ(std::nullopt, token.value().getValue(lexer.getInterner()));
     }
 }
 
@@ -50,7 +57,7 @@ TEST(LexerTests, HandlesSeparators) {
 
     for (const auto& token : tokens) {
         ASSERT_TRUE(token.has_value());
-        ASSERT_EQ(std::nullopt, token.value().getValue());
+        ASSERT_EQ(std::nullopt, token.value().getValue(lexer.getInterner()));
     }
 }
 
@@ -75,7 +82,7 @@ TEST(LexerTests, HandlesKeywords) {
 
     for (const auto& token : tokens) {
         ASSERT_TRUE(token.has_value());
-        ASSERT_EQ(std::nullopt, token.value().getValue());
+        ASSERT_EQ(std::nullopt, token.value().getValue(lexer.getInterner()));
     }
 }
 
@@ -106,33 +113,33 @@ TEST(LexerTests, HandlesArithmeticExpression) {
 
     auto tk1 = lexer.match(TokenType::INTEGER_LITERAL);
     ASSERT_TRUE(tk1.has_value());
-    ASSERT_EQ(8230, std::get<int>(tk1.value().getValue().value()));
+    ASSERT_EQ(8230, std::get<int>(tk1.value().getValue(lexer.getInterner()).value()));
     ASSERT_EQ(TokenType::INTEGER_LITERAL, tk1.value().getType());
-    ASSERT_EQ(1, tk1.value().getPosition().getCol());
-    ASSERT_EQ(1, tk1.value().getPosition().getLine());
+    ASSERT_EQ(1, lexer.getSourceManager().getPosition(tk1->getOffset()).getCol());
+    ASSERT_EQ(1, lexer.getSourceManager().getPosition(tk1->getOffset()).getLine());
 
     auto tk2 = lexer.match(TokenType::PLUS);
     ASSERT_TRUE(tk2.has_value());
-    ASSERT_EQ(std::nullopt, tk2.value().getValue());
+    ASSERT_EQ(std::nullopt, tk2.value().getValue(lexer.getInterner()));
     ASSERT_EQ(TokenType::PLUS, tk2.value().getType());
-    ASSERT_EQ(6, tk2.value().getPosition().getCol());
-    ASSERT_EQ(1, tk2.value().getPosition().getLine());
+    ASSERT_EQ(6, lexer.getSourceManager().getPosition(tk2->getOffset()).getCol());
+    ASSERT_EQ(1, lexer.getSourceManager().getPosition(tk2->getOffset()).getLine());
 
     auto tk3 = lexer.match(TokenType::INTEGER_LITERAL);
     ASSERT_TRUE(tk3.has_value());
-    ASSERT_EQ(99, std::get<int>(tk3.value().getValue().value()));
+    ASSERT_EQ(99, std::get<int>(tk3.value().getValue(lexer.getInterner()).value()));
     ASSERT_EQ(TokenType::INTEGER_LITERAL, tk3.value().getType());
-    ASSERT_EQ(2, tk3.value().getPosition().getCol());
-    ASSERT_EQ(2, tk3.value().getPosition().getLine());
+    ASSERT_EQ(2, lexer.getSourceManager().getPosition(tk3->getOffset()).getCol());
+    ASSERT_EQ(2, lexer.getSourceManager().getPosition(tk3->getOffset()).getLine());
 
     // from now on, the lexer should always return EOI
 
     auto tk4 = lexer.match(TokenType::EOI);
     ASSERT_TRUE(tk4.has_value());
-    ASSERT_EQ(std::nullopt, tk4.value().getValue());
+    ASSERT_EQ(std::nullopt, tk4.value().getValue(lexer.getInterner()));
     ASSERT_EQ(TokenType::EOI, tk4.value().getType());
-    ASSERT_EQ(6, tk4.value().getPosition().getCol());
-    ASSERT_EQ(2, tk4.value().getPosition().getLine());
+    ASSERT_EQ(6, lexer.getSourceManager().getPosition(tk4->getOffset()).getCol());
+    ASSERT_EQ(2, lexer.getSourceManager().getPosition(tk4->getOffset()).getLine());
 
     auto tk5 = lexer.match(TokenType::EOI);
     ASSERT_TRUE(tk5.has_value());
@@ -145,26 +152,348 @@ TEST(LexerTests, HandlesNumbers) {
 
     auto tk1 = lexer.match(TokenType::REAL_LITERAL);
     ASSERT_TRUE(tk1.has_value());
-    EXPECT_EQ(123.456, std::get<double>(tk1.value().getValue().value()));
+    EXPECT_EQ(123.456, std::get<double>(tk1.value().getValue(lexer.getInterner()).value()));
     EXPECT_EQ(TokenType::REAL_LITERAL, tk1.value().getType());
 
     auto tk2 = lexer.match(TokenType::REAL_LITERAL);
     ASSERT_TRUE(tk2.has_value());
-    EXPECT_EQ(0.99, std::get<double>(tk2.value().getValue().value()));
+    EXPECT_EQ(0.99, std::get<double>(tk2.value().getValue(lexer.getInterner()).value()));
     EXPECT_EQ(TokenType::REAL_LITERAL, tk2.value().getType());
 
     auto tk3 = lexer.match(TokenType::INTEGER_LITERAL);
     ASSERT_TRUE(tk3.has_value());
-    EXPECT_EQ(668, std::get<int>(tk3.value().getValue().value()));
+    EXPECT_EQ(668, std::get<int>(tk3.value().getValue(lexer.getInterner()).value()));
     EXPECT_EQ(TokenType::INTEGER_LITERAL, tk3.value().getType());
 
     auto tk4 = lexer.match(TokenType::INTEGER_LITERAL);
     ASSERT_TRUE(tk4.has_value());
-    EXPECT_EQ(696206, std::get<int>(tk4.value().getValue().value()));
+    EXPECT_EQ(696206, std::get<int>(tk4.value().getValue(lexer.getInterner()).value()));
     EXPECT_EQ(TokenType::INTEGER_LITERAL, tk4.value().getType());
 
     auto tk5 = lexer.match(TokenType::INTEGER_LITERAL);
     ASSERT_TRUE(tk5.has_value());
-    EXPECT_EQ(0, std::get<int>(tk5.value().getValue().value()));
+    EXPECT_EQ(0, std::get<int>(tk5.value().getValue(lexer.getInterner()).value()));
     EXPECT_EQ(TokenType::INTEGER_LITERAL, tk5.value().getType());
 }
+
+TEST(LexerTests, HandlesNumberEdgeCases) {
+    auto lexSingle = [](const std::string& source) {
+        Lexer lexer(source.data(), source.data() + source.size());
+        Token token = lexer.next();
+        EXPECT_EQ(TokenType::EOI, lexer.peek().getType()) << source;
+        return token;
+    };
+
+    // Long fractions are correctly rounded (the divider used to overflow after 9 digits)
+    EXPECT_EQ(0.1234567890123456789, lexSingle("0.1234567890123456789").getReal());
+    EXPECT_EQ(3.141592653589793, lexSingle("3.14159265358979323846264338327950288").getReal());
+    EXPECT_EQ(0.3, lexSingle("0.3").getReal());
+
+    // Exponents
+    EXPECT_EQ(1e10, lexSingle("1e10").getReal());
+    EXPECT_EQ(2.5e-3, lexSingle("2.5E-3").getReal());
+    EXPECT_EQ(6.02214076e+23, lexSingle("6.02214076e+23").getReal());
+    EXPECT_EQ(TokenType::REAL_LITERAL, lexSingle("7e0").getType());
+
+    // Limits
+    EXPECT_EQ(2147483647, lexSingle("2147483647").getInt());
+    EXPECT_EQ(2147483647, lexSingle("$7fffffff").getInt());
+    EXPECT_EQ(2147483647, lexSingle("&17777777777").getInt());
+    EXPECT_EQ(7, lexSingle("0000007").getInt());
+    EXPECT_THROW(lexSingle("2147483648"), LexerException);
+    EXPECT_THROW(lexSingle("99999999999999999999"), LexerException);
+    EXPECT_THROW(lexSingle("$100000000"), LexerException);
+    EXPECT_THROW(lexSingle("&40000000000"), LexerException);
+    EXPECT_THROW(lexSingle("1e999"), LexerException);
+
+    // Invalid digits and missing digits
+    EXPECT_THROW(lexSingle("&18"), LexerException);
+    EXPECT_THROW(lexSingle("$fg"), LexerException);
+    EXPECT_THROW(lexSingle("$"), LexerException);
+    EXPECT_THROW(lexSingle("&"), LexerException);
+    EXPECT_THROW(lexSingle("1."), LexerException);
+    EXPECT_THROW(lexSingle("1.x"), LexerException);
+    for (const auto& [literal, message] :
+         {std::pair{"$fg", "Invalid hex digit 'g'."}, std::pair{"&18", "Invalid octal digit '8'."}}) {
+        try {
+            lexSingle(literal);
+            FAIL() << "expected a LexerException";
+        } catch (const LexerException& e) {
+            EXPECT_NE(std::string::npos, std::string(e.what()).find(message)) << e.what();
+        }
+    }
+
+    // An 'e' without exponent digits and a range are not part of the literal
+    std::istringstream input("1else 2e+ 0..20 1.5e3.");
+    Lexer lexer(input);
+    EXPECT_EQ(1, lexer.match(TokenType::INTEGER_LITERAL)->getInt());
+    EXPECT_TRUE(lexer.match(TokenType::ELSE).has_value());
+    EXPECT_EQ(2, lexer.match(TokenType::INTEGER_LITERAL)->getInt());
+    EXPECT_EQ("e", lexer.getInterner().getName(lexer.match(TokenType::IDENTIFIER)->getSymbol()));
+    EXPECT_TRUE(lexer.match(TokenType::PLUS).has_value());
+    EXPECT_EQ(0, lexer.match(TokenType::INTEGER_LITERAL)->getInt());
+    EXPECT_TRUE(lexer.match(TokenType::DOUBLE_DOT).has_value());
+    auto twenty = lexer.match(TokenType::INTEGER_LITERAL);
+    ASSERT_TRUE(twenty.has_value());
+    EXPECT_EQ(20, twenty->getInt());
+    EXPECT_EQ(14u, lexer.getSourceManager().getPosition(twenty->getOffset()).getCol());
+    auto real = lexer.match(TokenType::REAL_LITERAL);
+    ASSERT_TRUE(real.has_value());
+    EXPECT_EQ(1500.0, real->getReal());
+    EXPECT_EQ(17u, lexer.getSourceManager().getPosition(real->getOffset()).getCol());
+    EXPECT_TRUE(lexer.match(TokenType::DOT).has_value());
+}
+
+TEST(LexerTests, HandlesSourceBuffers) {
+    const std::string source = "program test;\nbegin { comment }\n  x := $ff + &17 * 1.5;\nend.";
+
+    llvm::SmallString<128> path;
+    ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("mila-lexer-test", "mila", path));
+    std::ofstream(path.str().str()) << source;
+    SourceBuffer mapped = SourceBuffer::fromFile(path.str().str());
+    EXPECT_TRUE(mapped.isMapped());
+    EXPECT_EQ(source, mapped.getContent());
+
+    // Reads the pipe in chunks until EOF, just like stdin
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    ASSERT_EQ(ssize_t(source.size()), write(fds[1], source.data(), source.size()));
+    close(fds[1]);
+    SourceBuffer piped = SourceBuffer::fromFileDescriptor(fds[0]);
+    close(fds[0]);
+    EXPECT_FALSE(piped.isMapped());
+    EXPECT_EQ(source, piped.getContent());
+
+    // Moving keeps the content valid, even for a short (inline) string
+    SourceBuffer moved = SourceBuffer::fromString("x");
+    SourceBuffer target = std::move(moved);
+    EXPECT_EQ("x", target.getContent());
+
+    std::istringstream input(source);
+    Lexer streamLexer(input);
+    Lexer mappedLexer(mapped);
+    Lexer pipedLexer(piped);
+    for (TokenType type : {TokenType::PROGRAM, TokenType::IDENTIFIER, TokenType::SEMICOLON, TokenType::BEGIN,
+                           TokenType::IDENTIFIER, TokenType::ASSIGN, TokenType::INTEGER_LITERAL, TokenType::PLUS,
+                           TokenType::INTEGER_LITERAL, TokenType::MULTIPLY, TokenType::REAL_LITERAL,
+                           TokenType::SEMICOLON, TokenType::END, TokenType::DOT, TokenType::EOI}) {
+        auto expected = streamLexer.match(type);
+        ASSERT_TRUE(expected.has_value()) << type;
+        for (Lexer* lexer : {&mappedLexer, &pipedLexer}) {
+            auto token = lexer->match(type);
+            ASSERT_TRUE(token.has_value()) << type;
+            EXPECT_EQ(expected->getValue(streamLexer.getInterner()), token->getValue(lexer->getInterner()));
+            EXPECT_EQ(expected->getOffset(), token->getOffset());
+        }
+    }
+
+    // Empty files cannot be mapped, but still lex to the end of input
+    std::ofstream(path.str().str(), std::ios::trunc).flush();
+    SourceBuffer empty = SourceBuffer::fromFile(path.str().str());
+    EXPECT_EQ(0u, empty.getSize());
+    EXPECT_TRUE(Lexer(empty).match(TokenType::EOI).has_value());
+
+    // Offsets are 32-bit, so larger sources are rejected up front (the sparse file takes no space)
+    ASSERT_EQ(0, truncate(path.c_str(), off_t(SourceBuffer::maxSize) + 1));
+    EXPECT_THROW((void)SourceBuffer::fromFile(path.str().str()), SourceBufferException);
+
+    llvm::sys::fs::remove(path);
+    ASSERT_THROW((void)SourceBuffer::fromFile(path.str().str()), SourceBufferException);
+}
+
+TEST(LexerTests, HandlesLargeStreams) {
+    // Spans several refill chunks
+    std::string source;
+    while (source.size() < 3 * SourceBuffer::chunkSize)
+        source += "abc 42 ";
+
+    std::istringstream input(source);
+    Lexer lexer(input);
+    size_t tokens = 0;
+    while (lexer.match(TokenType::IDENTIFIER) && lexer.match(TokenType::INTEGER_LITERAL))
+        tokens += 2;
+
+    EXPECT_EQ(source.size() / 7 * 2, tokens);
+    EXPECT_TRUE(lexer.match(TokenType::EOI).has_value());
+}
+
+TEST(LexerTests, HandlesKeywordPerfectHash) {
+    for (const auto& keyword : Keywords::keywords) {
+        auto type = Keywords::lookup(keyword.spelling);
+        ASSERT_TRUE(type.has_value()) << keyword.spelling;
+        EXPECT_EQ(keyword.type, *type);
+    }
+
+    // Same hash inputs (first two and last character, length) as keywords, or prefixes/extensions of them
+    for (std::string_view identifier : {"", "i", "iff", "ends", "en", "procedurex", "procedur", "BEGIN", "Begin",
+                                        "dowto", "dnto", "forwarf", "x", "integer_"}) {
+        EXPECT_FALSE(Keywords::lookup(identifier).has_value()) << identifier;
+    }
+
+    std::istringstream input("downto down endx end");
+    Lexer lexer(input);
+    EXPECT_TRUE(lexer.match(TokenType::DOWNTO).has_value());
+    EXPECT_TRUE(lexer.match(TokenType::IDENTIFIER).has_value());
+    EXPECT_TRUE(lexer.match(TokenType::IDENTIFIER).has_value());
+    EXPECT_TRUE(lexer.match(TokenType::END).has_value());
+}
+
+TEST(LexerTests, HandlesVectorizedSkipping) {
+    std::mt19937 random(7);
+    const std::string alphabet = "  \t\n\r\v\fx}\xe9";
+
+    for (int round = 0; round < 500; ++round) {
+        // Mostly whitespace with the occasional stop character, lengths around the 16/32 byte blocks
+        std::string input;
+        for (size_t length = random() % 100; length > 0; --length)
+            input.push_back(random() % 8 ? alphabet[random() % 7] : alphabet[7 + random() % 3]);
+
+        const char* begin = input.data();
+        const char* end = input.data() + input.size();
+        const char* scalarWhitespace = Scanner::skipWhitespace(begin, end, Scanner::Isa::Scalar);
+        const char* scalarComment = Scanner::skipComment(begin, end, Scanner::Isa::Scalar);
+
+        for (Scanner::Isa isa : {Scanner::Isa::SSE2, Scanner::Isa::AVX2}) {
+            if (!Scanner::isSupported(isa))
+                continue;
+
+            EXPECT_EQ(scalarWhitespace, Scanner::skipWhitespace(begin, end, isa));
+            EXPECT_EQ(scalarComment, Scanner::skipComment(begin, end, isa));
+        }
+    }
+
+    // Positions after long indentation and multi-line comments
+    std::istringstream input(std::string(40, ' ') + "a\n\n" + std::string(37, '\t') + "{ line 3\n line 4 \n\n} b");
+    Lexer lexer(input);
+    auto a = lexer.match(TokenType::IDENTIFIER);
+    ASSERT_TRUE(a.has_value());
+    EXPECT_EQ(1u, lexer.getSourceManager().getPosition(a->getOffset()).getLine());
+    EXPECT_EQ(41u, lexer.getSourceManager().getPosition(a->getOffset()).getCol());
+    auto b = lexer.match(TokenType::IDENTIFIER);
+    ASSERT_TRUE(b.has_value());
+    EXPECT_EQ(6u, lexer.getSourceManager().getPosition(b->getOffset()).getLine());
+    EXPECT_EQ(3u, lexer.getSourceManager().getPosition(b->getOffset()).getCol());
+}
+
+TEST(LexerTests, HandlesStringInterning) {
+    StringInterner interner;
+    SymbolId a = interner.intern("counter");
+    SymbolId b = interner.intern("value");
+    std::string_view name = interner.getName(a);
+
+    // Views stay valid while the table grows
+    for (int i = 0; i < 10000; ++i)
+        (void)interner.intern("name" + std::to_string(i));
+
+    EXPECT_EQ(a, interner.intern(std::string("counter")));
+    EXPECT_NE(a, b);
+    EXPECT_EQ("counter", name);
+    EXPECT_EQ(name.data(), interner.getName(a).data());
+    EXPECT_EQ(10002u, interner.size());
+
+    std::istringstream input("x y x");
+    Lexer lexer(input);
+    Token x1 = *lexer.match(TokenType::IDENTIFIER);
+    Token y = *lexer.match(TokenType::IDENTIFIER);
+    Token x2 = *lexer.match(TokenType::IDENTIFIER);
+    EXPECT_EQ(x1.getSymbol(), x2.getSymbol());
+    EXPECT_NE(x1.getSymbol(), y.getSymbol());
+    EXPECT_EQ("y", lexer.getInterner().getName(y.getSymbol()));
+    EXPECT_EQ(2u, lexer.getInterner().size());
+    EXPECT_EQ(16u, sizeof(Token));
+}
+
+TEST(LexerTests, HandlesTokenStream) {
+    const std::string source =
+        "program p;\n  var x : integer;\nbegin { comment\n }\n  x := 42 + 2.5e1 * x;\n"
+        "  if x > 0 then begin begin end end\nend.";
+
+    TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+    Lexer lexer(source.data(), source.data() + source.size());
+
+    // Same kinds, positions and values as the streaming lexer
+    size_t index = 0;
+    while (true) {
+        Token expected = lexer.next();
+        Token token = stream.getToken(index);
+        ASSERT_EQ(expected.getType(), token.getType()) << "token " << index;
+        EXPECT_EQ(expected.getOffset(), token.getOffset());
+        EXPECT_EQ(expected.getValue(lexer.getInterner()), token.getValue(stream.getInterner()));
+        ++index;
+        if (expected.getType() == TokenType::EOI)
+            break;
+    }
+    EXPECT_EQ(index, stream.size());
+    EXPECT_EQ(TokenType::EOI, stream.getKind(stream.size() + 10));
+    EXPECT_EQ(TokenType::EOI, stream.getToken(stream.size() + 10).getType());
+
+    // Arbitrary lookahead: "x := 42" starts at the first ASSIGN - 1
+    size_t assign = 0;
+    while (stream.getKind(assign) != TokenType::ASSIGN)
+        ++assign;
+    EXPECT_EQ(TokenType::IDENTIFIER, stream.getKind(assign - 1));
+    EXPECT_EQ(TokenType::INTEGER_LITERAL, stream.getKind(assign + 1));
+    EXPECT_EQ(TokenType::REAL_LITERAL, stream.getKind(assign + 3));
+    EXPECT_EQ(source.find("42"), stream.getOffset(assign + 1));
+
+    // Skipping blocks over the kinds
+    size_t outerBegin = 0;
+    while (stream.getKind(outerBegin) != TokenType::BEGIN)
+        ++outerBegin;
+    size_t outerEnd = stream.findMatchingEnd(outerBegin);
+    EXPECT_EQ(TokenType::DOT, stream.getKind(outerEnd + 1));
+
+    size_t innerBegin = outerBegin + 1;
+    while (stream.getKind(innerBegin) != TokenType::BEGIN)
+        ++innerBegin;
+    EXPECT_EQ(TokenType::BEGIN, stream.getKind(innerBegin + 1));
+    EXPECT_EQ(innerBegin + 3, stream.findMatchingEnd(innerBegin));
+
+    const std::string unclosed = "begin begin end";
+    TokenStream unclosedStream = TokenStream::lex(unclosed.data(), unclosed.data() + unclosed.size());
+    EXPECT_EQ(unclosedStream.size() - 1, unclosedStream.findMatchingEnd(0));
+
+    const std::string invalid = "x := ?";
+    EXPECT_THROW((void)TokenStream::lex(invalid.data(), invalid.data() + invalid.size()), LexerException);
+}
+
+TEST(LexerTests, HandlesSourceManager) {
+    const std::string source = "first\n\nthird line\r\nlast";
+    SourceManager sources(source.data(), source.data() + source.size(), "test.mila");
+
+    EXPECT_EQ("test.mila", sources.getName());
+    EXPECT_EQ(source.size(), sources.getSize());
+
+    auto expectPosition = [&](uint32_t offset, unsigned line, unsigned col) {
+        Position position = sources.getPosition(offset);
+        EXPECT_EQ(line, position.getLine()) << "offset " << offset;
+        EXPECT_EQ(col, position.getCol()) << "offset " << offset;
+    };
+    expectPosition(0, 1, 1);
+    expectPosition(4, 1, 5);
+    expectPosition(5, 1, 6);  // the newline itself
+    expectPosition(6, 2, 1);
+    expectPosition(7, 3, 1);
+    expectPosition(source.find("line"), 3, 7);
+    expectPosition(source.find("last") + 3, 4, 4);
+    // Past the end maps to the end
+    expectPosition(10000, 4, 5);
+
+    EXPECT_EQ("first", sources.getLine(1));
+    EXPECT_EQ("", sources.getLine(2));
+    EXPECT_EQ("third line\r", sources.getLine(3));
+    EXPECT_EQ("last", sources.getLine(4));
+    EXPECT_EQ("", sources.getLine(5));
+    EXPECT_EQ("", sources.getLine(0));
+
+    // Lexer errors are located through the source manager
+    const std::string invalid = "program p;\n  x := 12 ?";
+    try {
+        Lexer lexer(invalid.data(), invalid.data() + invalid.size());
+        while (lexer.next().getType() != TokenType::EOI) {
+        }
+        FAIL() << "expected a LexerException";
+    } catch (const LexerException& e) {
+        EXPECT_NE(std::string::npos, std::string(e.what()).find("[2:11]")) << e.what();
+    }
+}
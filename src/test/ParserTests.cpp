@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <sstream>
+#include "ast/FlatAST.hpp"
+#include "ast/visitor/CollectorVisitor.hpp"
 #include "parser/Parser.hpp"
 
 // It is much more easier and efficient to test codegen, than to test parser alone
@@ -7,7 +9,8 @@
 TEST(ParserTests, HandlesEmptyProgram) {
     std::istringstream input("program test ; begin end .");
     Lexer lexer(input);
-    Parser parser(lexer);
+    ASTContext context;
+    Parser parser(lexer, context);
 
     auto programNode = parser.parseProgram();
     ASSERT_EQ("test", programNode->getProgramName());
@@ -16,26 +19,54 @@ TEST(ParserTests, HandlesEmptyProgram) {
 TEST(ParserTests, HandlesPrimitiveType) {
     std::istringstream input("integer");
     Lexer lexer(input);
-    Parser parser(lexer);
+    ASTContext context;
+    Parser parser(lexer, context);
 
     auto typeNode = parser.parseType();
     ASSERT_EQ(TypeASTNode::Type::PRIMITIVE, typeNode->getType());
 
-    auto primitiveTypeNode = dynamic_cast<PrimitiveTypeASTNode*>(typeNode.get());
+    auto primitiveTypeNode = llvm::dyn_cast<PrimitiveTypeASTNode>(typeNode);
+    ASSERT_NE(nullptr, primitiveTypeNode);
     ASSERT_EQ(PrimitiveTypeASTNode::PrimitiveType::INTEGER, primitiveTypeNode->getPrimitiveType());
 }
 
+TEST(ParserTests, HandlesNodeKinds) {
+    std::istringstream input("program test;\nvar x : integer;\nbegin x := -x + 1; exit\nend.");
+    Lexer lexer(input);
+    ASTContext context;
+    Parser parser(lexer, context);
+
+    auto statementNodes = parser.parseProgram()->getBlockNode()->getStatementNodes();
+    ASSERT_EQ(2, statementNodes.size());
+    EXPECT_TRUE(llvm::isa<VarDeclASTNode>(statementNodes[0]));
+    EXPECT_TRUE(llvm::isa<DeclASTNode>(statementNodes[0]));
+    EXPECT_FALSE(llvm::isa<ArrayDeclASTNode>(statementNodes[0]));
+
+    auto compoundNode = llvm::cast<CompoundStmtASTNode>(statementNodes[1]);
+    auto assignNode = llvm::cast<AssignASTNode>(compoundNode->getStatementNodes()[0]);
+    EXPECT_TRUE(llvm::isa<ExitASTNode>(compoundNode->getStatementNodes()[1]));
+    EXPECT_TRUE(llvm::isa<DeclRefASTNode>(assignNode->getVarNode()));
+
+    auto binOpNode = llvm::dyn_cast<BinOpASTNode>(assignNode->getExprNode());
+    ASSERT_NE(nullptr, binOpNode);
+    EXPECT_TRUE(llvm::isa<UnaryOpASTNode>(binOpNode->getLhsExprNode()));
+    EXPECT_TRUE(llvm::isa<ExprASTNode>(binOpNode->getRhsExprNode()));
+    EXPECT_FALSE(llvm::isa<StatementASTNode>(binOpNode->getRhsExprNode()));
+    EXPECT_EQ(nullptr, llvm::dyn_cast<DeclRefASTNode>(binOpNode->getRhsExprNode()));
+}
+
 TEST(ParserTests, HandlesProcedureDeclaration) {
     std::istringstream input("{...} procedure proc() ; forward ; begin {...}");
     Lexer lexer(input);
-    Parser parser(lexer);
+    ASTContext context;
+    Parser parser(lexer, context);
 
-    std::vector<std::unique_ptr<StatementASTNode>> statementNodes;
+    std::vector<StatementASTNode*> statementNodes;
     parser.parseProcedureDeclaration(statementNodes);
 
     ASSERT_EQ(1, statementNodes.size());
 
-    auto procDeclNode = dynamic_cast<ProcDeclASTNode*>(statementNodes[0].get());
+    auto procDeclNode = llvm::dyn_cast<ProcDeclASTNode>(statementNodes[0]);
 
     ASSERT_EQ("proc", procDeclNode->getDeclName());
     ASSERT_EQ(0, procDeclNode->getParamNodes().size());
@@ -45,7 +76,8 @@ TEST(ParserTests, HandlesProcedureDeclaration) {
 TEST(ParserTests, HandlesAdditiveOperator) {
     std::istringstream input("+");
     Lexer lexer(input);
-    Parser parser(lexer);
+    ASTContext context;
+    Parser parser(lexer, context);
 
     auto token = parser.parseAdditiveOperator();
     ASSERT_TRUE(token.getType() == TokenType::PLUS);
@@ -54,8 +86,389 @@ TEST(ParserTests, HandlesAdditiveOperator) {
 TEST(ParserTests, HandlesMultiplicativeOperator) {
     std::istringstream input("*");
     Lexer lexer(input);
-    Parser parser(lexer);
+    ASTContext context;
+    Parser parser(lexer, context);
 
     auto token = parser.parseMultiplicativeOperator();
     ASSERT_TRUE(token.getType() == TokenType::MULTIPLY);
 }
+
+TEST(ParserTests, HandlesTokenStream) {
+    const std::string source =
+        "program test;\nconst c = 10;\nvar x, y : integer;\n"
+        "function f(a : integer) : integer; begin f := a * c end;\n"
+        "begin x := f(2) + 1; while x > 0 do x := x - 1; if x = 0 then y := 1 else y := 2 end.";
+
+    std::istringstream input(source);
+    Lexer lexer(input);
+    std::ostringstream lexerDump;
+    ASTContext lexerContext;
+    Parser lexerParser(lexer, lexerContext, true, lexerDump);
+    lexerParser.parseProgram();
+
+    TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+    std::ostringstream streamDump;
+    ASTContext streamContext;
+    Parser streamParser(stream, streamContext, true, streamDump);
+    auto streamProgram = streamParser.parseProgram();
+
+    ASSERT_EQ("test", streamProgram->getProgramName());
+    ASSERT_EQ(lexerDump.str(), streamDump.str());
+}
+
+TEST(ParserTests, HandlesTokenPipe) {
+    std::string source = "program test;\nvar x, y : integer;\nbegin\n";
+    for (int i = 0; i < 1000; ++i)
+        source += "x := x + " + std::to_string(i) + " * y; writeln(x);\n";
+    source += "end.";
+
+    std::istringstream input(source);
+    Lexer lexer(input);
+    std::ostringstream lexerDump;
+    ASTContext lexerContext;
+    Parser lexerParser(lexer, lexerContext, true, lexerDump);
+    lexerParser.parseProgram();
+
+    // A tiny ring makes the lexer thread wait on the parser all the time
+    for (size_t capacity : {size_t(2), TokenPipe::defaultCapacity}) {
+        TokenPipe pipe(source.data(), source.data() + source.size(), capacity);
+        std::ostringstream pipeDump;
+        ASTContext pipeContext;
+        Parser pipeParser(pipe, pipeContext, true, pipeDump);
+        auto pipeProgram = pipeParser.parseProgram();
+
+        ASSERT_EQ("test", pipeProgram->getProgramName());
+        ASSERT_EQ(lexerDump.str(), pipeDump.str());
+    }
+
+    // The lexer error is rethrown on the parser thread once it reaches it, with its position
+    const std::string invalid = "program test;\nbegin x := 1 ? end.";
+    TokenPipe invalidPipe(invalid.data(), invalid.data() + invalid.size(), 2);
+    ASTContext invalidContext;
+    Parser invalidParser(invalidPipe, invalidContext);
+    try {
+        invalidParser.parseProgram();
+        FAIL() << "expected a LexerException";
+    } catch (const LexerException& e) {
+        EXPECT_NE(std::string::npos, std::string(e.what()).find("[2:14]")) << e.what();
+    }
+
+    // A parser error leaves the lexer thread blocked on the full ring, destroying the pipe releases it
+    TokenPipe abandonedPipe(source.data(), source.data() + source.size(), 2);
+    ASTContext abandonedContext;
+    Parser abandonedParser(abandonedPipe, abandonedContext);
+    EXPECT_THROW(abandonedParser.parseType(), ParserException);
+}
+
+TEST(ParserTests, HandlesLongExpressionChain) {
+    static_assert(std::is_trivially_destructible_v<BinOpASTNode>, "arena nodes are released without destructors");
+
+    std::string source = "program test;\nvar x : integer;\nbegin\nx := 0";
+    for (int i = 0; i < 10000; ++i)
+        source += " + x";
+    source += "\nend.";
+
+    // The chain is a left-leaning tree 10000 nodes deep, releasing the context must not walk it
+    auto context = std::make_unique<ASTContext>();
+    TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+    Parser parser(stream, *context);
+    auto programNode = parser.parseProgram();
+
+    ASSERT_EQ("test", programNode->getProgramName());
+    context.reset();
+}
+
+// Renders the expression tree fully parenthesized, e.g. (PLUS a (MULTIPLY b c))
+static std::string toSExpression(ExprASTNode* exprNode) {
+    std::ostringstream oss;
+    if (auto binOpNode = llvm::dyn_cast<BinOpASTNode>(exprNode)) {
+        oss << "(" << binOpNode->getOp().getType() << " " << toSExpression(binOpNode->getLhsExprNode()) << " "
+            << toSExpression(binOpNode->getRhsExprNode()) << ")";
+    } else if (auto unaryOpNode = llvm::dyn_cast<UnaryOpASTNode>(exprNode)) {
+        oss << "(" << unaryOpNode->getOp().getType() << " " << toSExpression(unaryOpNode->getExprNode()) << ")";
+    } else if (auto literalNode = llvm::dyn_cast<LiteralASTNode>(exprNode)) {
+        oss << literalNode->getValue();
+    } else if (auto declRefNode = llvm::dyn_cast<DeclRefASTNode>(exprNode)) {
+        oss << declRefNode->getRefName();
+    }
+    return oss.str();
+}
+
+TEST(ParserTests, HandlesOperatorPrecedence) {
+    const std::vector<std::pair<std::string, std::string>> cases = {
+        {"a - b - c", "(MINUS (MINUS a b) c)"},
+        {"a + b * c", "(PLUS a (MULTIPLY b c))"},
+        {"a * b + c * d", "(PLUS (MULTIPLY a b) (MULTIPLY c d))"},
+        {"a div b mod c / d", "(DIVIDE (MOD (DIV a b) c) d)"},
+        {"-a * -b", "(MULTIPLY (MINUS a) (MINUS b))"},
+        {"not - a", "(NOT (MINUS a))"},
+        {"(a + b) * c", "(MULTIPLY (PLUS a b) c)"},
+        {"a < b < c", "(LESS (LESS a b) c)"},
+        {"a = b <> c", "(NOT_EQUAL (EQUAL a b) c)"},
+        {"a or b and c = d < e + f * g", "(OR a (AND b (EQUAL c (LESS d (PLUS e (MULTIPLY f g))))))"},
+        {"a * b + c < d = e and f or g", "(OR (AND (EQUAL (LESS (PLUS (MULTIPLY a b) c) d) e) f) g)"},
+        {"a or b or c and d and e", "(OR (OR a b) (AND (AND c d) e))"},
+        {"1 + 2 >= x", "(GREATER_EQUAL (PLUS int: 1 int: 2) x)"},
+    };
+
+    for (const auto& [source, expected] : cases) {
+        std::istringstream input(source + ";");
+        Lexer lexer(input);
+        ASTContext context;
+        Parser parser(lexer, context);
+
+        EXPECT_EQ(expected, toSExpression(parser.parseExpression())) << source;
+    }
+
+    // A token that can neither continue nor end the expression is reported right after it
+    std::istringstream input("a + b c;");
+    Lexer lexer(input);
+    ASTContext context;
+    Parser parser(lexer, context);
+    EXPECT_THROW(parser.parseExpression(), ParserException);
+}
+
+TEST(ParserTests, HandlesFlatAST) {
+    std::istringstream input(
+        "program test;\n"
+        "const c = 2;\n"
+        "var a : array [1 .. 3] of real; i : integer;\n"
+        "begin\n"
+        "for i := c downto 1 do a[i] := -i * 1.5;\n"
+        "if not (a[1] <> 0) then writeln(a[1]) else exit\n"
+        "end.");
+    Lexer lexer(input);
+    ASTContext context;
+    Parser parser(lexer, context);
+    FlatAST flat = FlatAST::lower(*parser.parseProgram());
+
+    std::ostringstream oss;
+    flat.print(oss);
+    EXPECT_EQ(
+        "Program test\n"
+        "  Block\n"
+        "    ConstDef c\n"
+        "      Literal int: 2\n"
+        "    ArrayDecl a\n"
+        "      ArrayType from 1 to 3\n"
+        "        PrimitiveType real\n"
+        "    VarDecl i\n"
+        "      PrimitiveType integer\n"
+        "    CompoundStmt\n"
+        "      For downto\n"
+        "        Assign\n"
+        "          DeclVarRef i\n"
+        "          DeclVarRef c\n"
+        "        Literal int: 1\n"
+        "        Assign\n"
+        "          DeclArrayRef a\n"
+        "            DeclVarRef i\n"
+        "          BinOp MUL\n"
+        "            UnaryOp NEG\n"
+        "              DeclVarRef i\n"
+        "            Literal double: 1.5\n"
+        "      If\n"
+        "        UnaryOp NOT\n"
+        "          BinOp NE\n"
+        "            DeclArrayRef a\n"
+        "              Literal int: 1\n"
+        "            Literal int: 0\n"
+        "        ProcCall writeln\n"
+        "          DeclArrayRef a\n"
+        "            Literal int: 1\n"
+        "        Exit\n",
+        oss.str());
+
+    // Children are reached by jumping over the subtrees of the preceding ones
+    const FlatAST::NodeId blockId = flat.getChild(0, 0);
+    ASSERT_EQ(4, flat.getNumChildren(blockId));
+    const FlatAST::NodeId compoundId = flat.getChild(blockId, 3);
+    ASSERT_EQ(ASTNode::Kind::COMPOUND_STMT, flat.getKind(compoundId));
+    EXPECT_EQ(flat.size(), flat.getEnd(compoundId));
+
+    const FlatAST::NodeId ifId = flat.getChild(compoundId, 1);
+    ASSERT_EQ(ASTNode::Kind::IF, flat.getKind(ifId));
+    std::vector<ASTNode::Kind> ifChildren;
+    for (FlatAST::NodeId child : flat.children(ifId))
+        ifChildren.push_back(flat.getKind(child));
+    EXPECT_EQ(std::vector({ASTNode::Kind::UNARY_OP, ASTNode::Kind::PROC_CALL, ASTNode::Kind::EXIT}), ifChildren);
+    EXPECT_EQ(Opcode::NOT, flat.getOpcode(flat.getChild(ifId, 0)));
+
+    const FlatAST::NodeId forId = flat.getChild(compoundId, 0);
+    EXPECT_FALSE(flat.isIncreasing(forId));
+    EXPECT_EQ(TokenValue(1.5), flat.getValue(flat.getChild(flat.getChild(flat.getChild(forId, 2), 1), 1)));
+    EXPECT_LT(flat.getOffset(compoundId), flat.getOffset(forId));
+}
+
+TEST(ParserTests, HandlesFlatASTOfLongProgram) {
+    std::string source = "program test;\nconst c = 2 * 3; d = -c;\nvar x, y : integer;\nbegin\n";
+    for (size_t i = 0; i < 1000; ++i)
+        source += "x := (x + " + std::to_string(i) + ") * y - x div 3; if x > y then y := -x;\n";
+    source += "writeln(x)\nend.";
+
+    ASTContext context;
+    TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+    Parser parser(stream, context);
+    auto programNode = parser.parseProgram();
+    FlatAST flat = FlatAST::lower(*programNode);
+
+    // The same nodes as in the tree, kind by kind
+    CollectorVisitor<ExprASTNode> exprs;
+    exprs.dispatch(*programNode);
+    EXPECT_EQ(exprs.visitedNodes, flat.size());
+    const auto& kinds = flat.getKinds();
+    EXPECT_EQ(exprs.collectedNodes.size(), std::count_if(kinds.begin(), kinds.end(), [](ASTNode::Kind kind) {
+                  return kind >= ASTNode::Kind::BIN_OP && kind <= ASTNode::Kind::FUN_CALL;
+              }));
+
+    // 14 bytes per node plus the payloads, a fraction of the tree
+    EXPECT_LT(flat.getMemoryUsage(), flat.size() * 16);
+    EXPECT_LT(flat.getMemoryUsage() * 3, context.getBytesAllocated());
+}
+
+static void testStatementList(size_t statements) {
+    std::string source = "program test;\nvar x : integer;\nbegin\n";
+    for (size_t i = 0; i < statements; ++i)
+        source += "x := x + 1;\n";
+    source += "writeln(x)\nend.";
+
+    ASTContext context;
+    TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+    Parser parser(stream, context);
+    auto programNode = parser.parseProgram();
+
+    auto blockStatements = programNode->getBlockNode()->getStatementNodes();
+    auto compoundNode = llvm::dyn_cast<CompoundStmtASTNode>(blockStatements.back());
+    ASSERT_NE(nullptr, compoundNode);
+    ASSERT_EQ(statements + 1, compoundNode->getStatementNodes().size());
+}
+
+static void testDeclarationLists(size_t declarations) {
+    std::string source = "program test;\nconst\n";
+    for (size_t i = 0; i < declarations; ++i)
+        source += "c" + std::to_string(i) + " = " + std::to_string(i) + ";\n";
+    source += "var v0";
+    for (size_t i = 1; i < declarations; ++i)
+        source += ", v" + std::to_string(i);
+    source += " : integer;\nbegin\nwriteln(c0";
+    for (size_t i = 1; i < declarations; ++i)
+        source += ", c" + std::to_string(i);
+    source += ")\nend.";
+
+    ASTContext context;
+    TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+    Parser parser(stream, context);
+    auto programNode = parser.parseProgram();
+
+    auto blockStatements = programNode->getBlockNode()->getStatementNodes();
+    ASSERT_EQ(2 * declarations + 1, blockStatements.size());
+
+    auto compoundNode = llvm::dyn_cast<CompoundStmtASTNode>(blockStatements.back());
+    auto callNode = llvm::dyn_cast<ProcCallASTNode>(compoundNode->getStatementNodes()[0]);
+    ASSERT_NE(nullptr, callNode);
+    ASSERT_EQ(declarations, callNode->getArgNodes().size());
+}
+
+TEST(ParserTests, HandlesMillionStatements) {
+    testStatementList(1000000);
+}
+
+TEST(ParserTests, HandlesMillionDeclarations) {
+    testDeclarationLists(1000000);
+}
+
+TEST(ParserTests, HandlesLongElseIfChain) {
+    const size_t branches = 1000000;
+    std::string source = "program test;\nvar x : integer;\nbegin\nreadln(x);\n";
+    for (size_t i = 0; i < branches; ++i)
+        source += "if x = " + std::to_string(i) + " then writeln(" + std::to_string(i) + ") else ";
+    source += "writeln(-1)\nend.";
+
+    ASTContext context;
+    TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+    Parser parser(stream, context);
+    auto programNode = parser.parseProgram();
+
+    auto compoundNode = llvm::dyn_cast<CompoundStmtASTNode>(programNode->getBlockNode()->getStatementNodes().back());
+    StatementASTNode* statementNode = compoundNode->getStatementNodes()[1];
+
+    // Each 'else if' is nested in the else branch of the previous one
+    size_t chainLength = 0;
+    while (auto ifNode = llvm::dyn_cast<IfASTNode>(statementNode)) {
+        ++chainLength;
+        ASSERT_TRUE(ifNode->getElseBodyNode().has_value());
+        statementNode = ifNode->getElseBodyNode().value();
+    }
+    ASSERT_EQ(branches, chainLength);
+    ASSERT_NE(nullptr, llvm::dyn_cast<ProcCallASTNode>(statementNode));
+}
+
+static void expectTooDeep(const std::string& source) {
+    ASTContext context;
+    TokenStream stream = TokenStream::lex(source.data(), source.data() + source.size());
+    Parser parser(stream, context);
+    try {
+        parser.parseProgram();
+        FAIL() << "expected a ParserException";
+    } catch (const ParserException& e) {
+        EXPECT_NE(std::string::npos, std::string(e.what()).find("Nesting is deeper than")) << e.what();
+    }
+}
+
+TEST(ParserTests, HandlesDeepNesting) {
+    auto nestedProgram = [](size_t depth) {
+        std::string source = "program test;\nvar x : integer;\nbegin\n";
+        for (size_t i = 0; i < depth; ++i)
+            source += "while x > 0 do begin ";
+        source += "x := -(-(" + std::string(depth, '(') + "x" + std::string(depth, ')') + "))";
+        for (size_t i = 0; i < depth; ++i)
+            source += " end";
+        return source + "\nend.";
+    };
+
+    const std::string accepted = nestedProgram(200);
+    ASTContext acceptedContext;
+    TokenStream acceptedStream = TokenStream::lex(accepted.data(), accepted.data() + accepted.size());
+    Parser acceptedParser(acceptedStream, acceptedContext);
+    EXPECT_NO_THROW(acceptedParser.parseProgram());
+
+    // Input nested deeper than the limit is rejected instead of overflowing the stack
+    expectTooDeep(nestedProgram(50000));
+    expectTooDeep("program test;\nbegin\nwriteln(" + std::string(50000, '(') + "1" + std::string(50000, ')') +
+                  ")\nend.");
+
+    // Operator chains are not nesting, they are parsed and walked by the later passes without recursion
+    std::string sum = "program test;\nvar x : integer;\nbegin\nx := 0";
+    for (size_t i = 0; i < 50000; ++i)
+        sum += " + 1";
+    sum += ";\nx := " + std::string(50000, '-') + "x\nend.";
+    ASTContext sumContext;
+    TokenStream sumStream = TokenStream::lex(sum.data(), sum.data() + sum.size());
+    Parser sumParser(sumStream, sumContext);
+    EXPECT_NO_THROW(sumParser.parseProgram());
+}
+
+TEST(ParserTests, HandlesRuleTracing) {
+    const std::string source = "program test;\nbegin\nwriteln(1 + 2)\nend.";
+
+    // Without tracing nothing reaches the stream
+    std::istringstream quietInput(source);
+    Lexer quietLexer(quietInput);
+    std::ostringstream quietDump;
+    ASTContext quietContext;
+    Parser quietParser(quietLexer, quietContext, false, quietDump);
+    quietParser.parseProgram();
+    EXPECT_TRUE(quietDump.str().empty());
+
+    std::istringstream input(source);
+    Lexer lexer(input);
+    std::ostringstream dump;
+    ASTContext context;
+    Parser parser(lexer, context, true, dump);
+    parser.parseProgram();
+
+    const std::string rules = dump.str();
+    EXPECT_EQ(0, rules.find("Program -> <PROGRAM> <IDENTIFIER> <SEMICOLON> Block <DOT>\nmatch "));
+    EXPECT_NE(std::string::npos, rules.find("AdditiveOperator -> <PLUS>\nmatch "));
+    EXPECT_NE(std::string::npos, rules.find("CompoundStatementR ->\n"));
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "ast/CodeGenerator.hpp"
+#include "ast/SemaContext.hpp"
+#include "ast/visitor/CollectorVisitor.hpp"
+#include "ast/visitor/SemaVisitor.hpp"
+#include "parser/Parser.hpp"
+
+/**
+ * @brief Runs the semantic analysis over the program, returns the located error message or "" if there is none
+ */
+static std::string analysisErrorOf(const std::string& src) {
+    std::istringstream input(src);
+    Lexer lexer(input);
+    ASTContext context;
+    Parser parser(lexer, context);
+    ProgramASTNode* programNode = parser.parseProgram();
+
+    SemaContext sema;
+    try {
+        SemaVisitor(sema).analyze(*programNode);
+    } catch (const CodeGenException& e) {
+        return e.format(lexer.getSourceManager());
+    }
+    return "";
+}
+
+TEST(SemaTests, HandlesSymbolTableScopes) {
+    SymbolTable table;
+    table.addSymbol("x", 0);
+    EXPECT_THROW(table.addSymbol("x", 1), CodeGenException);
+
+    {
+        SymbolTable::Scope outer(table);
+        EXPECT_TRUE(table.contains("x"));
+        EXPECT_FALSE(table.containsInScope("x"));
+
+        table.addSymbol("x", 1);
+        table.addSymbol("y", 2);
+        EXPECT_EQ(1u, table.lookup("x"));
+
+        {
+            SymbolTable::Scope inner(table);
+            table.addSymbol("x", 3);
+            EXPECT_EQ(3u, table.lookup("x"));
+        }
+
+        EXPECT_EQ(1u, table.lookup("x"));
+        EXPECT_TRUE(table.containsInScope("y"));
+    }
+
+    EXPECT_EQ(0u, table.lookup("x"));
+    EXPECT_FALSE(table.contains("y"));
+    EXPECT_EQ(std::nullopt, table.lookup("y"));
+    EXPECT_THROW(table.popScope(), CodeGenException);
+}
+
+TEST(SemaTests, InternsTypes) {
+    SemaContext sema;
+    const SemaType* integerArray = sema.getArrayType(sema.getIntegerType(), 1, 10);
+
+    EXPECT_EQ(integerArray, sema.getArrayType(sema.getIntegerType(), 1, 10));
+    EXPECT_NE(integerArray, sema.getArrayType(sema.getIntegerType(), 0, 10));
+    EXPECT_NE(integerArray, sema.getArrayType(sema.getRealType(), 1, 10));
+    EXPECT_EQ(sema.getIntegerType(), integerArray->getElementType());
+    EXPECT_EQ("array [1..10] of integer", integerArray->toString());
+}
+
+TEST(SemaTests, BindsReferencesOnce) {
+    std::istringstream input(
+        "program test;\n"
+        "var x : integer; y : real;\n"
+        "procedure p(x : real);\n"
+        "begin y := x end;\n"
+        "function f(n : integer) : integer;\n"
+        "begin f := n * 2 end;\n"
+        "begin x := f(x); p(x) end.\n");
+    Lexer lexer(input);
+    ASTContext context;
+    Parser parser(lexer, context);
+    ProgramASTNode* programNode = parser.parseProgram();
+
+    SemaContext sema;
+    SemaVisitor(sema).analyze(*programNode);
+
+    CollectorVisitor<DeclVarRefASTNode> refs;
+    refs.dispatch(*programNode);
+
+    // Assignments are collected expression first: x, y (in p), n, f (in f), x, x, x (in the main block)
+    ASSERT_EQ(7u, refs.collectedNodes.size());
+    for (const auto* ref : refs.collectedNodes) {
+        const Symbol& symbol = sema.getSymbol(ref->getSymbolId());
+        EXPECT_EQ(ref->getRefName(), symbol.name.str());
+        EXPECT_EQ(symbol.type, ref->getSemaType());
+    }
+
+    // The parameter 'x' of 'p' shadows the global one
+    const DeclVarRefASTNode* paramRef = refs.collectedNodes[0];
+    const DeclVarRefASTNode* globalRef = refs.collectedNodes.back();
+    EXPECT_NE(paramRef->getSymbolId(), globalRef->getSymbolId());
+    EXPECT_EQ(sema.getRealType(), paramRef->getSemaType());
+    EXPECT_FALSE(sema.getSymbol(paramRef->getSymbolId()).global);
+    EXPECT_EQ(sema.getIntegerType(), globalRef->getSemaType());
+    EXPECT_TRUE(sema.getSymbol(globalRef->getSymbolId()).global);
+
+    CollectorVisitor<FunCallASTNode> calls;
+    calls.dispatch(*programNode);
+    ASSERT_EQ(1u, calls.collectedNodes.size());
+    const Routine& routine = sema.getRoutine(calls.collectedNodes[0]->getRoutineId());
+    EXPECT_EQ("f", routine.name);
+    EXPECT_EQ(Builtin::NONE, routine.builtin);
+    EXPECT_EQ(sema.getIntegerType(), routine.returnType);
+}
+
+TEST(SemaTests, ReportsTypeErrors) {
+    EXPECT_EQ("at [3:10] - Condition must be a boolean expression",
+              analysisErrorOf("program test;\nvar x : integer;\nbegin if x then x := 1\nend."));
+    EXPECT_EQ("at [3:9] - Assignment failed - cannot assign boolean value to an integer variable: x",
+              analysisErrorOf("program test;\nvar x : integer;\nbegin x := 1 < 2\nend."));
+    EXPECT_EQ("at [3:14] - Operator '+' cannot be applied to integer and boolean",
+              analysisErrorOf("program test;\nvar x : integer;\nbegin x := 1 + (x < 2)\nend."));
+    EXPECT_EQ("at [3:12] - Unsupported NOT operation for real type",
+              analysisErrorOf("program test;\nvar x : real;\nbegin x := not x\nend."));
+    EXPECT_EQ("at [4:9] - Function/Procedure p expects argument $0 of type integer, but real was provided",
+              analysisErrorOf("program test;\nprocedure p(n : integer);\nbegin end;\nbegin p(1.5)\nend."));
+    EXPECT_EQ("at [3:7] - Unsupported argument type for 'writeln' procedure",
+              analysisErrorOf("program test;\nvar x : integer;\nbegin writeln(x > 1)\nend."));
+    EXPECT_EQ("at [3:7] - Cannot read into a constant: c",
+              analysisErrorOf("program test;\nconst c = 1;\nbegin readln(c)\nend."));
+    EXPECT_EQ("at [3:15] - Array is used without an index: a",
+              analysisErrorOf("program test;\nvar a : array [1 .. 2] of integer;\nbegin a[1] := a\nend."));
+    EXPECT_EQ("", analysisErrorOf("program test;\nvar y : real;\nbegin y := 1 + 2.5; if (y > 1) and (y < 4) then "
+                                  "writeln(y)\nend."));
+}
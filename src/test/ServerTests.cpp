@@ -0,0 +1,246 @@
+#include <gtest/gtest.h>
+#include <llvm/Support/FileSystem.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include "server/CompileServer.hpp"
+#include "utils/Utils.hpp"
+
+/**
+ * @brief Fresh working directory per test (for executables and the socket), removed afterwards
+ */
+class ServerTests : public testing::Test {
+   protected:
+    std::string directory;
+
+    void SetUp() override {
+        llvm::SmallString<128> path;
+        ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("mila-server-test", path));
+        ASSERT_FALSE(llvm::sys::fs::make_absolute(path));
+        directory = path.str().str();
+    }
+
+    void TearDown() override {
+        llvm::sys::fs::remove_directories(directory);
+    }
+};
+
+TEST_F(ServerTests, HandlesProtocolEncoding) {
+    Protocol::CompileRequest request{"program test; begin end.", "/tmp/out", {"-O2", "-Os"}};
+    Protocol::CompileRequest decodedRequest = Protocol::decodeCompileRequest(Protocol::encodeCompileRequest(request));
+
+    EXPECT_EQ(request.source, decodedRequest.source);
+    EXPECT_EQ(request.outputFile, decodedRequest.outputFile);
+    EXPECT_EQ(request.flags, decodedRequest.flags);
+
+    Protocol::Response response{-1, "out", std::string(300, 'e')};
+    Protocol::Response decodedResponse = Protocol::decodeResponse(Protocol::encodeResponse(response));
+
+    EXPECT_EQ(response.exitCode, decodedResponse.exitCode);
+    EXPECT_EQ(response.out, decodedResponse.out);
+    EXPECT_EQ(response.err, decodedResponse.err);
+
+    ASSERT_THROW(Protocol::decodeResponse(Protocol::encodeCompileRequest(request)), ProtocolException);
+    ASSERT_THROW(Protocol::decodeCompileRequest(Protocol::encodeCompileRequest(request).substr(0, 10)),
+                 ProtocolException);
+}
+
+TEST_F(ServerTests, HandlesLatencyHistogram) {
+    LatencyHistogram histogram;
+    for (uint64_t latencyUs : {100, 100, 100, 100, 100, 100, 100, 100, 100, 5000})
+        histogram.record(latencyUs);
+
+    EXPECT_EQ(10u, histogram.getCount());
+    EXPECT_EQ(128u, histogram.percentile(50));
+    EXPECT_EQ(128u, histogram.percentile(90));
+    EXPECT_EQ(8192u, histogram.percentile(99));
+}
+
+TEST_F(ServerTests, HandlesCompileService) {
+    CompileService service(2);
+
+    // More requests than pooled contexts
+    for (int i = 0; i < 3; ++i) {
+        std::string outputFile = directory + "/prog" + std::to_string(i) + ".out";
+        Protocol::Response response = service.compile(
+            {"program test; begin writeln(" + std::to_string(i) + "); end.", outputFile, {"-O2"}});
+
+        ASSERT_EQ(EXIT_SUCCESS, response.exitCode) << response.err;
+        EXPECT_EQ(std::to_string(i) + "\n", Utils::exec(outputFile).output);
+    }
+
+    Protocol::Response parserError = service.compile({"program test; begin x := ; end.", directory + "/bad", {}});
+    EXPECT_EQ(EXIT_FAILURE, parserError.exitCode);
+    EXPECT_NE(std::string::npos, parserError.err.find("Parser error"));
+
+    Protocol::Response badFlag = service.compile({"program test; begin end.", directory + "/bad", {"--run"}});
+    EXPECT_EQ(EXIT_FAILURE, badFlag.exitCode);
+
+    Protocol::Response relativeOutput = service.compile({"program test; begin end.", "bad", {}});
+    EXPECT_EQ(EXIT_FAILURE, relativeOutput.exitCode);
+    EXPECT_NE(std::string::npos, relativeOutput.err.find("absolute path"));
+
+    EXPECT_NE(std::string::npos, service.stats().find("Requests: 6 (3 failed)"));
+}
+
+TEST_F(ServerTests, HandlesServerRequests) {
+    const std::string socketPath = directory + "/milac.sock";
+    auto server = std::make_unique<CompileServer>(socketPath);
+    std::thread serverThread([&server]() { server->serve(); });
+
+    // Accessible to the owner only, whatever the umask
+    struct stat status {};
+    ASSERT_EQ(0, stat(socketPath.c_str(), &status));
+    EXPECT_EQ(mode_t(S_IRUSR | S_IWUSR), status.st_mode & 0777);
+
+    Protocol::Response response = Protocol::request(
+        socketPath,
+        Protocol::encodeCompileRequest({"program test; begin writeln(7); end.", directory + "/prog.out", {"-O1"}}));
+    EXPECT_EQ(EXIT_SUCCESS, response.exitCode) << response.err;
+    EXPECT_EQ("7\n", Utils::exec(directory + "/prog.out").output);
+
+    Protocol::Response stats =
+        Protocol::request(socketPath, std::string(1, static_cast<char>(Protocol::MessageType::Stats)));
+    EXPECT_NE(std::string::npos, stats.out.find("Requests: 1 (0 failed)"));
+
+    Protocol::request(socketPath, std::string(1, static_cast<char>(Protocol::MessageType::Shutdown)));
+    serverThread.join();
+    server.reset();
+
+    EXPECT_FALSE(llvm::sys::fs::exists(socketPath));
+    ASSERT_THROW(Protocol::request(socketPath, std::string(1, static_cast<char>(Protocol::MessageType::Stats))),
+                 ProtocolException);
+}
+
+TEST_F(ServerTests, HandlesOccupiedSocketPath) {
+    // Not a socket, left untouched
+    const std::string filePath = directory + "/file";
+    std::ofstream(filePath) << "data";
+    ASSERT_THROW(CompileServer server(filePath), ServerException);
+    EXPECT_TRUE(llvm::sys::fs::exists(filePath));
+
+    // A live server is not replaced
+    const std::string socketPath = directory + "/milac.sock";
+    {
+        CompileServer server(socketPath);
+        ASSERT_THROW(CompileServer second(socketPath), ServerException);
+    }
+
+    // A stale socket of a killed server (bound, then closed without removing the file) is replaced
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    int staleFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_EQ(0, bind(staleFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+    close(staleFd);
+    ASSERT_TRUE(llvm::sys::fs::exists(socketPath));
+    EXPECT_NO_THROW(CompileServer replacement(socketPath));
+}
+
+TEST_F(ServerTests, SurvivesMisbehavingClients) {
+    const std::string socketPath = directory + "/milac.sock";
+    auto server = std::make_unique<CompileServer>(socketPath, std::chrono::milliseconds(200));
+    std::thread serverThread([&server]() { server->serve(); });
+
+    auto connectRaw = [&socketPath]() {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        EXPECT_EQ(0, connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+        return fd;
+    };
+
+    // A frame length far beyond maxFrameSize is refused before anything is allocated
+    int hugeFd = connectRaw();
+    const unsigned char hugeHeader[] = {0xff, 0xff, 0xff, 0xff};
+    ASSERT_EQ(4, send(hugeFd, hugeHeader, sizeof(hugeHeader), MSG_NOSIGNAL));
+
+    // An idle client only holds the server until the timeout
+    int idleFd = connectRaw();
+
+    Protocol::Response stats =
+        Protocol::request(socketPath, std::string(1, static_cast<char>(Protocol::MessageType::Stats)));
+    EXPECT_NE(std::string::npos, stats.out.find("Requests: 0"));
+
+    close(hugeFd);
+    close(idleFd);
+    Protocol::request(socketPath, std::string(1, static_cast<char>(Protocol::MessageType::Shutdown)));
+    serverThread.join();
+}
+
+TEST_F(ServerTests, RejectsOtherUsers) {
+    if (geteuid() != 0)
+        GTEST_SKIP() << "switching to another user requires root";
+    const uid_t otherUid = 65534;  // nobody
+
+    auto listenOn = [](const std::string& path) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        EXPECT_EQ(0, bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+        EXPECT_EQ(0, listen(fd, 1));
+        return fd;
+    };
+
+    // A socket planted by another user is neither used by clients nor replaced by the server
+    const std::string foreignPath = directory + "/foreign.sock";
+    int foreignFd = listenOn(foreignPath);
+    ASSERT_EQ(0, chown(foreignPath.c_str(), otherUid, otherUid));
+    try {
+        Protocol::request(foreignPath, std::string(1, static_cast<char>(Protocol::MessageType::Stats)));
+        FAIL() << "expected a ProtocolException";
+    } catch (const ProtocolException& e) {
+        EXPECT_NE(std::string::npos, std::string(e.what()).find("not a socket owned by the current user")) << e.what();
+    }
+    close(foreignFd);
+    ASSERT_THROW(CompileServer server(foreignPath), ServerException);
+
+    const std::string socketPath = directory + "/milac.sock";
+    auto server = std::make_unique<CompileServer>(socketPath);
+    std::thread serverThread([&server]() { server->serve(); });
+
+    // Connects as the other user and sends a stats request, the exit code tells how far it got: 1 - connect failed,
+    // 2 - the server answered, 0 - the server closed the connection (before or after the request was sent)
+    auto requestAsOtherUser = [&socketPath, otherUid]() {
+        pid_t pid = fork();
+        if (pid == 0) {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+            int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (setgid(otherUid) != 0 || setuid(otherUid) != 0 ||
+                connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+                _exit(1);
+
+            const char frame[] = {0, 0, 0, 1, static_cast<char>(Protocol::MessageType::Stats)};
+            char answer;
+            _exit(send(fd, frame, sizeof(frame), MSG_NOSIGNAL) == sizeof(frame) && recv(fd, &answer, 1, 0) > 0 ? 2 : 0);
+        }
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    };
+
+    // The permissions of the socket keep the other user out
+    EXPECT_EQ(1, requestAsOtherUser());
+
+    // Its credentials too, even if the permissions (of the socket and of the directory) are loosened
+    ASSERT_EQ(0, chmod(directory.c_str(), 0711));
+    ASSERT_EQ(0, chmod(socketPath.c_str(), 0666));
+    EXPECT_EQ(0, requestAsOtherUser());
+
+    Protocol::Response stats =
+        Protocol::request(socketPath, std::string(1, static_cast<char>(Protocol::MessageType::Stats)));
+    EXPECT_NE(std::string::npos, stats.out.find("Rejected connections of other users: 1"));
+
+    Protocol::request(socketPath, std::string(1, static_cast<char>(Protocol::MessageType::Shutdown)));
+    serverThread.join();
+}
@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <sstream>
+#include "utils/PhaseTimer.hpp"
+#include "utils/Statistic.hpp"
 #include "utils/Utils.hpp"
 
 TEST(CodeGenTests, HandlesExecCommmandSuccess) {
@@ -13,3 +16,61 @@ TEST(CodeGenTests, HandlesExecCommmandError) {
 
     EXPECT_EQ(2, programResult.exitCode);
 }
+
+TEST(UtilsTests, HandlesPhaseTimings) {
+    PhaseTimings timings;
+    {
+        PhaseTimings::Activation activation(timings);
+        PhaseTimer outer("Outer");
+        for (int i = 0; i < 3; ++i)
+            PhaseTimer inner("Inner");
+    }
+
+    // Without an active registry nothing is recorded
+    { PhaseTimer ignored("Ignored"); }
+
+    std::ostringstream os;
+    timings.print(os);
+    const std::string table = os.str();
+
+    size_t outer = table.find("\nOuter ");
+    size_t inner = table.find("\n  Inner ");
+    ASSERT_NE(std::string::npos, outer);
+    ASSERT_NE(std::string::npos, inner);
+    EXPECT_LT(outer, inner);
+    EXPECT_NE(std::string::npos, table.find(" 3 ", inner));
+    EXPECT_EQ(std::string::npos, table.find("Ignored"));
+    EXPECT_EQ(nullptr, PhaseTimings::active());
+}
+
+MILA_STATISTIC(NumTestEvents, "test", "Number of test events");
+
+TEST(UtilsTests, HandlesStatistics) {
+    StatisticRegistry& registry = StatisticRegistry::instance();
+    registry.reset();
+
+    ++NumTestEvents;
+    NumTestEvents += 2;
+    EXPECT_EQ(3u, registry.getValue("test", "NumTestEvents"));
+
+    // Named counters are only collected when enabled
+    registry.add("test", "dynamic", 5);
+    EXPECT_EQ(0u, registry.getValue("test", "dynamic"));
+    registry.setEnabled(true);
+    registry.add("test", "dynamic", 5);
+    registry.add("test", "dynamic", 1);
+    registry.setEnabled(false);
+    EXPECT_EQ(6u, registry.getValue("test", "dynamic"));
+
+    std::ostringstream text, json;
+    registry.print(text, false);
+    registry.print(json, true);
+    EXPECT_NE(std::string::npos, text.str().find("Statistics Collected"));
+    EXPECT_NE(std::string::npos, text.str().find("3 test       - Number of test events"));
+    EXPECT_NE(std::string::npos, json.str().find("\"NumTestEvents\": 3"));
+    EXPECT_NE(std::string::npos, json.str().find("\"dynamic\": 6"));
+
+    registry.reset();
+    EXPECT_EQ(0u, registry.getValue("test", "NumTestEvents"));
+    EXPECT_EQ(0u, registry.getValue("test", "dynamic"));
+}